@@ -40,6 +40,7 @@
 #include <seesaw_neopixel.h>    // NeoPixel op encoder board
 #include <SD_MMC.h>             // SD card voor CSV recording (SD_MMC mode)
 #include <esp_now.h>            // ESP-NOW communicatie
+#include <esp_timer.h>          // 64 bit µs klok voor de sessie tijd sync
 #include <WiFi.h>               // WiFi voor ESP-NOW
 #include "esp_task_wdt.h"       // 🔥 NIEUW: Watchdog timer
 #include <Preferences.h>        // Voor touch settings opslag
@@ -53,6 +54,17 @@
 #include "nvs_settings.h"       // 🔥 NIEUW: Centrale NVS opslag (vervangt EEPROM functies)
 #include "sensor_settings.h"    // Alleen struct definitie voor compatibiliteit
 #include "multifunplayer_client.h"  // MultiFunPlayer WebSocket client
+#include "ai_analyze_queue.h"   // Achtergrond AI analyse van opnames
+#include "edge_forecaster.h"    // Seconden tot edge voorspelling
+#include "change_point.h"       // CUSUM change point events (HR/GSR/Temp)
+#include "signal_quality.h"     // Artefact detectie / SQI per sensor kanaal
+#include "espnow_protocol.h"    // Binair ESP-NOW protocol (gedeeld met HoofdESP)
+#include "espnow_rx_queue.h"    // Lock-free callback → loop() overdracht
+#include "espnow_reliable.h"    // Ack + herhaling voor kritieke opcodes
+#include "espnow_publisher.h"   // Adaptief zendritme (alleen bij wijziging + keepalive)
+#include "espnow_link.h"        // RTT / verlies / RSSI van de HoofdESP link
+#include "espnow_timesync.h"    // Sessie klok: HoofdESP tijd via PING/PONG
+#include "espnow_netem.h"       // Nagebootst slecht kanaal (ESPNOW_NETEM_ENABLED)
 
 // ========= TOUCH TOGGLE STATES (GLOBAAL) =========
 bool touchEnabled = true;         // Global touch enable/disable
@@ -185,8 +197,8 @@ static float sleevePercentage = 0.0f;  // Echte sleeve positie percentage (0-100
 static uint8_t hoofdESPSpeedStep = 3;  // Laatst ontvangen speed step van HoofdESP
 static bool espNowInitialized = false;
 
-// ESP-NOW ontvangst bericht structuur (van HoofdESP)
-typedef struct __attribute__((packed)) {
+// ESP-NOW ontvangst (van HoofdESP), gedecodeerd uit EspNowStatusPayload
+typedef struct {
   float trust;            // Trust speed (0.0-2.0)
   float sleeve;           // Sleeve speed (0.0-2.0)  
   float suction;          // Suction level (0.0-100.0)
@@ -199,37 +211,73 @@ typedef struct __attribute__((packed)) {
   float cyclusTijd;       // Verwachte cyclus duur in seconden
   float sleevePercentage; // Sleeve positie percentage (0.0-100.0)
   uint8_t currentSpeedStep; // Huidige versnelling (0-7)
-  char command[32];       // "STATUS_UPDATE"
+  uint8_t opcode;         // ESPNOW_OP_STATUS_UPDATE, ESPNOW_OP_ORGASM_TRIGGER, ...
 } esp_now_receive_message_t;
 
-// ESP-NOW verzend bericht structuur (naar HoofdESP)
-typedef struct __attribute__((packed)) {
-  float newTrust;         // AI berekende trust override (0.0-1.0)
-  float newSleeve;        // AI berekende sleeve override (0.0-1.0)
-  bool overruleActive;    // AI overrule status
-  uint8_t stressLevel;    // Stress level 1-7 voor playback/AI
-  bool vibeOn;            // Vibe status voor playback
-  bool zuigenOn;          // Zuigen status voor playback
-  char command[32];       // "AI_OVERRIDE", "EMERGENCY_STOP", "HEARTBEAT", "PLAYBACK_STRESS"
-} esp_now_send_message_t;
-
-// 🔥 NIEUW: ESP-NOW Retry Queue (NA typedef!)
-#define ESPNOW_QUEUE_SIZE 5
-#define MAX_RETRIES 3
-#define RETRY_DELAY_MS 100
-
-struct ESPNowQueueItem {
-  esp_now_send_message_t message;
-  uint32_t timestamp;
-  uint8_t retryCount;
-  bool inUse;
-};
+// Volgnummers, ack/herhaling en duplicaat filter voor de HoofdESP peer
+static EspNowReliable espNowRel;
+
+// Link kwaliteit naar HoofdESP (PING/PONG, seq gaten, RSSI) - ook in de CSV opname
+static EspNowLinkStats hooftLink;
+
+// Sessie klok = HoofdESP klok. Body frames dragen die tijd (ESPNOW_FLAG_SYNCED)
+// zodat beide kanten log regels, status en latency op één tijdlijn zetten.
+static EspNowClockSync hooftClock;
+static uint32_t hooftStatusSessionMs = 0;  // hdr.timeMs van laatste HoofdESP status
+static uint32_t hooftStatusRxMs = 0;       // millis() bij ontvangst daarvan
+
+// Sessie tijd (ms) voor hdr.timeMs + bijbehorende vlag. Niet gesynchroniseerd
+// → eigen millis() zonder vlag (zelfde als voor de tijd sync)
+static uint32_t espnowSessionMs(uint8_t* flags = nullptr) {
+  int64_t nowUs = esp_timer_get_time();
+  bool synced = espnowSync_isSynced(hooftClock, nowUs);
+  if (flags) *flags = synced ? ESPNOW_FLAG_SYNCED : 0;
+  return (uint32_t)((synced ? espnowSync_toMasterUs(hooftClock, nowUs) : nowUs) / 1000);
+}
+
+// Leeftijd (ms) van de laatst ontvangen HoofdESP status op de sessie klok,
+// -1 = onbekend (nog geen status of klok niet gesynchroniseerd)
+static int32_t hooftStatusAgeMs() {
+  if (hooftStatusRxMs == 0 || !espnowSync_isSynced(hooftClock, esp_timer_get_time())) return -1;
+  return (int32_t)(espnowSessionMs() - hooftStatusSessionMs);
+}
 
-static ESPNowQueueItem espNowQueue[ESPNOW_QUEUE_SIZE];
-static int queueHead = 0;
-static int queueTail = 0;
-static int queueCount = 0;
+static bool sendHooftFrame(const uint8_t* frame, uint8_t len) {
+  return esp_now_send(hoofdESP_MAC, frame, len) == ESP_OK;
+}
 
+// AI_OVERRIDE / AI_WARMUP: alleen bij een ander commando, anders keepalive.
+// Elk frame is kritiek (ACK + herhaling), dus niet elke tick opnieuw sturen.
+#define AI_CMD_MIN_GAP_MS       500     // Max 2 nieuwe AI commando's per seconde
+#define AI_CMD_KEEPALIVE_MS     3000    // Zelfde commando herhalen (HoofdESP timeout = 10s)
+#define AI_CMD_TRUST_DEADBAND   0.02f
+
+static EspNowPublisher aiCmdPub;
+
+// true = nu versturen (en onthouden als laatst verstuurd commando)
+static bool aiCommandDue(uint8_t opcode, float trust, uint8_t level, bool vibe, bool zuigen) {
+  static uint8_t lastOpcode = 0;
+  static uint8_t lastLevel = 0xFF;
+  static bool lastVibe = false;
+  static bool lastZuigen = false;
+  static float lastTrust = -1.0f;
+
+  bool changed = opcode != lastOpcode || level != lastLevel ||
+                 vibe != lastVibe || zuigen != lastZuigen ||
+                 fabsf(trust - lastTrust) > AI_CMD_TRUST_DEADBAND;
+  // Stop / nood pauze nog niet bevestigd: geen AI commando ertussen
+  if (espnowRel_priorityOpen(espNowRel)) return false;
+  EspNowPubSend kind = espnowPub_decide(aiCmdPub, millis(), changed, false);
+  if (kind == ESPNOW_PUB_NONE) return false;
+
+  lastOpcode = opcode;
+  lastLevel = level;
+  lastVibe = vibe;
+  lastZuigen = zuigen;
+  lastTrust = trust;
+  espnowPub_sent(aiCmdPub, millis(), kind);
+  return true;
+}
 
 // ===== Callback variabelen =====
 volatile bool touchDetected = false;
@@ -253,6 +301,7 @@ static uint32_t warmupStartTime = 0;
 static bool warmupActive = false;
 static bool orgasmActive = false;      // 🔥 NIEUW: Orgasme gedetecteerd
 static bool cooldownActive = false;    // 🔥 NIEUW: Cooldown na orgasme
+static int aiDecisionLevel = -1;       // Laatste AI level (0-7), -1 = AI niet actief
 
 // ===== CSV Recording =====
 File csvFile;
@@ -261,6 +310,7 @@ static uint32_t lastCSVWrite = 0;
 const uint32_t CSV_WRITE_INTERVAL = 1000;  // Elke 1 seconde een regel schrijven
 uint32_t recordingStartTime = 0;
 uint32_t csvSampleCount = 0;
+static uint32_t csvChangePointSeq = 0;  // Laatst gelogde change point event
 
 // 🔥 NIEUW: SD card write buffer (60 samples = 1 minuut bij 1 Hz)
 #define SD_BUFFER_SIZE 60
@@ -499,12 +549,16 @@ void startCSVRecording() {
   }
   
   // Schrijf CSV header
-  csvFile.println("Tijd_s,Timestamp,BPM,Temp_C,GSR,Trust,Sleeve,Suction,Vibe,Zuig,Vacuum_mbar,Pause,SleevePos_%,SpeedStep,AI_Override,Event");
+  csvFile.println("Tijd_s,Timestamp,BPM,Temp_C,GSR,Trust,Sleeve,Suction,Vibe,Zuig,Vacuum_mbar,Pause,SleevePos_%,SpeedStep,AI_Override,SQI_HR,SQI_GSR,SQI_Temp,Link_RTT_ms,Link_Loss_%,Link_RSSI,Link_Q,Sessie_ms,Sync_Err_ms,Hooft_Age_ms,Event");
   csvFile.flush();
   
   recordingStartTime = millis();
   csvSampleCount = 0;
   lastCSVWrite = millis();
+
+  // Events van voor de opname niet loggen
+  ChangePointEvent oldEvent;
+  while (changePoint_next(csvChangePointSeq, oldEvent)) {}
   
   Serial.printf("[CSV] Recording STARTED: %s\n", csvFilename.c_str());
 }
@@ -547,6 +601,8 @@ void updateCSVRecording() {
             rtcNow.hour(), rtcNow.minute(), rtcNow.second());
     
     // 🔥 NIEUW: Bepaal Event type
+    ChangePointEvent cpEvent;
+    bool cpNew = changePoint_next(csvChangePointSeq, cpEvent);
     const char* eventType = "NORMAL";
     if (cooldownActive) {
       eventType = "COOLDOWN";
@@ -556,13 +612,15 @@ void updateCSVRecording() {
       eventType = "WARMUP";
     } else if (emergencyPauseActive || pauseActive) {
       eventType = "PAUSE";
+    } else if (cpNew) {
+      eventType = changePoint_eventName(cpEvent);   // bv. CP_GSR_UP
     } else if (aiOverruleActive) {
       eventType = "AI_CONTROL";
     }
     
     // 🔥 NIEUW: Schrijf naar BUFFER in plaats van direct naar SD
-    char csvLine[280];
-    sprintf(csvLine, "%.1f,%s,%u,%.2f,%.1f,%.2f,%.2f,%.1f,%d,%d,%.1f,%d,%.0f,%u,%d,%s",
+    char csvLine[300];
+    sprintf(csvLine, "%.1f,%s,%u,%.2f,%.1f,%.2f,%.2f,%.1f,%d,%d,%.1f,%d,%.0f,%u,%d,%u,%u,%u,%.1f,%u,%.0f,%u,%lu,%.1f,%ld,%s",
             elapsedTime,           // Tijd sinds start
             timestamp,             // RTC timestamp
             sensorData.BPM,        // Hartslag
@@ -578,6 +636,16 @@ void updateCSVRecording() {
             sleevePercentage,      // Sleeve positie %
             hoofdESPSpeedStep,     // Speed step
             aiOverruleActive ? 1 : 0,  // AI override
+            sensorData.pulseQuality,   // Signaal kwaliteit 0-100
+            sensorData.gsrQuality,
+            sensorData.ntcQuality,
+            hooftLink.rttAvgMs,        // Link naar HoofdESP (espnow_link.h)
+            espnowLink_lossPct(hooftLink),
+            hooftLink.rssiAvg,
+            espnowLink_quality(hooftLink, now),
+            (unsigned long)espnowSessionMs(),  // Sessie klok (= HoofdESP millis zodra sync)
+            hooftClock.synced ? espnowSync_errorUs(hooftClock, esp_timer_get_time()) / 1000.0f : -1.0f,
+            (long)hooftStatusAgeMs(),          // Hoe oud de HoofdESP status is die we kennen
             eventType);            // 🔥 NIEUW: Event kolom
     
     csvBuffer[bufferIndex++] = String(csvLine);
@@ -619,11 +687,129 @@ static uint8_t screenRotation = 1;
 // Funscript mode (Aan/Uit) - extern beschikbaar voor menu
 bool funscriptEnabled = false;
 
-// ===== ESP-NOW Callback =====
-static void onESPNowReceive(const esp_now_recv_info *info, const uint8_t *incomingData, int len) {
-  if (len == sizeof(esp_now_receive_message_t)) {
+// ===== Latency trace (sensor sample → Keon) =====
+// Sensor tick zet een trace klaar, het eerstvolgende AI bericht neemt hem mee
+static uint32_t traceNextId = 1;
+static uint32_t traceSensorUs = 0;
+static uint32_t traceDecisionUs = 0;
+static uint32_t traceReadyUs = 0;          // micros() toen beslissing klaar was
+static bool traceArmed = false;
+static volatile uint32_t traceSentUs = 0;  // esp_now_send() van laatste trace bericht
+static volatile uint32_t traceAirUs = 0;   // Laatste gemeten send → callback
+
+static void armLatencyTrace(uint32_t sensorUs, uint32_t decisionUs) {
+  traceSensorUs = sensorUs;
+  traceDecisionUs = decisionUs;
+  traceReadyUs = micros();
+  traceArmed = true;
+}
+
+static void onESPNowSent(const uint8_t *mac, esp_now_send_status_t status) {
+  espnowRel_onSendStatus(espNowRel, status == ESP_NOW_SEND_SUCCESS);
+  if (traceSentUs != 0 && status == ESP_NOW_SEND_SUCCESS) {
+    traceAirUs = micros() - traceSentUs;
+  }
+  traceSentUs = 0;
+}
+
+// ===== ESP-NOW Ontvangst (loop context) =====
+static void handleHooftFrame(const uint8_t *incomingData, int len, int8_t rssi, int64_t rxUs) {
+  EspNowFrame frame;
+  EspNowDecodeResult decoded = espnow_decode(incomingData, len, frame);
+  if (decoded == ESPNOW_DECODE_OK) {
+    espnowLink_onFrame(hooftLink, frame.hdr, rssi, millis());
+  }
+  if (decoded == ESPNOW_DECODE_OK && frame.hdr.opcode == ESPNOW_OP_ACK) {
+    espnowRel_onAck(espNowRel, frame.ack.ackSeq, millis());
+    return;
+  }
+  if (decoded == ESPNOW_DECODE_OK && frame.hdr.opcode == ESPNOW_OP_PING) {
+    EspNowFrame pong;
+    memset(&pong, 0, sizeof(pong));
+    espnowLink_buildPong(hooftLink, frame, millis(), rxUs, esp_timer_get_time(), pong);
+    uint8_t flags;
+    uint32_t sessionMs = espnowSessionMs(&flags);
+    uint8_t buf[ESPNOW_MAX_FRAME];
+    uint8_t pongLen = espnow_encode(pong, ESPNOW_OP_PONG, espnowRel_nextSeq(espNowRel, ESPNOW_OP_PONG), sessionMs, false, buf, flags);
+    sendHooftFrame(buf, pongLen);
+    lastCommTime = millis();
+    return;
+  }
+  if (decoded == ESPNOW_DECODE_OK && frame.hdr.opcode == ESPNOW_OP_PONG) {
+    // Alleen het antwoord op onze eigen openstaande PING is een bruikbare sample
+    if (espnowLink_onPong(hooftLink, frame, millis(), rxUs)) {
+      bool wasSynced = hooftClock.synced;
+      uint32_t steps = hooftClock.steps;
+      if (espnowSync_onSample(hooftClock, frame.link.t1Us, frame.link.t2Us, frame.link.t3Us, rxUs)) {
+        if (!wasSynced || hooftClock.steps != steps) {
+          Serial.printf("[SYNC] Sessie klok %s: offset %lld ms, fout ±%.1f ms\n",
+                        wasSynced ? "opnieuw gezet (HoofdESP herstart?)" : "gesynchroniseerd",
+                        (long long)(hooftClock.offsetUs / 1000), espnowSync_errorUs(hooftClock, rxUs) / 1000.0f);
+        }
+      }
+    }
+    lastCommTime = millis();
+    return;
+  }
+  if (decoded == ESPNOW_DECODE_OK && espnow_isHooftOpcode(frame.hdr.opcode)) {
+    // ACK altijd terug (ook bij duplicaat: eerste ACK kan verloren zijn)
+    uint8_t ackFrame[ESPNOW_MAX_FRAME];
+    uint8_t ackFlags;
+    uint32_t ackMs = espnowSessionMs(&ackFlags);
+    uint8_t ackLen = espnowRel_buildAck(espNowRel, frame.hdr, ackMs, ackFrame, ackFlags);
+    if (ackLen) sendHooftFrame(ackFrame, ackLen);
+    if (espnowRel_onReceive(espNowRel, frame.hdr)) {
+      Serial.printf("[ESP-NOW] Duplicaat %s #%u genegeerd\n", espnow_opcodeName(frame.hdr.opcode), frame.hdr.seq);
+      return;
+    }
+
+    // Machine status: STATUS_UPDATE vervangt, STATUS_DELTA werkt alleen de
+    // meegestuurde velden bij. Event opcodes (ORGASM_*, FUNSCRIPT_*, ...) dragen
+    // geen volledige status en laten de laatst bekende status staan.
+    static EspNowStatusPayload hooftStatus = {};
+    static uint16_t hooftStatusSeq = 0;
+    static bool hooftStatusSeqValid = false;
+    static bool hooftStatusFull = false;
+    bool isStatus = frame.hdr.opcode == ESPNOW_OP_STATUS_UPDATE || frame.hdr.opcode == ESPNOW_OP_STATUS_DELTA;
+    // Delta zonder eerdere volledige status: geen basis, wachten op een FULL
+    if (frame.hdr.opcode == ESPNOW_OP_STATUS_DELTA && !hooftStatusFull) isStatus = false;
+    // Te laat binnen (volgorde omgedraaid): nieuwere status staat er al, niet
+    // terugdraaien. Grote sprong terug = HoofdESP herstart → gewoon toepassen.
+    int16_t statusAge = (int16_t)(hooftStatusSeq - frame.hdr.seq);
+    if (isStatus && !(hooftStatusSeqValid && statusAge > 0 && statusAge < ESPNOW_REL_DUP_BITS)) {
+      if (frame.hdr.opcode == ESPNOW_OP_STATUS_UPDATE) {
+        hooftStatus = frame.status;
+        hooftStatusFull = true;
+      } else {
+        espnow_applyStatusDelta(frame, hooftStatus);
+      }
+      hooftStatusSeq = frame.hdr.seq;
+      hooftStatusSeqValid = true;
+      hooftStatusSessionMs = frame.hdr.timeMs;   // HoofdESP stempelt met zijn eigen (= sessie) klok
+      hooftStatusRxMs = millis();
+    }
+
+    // HoofdESP → Body in één richting: ontvangst op de sessie klok - zendtijd
+    if ((frame.hdr.flags & ESPNOW_FLAG_SYNCED) && espnowSync_isSynced(hooftClock, rxUs)) {
+      int32_t oneWay = (int32_t)((uint32_t)(espnowSync_toMasterUs(hooftClock, rxUs) / 1000) - frame.hdr.timeMs);
+      espnowLink_onOneWay(hooftLink, oneWay);
+    }
+
+    const EspNowStatusPayload& st = hooftStatus;
     esp_now_receive_message_t message;
-    memcpy(&message, incomingData, sizeof(message));
+    message.trust = st.trust_x1000 / 1000.0f;
+    message.sleeve = st.sleeve_x1000 / 1000.0f;
+    message.suction = st.suction_x10 / 10.0f;
+    message.pause = st.pause_x100 / 100.0f;
+    message.vibeOn = st.bits & ESPNOW_ST_VIBE;
+    message.zuigActive = st.bits & ESPNOW_ST_ZUIG;
+    message.vacuumMbar = st.vacuumMbar_x10 / 10.0f;
+    message.pauseActive = st.bits & ESPNOW_ST_PAUSE;
+    message.lubeTrigger = st.bits & ESPNOW_ST_LUBE;
+    message.cyclusTijd = st.cyclusTijd_x100 / 100.0f;
+    message.sleevePercentage = st.sleevePct_x10 / 10.0f;
+    message.currentSpeedStep = st.speedStep;
+    message.opcode = frame.hdr.opcode;
     
 // Update machine parameters
     trustSpeed = message.trust;
@@ -644,6 +830,9 @@ static void onESPNowReceive(const esp_now_recv_info *info, const uint8_t *incomi
       
       Serial.printf("[PAUSE] Was op Level %d\n", levelBeforePause);
       
+      // Noodpauze tijdens AI = edge moment voor de forecaster
+      edgeForecast_markEdge();
+      
       if (EMERGENCY_PAUSE_ROOD_SCHERM) {
         emergencyPauseActive = true;
       }
@@ -661,22 +850,34 @@ static void onESPNowReceive(const esp_now_recv_info *info, const uint8_t *incomi
     sleevePercentage = message.sleevePercentage;
     hoofdESPSpeedStep = message.currentSpeedStep;
     
+    // Nunchuk correctie: onder AI_OVERRIDE verandert alleen de gebruiker de
+    // speed step (warmup forceert hem zelf), elke wijziging is een correctie
+    static uint8_t lastSpeedStep = 0xFF;
+    if (aiOverruleActive && !warmupActive && aiDecisionLevel >= 0 &&
+        lastSpeedStep != 0xFF && message.currentSpeedStep != lastSpeedStep) {
+      mlIntegration_logNunchukCorrection(aiDecisionLevel, message.currentSpeedStep);
+    }
+    lastSpeedStep = message.currentSpeedStep;
+    
     lastCommTime = millis();
 
     // ═══════════════════════════════════════════════════════════
     // COMMAND HANDLING - Hooft ESP Commands
     // ═══════════════════════════════════════════════════════════
     
-    // Check command type
-    if (strcmp(message.command, "STATUS_UPDATE") == 0) {
+    // Opcode dispatch (switch → jump table)
+    switch (message.opcode) {
+    case ESPNOW_OP_STATUS_UPDATE:
+    case ESPNOW_OP_STATUS_DELTA:
       // Normale status update - niks extra doen
-    }
-    else if (strcmp(message.command, "ORGASM_TRIGGER") == 0) {
+      break;
+    case ESPNOW_OP_ORGASM_TRIGGER:
       Serial.println("[CMD] ✅ ORGASM_TRIGGER ontvangen!");
   
       // 🔥 NIEUW: Zet orgasmActive voor CSV Event logging
       orgasmActive = true;
       cooldownActive = false;
+      edgeForecast_markEdge();
   
       // AI stopt met overrides (geen commands naar Hooft ESP)
       // MAAR: sensors blijven lezen, CSV blijft loggen, ML blijft leren
@@ -686,16 +887,16 @@ static void onESPNowReceive(const esp_now_recv_info *info, const uint8_t *incomi
       }
   
       // TODO: Log event voor ML training
-    }
-    else if (strcmp(message.command, "FUNSCRIPT_ON") == 0) {
+      break;
+    case ESPNOW_OP_FUNSCRIPT_ON:
       funscriptEnabled = true;
       Serial.println("[CMD] ✅ Funscript ENABLED door Hooft ESP");
-    }
-    else if (strcmp(message.command, "FUNSCRIPT_OFF") == 0) {
+      break;
+    case ESPNOW_OP_FUNSCRIPT_OFF:
       funscriptEnabled = false;
       Serial.println("[CMD] ✅ Funscript DISABLED door Hooft ESP");
-    }
-    else if (strcmp(message.command, "ORGASM_COMPLETE") == 0) {
+      break;
+    case ESPNOW_OP_ORGASM_COMPLETE:
       Serial.println("[CMD] ✅ ORGASM_COMPLETE - User drukte C knop");
       
       // 🔥 NIEUW: Zet cooldownActive voor CSV Event logging
@@ -704,8 +905,8 @@ static void onESPNowReceive(const esp_now_recv_info *info, const uint8_t *incomi
       
       // TODO: AI berekent optimale cooldown tijd
       // TODO: Stuurt COOLDOWN_OVERRIDE naar Hooft ESP
-    }  
-    else if (strcmp(message.command, "COOLDOWN_COMPLETE") == 0) {
+      break;
+    case ESPNOW_OP_COOLDOWN_COMPLETE:
       Serial.println("[CMD] ✅ COOLDOWN_COMPLETE - hervat AI overrides");
   
       // 🔥 NIEUW: Reset state voor CSV Event logging
@@ -717,16 +918,72 @@ static void onESPNowReceive(const esp_now_recv_info *info, const uint8_t *incomi
         aiOverruleActive = true;
         Serial.println("[AI] Overrides RESUMED - AI mag weer ingrijpen");
       }
-    }
-    else {
-      Serial.printf("[CMD] ⚠️ Unknown command: %s\n", message.command);
+      break;
+    default:
+      Serial.printf("[CMD] ⚠️ Unknown opcode: 0x%02X\n", message.opcode);
+      break;
     }
     
-    Serial.printf("[ESP-NOW] RX: T:%.1f S:%.1f Su:%.1f V:%d Z:%d Vac:%.1f P:%d Lube:%d Cyc:%.1fs Pos:%.0f%% Step:%d Cmd:%s\n", 
+    Serial.printf("[ESP-NOW] RX: T:%.1f S:%.1f Su:%.1f V:%d Z:%d Vac:%.1f P:%d Lube:%d Cyc:%.1fs Pos:%.0f%% Step:%d Cmd:%s #%u\n", 
                   trustSpeed, sleeveSpeed, suctionLevel, vibeOn, zuigActive, vacuumMbar,
-                  pauseActive, lubeTrigger, cyclusTijd, sleevePercentage, hoofdESPSpeedStep, message.command);
+                  pauseActive, lubeTrigger, cyclusTijd, sleevePercentage, hoofdESPSpeedStep,
+                  espnow_opcodeName(message.opcode), frame.hdr.seq);
+  } else if (decoded == ESPNOW_DECODE_OK) {
+    Serial.printf("[ESP-NOW] RX opcode %s hoort niet bij HoofdESP\n", espnow_opcodeName(frame.hdr.opcode));
   } else {
-    Serial.printf("[ESP-NOW] RX SIZE MISMATCH: %d bytes\n", len);
+    Serial.printf("[ESP-NOW] RX afgewezen (%d bytes): %s\n", len, espnow_decodeError(decoded));
+  }
+}
+
+static EspNowRxQueue espNowRxQueue;
+static EspNowRxQueue espNowRxPrioQueue;   // ESPNOW_FLAG_PRIORITY frames (ORGASM_TRIGGER)
+
+#if ESPNOW_NETEM_ENABLED
+// Test kanaal: zelfde waarden op de HoofdESP zetten voor beide richtingen
+static const EspNowNetemConfig NETEM_CONFIG = { 10, 5, 10, 5 };   // verlies %, latency ms, jitter ms, volgorde %
+static EspNowNetem espNowNetem;
+#endif
+
+// ===== ESP-NOW Callback (WiFi task) =====
+// Alleen kopiëren: decoderen, state en Serial gebeuren in processESPNowRx()
+static void onESPNowReceive(const esp_now_recv_info *info, const uint8_t *incomingData, int len) {
+  int8_t rssi = info->rx_ctrl ? info->rx_ctrl->rssi : 0;
+  EspNowRxQueue& q = espnow_peekPriority(incomingData, len) ? espNowRxPrioQueue : espNowRxQueue;
+  espnowRx_push(q, info->src_addr, incomingData, len, rssi, micros());
+}
+
+// Vanuit loop(): alle wachtende frames toepassen
+static void processESPNowRx() {
+  static uint32_t lastDropped = 0;
+  EspNowRxItem item;
+
+  // Voorrang frames eerst, nooit achter status verkeer (netem: alleen verlies)
+  while (espnowRx_pop(espNowRxPrioQueue, item)) {
+#if ESPNOW_NETEM_ENABLED
+    if (espnowNetem_chance(espNowNetem, NETEM_CONFIG.lossPct)) { espNowNetem.lost++; continue; }
+#endif
+    handleHooftFrame(item.data, item.len, item.rssi, espnowSync_extendUs(item.rxUs, esp_timer_get_time()));
+  }
+
+#if ESPNOW_NETEM_ENABLED
+  while (espnowRx_pop(espNowRxQueue, item)) {
+    espnowNetem_push(espNowNetem, item, micros());
+  }
+  while (espnowNetem_pop(espNowNetem, micros(), item)) {
+    handleHooftFrame(item.data, item.len, item.rssi, espnowSync_extendUs(item.rxUs, esp_timer_get_time()));
+  }
+#else
+  while (espnowRx_pop(espNowRxQueue, item)) {
+    handleHooftFrame(item.data, item.len, item.rssi, espnowSync_extendUs(item.rxUs, esp_timer_get_time()));
+  }
+#endif
+
+  uint32_t dropped = espnowRx_dropped(espNowRxQueue) + espnowRx_dropped(espNowRxPrioQueue);
+  if (dropped != lastDropped) {
+    Serial.printf("[ESP-NOW RX] %lu frames weggegooid (vol:%lu te lang:%lu, max bezet %d/%d)\n",
+                  (unsigned long)(dropped - lastDropped), (unsigned long)espNowRxQueue.overflows,
+                  (unsigned long)espNowRxQueue.tooLong, espNowRxQueue.highWater, ESPNOW_RXQ_DEPTH);
+    lastDropped = dropped;
   }
 }
 
@@ -740,6 +997,16 @@ static bool initESPNow() {
   WiFi.mode(WIFI_STA);
   WiFi.setChannel(4);  // Kanaal 4 (sync met HoofdESP)
   
+  espnowRel_reset(espNowRel);
+  espnowPub_init(aiCmdPub, AI_CMD_MIN_GAP_MS, AI_CMD_MIN_GAP_MS, AI_CMD_KEEPALIVE_MS);
+  espnowLink_reset(hooftLink);
+  espnowSync_reset(hooftClock);
+#if ESPNOW_NETEM_ENABLED
+  espnowNetem_init(espNowNetem, NETEM_CONFIG, 0xB0D1);
+  Serial.printf("[NETEM] ⚠️ Test kanaal actief: verlies %d%% latency %d ms jitter %d ms volgorde %d%%\n",
+                NETEM_CONFIG.lossPct, NETEM_CONFIG.latencyMs, NETEM_CONFIG.jitterMs, NETEM_CONFIG.reorderPct);
+#endif
+  
   if (esp_now_init() != ESP_OK) {
     Serial.println("[ESP-NOW] Init failed");
     return false;
@@ -747,6 +1014,7 @@ static bool initESPNow() {
   
   // Registreer ontvangst callback
   esp_now_register_recv_cb(onESPNowReceive);
+  esp_now_register_send_cb(onESPNowSent);
   
   // Voeg HoofdESP toe als peer
   esp_now_peer_info_t peerInfo;
@@ -768,92 +1036,138 @@ static bool initESPNow() {
   return true;
 }
 
-// 🔥 NIEUW: Voeg bericht toe aan retry queue
-bool addToESPNowQueue(const esp_now_send_message_t& message) {
-  if (queueCount >= ESPNOW_QUEUE_SIZE) {
-    Serial.println("[ESP-NOW QUEUE] FULL - dropping oldest message");
-    // Overschrijf oudste (head)
-    queueHead = (queueHead + 1) % ESPNOW_QUEUE_SIZE;
-    queueCount--;
-  }
-  
-  // Voeg toe aan tail
-  espNowQueue[queueTail].message = message;
-  espNowQueue[queueTail].timestamp = millis();
-  espNowQueue[queueTail].retryCount = 0;
-  espNowQueue[queueTail].inUse = true;
+// Herhalingen van kritieke frames + periodiek stats (vanuit loop)
+static void processESPNowReliable() {
+  if (!espNowInitialized) return;
   
-  queueTail = (queueTail + 1) % ESPNOW_QUEUE_SIZE;
-  queueCount++;
+  uint8_t givenUp = espnowRel_poll(espNowRel, millis(), sendHooftFrame);
+  if (givenUp > 0) {
+    Serial.printf("[ESP-NOW REL] %d frame(s) opgegeven na %d pogingen\n", givenUp, ESPNOW_REL_MAX_RETRIES + 1);
+  }
   
-  Serial.printf("[ESP-NOW QUEUE] Added message (queue: %d/%d)\n", queueCount, ESPNOW_QUEUE_SIZE);
-  return true;
+  static uint32_t lastStats = 0;
+  if (millis() - lastStats > 30000) {
+    lastStats = millis();
+    const EspNowRelStats& st = espNowRel.stats;
+    Serial.printf("[ESP-NOW REL] sent:%lu ok:%lu retry:%lu drop:%lu dup:%lu ack:%lu open:%d\n",
+                  (unsigned long)st.sent, (unsigned long)st.delivered, (unsigned long)st.retried,
+                  (unsigned long)st.dropped, (unsigned long)st.duplicates, (unsigned long)st.acksSent,
+                  espnowRel_outstanding(espNowRel));
+    // Benchmark: leveringstijd en doorvoer van kritieke commando's over dit interval
+    static uint32_t lastDelivered = 0;
+    Serial.printf("[ESP-NOW REL] levering gem:%.1f ms max:%lu ms, %.2f cmd/s | voorrang %lu/%lu weg:%lu slechtst:%lu ms\n",
+                  espnowRel_avgDeliveryMs(espNowRel), (unsigned long)st.deliveryMaxMs,
+                  (st.delivered - lastDelivered) / 30.0f,
+                  (unsigned long)st.prioDelivered, (unsigned long)st.prioSent,
+                  (unsigned long)st.prioDropped, (unsigned long)st.prioMaxMs);
+    lastDelivered = st.delivered;
+#if ESPNOW_NETEM_ENABLED
+    Serial.printf("[NETEM] door:%lu weg:%lu volgorde:%lu vol:%lu\n",
+                  (unsigned long)espNowNetem.passed, (unsigned long)espNowNetem.lost,
+                  (unsigned long)espNowNetem.reordered, (unsigned long)espNowNetem.overflow);
+#endif
+    Serial.printf("[ESP-NOW PUB] AI cmd: full:%lu delta:%lu skip:%lu\n",
+                  (unsigned long)aiCmdPub.fullSent, (unsigned long)aiCmdPub.deltaSent,
+                  (unsigned long)aiCmdPub.suppressed);
+  }
 }
 
-// 🔥 NIEUW: Verwerk retry queue
-void processESPNowQueue() {
-  if (queueCount == 0 || !espNowInitialized) return;
-  
-  ESPNowQueueItem* item = &espNowQueue[queueHead];
+// Elke ESPNOW_LINK_PING_MS een PING, waarschuwen als de link achteruit gaat
+static void processESPNowLink() {
+  if (!espNowInitialized) return;
+  uint32_t now = millis();
   
-  // Check of het tijd is voor retry
-  if (millis() - item->timestamp < RETRY_DELAY_MS) {
-    return;  // Nog niet tijd voor retry
+  if (!espnowRel_priorityOpen(espNowRel) && espnowLink_pingDue(hooftLink, now)) {
+    EspNowFrame ping;
+    memset(&ping, 0, sizeof(ping));
+    uint8_t flags;
+    uint32_t sessionMs = espnowSessionMs(&flags);
+    espnowLink_buildPing(hooftLink, now, esp_timer_get_time(), ping);
+    uint8_t buf[ESPNOW_MAX_FRAME];
+    uint8_t len = espnow_encode(ping, ESPNOW_OP_PING, espnowRel_nextSeq(espNowRel, ESPNOW_OP_PING), sessionMs, false, buf, flags);
+    sendHooftFrame(buf, len);
   }
   
-  // Probeer te verzenden
-  esp_err_t result = esp_now_send(hoofdESP_MAC, (uint8_t*)&item->message, sizeof(item->message));
+  // Alleen als de HoofdESP er is: anders is "slecht" gewoon "uit"
+  static bool linkWarned = false;
+  uint8_t quality = espnowLink_quality(hooftLink, now);
+  if (quality > 0 && quality < 40 && !linkWarned) {
+    linkWarned = true;
+    Serial.printf("[LINK] ⚠️ HoofdESP link %s (Q:%d): RTT %.1f ms, verlies %d%%, RSSI %.0f dBm\n",
+                  espnowLink_qualityName(quality), quality, hooftLink.rttAvgMs,
+                  espnowLink_lossPct(hooftLink), hooftLink.rssiAvg);
+  } else if (quality >= 60 && linkWarned) {
+    linkWarned = false;
+    Serial.printf("[LINK] HoofdESP link hersteld (Q:%d)\n", quality);
+  }
   
-  if (result == ESP_OK) {
-    // Success! Verwijder uit queue
-    Serial.printf("[ESP-NOW QUEUE] Retry SUCCESS (attempt %d)\n", item->retryCount + 1);
-    item->inUse = false;
-    queueHead = (queueHead + 1) % ESPNOW_QUEUE_SIZE;
-    queueCount--;
-  } else {
-    // Failed - increment retry
-    item->retryCount++;
-    item->timestamp = millis();  // Reset timer voor volgende retry
-    
-    if (item->retryCount >= MAX_RETRIES) {
-      // Max retries bereikt - drop message
-      Serial.printf("[ESP-NOW QUEUE] Max retries reached - dropping message\n");
-      item->inUse = false;
-      queueHead = (queueHead + 1) % ESPNOW_QUEUE_SIZE;
-      queueCount--;
-    } else {
-      Serial.printf("[ESP-NOW QUEUE] Retry %d/%d failed\n", item->retryCount, MAX_RETRIES);
+  static uint32_t lastLinkLog = 0;
+  if (now - lastLinkLog > 30000) {
+    lastLinkLog = now;
+    Serial.printf("[LINK] HoofdESP Q:%d RTT:%.1f/%.1f ms jit:%.1f verl:%d%% (peer %d%%) RSSI:%.0f (peer %d) ping:%lu/%lu RXq max %d/%d\n",
+                  quality, hooftLink.rttAvgMs, hooftLink.rttMaxMs, hooftLink.rttJitterMs,
+                  espnowLink_lossPct(hooftLink), hooftLink.peerLossPct, hooftLink.rssiAvg, hooftLink.peerRssi,
+                  (unsigned long)hooftLink.pongs, (unsigned long)hooftLink.pingsSent,
+                  espNowRxQueue.highWater, ESPNOW_RXQ_DEPTH);
+    if (hooftClock.synced) {
+      int64_t nowUs = esp_timer_get_time();
+      Serial.printf("[SYNC] Sessie %lu ms offset:%lld ms fout:±%.1f ms drift:%.1f ppm 1-weg:%.1f ms samples:%lu/%lu status leeftijd:%ld ms\n",
+                    (unsigned long)espnowSessionMs(), (long long)(hooftClock.offsetUs / 1000),
+                    espnowSync_errorUs(hooftClock, nowUs) / 1000.0f, hooftClock.driftPpm, hooftLink.oneWayAvgMs,
+                    (unsigned long)hooftClock.accepted, (unsigned long)(hooftClock.accepted + hooftClock.rejected),
+                    (long)hooftStatusAgeMs());
     }
   }
 }
 
 // ===== ESP-NOW Verzend Functie =====
 // Extern beschikbaar voor MultiFunPlayer client
-bool sendESPNowMessage(float newTrust, float newSleeve, bool overruleActive, const char* command, uint8_t stressLevel = 0, bool vibeOn = false, bool zuigenOn = false) {
+bool sendESPNowMessage(float newTrust, float newSleeve, bool overruleActive, uint8_t opcode, uint8_t stressLevel = 0, bool vibeOn = false, bool zuigenOn = false) {
   if (!espNowInitialized) return false;
   
-  esp_now_send_message_t message;
+  EspNowFrame message;
   memset(&message, 0, sizeof(message));
   
-  message.newTrust = newTrust;
-  message.newSleeve = newSleeve;
-  message.overruleActive = overruleActive;
-  message.stressLevel = stressLevel;
-  message.vibeOn = vibeOn;
-  message.zuigenOn = zuigenOn;
-  strncpy(message.command, command, sizeof(message.command) - 1);
+  message.ai.trust_x1000 = espnow_toFixed(newTrust, 1000.0f);
+  message.ai.sleeve_x1000 = espnow_toFixed(newSleeve, 1000.0f);
+  message.ai.stressLevel = stressLevel;
+  message.ai.bits = (overruleActive ? ESPNOW_AI_OVERRULE : 0) |
+                    (vibeOn ? ESPNOW_AI_VIBE : 0) |
+                    (zuigenOn ? ESPNOW_AI_ZUIGEN : 0);
+  
+  bool withTrace = traceArmed;
+  if (traceArmed) {
+    message.trace.traceId = traceNextId++;
+    message.trace.sensorUs = traceSensorUs;
+    message.trace.decisionUs = traceDecisionUs;
+    message.trace.airUs = traceAirUs;
+    traceArmed = false;
+    traceSentUs = micros();
+    message.trace.sendUs = traceSentUs - traceReadyUs;
+  }
   
-  esp_err_t result = esp_now_send(hoofdESP_MAC, (uint8_t *)&message, sizeof(message));
+  uint8_t flags;
+  uint32_t sessionMs = espnowSessionMs(&flags);
+  uint8_t frame[ESPNOW_MAX_FRAME];
+  uint8_t len = espnow_encode(message, opcode, espnowRel_nextSeq(espNowRel, opcode), sessionMs, withTrace, frame, flags);
+  // Kritieke opcodes blijven staan tot ACK (ook als de eerste send faalt),
+  // voorrang opcodes (stop, nood pauze, vacuum los) gaan direct dubbel weg
+  bool sent = espnowRel_send(espNowRel, frame, len, millis(), sendHooftFrame);
+  
+  // Ander kritiek commando (stop, resume, ...) → volgende AI override direct sturen
+  if (espnow_needsAck(opcode) && opcode != ESPNOW_OP_AI_OVERRIDE && opcode != ESPNOW_OP_AI_WARMUP) {
+    espnowPub_restart(aiCmdPub);
+  }
   
-  if (result == ESP_OK) {
-    Serial.printf("[ESP-NOW] TX: T:%.1f S:%.1f O:%d Stress:%d Cmd:%s\n",
-                  newTrust, newSleeve, overruleActive, stressLevel, command);
+  if (sent) {
+    Serial.printf("[ESP-NOW] TX: T:%.1f S:%.1f O:%d Stress:%d Cmd:%s%s (%d bytes)\n",
+                  newTrust, newSleeve, overruleActive, stressLevel, espnow_opcodeName(opcode),
+                  espnow_isPriority(opcode) ? " [VOORRANG]" : "", len);
     return true;
   } else {
-    // 🔥 NIEUW: Bij failure → toevoegen aan retry queue
-    Serial.printf("[ESP-NOW] TX FAILED: %d - adding to retry queue\n", result);
-    addToESPNowQueue(message);
-    return false;  // Direct send failed, maar wordt ge-retry'd
+    Serial.printf("[ESP-NOW] TX FAILED: %s (%s)\n", espnow_opcodeName(opcode),
+                  espnow_needsAck(opcode) ? "wordt herhaald" : "fire-and-forget");
+    return false;
   }
 }
 
@@ -1018,7 +1332,7 @@ void touchCallback(TPoint point, TEvent e) {
     setEncoderLEDOff();  // Stop knipperen
     
     // Stuur RESUME naar Hooft ESP
-    sendESPNowMessage(0, 0, false, "RESUME_SESSION", 0, false, false);
+    sendESPNowMessage(0, 0, false, ESPNOW_OP_RESUME_SESSION, 0, false, false);
     
     // Herstel normaal scherm
     body_gfx4_clear();
@@ -2036,10 +2350,8 @@ void handleEncoderInput() {
               if (filename.endsWith(".anl")) {
                 Serial.println("[ENCODER] Dit bestand is al geanalyseerd (.anl)!");
               } else {
-                Serial.printf("[ENCODER] Starting AI analyze: %s\n", filename.c_str());
-                // Zet LED op magenta tijdens analyse
-                setEncoderLED(255, 0, 255, true);
-                performAIAnalysis(filename);
+                Serial.printf("[ENCODER] Queueing AI analyze: %s\n", filename.c_str());
+                performAIAnalysis(filename);  // Draait in achtergrond
                 selectedRecordingFile = -1;
                 recordingInButtonMode = false;
                 bodyMenuIdx = 0;
@@ -2047,7 +2359,10 @@ void handleEncoderInput() {
                 updateEncoderLEDForMenu();
               }
             } else {
-              Serial.println("[ENCODER] Selecteer eerst een bestand!");
+              // Geen selectie: hele backlog in de wachtrij
+              Serial.println("[ENCODER] Geen bestand geselecteerd - analyseer alle opnames");
+              aiAnalyzeQueue_enqueueAll();
+              bodyMenuForceRedraw();
             }
           } else if (bodyMenuIdx == 3) {
             // TERUG - reset naar bestand mode
@@ -2382,6 +2697,7 @@ void setup() {
   SD_MMC.setPins(39, 40, 38);  // CLK, CMD, D0
   if (SD_MMC.begin("/sdcard", true)) {  // 1-bit mode
     Serial.println("[SD CARD] Initialized OK!");
+    aiAnalyzeQueue_begin();  // AI analyse taak (Core 0, lage prioriteit)
   } else {
     Serial.println("[SD CARD] Init failed - recording won't work");
   }
@@ -2397,7 +2713,7 @@ void setup() {
   if (espNowInitialized) {
     Serial.println("[ESP-NOW] Ready for communication!");
     // Test bericht versturen
-    sendESPNowMessage(1.0f, 1.0f, false, "HEARTBEAT", 0, false, false);
+    sendESPNowMessage(1.0f, 1.0f, false, ESPNOW_OP_HEARTBEAT, 0, false, false);
   } else {
     Serial.println("[ESP-NOW] FAILED - continuing without ESP-NOW");
   }
@@ -2407,6 +2723,7 @@ void setup() {
   extern AdvancedStressManager stressManager;
   stressManager.begin();
   Serial.println("[AI] Stress Manager ready!");
+  mlIntegration_begin();   // Actief model + shadow kandidaat van SD / NVS
 
   // ===== Body GFX4 Initialisatie =====
   Serial.println("\n[BODY_GFX4] Initializing graphics system...");
@@ -2449,6 +2766,9 @@ void setup() {
 
 void loop() {
 
+  // ESP-NOW frames uit de callback queue toepassen (state alleen in loop context)
+  processESPNowRx();
+
   // ═══════════════════════════════════════════════════════════
   // EMERGENCY PAUSE SCREEN - Teken in main loop (niet in callback!)
   // ═══════════════════════════════════════════════════════════
@@ -2553,7 +2873,9 @@ void loop() {
     if (currentMode == MODE_MAIN && !isPlayback && !emergencyPauseActive && millis() - lastSensorPush > SENSOR_INTERVAL_MS) {
     if (adsAvailable) {
       // Lees alle ADS1115 sensoren
+      uint32_t sensorStartUs = micros();
       ads1115_readAll();
+      uint32_t sensorUs = micros() - sensorStartUs;
       ADS1115_SensorData sensorData = ads1115_getData();
       
       // Push echte sensor data naar grafieken
@@ -2564,6 +2886,16 @@ void loop() {
       
       // 🔥 NIEUW: Update ML integration met sensor data
       bodyMenuUpdateSensors(sensorData.BPM, sensorData.temperature, sensorData.gsrSmooth);
+      
+      // Artefacten niet doorgeven: slecht kanaal houdt laatste goede waarde
+      float hrIn = sigQuality_gate(SQ_PULSE, sensorData.BPM);
+      float tempIn = sigQuality_gate(SQ_NTC, sensorData.temperature);
+      float gsrIn = sigQuality_gate(SQ_GSR, sensorData.gsrSmooth);
+      float breathIn = sigQuality_gate(SQ_FLEX, sensorData.breathValue);
+      
+      // Trend richting edge (rekent zelf elke EDGE_FC_SAMPLE_MS)
+      edgeForecast_update(hrIn, tempIn, gsrIn, breathIn);
+      changePoint_update(hrIn, tempIn, gsrIn);
 
       // ═══════════════════════════════════════════════════════════
       // AI STRESS MANAGER UPDATE & WARM-UP
@@ -2585,15 +2917,19 @@ void loop() {
           const float levelSpeeds[8] = {0.1, 0.4, 0.6, 0.8, 1.0, 1.3, 1.6, 2.0};
           float trustSpeed = levelSpeeds[currentWarmupLevel];
   
-          sendESPNowMessage(
-            trustSpeed,
-            trustSpeed,
-            true,
-            "AI_WARMUP",  // ← Verander naar AI_WARMUP!
-            currentWarmupLevel,
-            WARMUP_VIBE_ENABLED,
-            WARMUP_SUCTION_ENABLED
-          );
+          if (aiCommandDue(ESPNOW_OP_AI_WARMUP, trustSpeed, currentWarmupLevel,
+                           WARMUP_VIBE_ENABLED, WARMUP_SUCTION_ENABLED)) {
+            armLatencyTrace(sensorUs, 0);
+            sendESPNowMessage(
+              trustSpeed,
+              trustSpeed,
+              true,
+              ESPNOW_OP_AI_WARMUP,  // Mag level forceren
+              currentWarmupLevel,
+              WARMUP_VIBE_ENABLED,
+              WARMUP_SUCTION_ENABLED
+            );
+          }
   
           // Debug output (elke seconde)
           static uint32_t lastWarmupDebug = 0;
@@ -2609,27 +2945,68 @@ void loop() {
         extern AdvancedStressManager stressManager;
   
         BiometricData bio;
-        bio.heartRate = sensorData.BPM;
-        bio.temperature = sensorData.temperature;
-        bio.gsrValue = sensorData.gsrSmooth;
+        bio.heartRate = hrIn;
+        bio.temperature = tempIn;
+        bio.gsrValue = gsrIn;
+        bio.quality = sigQuality_stressQuality() / 100.0f;
         bio.timestamp = millis();
   
+        // Volledige feature vector van deze tick voor het actieve model
+        // (gecompileerd of model.bin) en de shadow kandidaat
+        float liveFeatures[9] = {
+          hrIn, tempIn, gsrIn,
+          breathIn, trustSpeed, sleevePercentage,
+          suctionLevel, vibeOn ? 1.0f : 0.0f,
+          stressManager.getSessionDuration() / 1000.0f
+        };
+        mlIntegration_setLiveFeatures(liveFeatures);
+  
+        uint32_t updateStartUs = micros();
         stressManager.update(bio);
         
         // Haal AI beslissing op
         StressDecision decision = stressManager.getStressDecision();
+        uint32_t traceDecisionTotalUs = micros() - updateStartUs;
         
-        // Stuur AI override (elke seconde)
-        static uint32_t lastAIUpdate = 0;
-        if (millis() - lastAIUpdate > 1000) {
-          float trustOverride = decision.recommendedSpeed / 7.0f;
-          float sleeveOverride = trustOverride;
+        // Proactief afremmen: edge voorspeld vóór de classifier het ziet
+        if (edgeForecast_shouldSlowDown() && decision.currentLevel > STRESS_1_GEEN) {
+          EdgeForecast fc = edgeForecast_get();
+          decision.currentLevel = (StressLevel)(decision.currentLevel - 1);
+          decision.recommendedSpeed = stressLevelToSpeed(decision.currentLevel);
+          decision.recommendedAction = ACTION_SPEED_DOWN;
+          decision.reasoning = "Edge voorspeld - proactief verlagen";
           
+          static uint32_t lastForecastLog = 0;
+          if (millis() - lastForecastLog > 2000) {
+            Serial.printf("[FORECAST] Edge over ~%.0fs (min %.0fs, conf %.2f) → Level %d\n",
+                          fc.secondsToEdge, fc.secondsToEdgeLow, fc.confidence,
+                          decision.currentLevel);
+            lastForecastLog = millis();
+          }
+        }
+        
+        aiDecisionLevel = decision.currentLevel;
+        
+        // Shadow kandidaat op dezelfde tick naast het actieve model meten
+        // (stuurt niets aan)
+        if (mlShadow_hasCandidate()) {
+          uint32_t activeStartUs = micros();
+          int activeLevel = mlIntegration_predictActive(liveFeatures);
+          uint32_t activeUs = micros() - activeStartUs;
+          mlShadow_observe(liveFeatures, activeLevel, activeUs);
+        }
+        
+        // Stuur AI override (bij nieuwe beslissing, anders keepalive)
+        float trustOverride = decision.recommendedSpeed / 7.0f;
+        float sleeveOverride = trustOverride;
+        if (aiCommandDue(ESPNOW_OP_AI_OVERRIDE, trustOverride, decision.currentLevel,
+                         decision.vibeRecommended, decision.suctionRecommended)) {
+          armLatencyTrace(sensorUs, traceDecisionTotalUs);
           sendESPNowMessage(
             trustOverride,
             sleeveOverride,
             true,
-            "AI_OVERRIDE",
+            ESPNOW_OP_AI_OVERRIDE,
             decision.currentLevel,
             decision.vibeRecommended,
             decision.suctionRecommended
@@ -2638,8 +3015,6 @@ void loop() {
           Serial.printf("[AI] Override sent: Speed=%d, Level=%d, Vibe=%d, Suction=%d\n",
                         decision.recommendedSpeed, decision.currentLevel,
                         decision.vibeRecommended, decision.suctionRecommended);
-          
-          lastAIUpdate = millis();
         }
       }
 
@@ -2763,13 +3138,14 @@ void loop() {
     mfpClient.loop();
   }
   
-  // 🔥 NIEUW: Process ESP-NOW retry queue
-  processESPNowQueue();
+  // ESP-NOW herhalingen (kritieke frames zonder ACK)
+  processESPNowReliable();
+  processESPNowLink();   // PING + link kwaliteit (RTT / verlies / RSSI)
 
   // ===== ESP-NOW HEARTBEAT (elke 5 seconden) =====
   static uint32_t lastHeartbeat = 0;
   if (espNowInitialized && (millis() - lastHeartbeat > 5000)) {
-    sendESPNowMessage(1.0f, 1.0f, false, "HEARTBEAT", 0, false, false);
+    sendESPNowMessage(1.0f, 1.0f, false, ESPNOW_OP_HEARTBEAT, 0, false, false);
     lastHeartbeat = millis();
     
     // Toon laatste ontvangen data
@@ -1,4 +1,5 @@
 #include "ads1115_sensors.h"
+#include "signal_quality.h"
 #include <Wire.h>
 
 // ===== GLOBALE OBJECTEN =====
@@ -44,6 +45,7 @@ bool ads1115_begin() {
   sensorData.flexBaseline = 1.5f;     // ~1.5V baseline voor flex
   sensorData.pulseBaseline = 2048;    // Midden van bereik
   sensorData.ntcOffset = 0.0f;
+  sigQuality_reset();
   
   ads1115Initialized = true;
   return true;
@@ -70,6 +72,9 @@ void ads1115_readAll() {
   ads1115_readFlex();
   ads1115_readPulse();
   ads1115_readNTC();
+  
+  // Artefact detectie op dezelfde sample
+  sigQuality_update(sensorData);
 }
 
 // ===== GSR SENSOR (A0) =====
@@ -184,6 +189,9 @@ void ads1115_printDebug() {
                 sensorData.beatDetected ? "YES" : "NO");
   Serial.printf("  NTC:   Raw=%d, Volts=%.3fV, Temp=%.1f°C\n", 
                 sensorData.ntcRaw, sensorData.ntcVolts, sensorData.temperature);
+  Serial.printf("  SQI:   GSR=%d, Adem=%d, Pulse=%d (r=%.2f), NTC=%d\n",
+                sensorData.gsrQuality, sensorData.flexQuality, sensorData.pulseQuality,
+                sigQuality_ppgCorrelation(), sensorData.ntcQuality);
 }
 
 // ===== KALIBRATIE FUNCTIES =====
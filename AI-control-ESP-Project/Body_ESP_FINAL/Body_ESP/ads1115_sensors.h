@@ -50,6 +50,12 @@ struct ADS1115_SensorData {
   float temperature;      // Temperatuur in °C
   bool beatDetected;      // Hartslag beat gedetecteerd
   
+  // Signaal kwaliteit 0-100 (zie signal_quality.h)
+  uint8_t gsrQuality;
+  uint8_t flexQuality;
+  uint8_t pulseQuality;
+  uint8_t ntcQuality;
+  
   // Kalibratie
   float gsrBaseline;      // GSR baseline voor verschil
   float flexBaseline;     // Flex sensor baseline
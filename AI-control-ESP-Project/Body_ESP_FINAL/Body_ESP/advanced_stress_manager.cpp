@@ -4,6 +4,12 @@
 
 #include "advanced_stress_manager.h"
 #include "ml_stress_analyzer.h"
+#include "change_point.h"
+#include "config.h"
+
+#if AI_USE_COMPILED_MODEL
+#include "ml_integration.h"  // mlIntegration_getLiveFeatures / predictActive
+#endif
 
 // External function declarations (defined in Body_ESP.ino)
 extern void startRecording();
@@ -13,6 +19,14 @@ extern bool isRecording;
 // Global instance
 AdvancedStressManager stressManager;
 
+// Ruw CUSUM alarm → stress score: max +/-0.25 per alarm, samen max +/-0.5,
+// vervalt in ~30 sec en schuift met hooguit 0.3/min in de score (onder
+// STRESS_CHANGE_RUSTIG en de 0.1 minimum stap: alleen verandert het geen klasse)
+static const float CP_BIAS_PER_ALARM = 0.25f;
+static const float CP_BIAS_MAX = 0.5f;
+static const float CP_BIAS_DECAY_MS = 30000.0f;
+static const float CP_BIAS_SLEW_PER_MS = 0.3f / 60000.0f;
+
 // ===== Constructor =====
 AdvancedStressManager::AdvancedStressManager() {
   currentStressLevel = STRESS_0_NORMAAL;
@@ -45,6 +59,12 @@ void AdvancedStressManager::begin() {
   for (int i = 0; i < 10; i++) {
     biometricHistory[i] = BiometricData();
   }
+  
+#if AI_USE_COMPILED_MODEL
+  // Gecompileerd model is de productie beslisser
+  mlEnabled = true;
+  Serial.println("[STRESS] AI beslissingen via gecompileerd model");
+#endif
 }
 
 void AdvancedStressManager::update(const BiometricData& biometrics) {
@@ -59,8 +79,18 @@ void AdvancedStressManager::update(const BiometricData& biometrics) {
   // Calculate current biometric stress
   float currentStress = calculateBiometricStress(biometrics);
   
+  // Ruwe CUSUM alarmen tellen mee in de score, bevestigde in de klasse
+  StressChangeType cpChange = readChangePoints(now);
+  currentStress = constrain(currentStress + changePointBias, 0.0f, 7.0f);
+  
+  // Twijfelachtige sensor samples minder zwaar laten meewegen
+  if (lastStressTime != 0 && biometrics.quality < 1.0f) {
+    float weight = constrain(biometrics.quality, 0.0f, 1.0f);
+    currentStress = lastStressValue + weight * (currentStress - lastStressValue);
+  }
+  
   // Detect stress changes
-  StressChangeType changeType = detectStressChange(currentStress);
+  StressChangeType changeType = detectStressChange(currentStress, cpChange);
   lastStressChange = changeType;
   
   // Update stress tracking
@@ -115,6 +145,10 @@ void AdvancedStressManager::executeAction(const StressDecision& decision) {
 void AdvancedStressManager::startSession() {
   sessionActive = true;
   sessionStartTime = millis();
+  changePointTarget = 0.0f;
+  changePointBias = 0.0f;
+  mlRecentCount = 0;
+  mlRecentHead = 0;
   currentStressLevel = STRESS_0_NORMAAL;
   previousStressLevel = STRESS_0_NORMAAL;
   levelStartTime = millis();
@@ -283,7 +317,49 @@ float AdvancedStressManager::calculateBiometricStress(const BiometricData& data)
   return constrain(totalStress, 0.0f, 7.0f);
 }
 
-StressChangeType AdvancedStressManager::detectStressChange(float currentStress) {
+StressChangeType AdvancedStressManager::readChangePoints(uint32_t now) {
+  // Alleen HR/GSR, temperatuur is te traag om snel op te sturen.
+  // Een ruw alarm is ~1 per 800 samples ruis: het duwt alleen de score.
+  // Pas een bevestigd alarm (persistentie of HR + GSR samen) mag de klasse
+  // zetten, en nooit verder dan SNEL: één change point geeft geen noodstop
+  // of +2 level, dat blijft aan de gemeten stress snelheid.
+  float dt = (lastStressTime != 0) ? (float)(now - lastStressTime) : 0.0f;
+  changePointTarget *= expf(-dt / CP_BIAS_DECAY_MS);
+
+  ChangePointEvent cp;
+  StressChangeType cpChange = CHANGE_NONE;
+  while (changePoint_next(changePointSeq, cp)) {
+    if (cp.channel == CP_TEMP) continue;
+    if (now - cp.detectMs > 2000) continue;   // Oud event (buiten sessie)
+    if (cp.confirmed) {
+      cpChange = (cp.direction > 0) ? CHANGE_SNEL_OMHOOG : CHANGE_SNEL_OMLAAG;
+    } else {
+      changePointTarget += cp.direction * CP_BIAS_PER_ALARM * min(cp.magnitude, 4.0f) / 4.0f;
+    }
+  }
+  changePointTarget = constrain(changePointTarget, -CP_BIAS_MAX, CP_BIAS_MAX);
+
+  float step = dt * CP_BIAS_SLEW_PER_MS;
+  changePointBias += constrain(changePointTarget - changePointBias, -step, step);
+  return cpChange;
+}
+
+StressChangeType AdvancedStressManager::detectStressChange(float currentStress, StressChangeType cpChange) {
+  StressChangeType rateChange = detectRateChange(currentStress);
+
+  // Bevestigd change point versnelt alleen een rustige/normale klasse,
+  // een SNEL of HEEL SNEL uit de stress snelheid wint altijd
+  if (cpChange == CHANGE_NONE) return rateChange;
+  switch (rateChange) {
+    case CHANGE_SNEL_OMHOOG: case CHANGE_SNEL_OMLAAG:
+    case CHANGE_HEEL_SNEL_OMHOOG: case CHANGE_HEEL_SNEL_OMLAAG:
+      return rateChange;
+    default:
+      return cpChange;
+  }
+}
+
+StressChangeType AdvancedStressManager::detectRateChange(float currentStress) {
   if (lastStressTime == 0) return CHANGE_NONE;
   
   uint32_t timeDelta = millis() - lastStressTime;
@@ -480,9 +556,57 @@ StressDecision AdvancedStressManager::makeReactiveDecision() {
   return decision;
 }
 
+// ML level (0-6) in de beslissing, voor beide model paden. Een decision
+// tree geeft geen kans per klasse: confidence = hoe vaak de vorige
+// ML_RECENT_LEVELS voorspellingen hetzelfde level gaven (0.3 zonder
+// historie, 0.95 als stabiel). Wisselende voorspellingen blijven zo onder
+// AI_OVERRIDE_CONFIDENCE. Actie volgt uit het level t.o.v. het huidige
+void AdvancedStressManager::applyMLLevel(StressDecision& decision, StressLevel level, const String& reasoning) {
+  // Zelfde tick nog een keer (update() + getStressDecision()): laatste
+  // voorspelling vervangen i.p.v. zichzelf als bevestiging te tellen
+  if (mlRecentCount > 0 && mlRecentStamp == lastStressTime) {
+    mlRecentHead = (mlRecentHead + ML_RECENT_LEVELS - 1) % ML_RECENT_LEVELS;
+    mlRecentCount--;
+  }
+  
+  uint8_t same = 0;
+  uint8_t oldest = (mlRecentHead + ML_RECENT_LEVELS - mlRecentCount) % ML_RECENT_LEVELS;
+  for (uint8_t i = 0; i < mlRecentCount; i++) {
+    if (mlRecentLevels[(oldest + i) % ML_RECENT_LEVELS] == level) same++;
+  }
+  float agree = (mlRecentCount > 0) ? (float)same / mlRecentCount : 0.0f;
+  
+  mlRecentLevels[mlRecentHead] = level;
+  mlRecentHead = (mlRecentHead + 1) % ML_RECENT_LEVELS;
+  if (mlRecentCount < ML_RECENT_LEVELS) mlRecentCount++;
+  mlRecentStamp = lastStressTime;
+  
+  decision.currentLevel = level;
+  decision.isMLPrediction = true;
+  decision.confidence = 0.3f + 0.65f * agree;
+  decision.reasoning = reasoning;
+  
+  decision.recommendedSpeed = stressLevelToSpeed(level);
+  decision.vibeRecommended = shouldVibeBeActive(level);
+  decision.suctionRecommended = shouldSuctionBeActive(level);
+  if (level > currentStressLevel) decision.recommendedAction = ACTION_SPEED_UP;
+  else if (level < currentStressLevel) decision.recommendedAction = ACTION_SPEED_DOWN;
+  else decision.recommendedAction = ACTION_WAIT;
+}
+
 StressDecision AdvancedStressManager::makeMLDecision() {
   StressDecision decision = makeRuleBasedDecision(); // Fallback
   
+#if AI_USE_COMPILED_MODEL
+  // Gecompileerd model op de volledige feature vector van deze AI tick
+  float features[9];
+  int compiledLevel = mlIntegration_getLiveFeatures(features) ? mlIntegration_predictActive(features) : -1;
+  
+  if (compiledLevel >= 0) {
+    // Al 0-6
+    applyMLLevel(decision, (StressLevel)compiledLevel, "Compiled model: Level " + String(compiledLevel + 1));
+  }
+#else
   // If ML is available and ready, use it
   if (mlAnalyzer.hasModel() && historyCount >= 3) {
     // Get latest biometrics
@@ -493,18 +617,11 @@ StressDecision AdvancedStressManager::makeMLDecision() {
     int mlStressLevel = mlAnalyzer.analyzeStress(latest.heartRate, latest.temperature, latest.gsrValue);
     
     if (mlStressLevel >= 1 && mlStressLevel <= 7) {
-      decision.currentLevel = (StressLevel)(mlStressLevel - 1); // Convert to 0-6 range
-      decision.isMLPrediction = true;
-      decision.confidence = 0.8f; // ML confidence
-      decision.reasoning = "ML model prediction: Level " + String(mlStressLevel);
-      
-      // Apply ML-based actions
-      decision.recommendedSpeed = stressLevelToSpeed(decision.currentLevel);
-      decision.vibeRecommended = shouldVibeBeActive(decision.currentLevel);
-      decision.suctionRecommended = shouldSuctionBeActive(decision.currentLevel);
-      decision.recommendedAction = ACTION_SPEED_UP;
+      // Convert to 0-6 range
+      applyMLLevel(decision, (StressLevel)(mlStressLevel - 1), "ML model prediction: Level " + String(mlStressLevel));
     }
   }
+#endif
   
   return decision;
 }
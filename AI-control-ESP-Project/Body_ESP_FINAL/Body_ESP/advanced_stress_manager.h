@@ -63,6 +63,7 @@ struct BiometricData {
   float heartRate = 0.0f;
   float temperature = 0.0f;
   float gsrValue = 0.0f;
+  float quality = 1.0f;     // Signaal kwaliteit 0-1 (signal_quality.h)
   uint32_t timestamp = 0;
   
   BiometricData() {}
@@ -125,11 +126,19 @@ private:
   // Stress change detection
   float lastStressValue = 0.0f;
   uint32_t lastStressTime = 0;
+  uint32_t changePointSeq = 0;   // Laatst verwerkte CUSUM event (change_point.h)
+  float changePointTarget = 0.0f; // Ruwe CUSUM alarmen, vervalt naar 0
+  float changePointBias = 0.0f;   // Deel van target dat al in de stress score zit
   
   // ML integration
   bool mlEnabled = false;
   uint32_t lastMLUpdate = 0;
   StressChangeType lastStressChange = CHANGE_NONE;
+  static const uint8_t ML_RECENT_LEVELS = 5;   // Voorspellingen voor de confidence
+  StressLevel mlRecentLevels[ML_RECENT_LEVELS];
+  uint8_t mlRecentHead = 0;
+  uint8_t mlRecentCount = 0;
+  uint32_t mlRecentStamp = 0;                   // lastStressTime van de laatste voorspelling
   
   // ML Autonomy tracking
   uint32_t totalSessions = 0;
@@ -138,10 +147,13 @@ private:
   
   // Internal methods
   float calculateBiometricStress(const BiometricData& data);
-  StressChangeType detectStressChange(float currentStress);
+  StressChangeType readChangePoints(uint32_t now);
+  StressChangeType detectStressChange(float currentStress, StressChangeType cpChange);
+  StressChangeType detectRateChange(float currentStress);
   StressDecision makeRuleBasedDecision();
   StressDecision makeReactiveDecision();
   StressDecision makeMLDecision();
+  void applyMLLevel(StressDecision& decision, StressLevel level, const String& reasoning);
   StressDecision makeHybridDecision();  // Nieuwe hybride beslissingslogica
   void updateBiometricHistory(const BiometricData& data);
   bool isTimerExpired();
@@ -0,0 +1,438 @@
+#include "ai_analyze_queue.h"
+#include <SD_MMC.h>
+#include <Preferences.h>
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         AI BIJBEL CONSTANTEN
+// ═══════════════════════════════════════════════════════════════════════════
+
+// BIJBEL_ prefix om conflict met config.h te voorkomen
+static const float BIJBEL_HR_BASELINE = 70.0f;    // Gemiddelde hartslag in rust
+static const float BIJBEL_HR_EXCITED = 100.0f;    // Hartslag bij opwinding
+static const float BIJBEL_HR_EDGE = 130.0f;       // Hartslag bij edge zone
+static const float BIJBEL_HR_MAX = 160.0f;        // Maximum veilige hartslag
+
+static const float BIJBEL_TEMP_BASELINE = 36.5f;  // Normale temperatuur
+static const float BIJBEL_TEMP_ELEVATED = 37.5f;  // Verhoogde temperatuur
+static const float BIJBEL_TEMP_HIGH = 38.0f;      // Hoge temperatuur
+
+static const float BIJBEL_GSR_BASELINE = 300.0f;  // GSR in rust
+static const float BIJBEL_GSR_AROUSED = 600.0f;   // GSR bij opwinding
+static const float BIJBEL_GSR_EDGE = 900.0f;      // GSR bij edge zone
+static const float BIJBEL_GSR_MAX = 1200.0f;      // Maximum GSR
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         STATE
+// ═══════════════════════════════════════════════════════════════════════════
+
+struct AnlCacheEntry {
+  uint32_t csvSize;         // CSV grootte bij analyse (cache sleutel)
+  uint32_t samples;
+  float avgLevel;
+  uint8_t maxLevel;
+};
+
+// Uit Body_ESP.ino
+extern bool isRecording;
+extern String csvFilename;   // Volledig pad van lopende opname
+
+static QueueHandle_t jobQueue = NULL;
+static TaskHandle_t queueTaskHandle = NULL;
+static portMUX_TYPE statusMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Laatste resultaten (ring) + huidige job, beschermd door statusMux
+static AIAnalyzeJobStatus results[AI_QUEUE_SIZE];
+static uint8_t resultHead = 0;
+static AIAnalyzeJobStatus current;
+static volatile uint32_t completedJobs = 0;
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         HELPERS
+// ═══════════════════════════════════════════════════════════════════════════
+
+// NVS keys mogen max 15 tekens zijn → FNV-1a hash van bestandsnaam
+static void cacheKey(const char* filename, char* key) {
+  uint32_t h = 2166136261u;
+  for (const char* p = filename; *p; p++) {
+    h ^= (uint8_t)*p;
+    h *= 16777619u;
+  }
+  sprintf(key, "f%08lx", (unsigned long)h);
+}
+
+static bool cacheLookup(const char* filename, uint32_t csvSize, AnlCacheEntry* out) {
+  char key[12];
+  cacheKey(filename, key);
+
+  Preferences prefs;
+  if (!prefs.begin("anl_cache", true)) return false;
+  AnlCacheEntry entry;
+  bool hit = prefs.getBytes(key, &entry, sizeof(entry)) == sizeof(entry) &&
+             entry.csvSize == csvSize;
+  prefs.end();
+
+  if (hit && out) *out = entry;
+  return hit;
+}
+
+static void cacheStore(const char* filename, const AnlCacheEntry& entry) {
+  char key[12];
+  cacheKey(filename, key);
+
+  Preferences prefs;
+  if (!prefs.begin("anl_cache", false)) return;
+  prefs.putBytes(key, &entry, sizeof(entry));
+  prefs.end();
+}
+
+static String anlNameFor(const char* csvName) {
+  String anl = String(csvName);
+  anl.replace(".csv", ".anl");
+  return anl;
+}
+
+// True als de .anl bestaat EN hoort bij de huidige CSV inhoud
+static bool isUpToDate(const char* csvName, uint32_t csvSize, AnlCacheEntry* out) {
+  String anlPath = "/recordings/" + anlNameFor(csvName);
+  if (!SD_MMC.exists(anlPath.c_str())) return false;
+  return cacheLookup(csvName, csvSize, out);
+}
+
+static void publishResult(const AIAnalyzeJobStatus& status) {
+  portENTER_CRITICAL(&statusMux);
+  results[resultHead] = status;
+  resultHead = (resultHead + 1) % AI_QUEUE_SIZE;
+  current.state = AIQ_EMPTY;
+  completedJobs++;
+  portEXIT_CRITICAL(&statusMux);
+}
+
+static void updateProgress(uint8_t progress, uint32_t samples) {
+  portENTER_CRITICAL(&statusMux);
+  current.progress = progress;
+  current.samples = samples;
+  portEXIT_CRITICAL(&statusMux);
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         CLASSIFIER
+// ═══════════════════════════════════════════════════════════════════════════
+
+uint8_t aiAnalyzeQueue_classify(float bpm, float temp, float gsr) {
+  // Hartslag score (0.0 - 1.0)
+  float hrScore = 0.0f;
+  if (bpm > 0) {
+    if (bpm <= BIJBEL_HR_BASELINE) {
+      hrScore = 0.0f;  // Onder baseline = ontspannen
+    } else if (bpm <= BIJBEL_HR_EXCITED) {
+      hrScore = (bpm - BIJBEL_HR_BASELINE) / (BIJBEL_HR_EXCITED - BIJBEL_HR_BASELINE) * 0.4f;
+    } else if (bpm <= BIJBEL_HR_EDGE) {
+      hrScore = 0.4f + (bpm - BIJBEL_HR_EXCITED) / (BIJBEL_HR_EDGE - BIJBEL_HR_EXCITED) * 0.4f;
+    } else {
+      hrScore = 0.8f + (bpm - BIJBEL_HR_EDGE) / (BIJBEL_HR_MAX - BIJBEL_HR_EDGE) * 0.2f;
+    }
+  }
+
+  // Temperatuur score (0.0 - 1.0)
+  float tempScore = 0.0f;
+  if (temp > 0) {
+    if (temp <= BIJBEL_TEMP_BASELINE) {
+      tempScore = 0.0f;
+    } else if (temp <= BIJBEL_TEMP_ELEVATED) {
+      tempScore = (temp - BIJBEL_TEMP_BASELINE) / (BIJBEL_TEMP_ELEVATED - BIJBEL_TEMP_BASELINE) * 0.5f;
+    } else {
+      tempScore = 0.5f + (temp - BIJBEL_TEMP_ELEVATED) / (BIJBEL_TEMP_HIGH - BIJBEL_TEMP_ELEVATED) * 0.5f;
+    }
+  }
+
+  // GSR score (0.0 - 1.0)
+  float gsrScore = 0.0f;
+  if (gsr > 0) {
+    if (gsr <= BIJBEL_GSR_BASELINE) {
+      gsrScore = 0.0f;
+    } else if (gsr <= BIJBEL_GSR_AROUSED) {
+      gsrScore = (gsr - BIJBEL_GSR_BASELINE) / (BIJBEL_GSR_AROUSED - BIJBEL_GSR_BASELINE) * 0.4f;
+    } else if (gsr <= BIJBEL_GSR_EDGE) {
+      gsrScore = 0.4f + (gsr - BIJBEL_GSR_AROUSED) / (BIJBEL_GSR_EDGE - BIJBEL_GSR_AROUSED) * 0.4f;
+    } else {
+      gsrScore = 0.8f + (gsr - BIJBEL_GSR_EDGE) / (BIJBEL_GSR_MAX - BIJBEL_GSR_EDGE) * 0.2f;
+    }
+  }
+
+  // Gewogen combinatie: HR 50%, GSR 35%, temp 15%
+  float combinedScore = (hrScore * 0.50f) + (gsrScore * 0.35f) + (tempScore * 0.15f);
+  combinedScore = constrain(combinedScore, 0.0f, 1.0f);
+
+  // Converteer naar 0-7 level (AI Bijbel)
+  uint8_t stressLevel;
+  if (combinedScore <= 0.05f)      stressLevel = 0;  // Ontspannen
+  else if (combinedScore <= 0.15f) stressLevel = 1;  // Rustig
+  else if (combinedScore <= 0.30f) stressLevel = 2;  // Normaal
+  else if (combinedScore <= 0.45f) stressLevel = 3;  // Licht verhoogd
+  else if (combinedScore <= 0.60f) stressLevel = 4;  // Verhoogd
+  else if (combinedScore <= 0.75f) stressLevel = 5;  // Gestrest
+  else if (combinedScore <= 0.90f) stressLevel = 6;  // Zeer gestrest
+  else                             stressLevel = 7;  // Extreem / Edge Zone
+
+  // Special case: zeer hoge hartslag = altijd hoog stress
+  if (bpm > BIJBEL_HR_EDGE) stressLevel = max(stressLevel, (uint8_t)6);
+  if (bpm > BIJBEL_HR_MAX) stressLevel = 7;  // Emergency zone
+
+  return stressLevel;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         ANALYSE (1 STREAMING PASS)
+// ═══════════════════════════════════════════════════════════════════════════
+
+static void analyzeOne(const char* csvName) {
+  uint32_t startMs = millis();
+
+  AIAnalyzeJobStatus status;
+  memset(&status, 0, sizeof(status));
+  strncpy(status.filename, csvName, sizeof(status.filename) - 1);
+  status.state = AIQ_RUNNING;
+
+  portENTER_CRITICAL(&statusMux);
+  current = status;
+  portEXIT_CRITICAL(&statusMux);
+
+  String csvPath = "/recordings/" + String(csvName);
+  File csvFile = SD_MMC.open(csvPath.c_str(), FILE_READ);
+  if (!csvFile) {
+    Serial.printf("[AI QUEUE] ERROR: Cannot open %s\n", csvPath.c_str());
+    status.state = AIQ_FAILED;
+    publishResult(status);
+    return;
+  }
+
+  uint32_t csvSize = csvFile.size();
+  AnlCacheEntry cached;
+  if (isUpToDate(csvName, csvSize, &cached)) {
+    csvFile.close();
+    status.state = AIQ_CACHED;
+    status.progress = 100;
+    status.samples = cached.samples;
+    status.avgLevel = cached.avgLevel;
+    status.maxLevel = cached.maxLevel;
+    Serial.printf("[AI QUEUE] %s up-to-date (cache hit)\n", csvName);
+    publishResult(status);
+    return;
+  }
+
+  String anlPath = "/recordings/" + anlNameFor(csvName);
+  String tmpPath = anlPath + ".tmp";
+  File anlFile = SD_MMC.open(tmpPath.c_str(), FILE_WRITE);
+  if (!anlFile) {
+    Serial.printf("[AI QUEUE] ERROR: Cannot create %s\n", tmpPath.c_str());
+    csvFile.close();
+    status.state = AIQ_FAILED;
+    publishResult(status);
+    return;
+  }
+
+  // Header + StressLevel kolom
+  char line[320];
+  size_t len = csvFile.readBytesUntil('\n', line, sizeof(line) - 1);
+  line[len] = '\0';
+  if (len > 0 && line[len - 1] == '\r') line[--len] = '\0';
+  anlFile.printf("%s,StressLevel\n", line);
+
+  uint32_t levelSum = 0;
+  uint8_t lastProgress = 0;
+
+  while (csvFile.available()) {
+    len = csvFile.readBytesUntil('\n', line, sizeof(line) - 1);
+    line[len] = '\0';
+    while (len > 0 && (line[len - 1] == '\r' || line[len - 1] == ' ')) line[--len] = '\0';
+    if (len < 5) continue;
+
+    // Parse CSV: Tijd_s,Timestamp,BPM,Temp_C,GSR,... (kolom 2, 3, 4)
+    uint8_t stressLevel = 3;  // Default: normaal
+    const char* fields[5];
+    int fieldCount = 0;
+    fields[fieldCount++] = line;
+    for (char* p = line; *p && fieldCount < 5; p++) {
+      if (*p == ',') fields[fieldCount++] = p + 1;
+    }
+    if (fieldCount >= 5) {
+      float bpm = atof(fields[2]);
+      float temp = atof(fields[3]);
+      float gsr = atof(fields[4]);
+      stressLevel = aiAnalyzeQueue_classify(bpm, temp, gsr);
+    }
+
+    anlFile.printf("%s,%u\n", line, stressLevel);
+    status.samples++;
+    levelSum += stressLevel;
+    if (stressLevel > status.maxLevel) status.maxLevel = stressLevel;
+
+    // Voortgang op basis van bytes, geen aparte regeltelling nodig
+    uint8_t progress = csvSize > 0 ? (uint8_t)((uint64_t)csvFile.position() * 100 / csvSize) : 100;
+    if (progress != lastProgress) {
+      lastProgress = progress;
+      updateProgress(progress, status.samples);
+    }
+
+    // Geef andere taken op Core 0 lucht
+    if ((status.samples & 0x3F) == 0) vTaskDelay(1);
+  }
+
+  csvFile.close();
+  anlFile.close();
+
+  // Atomisch vervangen: oude .anl pas weg als nieuwe compleet is
+  if (SD_MMC.exists(anlPath.c_str())) SD_MMC.remove(anlPath.c_str());
+  if (!SD_MMC.rename(tmpPath.c_str(), anlPath.c_str())) {
+    Serial.printf("[AI QUEUE] ERROR: Rename %s failed\n", tmpPath.c_str());
+    SD_MMC.remove(tmpPath.c_str());
+    status.state = AIQ_FAILED;
+    publishResult(status);
+    return;
+  }
+
+  status.state = AIQ_DONE;
+  status.progress = 100;
+  status.avgLevel = status.samples > 0 ? (float)levelSum / status.samples : 0.0f;
+  status.elapsedMs = millis() - startMs;
+
+  AnlCacheEntry entry = { csvSize, status.samples, status.avgLevel, status.maxLevel };
+  cacheStore(csvName, entry);
+
+  Serial.printf("[AI QUEUE] Done: %s (%u samples, avg L%.1f, max L%u, %lums)\n",
+                csvName, status.samples, status.avgLevel, status.maxLevel,
+                (unsigned long)status.elapsedMs);
+  publishResult(status);
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         FREERTOS TASK
+// ═══════════════════════════════════════════════════════════════════════════
+
+static void queueTask(void* parameter) {
+  Serial.println("[AI QUEUE] Task started on Core 0");
+
+  char name[AI_QUEUE_NAME_LEN];
+  while (true) {
+    if (xQueueReceive(jobQueue, name, portMAX_DELAY) == pdTRUE) {
+      analyzeOne(name);
+    }
+  }
+}
+
+void aiAnalyzeQueue_begin() {
+  if (jobQueue != NULL) return;
+
+  memset(results, 0, sizeof(results));
+  memset(&current, 0, sizeof(current));
+
+  jobQueue = xQueueCreate(AI_QUEUE_SIZE, AI_QUEUE_NAME_LEN);
+  if (jobQueue == NULL) {
+    Serial.println("[AI QUEUE] ERROR: Cannot create queue!");
+    return;
+  }
+
+  xTaskCreatePinnedToCore(
+    queueTask,
+    "AIQueueTask",
+    AI_QUEUE_TASK_STACK,
+    NULL,
+    AI_QUEUE_TASK_PRIO,
+    &queueTaskHandle,
+    AI_QUEUE_TASK_CORE
+  );
+
+  Serial.println("[AI QUEUE] Ready");
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         PUBLIEKE API
+// ═══════════════════════════════════════════════════════════════════════════
+
+bool aiAnalyzeQueue_enqueue(const String& filename) {
+  if (jobQueue == NULL) return false;
+  if (!filename.endsWith(".csv") || filename.length() >= AI_QUEUE_NAME_LEN) return false;
+
+  // Bestand dat nu opgenomen wordt niet analyseren (nog niet compleet)
+  if (isRecording && csvFilename.endsWith("/" + filename)) {
+    Serial.printf("[AI QUEUE] Skip %s - opname loopt nog\n", filename.c_str());
+    return false;
+  }
+
+  char name[AI_QUEUE_NAME_LEN];
+  memset(name, 0, sizeof(name));
+  strncpy(name, filename.c_str(), sizeof(name) - 1);
+
+  if (xQueueSend(jobQueue, name, 0) != pdTRUE) {
+    Serial.println("[AI QUEUE] FULL - job geweigerd");
+    return false;
+  }
+
+  Serial.printf("[AI QUEUE] Enqueued %s (%u wachtend)\n",
+                name, (unsigned)uxQueueMessagesWaiting(jobQueue));
+  return true;
+}
+
+int aiAnalyzeQueue_enqueueAll() {
+  int added = 0;
+  File root = SD_MMC.open("/recordings");
+  if (!root || !root.isDirectory()) return 0;
+
+  File file = root.openNextFile();
+  while (file) {
+    if (!file.isDirectory()) {
+      String name = String(file.name());
+      if (name.endsWith(".csv") && !isUpToDate(name.c_str(), file.size(), nullptr)) {
+        if (!aiAnalyzeQueue_enqueue(name)) {
+          if (uxQueueSpacesAvailable(jobQueue) == 0) {
+            file.close();
+            break;
+          }
+        } else {
+          added++;
+        }
+      }
+    }
+    file.close();
+    file = root.openNextFile();
+  }
+  root.close();
+
+  Serial.printf("[AI QUEUE] Backlog: %d opnames toegevoegd\n", added);
+  return added;
+}
+
+uint8_t aiAnalyzeQueue_pending() {
+  return jobQueue ? (uint8_t)uxQueueMessagesWaiting(jobQueue) : 0;
+}
+
+bool aiAnalyzeQueue_isBusy() {
+  return aiAnalyzeQueue_pending() > 0 || current.state == AIQ_RUNNING;
+}
+
+bool aiAnalyzeQueue_getCurrent(AIAnalyzeJobStatus* out) {
+  portENTER_CRITICAL(&statusMux);
+  bool running = current.state == AIQ_RUNNING;
+  if (running && out) *out = current;
+  portEXIT_CRITICAL(&statusMux);
+  return running;
+}
+
+bool aiAnalyzeQueue_getResult(const String& filename, AIAnalyzeJobStatus* out) {
+  bool found = false;
+  portENTER_CRITICAL(&statusMux);
+  // Nieuwste eerst
+  for (int i = 1; i <= AI_QUEUE_SIZE && !found; i++) {
+    const AIAnalyzeJobStatus& r = results[(resultHead + AI_QUEUE_SIZE - i) % AI_QUEUE_SIZE];
+    if (r.state != AIQ_EMPTY && strcmp(r.filename, filename.c_str()) == 0) {
+      if (out) *out = r;
+      found = true;
+    }
+  }
+  portEXIT_CRITICAL(&statusMux);
+  return found;
+}
+
+uint32_t aiAnalyzeQueue_completedCount() {
+  return completedJobs;
+}
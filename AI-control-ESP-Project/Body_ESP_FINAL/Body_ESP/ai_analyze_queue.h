@@ -0,0 +1,66 @@
+/*
+  AI ANALYSE QUEUE - Achtergrond batch analyse van opnames
+
+  ═══════════════════════════════════════════════════════════════════════════
+  Opnames (.csv in /recordings/) worden in een wachtrij gezet en door een
+  lage-prioriteit FreeRTOS taak op Core 0 geanalyseerd. De UI blokkeert niet
+  meer: menu en live sessies lopen gewoon door, de UI toont alleen status.
+
+  - 1 streaming pass per bestand (geen aparte regeltelling meer)
+  - Voortgang op basis van gelezen bytes / bestandsgrootte
+  - Resultaat wordt per bestand gecached in NVS (namespace "anl_cache"),
+    gekoppeld aan de CSV grootte. Ongewijzigde opnames worden overgeslagen.
+  - .anl wordt eerst als .tmp geschreven en pas bij succes hernoemd
+  ═══════════════════════════════════════════════════════════════════════════
+*/
+
+#ifndef AI_ANALYZE_QUEUE_H
+#define AI_ANALYZE_QUEUE_H
+
+#include <Arduino.h>
+
+#define AI_QUEUE_SIZE         16     // Max wachtende bestanden
+#define AI_QUEUE_TASK_STACK   6144
+#define AI_QUEUE_TASK_PRIO    1      // Laag - onder WiFi/ESP-NOW taken
+#define AI_QUEUE_TASK_CORE    0      // loop() draait op Core 1
+#define AI_QUEUE_NAME_LEN     48
+
+enum AIQueueJobState : uint8_t {
+  AIQ_EMPTY = 0,
+  AIQ_PENDING,      // In wachtrij
+  AIQ_RUNNING,      // Wordt nu geanalyseerd
+  AIQ_DONE,         // Klaar, .anl geschreven
+  AIQ_CACHED,       // Overgeslagen: .anl is up-to-date
+  AIQ_FAILED        // Fout (bestand niet te openen/schrijven)
+};
+
+struct AIAnalyzeJobStatus {
+  char filename[AI_QUEUE_NAME_LEN];  // Alleen bestandsnaam, zonder /recordings/
+  AIQueueJobState state;
+  uint8_t progress;         // 0-100%
+  uint32_t samples;         // Verwerkte data regels
+  float avgLevel;           // Gemiddeld stress level (0-7)
+  uint8_t maxLevel;         // Hoogste stress level
+  uint32_t elapsedMs;       // Verwerkingstijd
+};
+
+// Initialisatie (na SD_MMC.begin)
+void aiAnalyzeQueue_begin();
+
+// Zet 1 opname in de wachtrij (false = vol, ongeldig of nu in opname)
+bool aiAnalyzeQueue_enqueue(const String& csvFilename);
+
+// Zet alle .csv opnames zonder actuele .anl in de wachtrij, geeft aantal terug
+int aiAnalyzeQueue_enqueueAll();
+
+// Status voor UI
+uint8_t aiAnalyzeQueue_pending();
+bool aiAnalyzeQueue_isBusy();
+bool aiAnalyzeQueue_getCurrent(AIAnalyzeJobStatus* out);
+bool aiAnalyzeQueue_getResult(const String& csvFilename, AIAnalyzeJobStatus* out);
+uint32_t aiAnalyzeQueue_completedCount();  // Verandert bij elke afgeronde job
+
+// AI Bijbel stress classifier (0-7) - gedeeld met andere analyses
+uint8_t aiAnalyzeQueue_classify(float bpm, float temp, float gsr);
+
+#endif
@@ -8,12 +8,14 @@
 #include "esp_task_wdt.h"  // 🔥 Watchdog timer
 #include "body_display.h"
 #include "body_config.h"
+#include "espnow_protocol.h"
 #include "body_fonts.h"
 #include "body_gfx4.h"  // Voor G4_* constanten en body_gfx4_pushSample
 #include "ads1115_sensors.h"
 #include "nvs_settings.h"       // 🔥 NIEUW: Centrale NVS opslag
 #include "sensor_settings.h"    // Alleen struct definitie (EEPROM functies in nvs_settings)
 #include "playback_screen_v2.h" // 🔥 NIEUW: Herontworpen playback scherm
+#include "ai_analyze_queue.h"   // Achtergrond AI analyse
 
 // 🔥 NIEUW: Extern reference naar rendering pause flag
 extern volatile bool g4_pauseRendering;
@@ -41,7 +43,8 @@ void stopPlayback();     // 🔥 Forward declaration
 void startPlayback(const char* filename);  // 🔥 Forward declaration
 void drawStressLevelPopup();
 bool performAIAnalysis(const String& csvFilename);
-void drawAIAnalyzeScreen(int progress, const String& filename);
+static void drawAIQueueStatusLine();
+extern int csvCount;
 
 // Menu state variables
 BodyMenuMode bodyMenuMode = BODY_MODE_SENSORS;
@@ -348,6 +351,20 @@ void bodyMenuTick() {
     }
   }
   
+  // AI analyse queue: status regel verversen, lijst herladen na afgeronde job
+  static uint32_t lastQueueStatusDraw = 0;
+  static uint32_t lastCompletedJobs = 0;
+  if (bodyMenuMode == BODY_MODE_MENU && bodyMenuPage == BODY_PAGE_RECORDING && !menuDirty) {
+    if (aiAnalyzeQueue_completedCount() != lastCompletedJobs) {
+      lastCompletedJobs = aiAnalyzeQueue_completedCount();
+      csvCount = -1;  // Nieuwe .anl tonen
+      menuDirty = true;
+    } else if (aiAnalyzeQueue_isBusy() && millis() - lastQueueStatusDraw > 500) {
+      drawAIQueueStatusLine();
+      lastQueueStatusDraw = millis();
+    }
+  }
+  
   // Update heart rate history
   if (millis() - lastHistoryUpdate > 200) { // 5Hz update
     heartRateHistory[historyIndex] = getBPM();
@@ -1377,300 +1394,46 @@ uint32_t lastRecordingScan = 0;  // Laatste scan tijd
 
 // ===== AI ANALYZE FUNCTIE =====
 // Analyseert CSV bestand met ML model en slaat op als .ANL
-bool aiAnalyzeActive = false;
-int aiAnalyzeProgress = 0;
-String aiAnalyzeFilename = "";
+// AI analyse loopt in de achtergrond (ai_analyze_queue), hier alleen enqueue
+bool performAIAnalysis(const String& csvFilename) {
+  Serial.printf("[AI ANALYZE] Queueing analysis of: %s\n", csvFilename.c_str());
+  bool queued = aiAnalyzeQueue_enqueue(csvFilename);
+  menuDirty = true;
+  return queued;
+}
+
+// Status regel onder de bestandslijst (alleen deze regel hertekenen)
+static void drawAIQueueStatusLine() {
+  const int STATUS_X = 40;
+  const int STATUS_Y = 20 + 60 + 8 * 20 + 14;
+  const int STATUS_W = 230;
 
-void drawAIAnalyzeScreen(int progress, const String& filename) {
-  body_gfx->fillScreen(BODY_CFG.COL_BG);
-  
-  // Titel
   #if USE_ADAFRUIT_FONTS
-    body_gfx->setFont(&FONT_TITLE);
-    body_gfx->setTextSize(1);
-  #else
     body_gfx->setFont(nullptr);
-    body_gfx->setTextSize(2);
-  #endif
-  
-  body_gfx->setTextColor(0xF81F, BODY_CFG.COL_BG);  // Magenta
-  int16_t x1, y1; uint16_t tw, th;
-  body_gfx->getTextBounds("AI ANALYSE", 0, 0, &x1, &y1, &tw, &th);
-  body_gfx->setCursor((480 - tw) / 2 - x1, 50);
-  body_gfx->print("AI ANALYSE");
-  
-  // Bestandsnaam
-  #if USE_ADAFRUIT_FONTS
-    body_gfx->setFont(&FONT_ITEM);
-  #else
-    body_gfx->setTextSize(1);
   #endif
-  body_gfx->setTextColor(0xFFFF, BODY_CFG.COL_BG);
-  body_gfx->setCursor(40, 100);
-  body_gfx->print("Bestand: ");
-  body_gfx->setTextColor(0x07E0, BODY_CFG.COL_BG);  // Groen
-  String shortName = filename;
-  if (shortName.length() > 30) {
-    shortName = shortName.substring(0, 27) + "...";
-  }
-  body_gfx->print(shortName);
-  
-  // Voortgangsbalk achtergrond
-  int barX = 40;
-  int barY = 150;
-  int barW = 400;
-  int barH = 40;
-  
-  body_gfx->drawRoundRect(barX, barY, barW, barH, 8, 0xFFFF);
-  body_gfx->drawRoundRect(barX+1, barY+1, barW-2, barH-2, 7, 0xFFFF);
-  
-  // Voortgangsbalk vulling (roze/magenta gradient)
-  int fillW = (barW - 8) * progress / 100;
-  if (fillW > 0) {
-    body_gfx->fillRoundRect(barX + 4, barY + 4, fillW, barH - 8, 4, 0xF81F);
+  body_gfx->setTextSize(1);
+  body_gfx->fillRect(STATUS_X - 5, STATUS_Y - 2, STATUS_W + 10, 12, BODY_CFG.COL_BG);
+  body_gfx->setCursor(STATUS_X, STATUS_Y);
+
+  AIAnalyzeJobStatus job;
+  uint8_t pending = aiAnalyzeQueue_pending();
+  if (aiAnalyzeQueue_getCurrent(&job)) {
+    String shortName = String(job.filename);
+    if (shortName.length() > 18) shortName = shortName.substring(0, 15) + "...";
+    body_gfx->setTextColor(0xF81F, BODY_CFG.COL_BG);  // Magenta
+    body_gfx->printf("AI: %s %u%%", shortName.c_str(), job.progress);
+    if (pending > 0) body_gfx->printf(" (+%u)", pending);
+  } else if (pending > 0) {
+    body_gfx->setTextColor(0xF81F, BODY_CFG.COL_BG);
+    body_gfx->printf("AI: %u in wachtrij", pending);
+  } else {
+    body_gfx->setTextColor(0x8410, BODY_CFG.COL_BG);  // Grijs
+    body_gfx->print("AI: geen analyses actief");
   }
-  
-  // Percentage tekst
-  #if USE_ADAFRUIT_FONTS
-    body_gfx->setFont(&FONT_TITLE);
-  #else
-    body_gfx->setTextSize(2);
-  #endif
-  body_gfx->setTextColor(0xFFFF, BODY_CFG.COL_BG);
-  char percentStr[8];
-  sprintf(percentStr, "%d%%", progress);
-  body_gfx->getTextBounds(percentStr, 0, 0, &x1, &y1, &tw, &th);
-  body_gfx->setCursor((480 - tw) / 2 - x1, 220);
-  body_gfx->print(percentStr);
-  
-  // Status tekst
+
   #if USE_ADAFRUIT_FONTS
     body_gfx->setFont(&FONT_ITEM);
-  #else
-    body_gfx->setTextSize(1);
   #endif
-  body_gfx->setTextColor(0xF81F, BODY_CFG.COL_BG);  // Magenta
-  body_gfx->setCursor(40, 260);
-  if (progress < 100) {
-    body_gfx->print("Analyseren met ML model...");
-  } else {
-    body_gfx->setTextColor(0x07E0, BODY_CFG.COL_BG);  // Groen
-    body_gfx->print("Analyse compleet! Opgeslagen als .ANL");
-  }
-}
-
-bool performAIAnalysis(const String& csvFilename) {
-  Serial.printf("[AI ANALYZE] Starting analysis of: %s\n", csvFilename.c_str());
-  
-  aiAnalyzeActive = true;
-  aiAnalyzeFilename = csvFilename;
-  aiAnalyzeProgress = 0;
-  
-  // Open CSV bestand
-  String csvPath = "/recordings/" + csvFilename;
-  File csvFile = SD_MMC.open(csvPath.c_str(), FILE_READ);
-  if (!csvFile) {
-    Serial.println("[AI ANALYZE] ERROR: Cannot open CSV file!");
-    aiAnalyzeActive = false;
-    return false;
-  }
-  
-  // Tel regels voor progress
-  int totalLines = 0;
-  while (csvFile.available()) {
-    csvFile.readStringUntil('\n');
-    totalLines++;
-  }
-  totalLines--;  // Min header
-  csvFile.seek(0);
-  
-  Serial.printf("[AI ANALYZE] Total data lines: %d\n", totalLines);
-  
-  // Maak ANL bestandsnaam
-  String anlFilename = csvFilename;
-  anlFilename.replace(".csv", ".anl");
-  String anlPath = "/recordings/" + anlFilename;
-  
-  File anlFile = SD_MMC.open(anlPath.c_str(), FILE_WRITE);
-  if (!anlFile) {
-    Serial.println("[AI ANALYZE] ERROR: Cannot create ANL file!");
-    csvFile.close();
-    aiAnalyzeActive = false;
-    return false;
-  }
-  
-  // Lees en schrijf header + StressLevel kolom
-  String header = csvFile.readStringUntil('\n');
-  header.trim();
-  anlFile.println(header + ",StressLevel");
-  
-  // Teken eerste scherm
-  drawAIAnalyzeScreen(0, csvFilename);
-  
-  // ═══════════════════════════════════════════════════════════════════
-  // AI BIJBEL STRESS LEVEL CLASSIFIER
-  // 
-  // Level 0: Ontspannen (zeer lage stress)
-  // Level 1: Rustig
-  // Level 2: Normaal
-  // Level 3: Licht verhoogd
-  // Level 4: Verhoogd
-  // Level 5: Gestrest
-  // Level 6: Zeer gestrest
-  // Level 7: Extreem / Edge Zone
-  // ═══════════════════════════════════════════════════════════════════
-  
-  // AI Bijbel baseline waarden (BIJBEL_ prefix om conflict met config.h te voorkomen)
-  const float BIJBEL_HR_BASELINE = 70.0f;    // Gemiddelde hartslag in rust
-  const float BIJBEL_HR_EXCITED = 100.0f;    // Hartslag bij opwinding
-  const float BIJBEL_HR_EDGE = 130.0f;       // Hartslag bij edge zone
-  const float BIJBEL_HR_MAX = 160.0f;        // Maximum veilige hartslag
-  
-  const float BIJBEL_TEMP_BASELINE = 36.5f;  // Normale temperatuur
-  const float BIJBEL_TEMP_ELEVATED = 37.5f;  // Verhoogde temperatuur
-  const float BIJBEL_TEMP_HIGH = 38.0f;      // Hoge temperatuur
-  
-  const float BIJBEL_GSR_BASELINE = 300.0f;  // GSR in rust
-  const float BIJBEL_GSR_AROUSED = 600.0f;   // GSR bij opwinding
-  const float BIJBEL_GSR_EDGE = 900.0f;      // GSR bij edge zone
-  const float BIJBEL_GSR_MAX = 1200.0f;      // Maximum GSR
-  
-  // Verwerk elke regel
-  int lineNum = 0;
-  int lastProgress = 0;
-  
-  while (csvFile.available()) {
-    String line = csvFile.readStringUntil('\n');
-    line.trim();
-    if (line.length() < 5) continue;
-    
-    lineNum++;
-    
-    // Parse CSV: Tijd_s,Timestamp,BPM,Temp_C,GSR,...
-    int commaIdx[15];
-    int commaCount = 0;
-    for (int i = 0; i < line.length() && commaCount < 15; i++) {
-      if (line.charAt(i) == ',') {
-        commaIdx[commaCount++] = i;
-      }
-    }
-    
-    int stressLevel = 3;  // Default: normaal
-    
-    if (commaCount >= 4) {
-      // Extract BPM, Temp, GSR (kolommen 2, 3, 4 = index 1, 2, 3)
-      float bpm = line.substring(commaIdx[1] + 1, commaIdx[2]).toFloat();
-      float temp = line.substring(commaIdx[2] + 1, commaIdx[3]).toFloat();
-      float gsr = line.substring(commaIdx[3] + 1, commaIdx[4]).toFloat();
-      
-      // ═══════════════════════════════════════════════════════════════
-      // MULTI-FACTOR STRESS BEREKENING (AI BIJBEL GEBASEERD)
-      // ═══════════════════════════════════════════════════════════════
-      
-      // Hartslag score (0.0 - 1.0)
-      float hrScore = 0.0f;
-      if (bpm > 0) {
-        if (bpm <= BIJBEL_HR_BASELINE) {
-          hrScore = 0.0f;  // Onder baseline = ontspannen
-        } else if (bpm <= BIJBEL_HR_EXCITED) {
-          hrScore = (bpm - BIJBEL_HR_BASELINE) / (BIJBEL_HR_EXCITED - BIJBEL_HR_BASELINE) * 0.4f;
-        } else if (bpm <= BIJBEL_HR_EDGE) {
-          hrScore = 0.4f + (bpm - BIJBEL_HR_EXCITED) / (BIJBEL_HR_EDGE - BIJBEL_HR_EXCITED) * 0.4f;
-        } else {
-          hrScore = 0.8f + (bpm - BIJBEL_HR_EDGE) / (BIJBEL_HR_MAX - BIJBEL_HR_EDGE) * 0.2f;
-        }
-      }
-      
-      // Temperatuur score (0.0 - 1.0)
-      float tempScore = 0.0f;
-      if (temp > 0) {
-        if (temp <= BIJBEL_TEMP_BASELINE) {
-          tempScore = 0.0f;
-        } else if (temp <= BIJBEL_TEMP_ELEVATED) {
-          tempScore = (temp - BIJBEL_TEMP_BASELINE) / (BIJBEL_TEMP_ELEVATED - BIJBEL_TEMP_BASELINE) * 0.5f;
-        } else {
-          tempScore = 0.5f + (temp - BIJBEL_TEMP_ELEVATED) / (BIJBEL_TEMP_HIGH - BIJBEL_TEMP_ELEVATED) * 0.5f;
-        }
-      }
-      
-      // GSR score (0.0 - 1.0)
-      float gsrScore = 0.0f;
-      if (gsr > 0) {
-        if (gsr <= BIJBEL_GSR_BASELINE) {
-          gsrScore = 0.0f;
-        } else if (gsr <= BIJBEL_GSR_AROUSED) {
-          gsrScore = (gsr - BIJBEL_GSR_BASELINE) / (BIJBEL_GSR_AROUSED - BIJBEL_GSR_BASELINE) * 0.4f;
-        } else if (gsr <= BIJBEL_GSR_EDGE) {
-          gsrScore = 0.4f + (gsr - BIJBEL_GSR_AROUSED) / (BIJBEL_GSR_EDGE - BIJBEL_GSR_AROUSED) * 0.4f;
-        } else {
-          gsrScore = 0.8f + (gsr - BIJBEL_GSR_EDGE) / (BIJBEL_GSR_MAX - BIJBEL_GSR_EDGE) * 0.2f;
-        }
-      }
-      
-      // Gewogen combinatie
-      // HR weegt het zwaarst (50%), dan GSR (35%), dan temp (15%)
-      float combinedScore = (hrScore * 0.50f) + (gsrScore * 0.35f) + (tempScore * 0.15f);
-      combinedScore = constrain(combinedScore, 0.0f, 1.0f);
-      
-      // Converteer naar 0-7 level (AI Bijbel)
-      if (combinedScore <= 0.05f) {
-        stressLevel = 0;  // Ontspannen
-      } else if (combinedScore <= 0.15f) {
-        stressLevel = 1;  // Rustig
-      } else if (combinedScore <= 0.30f) {
-        stressLevel = 2;  // Normaal
-      } else if (combinedScore <= 0.45f) {
-        stressLevel = 3;  // Licht verhoogd
-      } else if (combinedScore <= 0.60f) {
-        stressLevel = 4;  // Verhoogd
-      } else if (combinedScore <= 0.75f) {
-        stressLevel = 5;  // Gestrest
-      } else if (combinedScore <= 0.90f) {
-        stressLevel = 6;  // Zeer gestrest
-      } else {
-        stressLevel = 7;  // Extreem / Edge Zone
-      }
-      
-      // Special case: Zeer hoge hartslag = altijd hoog stress
-      if (bpm > BIJBEL_HR_EDGE) {
-        stressLevel = max(stressLevel, 6);
-      }
-      if (bpm > BIJBEL_HR_MAX) {
-        stressLevel = 7;  // Emergency zone
-      }
-    }
-    
-    // Schrijf regel + stress level
-    anlFile.printf("%s,%d\n", line.c_str(), stressLevel);
-    
-    // Update progress (elke 5% of elke 50 regels)
-    int progress = (lineNum * 100) / max(1, totalLines);
-    if (progress != lastProgress && (progress % 5 == 0 || lineNum % 50 == 0)) {
-      lastProgress = progress;
-      aiAnalyzeProgress = progress;
-      drawAIAnalyzeScreen(progress, csvFilename);
-      yield();  // Geef systeem tijd
-    }
-  }
-  
-  // Sluit bestanden
-  csvFile.close();
-  anlFile.close();
-  
-  // Toon 100% compleet
-  aiAnalyzeProgress = 100;
-  drawAIAnalyzeScreen(100, csvFilename);
-  
-  Serial.printf("[AI ANALYZE] Complete! Saved as: %s\n", anlFilename.c_str());
-  
-  // Wacht even zodat gebruiker resultaat ziet
-  delay(1500);
-  
-  // Reset state
-  aiAnalyzeActive = false;
-  csvCount = -1;  // Force rescan om nieuwe .anl te tonen
-  
-  return true;
 }
 
 void drawRecordingItems() {
@@ -1839,6 +1602,8 @@ void drawRecordingItems() {
     #endif
     body_gfx->print(btnLabels[i]);
   }
+
+  drawAIQueueStatusLine();
 }
 
 void drawSensorSettingsItems() {
@@ -2207,7 +1972,10 @@ void bodyMenuHandleTouch(int16_t x, int16_t y, bool pressed) {
                     menuDirty = true;
                   }
                 } else {
-                  Serial.println("[RECORDING] Selecteer eerst een bestand!");
+                  // Geen selectie: hele backlog in de wachtrij
+                  Serial.println("[RECORDING] Geen bestand geselecteerd - analyseer alle opnames");
+                  aiAnalyzeQueue_enqueueAll();
+                  menuDirty = true;
                 }
                 break;
               case 3:
@@ -3802,10 +3570,10 @@ void updatePlayback() {
   
   // Parse CSV regel: timestamp,trust,sleeve,vibe,zuig,hr,hrv,temp,gsr,...
   // Format: timestamp,trust,sleeve,vibe,zuig,hr,hrv,temp,gsr,accelX,accelY,accelZ,gyroX,gyroY,gyroZ
-  int commaPos[16];
+  int commaPos[24];
   int commaCount = 0;
   
-  for (int i = 0; i < line.length() && commaCount < 16; i++) {
+  for (int i = 0; i < line.length() && commaCount < 24; i++) {
     if (line[i] == ',') {
       commaPos[commaCount++] = i;
     }
@@ -3925,7 +3693,7 @@ void updatePlayback() {
   // Serial.printf("[PLAYBACK] ESP-NOW TX: T:%.3f S:%.3f V:%d Z:%d\n", trustNorm, sleeveNorm, vibeActive, zuigActive);
   
   // Stuur ESP-NOW PLAYBACK_STRESS commando (hergebruik bestaande handler)
-  extern bool sendESPNowMessage(float newTrust, float newSleeve, bool overruleActive, const char* command, uint8_t stressLevel, bool vibeOn, bool zuigenOn);
+  extern bool sendESPNowMessage(float newTrust, float newSleeve, bool overruleActive, uint8_t opcode, uint8_t stressLevel, bool vibeOn, bool zuigenOn);
   
   // Converteer trust (0.0-2.0) naar stress level (1-7)
   // Trust mapping:
@@ -3955,7 +3723,7 @@ void updatePlayback() {
   bool vibeActive = (vibe > 0);  // 0/1 -> bool
   bool zuigActive = (zuig > 0);  // 0/1 -> bool
   
-  sendESPNowMessage(0, 0, false, "PLAYBACK_STRESS", stressLevel, vibeActive, zuigActive);
+  sendESPNowMessage(0, 0, false, ESPNOW_OP_PLAYBACK_STRESS, stressLevel, vibeActive, zuigActive);
   
   Serial.printf("[PLAYBACK] ESP-NOW TX: Stress:%d (T:%.2f) V:%d Z:%d\n", stressLevel, trust, vibeActive, zuigActive);
 }
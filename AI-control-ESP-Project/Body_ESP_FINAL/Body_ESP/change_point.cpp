@@ -0,0 +1,247 @@
+/*
+  CHANGE POINT DETECTOR - Implementatie
+
+  Tweezijdige CUSUM per kanaal met zelf-kalibrerende drift en drempel,
+  daarna bevestiging via persistentie of HR/GSR samen
+*/
+
+#include "change_point.h"
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         STATE
+// ═══════════════════════════════════════════════════════════════════════════
+
+struct CPState {
+  float mean;
+  float var;
+  float gUp;
+  float gDown;
+  uint32_t onsetUpMs;     // Laatste moment dat gUp 0 was
+  uint32_t onsetDownMs;
+  uint16_t runUp;         // Samples sinds gUp 0 was
+  uint16_t runDown;
+  uint16_t samples;
+};
+
+// Ruw alarm dat op bevestiging wacht
+struct CPPending {
+  int8_t direction;       // 0 = niets te bevestigen
+  float baseMean;         // μ vóór het alarm
+  float minShift;         // Gemiddelde moet minstens zo ver van baseMean liggen
+  float sum;
+  uint16_t samples;
+  ChangePointEvent ev;    // Het ruwe alarm
+};
+
+static CPState channels[CP_CHANNELS];
+static CPPending pending[CP_CHANNELS];
+
+// Minimale σ per kanaal: voorkomt alarm op ADC ruis bij een vlak signaal
+static const float SIGMA_FLOOR[CP_CHANNELS] = { 0.5f, 2.0f, 0.02f };
+static const char* CHANNEL_NAMES[CP_CHANNELS] = { "HR", "GSR", "Temp" };
+static const char* EVENT_NAMES[CP_CHANNELS][2][2] = {
+  { { "CP_HR_DOWN",   "CP_HR_UP" },   { "CP_HR_DOWN_OK",   "CP_HR_UP_OK" } },
+  { { "CP_GSR_DOWN",  "CP_GSR_UP" },  { "CP_GSR_DOWN_OK",  "CP_GSR_UP_OK" } },
+  { { "CP_TEMP_DOWN", "CP_TEMP_UP" }, { "CP_TEMP_DOWN_OK", "CP_TEMP_UP_OK" } }
+};
+
+static ChangePointEvent events[CP_EVENT_RING];
+static uint32_t eventSeq = 0;
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         DETECTIE
+// ═══════════════════════════════════════════════════════════════════════════
+
+static const ChangePointEvent& emitEvent(CPChannel ch, int8_t direction, float magnitude,
+                                         uint32_t onsetMs, uint32_t now, bool confirmed) {
+  eventSeq++;
+  ChangePointEvent& ev = events[eventSeq % CP_EVENT_RING];
+  ev.seq = eventSeq;
+  ev.channel = ch;
+  ev.direction = direction;
+  ev.magnitude = magnitude;
+  ev.onsetMs = onsetMs;
+  ev.detectMs = now;
+  ev.confirmed = confirmed;
+
+  Serial.printf("[CP] %s %s %.1fσ (onset -%lums)%s\n",
+                CHANNEL_NAMES[ch], direction > 0 ? "omhoog" : "omlaag",
+                magnitude, (unsigned long)(now - onsetMs), confirmed ? " bevestigd" : "");
+  return ev;
+}
+
+static void confirmPending(CPChannel ch, uint32_t now) {
+  CPPending& p = pending[ch];
+  emitEvent(ch, p.ev.direction, p.ev.magnitude, p.ev.onsetMs, now, true);
+  p.direction = 0;
+}
+
+// Niet bevestigd: het alarm was ruis, μ terug zodat er geen alarm
+// de andere kant op volgt
+static void dropPending(CPChannel ch) {
+  CPState& s = channels[ch];
+  s.mean = pending[ch].baseMean;
+  s.gUp = 0.0f;
+  s.gDown = 0.0f;
+  s.runUp = 0;
+  s.runDown = 0;
+  pending[ch].direction = 0;
+}
+
+// Het andere snelle kanaal (HR ↔ GSR), Temp heeft geen partner
+static bool partnerChannel(CPChannel ch, CPChannel& partner) {
+  if (ch == CP_HR) { partner = CP_GSR; return true; }
+  if (ch == CP_GSR) { partner = CP_HR; return true; }
+  return false;
+}
+
+// Ruw alarm: bevestigen, annuleren of laten wachten op persistentie
+static void onAlarm(CPChannel ch, const ChangePointEvent& ev, float baseMean, float minShift, uint32_t now) {
+  CPPending& p = pending[ch];
+
+  if (p.direction == ev.direction) {
+    confirmPending(ch, now);   // Verandering zet door (helling)
+    return;
+  }
+  if (p.direction != 0) {
+    dropPending(ch);           // Heen en terug: ruis
+    return;
+  }
+
+  CPChannel other;
+  if (partnerChannel(ch, other) && pending[other].direction == ev.direction &&
+      now - pending[other].ev.detectMs <= CP_AGREE_MS) {
+    confirmPending(other, now);
+    emitEvent(ch, ev.direction, ev.magnitude, ev.onsetMs, now, true);
+    return;
+  }
+
+  p.direction = ev.direction;
+  p.baseMean = baseMean;
+  p.minShift = minShift;
+  p.sum = 0.0f;
+  p.samples = 0;
+  p.ev = ev;
+}
+
+static void updatePending(CPChannel ch, float x, uint32_t now) {
+  CPPending& p = pending[ch];
+  if (p.direction == 0) return;
+
+  p.sum += x;
+  if (++p.samples < CP_CONFIRM_SAMPLES) return;
+
+  float shift = (p.sum / p.samples - p.baseMean) * p.direction;
+  if (shift >= p.minShift) {
+    confirmPending(ch, now);
+  } else {
+    dropPending(ch);
+  }
+}
+
+static void updateChannel(CPChannel ch, float x, uint32_t now) {
+  CPState& s = channels[ch];
+
+  // Sensor ontbreekt (0) → niets leren, niets detecteren
+  if (x <= 0.0f) return;
+
+  if (s.samples == 0) {
+    s.mean = x;
+    s.var = 0.0f;
+    s.onsetUpMs = now;
+    s.onsetDownMs = now;
+  }
+
+  float sigma = max(sqrtf(s.var), SIGMA_FLOOR[ch]);
+  float drift = CP_DRIFT_SIGMA * sigma;
+  float threshold = CP_THRESHOLD_SIGMA * sigma;
+  float dev = x - s.mean;
+
+  // Warm-up: alleen kalibreren
+  if (s.samples < CP_WARMUP_SAMPLES) {
+    s.samples++;
+    float alpha = 1.0f / s.samples;   // Eerst gewoon gemiddelde, dan EWMA
+    s.mean += alpha * dev;
+    s.var += alpha * (dev * dev - s.var);
+    s.onsetUpMs = now;
+    s.onsetDownMs = now;
+    return;
+  }
+
+  s.gUp = max(0.0f, s.gUp + dev - drift);
+  s.gDown = max(0.0f, s.gDown - dev - drift);
+
+  if (s.gUp == 0.0f) { s.onsetUpMs = now; s.runUp = 0; } else if (s.runUp < 0xFFFF) s.runUp++;
+  if (s.gDown == 0.0f) { s.onsetDownMs = now; s.runDown = 0; } else if (s.runDown < 0xFFFF) s.runDown++;
+
+  if (s.gUp > threshold || s.gDown > threshold) {
+    int8_t direction = (s.gUp > threshold) ? 1 : -1;
+    uint32_t onset = (direction > 0) ? s.onsetUpMs : s.onsetDownMs;
+    float g = (direction > 0) ? s.gUp : s.gDown;
+    uint16_t run = max((uint16_t)1, (direction > 0) ? s.runUp : s.runDown);
+
+    // Geschat nieuw niveau (CUSUM schatter) wordt de referentie;
+    // niet de laatste sample zelf, die is ruis en geeft een alarm cascade
+    float shift = drift + g / run;
+    float baseMean = s.mean;
+    ChangePointEvent ev = emitEvent(ch, direction, shift / sigma, onset, now, false);
+
+    s.mean += direction * shift;
+    s.gUp = 0.0f;
+    s.gDown = 0.0f;
+    s.runUp = 0;
+    s.runDown = 0;
+    s.onsetUpMs = now;
+    s.onsetDownMs = now;
+    onAlarm(ch, ev, baseMean, max(shift / 2, drift), now);
+    return;
+  }
+
+  updatePending(ch, x, now);
+
+  // σ altijd bijwerken: alleen "rustige" samples meenemen onderschat σ
+  // en geeft meer vals alarm. μ alleen zolang er geen verandering opbouwt.
+  s.var += CP_EWMA_ALPHA * (dev * dev - s.var);
+  if (s.gUp < threshold / 2 && s.gDown < threshold / 2) {
+    s.mean += CP_EWMA_ALPHA * dev;
+  }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         PUBLIC API
+// ═══════════════════════════════════════════════════════════════════════════
+
+void changePoint_reset() {
+  memset(channels, 0, sizeof(channels));
+  memset(pending, 0, sizeof(pending));
+}
+
+void changePoint_update(float heartRate, float temperature, float gsr) {
+  uint32_t now = millis();
+  updateChannel(CP_HR, heartRate, now);
+  updateChannel(CP_GSR, gsr, now);
+  updateChannel(CP_TEMP, temperature, now);
+}
+
+bool changePoint_next(uint32_t& lastSeq, ChangePointEvent& out) {
+  if (lastSeq >= eventSeq) return false;
+
+  // Te ver achter → oudste die nog in de ring staat
+  uint32_t next = lastSeq + 1;
+  if (eventSeq - next >= CP_EVENT_RING) {
+    next = eventSeq - CP_EVENT_RING + 1;
+  }
+
+  out = events[next % CP_EVENT_RING];
+  lastSeq = next;
+  return true;
+}
+
+const char* changePoint_channelName(CPChannel channel) {
+  return (channel < CP_CHANNELS) ? CHANNEL_NAMES[channel] : "?";
+}
+
+const char* changePoint_eventName(const ChangePointEvent& ev) {
+  if (ev.channel >= CP_CHANNELS) return "CP";
+  return EVENT_NAMES[ev.channel][ev.confirmed ? 1 : 0][ev.direction > 0 ? 1 : 0];
+}
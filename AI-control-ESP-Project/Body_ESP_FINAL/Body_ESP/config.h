@@ -180,6 +180,15 @@
 #define AI_TRAINING_MODE          false      // AI training data collection mode
 #define AUTO_RECORD_SESSIONS      true       // Automatisch CSV bestanden opnemen voor sessies
 
+// Gecompileerd model (productie build)
+#ifndef AI_USE_COMPILED_MODEL                // Host build (host/Makefile) zet hem via -D
+#define AI_USE_COMPILED_MODEL     false      // true = AI beslissingen via ml_compiled_model.h (flash)
+                                             // i.p.v. model.bin laden en interpreteren
+                                             // Genereer via mlCodegen_writeHeader(), staat dan
+                                             // op SD: /ml_training/ml_compiled_model.h
+                                             // → kopieer naast Body_ESP.ino
+#endif
+
 // ================================================================================
 // EMERGENCY PAUSE & WARM-UP CONFIGURATIE
 // ================================================================================
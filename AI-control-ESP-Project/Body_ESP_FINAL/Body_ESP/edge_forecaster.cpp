@@ -0,0 +1,192 @@
+/*
+  EDGE FORECASTER - Implementatie
+
+  Lineaire trend over arousal score, seconden tot geleerde edge drempel
+*/
+
+#include "edge_forecaster.h"
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         STATE
+// ═══════════════════════════════════════════════════════════════════════════
+
+static float scores[EDGE_FC_WINDOW];
+static uint8_t head = 0;          // Volgende schrijfpositie
+static uint8_t count = 0;
+static uint32_t lastSampleMs = 0;
+static float lastScore = 0.0f;
+
+// Baseline = gemiddelde eerste EDGE_FC_BASELINE_SAMPLES
+static bool baselineReady = false;
+static uint8_t baselineCount = 0;
+static float hrSum = 0, tempSum = 0, gsrSum = 0, breathSum = 0;
+static float hrBase = 0, tempBase = 0, gsrBase = 0, breathBase = 0;
+
+// Geleerd over edges heen (blijft staan bij reset)
+static float threshold = EDGE_FC_DEFAULT_THRESHOLD;
+static uint16_t learnedEdges = 0;
+
+static EdgeForecast forecast;
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         SCORE
+// ═══════════════════════════════════════════════════════════════════════════
+
+static float arousalScore(float hr, float temp, float gsr, float breath) {
+  // Ongeldige metingen (sensor los) tellen als baseline
+  float hrDev = (hr > 0) ? (hr - hrBase) / 15.0f : 0.0f;             // 15 BPM = 1
+  float gsrDev = (gsr > 0) ? (gsr - gsrBase) / max(gsrBase * 0.25f, 1.0f) : 0.0f;
+  float tempDev = (temp > 0) ? (temp - tempBase) / 0.5f : 0.0f;      // 0.5 °C = 1
+  float breathDev = (breath - breathBase) / 20.0f;                   // 20% = 1
+
+  return hrDev * 0.35f + gsrDev * 0.35f + tempDev * 0.15f + breathDev * 0.15f;
+}
+
+static void clearTrend() {
+  head = 0;
+  count = 0;
+  memset(&forecast, 0, sizeof(forecast));
+  forecast.threshold = threshold;
+  forecast.learnedEdges = learnedEdges;
+  forecast.secondsToEdge = EDGE_FC_MAX_SECONDS;
+  forecast.secondsToEdgeLow = EDGE_FC_MAX_SECONDS;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         REGRESSIE
+// ═══════════════════════════════════════════════════════════════════════════
+
+static void recompute() {
+  forecast.threshold = threshold;
+  forecast.learnedEdges = learnedEdges;
+  forecast.valid = false;
+  forecast.secondsToEdge = EDGE_FC_MAX_SECONDS;
+  forecast.secondsToEdgeLow = EDGE_FC_MAX_SECONDS;
+  forecast.confidence = 0.0f;
+  forecast.score = lastScore;
+  forecast.slopePerSec = 0.0f;
+
+  if (count < EDGE_FC_MIN_SAMPLES) return;
+
+  // x = tijd in seconden, oudste sample = 0
+  const float dt = EDGE_FC_SAMPLE_MS / 1000.0f;
+  uint8_t start = (head + EDGE_FC_WINDOW - count) % EDGE_FC_WINDOW;
+
+  float meanX = (count - 1) * dt / 2.0f;
+  float meanY = 0.0f;
+  for (uint8_t i = 0; i < count; i++) {
+    meanY += scores[(start + i) % EDGE_FC_WINDOW];
+  }
+  meanY /= count;
+
+  float sxx = 0, sxy = 0, syy = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    float dx = i * dt - meanX;
+    float dy = scores[(start + i) % EDGE_FC_WINDOW] - meanY;
+    sxx += dx * dx;
+    sxy += dx * dy;
+    syy += dy * dy;
+  }
+  if (sxx <= 0.0f) return;
+
+  float slope = sxy / sxx;
+  float fit = meanY + slope * ((count - 1) * dt - meanX);
+  float r2 = (syy > 0.0f) ? (sxy * sxy) / (sxx * syy) : 0.0f;
+  float residVar = max(0.0f, (syy - slope * sxy) / (count - 2));
+  float slopeSe = sqrtf(residVar / sxx);
+
+  forecast.score = fit;
+  forecast.slopePerSec = slope;
+
+  float fill = (float)count / EDGE_FC_WINDOW;
+  float edgeTrust = 0.5f + 0.5f * min(1.0f, (float)learnedEdges / EDGE_FC_CONFIDENT_EDGES);
+  forecast.confidence = constrain(r2 * fill * edgeTrust, 0.0f, 1.0f);
+
+  float remaining = threshold - fit;
+  if (remaining <= 0.0f) {
+    // Al over de drempel
+    forecast.valid = true;
+    forecast.secondsToEdge = 0.0f;
+    forecast.secondsToEdgeLow = 0.0f;
+    return;
+  }
+
+  if (slope <= 0.0f) return;  // Dalende/vlakke trend → geen edge in zicht
+
+  forecast.valid = true;
+  forecast.secondsToEdge = min(EDGE_FC_MAX_SECONDS, remaining / slope);
+  forecast.secondsToEdgeLow = min(EDGE_FC_MAX_SECONDS, remaining / (slope + 1.645f * slopeSe));
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         PUBLIC API
+// ═══════════════════════════════════════════════════════════════════════════
+
+void edgeForecast_reset() {
+  baselineReady = false;
+  baselineCount = 0;
+  hrSum = tempSum = gsrSum = breathSum = 0;
+  lastSampleMs = 0;
+  lastScore = 0.0f;
+  clearTrend();
+}
+
+void edgeForecast_update(float heartRate, float temperature, float gsr, float breath) {
+  uint32_t now = millis();
+  if (lastSampleMs != 0 && now - lastSampleMs < EDGE_FC_SAMPLE_MS) return;
+  lastSampleMs = now;
+
+  if (!baselineReady) {
+    hrSum += heartRate;
+    tempSum += temperature;
+    gsrSum += gsr;
+    breathSum += breath;
+    if (++baselineCount >= EDGE_FC_BASELINE_SAMPLES) {
+      hrBase = hrSum / baselineCount;
+      tempBase = tempSum / baselineCount;
+      gsrBase = gsrSum / baselineCount;
+      breathBase = breathSum / baselineCount;
+      baselineReady = true;
+      Serial.printf("[FORECAST] Baseline: HR=%.0f T=%.2f GSR=%.0f Adem=%.0f\n",
+                    hrBase, tempBase, gsrBase, breathBase);
+    }
+    return;
+  }
+
+  lastScore = arousalScore(heartRate, temperature, gsr, breath);
+  scores[head] = lastScore;
+  head = (head + 1) % EDGE_FC_WINDOW;
+  if (count < EDGE_FC_WINDOW) count++;
+
+  recompute();
+}
+
+void edgeForecast_markEdge() {
+  if (!baselineReady || count == 0) {
+    Serial.println("[FORECAST] Edge genegeerd - nog geen baseline");
+    return;
+  }
+
+  float edgeScore = lastScore;
+  if (edgeScore > 0.5f) {
+    threshold = (learnedEdges == 0) ? edgeScore
+                                    : threshold + EDGE_FC_LEARN_RATE * (edgeScore - threshold);
+    learnedEdges++;
+  }
+
+  Serial.printf("[FORECAST] Edge bij score %.2f → drempel %.2f (%u edges)\n",
+                edgeScore, threshold, learnedEdges);
+
+  // Na een edge begint een nieuwe opbouw
+  clearTrend();
+}
+
+EdgeForecast edgeForecast_get() {
+  return forecast;
+}
+
+bool edgeForecast_shouldSlowDown() {
+  return forecast.valid &&
+         forecast.confidence >= EDGE_FC_MIN_CONFIDENCE &&
+         forecast.secondsToEdgeLow <= EDGE_FC_SLOWDOWN_SECONDS;
+}
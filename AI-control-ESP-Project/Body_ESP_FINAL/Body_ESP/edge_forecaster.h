@@ -0,0 +1,68 @@
+/*
+  EDGE FORECASTER - Voorspelt seconden tot edge naast de level classifier
+
+  ═══════════════════════════════════════════════════════════════════════════
+  De stress manager classificeert alleen het HUIDIGE level en reageert via
+  detectStressChange() pas achteraf. Deze module kijkt vooruit:
+
+  1. Per sample een arousal score t.o.v. een sessie baseline
+     (HR, GSR, temperatuur, ademhaling → gewogen afwijking)
+  2. Lineaire regressie over de laatste EDGE_FC_WINDOW samples
+     (vast aantal → begrensde rekentijd per tick)
+  3. Seconden tot de score de edge drempel raakt:
+       - verwacht (helling)
+       - pessimistisch (helling + 1.645 x standaardfout ≈ 5% kwantiel)
+  4. Edge drempel wordt geleerd: bij elke edge (emergency pause tijdens AI,
+     ORGASM_TRIGGER) schuift de drempel richting de score op dat moment
+
+  Confidence (0-1) = R² van de fit x vulling window x aantal geleerde edges.
+  Stuurt zelf niets aan: Body_ESP.ino verlaagt het level als
+  edgeForecast_shouldSlowDown() true geeft.
+  ═══════════════════════════════════════════════════════════════════════════
+*/
+
+#ifndef EDGE_FORECASTER_H
+#define EDGE_FORECASTER_H
+
+#include <Arduino.h>
+
+#define EDGE_FC_SAMPLE_MS          500     // 2 samples/sec in het window
+#define EDGE_FC_WINDOW             40      // 40 x 0.5s = 20 sec trend
+#define EDGE_FC_MIN_SAMPLES        10      // Minimaal voor een voorspelling
+#define EDGE_FC_BASELINE_SAMPLES   20      // Eerste 10 sec = baseline
+#define EDGE_FC_MAX_SECONDS        600.0f  // Verder weg = "geen edge in zicht"
+
+#define EDGE_FC_DEFAULT_THRESHOLD  3.0f    // Score drempel tot eerste geleerde edge
+#define EDGE_FC_LEARN_RATE         0.3f    // Gewicht nieuwe edge in drempel
+#define EDGE_FC_CONFIDENT_EDGES    3       // Na 3 edges volle vertrouwen in drempel
+
+// Proactief afremmen
+#define EDGE_FC_SLOWDOWN_SECONDS   30.0f   // Pessimistische schatting onder 30 sec
+#define EDGE_FC_MIN_CONFIDENCE     0.4f
+
+struct EdgeForecast {
+  bool valid;                 // Genoeg samples en stijgende trend
+  float score;                // Huidige arousal score (gefit)
+  float threshold;            // Geleerde edge drempel
+  float slopePerSec;          // Score per seconde
+  float secondsToEdge;        // Verwacht
+  float secondsToEdgeLow;     // Pessimistisch (5% kwantiel)
+  float confidence;           // 0.0 - 1.0
+  uint16_t learnedEdges;
+};
+
+// Nieuwe sessie / na edge: trend en baseline opnieuw
+void edgeForecast_reset();
+
+// Elke sensor tick (rekent alleen elke EDGE_FC_SAMPLE_MS)
+void edgeForecast_update(float heartRate, float temperature, float gsr, float breath);
+
+// Edge moment waargenomen → drempel leren, trend resetten
+void edgeForecast_markEdge();
+
+EdgeForecast edgeForecast_get();
+
+// true = edge dichtbij genoeg en voorspelling betrouwbaar genoeg
+bool edgeForecast_shouldSlowDown();
+
+#endif // EDGE_FORECASTER_H
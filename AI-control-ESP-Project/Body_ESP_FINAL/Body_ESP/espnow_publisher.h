@@ -0,0 +1,93 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+// ===============================================================================
+// ESP-NOW PUBLISHER - Adaptief zendritme voor periodieke status
+// ===============================================================================
+// IDENTIEKE KOPIE in:
+//   Body_ESP_FINAL/Body_ESP/espnow_publisher.h
+//   Hooft_ESP/Hooft_ESP_KEON/espnow_publisher.h
+//
+// Vaste intervallen (status 2Hz, M5 colors 4Hz, AI override 1Hz) sturen
+// ook als er niets veranderd is, en laten een knop druk tot een interval
+// op zich wachten. Per stroom een EspNowPublisher:
+//
+//   urgent  (speed step, pauze, bits, ...)  → direct, max 1x per minGapMs
+//   traag   (vacuum, sleeve positie, ...)   → max 1x per slowGapMs
+//   niets veranderd                          → volledig frame na keepaliveMs
+//   laatste FULL ouder dan keepaliveMs       → volgende frame is FULL
+//
+// Een verloren delta wordt niet herhaald: zonder de laatste regel bleef
+// zo'n veld fout zolang er andere delta's gingen (keepalive telt vanaf het
+// laatste frame). Nu herstelt de volgende FULL het binnen ~keepaliveMs.
+// Na (her)start gaan de eerste ESPNOW_PUB_START_FULLS frames volledig:
+// ging de allereerste FULL verloren, dan had de peer geen basis en zette
+// hij elke delta op een lege status tot de keepalive.
+//
+// De aanroeper bepaalt zelf wat urgent/traag is (deadband) en wat er
+// verstuurd wordt; de publisher beslist alleen WANNEER en of het een
+// volledig frame (resync na verlies) of een delta mag zijn.
+// ===============================================================================
+
+enum EspNowPubSend : uint8_t {
+  ESPNOW_PUB_NONE = 0,
+  ESPNOW_PUB_DELTA,       // Alleen wijzigingen
+  ESPNOW_PUB_FULL         // Volledige status (eerste keer / keepalive)
+};
+
+#define ESPNOW_PUB_START_FULLS  3
+
+struct EspNowPublisher {
+  uint16_t minGapMs;      // Min tijd tussen twee frames (burst begrenzing)
+  uint16_t slowGapMs;     // Min tijd voor alleen trage wijzigingen
+  uint16_t keepaliveMs;   // Volledig frame als er zo lang niets ging
+  uint32_t lastSendMs;
+  uint32_t lastFullMs;
+  bool     started;       // false → eerstvolgende frame is FULL
+  uint8_t  startFulls;    // Nog zoveel frames FULL na (her)start
+
+  uint32_t fullSent;
+  uint32_t deltaSent;
+  uint32_t suppressed;    // Beslissingen zonder frame (niets of te snel)
+};
+
+static inline void espnowPub_init(EspNowPublisher& pub, uint16_t minGapMs, uint16_t slowGapMs, uint16_t keepaliveMs) {
+  memset(&pub, 0, sizeof(pub));
+  pub.minGapMs = minGapMs;
+  pub.slowGapMs = slowGapMs;
+  pub.keepaliveMs = keepaliveMs;
+  pub.startFulls = ESPNOW_PUB_START_FULLS;
+}
+
+// Volgende frame wordt FULL (peer opnieuw verbonden / herstart)
+static inline void espnowPub_restart(EspNowPublisher& pub) {
+  pub.started = false;
+  pub.startFulls = ESPNOW_PUB_START_FULLS;
+}
+
+static inline EspNowPubSend espnowPub_decide(EspNowPublisher& pub, uint32_t nowMs,
+                                             bool urgentChanged, bool slowChanged) {
+  uint32_t since = nowMs - pub.lastSendMs;
+  if (!pub.started || since >= pub.keepaliveMs) return ESPNOW_PUB_FULL;
+  bool due = (urgentChanged && since >= pub.minGapMs) || (slowChanged && since >= pub.slowGapMs);
+  if (!due) {
+    pub.suppressed++;
+    return ESPNOW_PUB_NONE;
+  }
+  // Continu delta verkeer: af en toe toch volledig (resync na verloren delta)
+  return (pub.startFulls || nowMs - pub.lastFullMs >= pub.keepaliveMs) ? ESPNOW_PUB_FULL : ESPNOW_PUB_DELTA;
+}
+
+// Na het daadwerkelijk versturen
+static inline void espnowPub_sent(EspNowPublisher& pub, uint32_t nowMs, EspNowPubSend kind) {
+  pub.lastSendMs = nowMs;
+  pub.started = true;
+  if (kind == ESPNOW_PUB_FULL) {
+    pub.lastFullMs = nowMs;
+    pub.fullSent++;
+    if (pub.startFulls) pub.startFulls--;
+  } else {
+    pub.deltaSent++;
+  }
+}
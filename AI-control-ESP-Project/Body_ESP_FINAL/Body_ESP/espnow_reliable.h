@@ -0,0 +1,340 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include "espnow_protocol.h"
+
+// ===============================================================================
+// ESP-NOW BETROUWBARE LEVERING - Ack + herhaling voor kritieke opcodes
+// ===============================================================================
+// IDENTIEKE KOPIE in:
+//   Body_ESP_FINAL/Body_ESP/espnow_reliable.h
+//   Hooft_ESP/Hooft_ESP_KEON/espnow_reliable.h
+//
+// esp_now_send() == ESP_OK zegt alleen dat het frame in de WiFi queue staat,
+// de send callback alleen dat de MAC laag het afleverde. Een verloren of
+// in een volle ontvangst queue weggegooid AI_OVERRIDE / ORGASM_TRIGGER
+// verdween dus stil. Per peer een EspNowReliable:
+//
+//   Zenden:   frames met ESPNOW_FLAG_ACK_REQ (espnow_needsAck) blijven in een
+//             venster van ESPNOW_REL_WINDOW tot de ACK binnen is. Timeout
+//             verdubbelt per poging (ESPNOW_REL_BASE_TIMEOUT_MS .. MAX),
+//             na ESPNOW_REL_MAX_RETRIES valt het frame af. Venster vol →
+//             oudste valt af (nieuwer commando is belangrijker).
+//             Send callback met FAIL → laatste frame direct opnieuw, max
+//             ESPNOW_REL_FAST_RETRIES keer per frame en buiten de
+//             timeout pogingen: anders brandt een storing (MAC faalt
+//             elke poging) het hele budget op in ~200 ms.
+//   Ontvangen: ACK terug op elk ACK_REQ frame (ook duplicaten: de eerste
+//             ACK kan verloren zijn), duplicaten worden niet opnieuw
+//             uitgevoerd (bitmap van de laatste 32 volgnummers).
+//
+// Niet kritiek verkeer (STATUS_UPDATE, HEARTBEAT, PLAYBACK_STRESS, ACK,
+// PING/PONG, ...) gaat er alleen doorheen voor het volgnummer: geen ACK,
+// geen herhaling. Dat is een eigen reeks: de kritieke reeks loopt zonder
+// gaten en alleen kritieke frames schuiven het duplicaat venster op.
+//
+// Voorrang lane (ESPNOW_FLAG_PRIORITY: stop, nood pauze, vacuum los,
+// ORGASM_TRIGGER): espnowRel_send() stuurt direct ESPNOW_REL_PRIO_COPIES
+// kopieën (ontvanger filtert op seq), korte timeout, meer pogingen, wordt
+// nooit door gewoon verkeer uit het venster gedrukt en gaat in poll()
+// voor. Zolang er een voorrang frame open staat wachten gewone herhalingen
+// en laat de aanroeper bulk verkeer liggen (espnowRel_priorityOpen).
+// Slechtste leveringstijd staat in stats.prioMaxMs.
+// ===============================================================================
+
+#define ESPNOW_REL_WINDOW            8       // Max frames zonder ACK
+#define ESPNOW_REL_MAX_RETRIES       5       // 30+60+120+240+480 (+500) ms ≈ 1.4 s voor opgeven
+#define ESPNOW_REL_FAST_RETRIES      3       // Directe herhalingen na een MAC fout
+#define ESPNOW_REL_BASE_TIMEOUT_MS   30      // Eerste herhaling (ESP-NOW RTT ~2-5 ms)
+#define ESPNOW_REL_MAX_TIMEOUT_MS    500
+#define ESPNOW_REL_DUP_BITS          32
+#define ESPNOW_REL_REBOOT_MS         5000    // Peer klok sprong terug → peer herstart
+
+#define ESPNOW_REL_PRIO_COPIES       2       // Direct verstuurde kopieën
+#define ESPNOW_REL_PRIO_TIMEOUT_MS   10
+#define ESPNOW_REL_PRIO_MAX_TIMEOUT_MS 40
+#define ESPNOW_REL_PRIO_MAX_RETRIES  12      // ~400 ms voor opgeven
+
+struct EspNowRelStats {
+  uint32_t sent;          // Kritieke frames verstuurd (eerste poging)
+  uint32_t delivered;     // ACK ontvangen
+  uint32_t retried;       // Herhalingen
+  uint32_t dropped;       // Opgegeven (max retries of venster vol)
+  uint32_t duplicates;    // Ontvangen duplicaten (niet uitgevoerd)
+  uint32_t acksSent;
+
+  // Leveringstijd kritieke frames: eerste send → ACK (incl. herhalingen)
+  uint32_t deliverySumMs;
+  uint32_t deliveryMaxMs;
+
+  // Voorrang lane (deel van de tellers hierboven)
+  uint32_t prioSent;
+  uint32_t prioDelivered;
+  uint32_t prioDropped;
+  uint32_t prioMaxMs;     // Slechtste leveringstijd
+};
+
+struct EspNowPending {
+  bool     inUse;
+  bool     priority;      // ESPNOW_FLAG_PRIORITY
+  uint8_t  opcode;
+  uint8_t  len;
+  uint8_t  retries;
+  uint8_t  fastRetries;   // Na MAC fout (telt niet mee in retries)
+  bool     fastDue;       // Volgende poll: direct opnieuw
+  uint16_t seq;
+  uint32_t firstSentMs;   // Eerste poging (leveringstijd)
+  uint32_t sentMs;        // Laatste poging
+  uint32_t timeoutMs;     // Huidige timeout (verdubbelt)
+  uint8_t  frame[ESPNOW_MAX_FRAME];
+};
+
+struct EspNowReliable {
+  // Zender
+  uint16_t txSeq;                    // Kritieke frames (ACK_REQ)
+  uint16_t txSeqUnrel;               // Overige frames (eigen reeks)
+  EspNowPending pending[ESPNOW_REL_WINDOW];
+  int8_t   lastPending;              // Slot van laatst verstuurde kritieke frame
+  volatile bool sendFailed;          // Gezet door send callback (WiFi task)
+
+  // Ontvanger
+  bool     rxSynced;
+  uint16_t rxHighSeq;                // Hoogste ontvangen volgnummer
+  uint32_t rxSeenBits;               // bit i = rxHighSeq - i ontvangen
+  uint32_t rxLastTimeMs;             // hdr.timeMs van peer
+
+  EspNowRelStats stats;
+};
+
+typedef bool (*EspNowRelSendFn)(const uint8_t* frame, uint8_t len);
+
+static inline void espnowRel_reset(EspNowReliable& rel) {
+  memset(&rel, 0, sizeof(rel));
+  rel.lastPending = -1;
+}
+
+// ===== ZENDER =====
+
+// Volgnummer voor het volgende frame naar deze peer, reeks volgens opcode
+static inline uint16_t espnowRel_nextSeq(EspNowReliable& rel, uint8_t op) {
+  return espnow_needsAck(op) ? rel.txSeq++ : rel.txSeqUnrel++;
+}
+
+// Na espnow_encode(): kritieke frames bewaren voor herhaling
+static inline void espnowRel_track(EspNowReliable& rel, const uint8_t* frame, uint8_t len, uint32_t nowMs) {
+  const EspNowHeader* hdr = (const EspNowHeader*)frame;
+  if (!(hdr->flags & ESPNOW_FLAG_ACK_REQ)) return;
+
+  bool priority = hdr->flags & ESPNOW_FLAG_PRIORITY;
+  int slot = -1;
+  int oldest = -1;        // Oudste gewone frame (voorrang frames blijven staan)
+  int oldestPrio = 0;
+  for (int i = 0; i < ESPNOW_REL_WINDOW; i++) {
+    const EspNowPending& q = rel.pending[i];
+    if (!q.inUse) { slot = i; break; }
+    if (q.priority) {
+      if ((int16_t)(q.seq - rel.pending[oldestPrio].seq) < 0 || !rel.pending[oldestPrio].priority) oldestPrio = i;
+    } else if (oldest < 0 || (int16_t)(q.seq - rel.pending[oldest].seq) < 0) {
+      oldest = i;
+    }
+  }
+  if (slot < 0) {
+    // Venster vol: oudste gewone frame opgeven. Alleen voorrang frames open
+    // → een nieuw gewoon frame wacht niet, een nieuw voorrang frame wint
+    slot = (oldest >= 0) ? oldest : oldestPrio;
+    if (rel.pending[slot].priority) rel.stats.prioDropped++;
+    rel.stats.dropped++;
+  }
+
+  EspNowPending& p = rel.pending[slot];
+  p.inUse = true;
+  p.priority = priority;
+  p.opcode = hdr->opcode;
+  p.seq = hdr->seq;
+  p.len = len;
+  p.retries = 0;
+  p.fastRetries = 0;
+  p.fastDue = false;
+  p.firstSentMs = nowMs;
+  p.sentMs = nowMs;
+  p.timeoutMs = priority ? ESPNOW_REL_PRIO_TIMEOUT_MS : ESPNOW_REL_BASE_TIMEOUT_MS;
+  memcpy(p.frame, frame, len);
+  rel.lastPending = slot;
+  rel.stats.sent++;
+  if (priority) rel.stats.prioSent++;
+}
+
+// Versturen + bijhouden in één stap. Voorrang frames gaan direct
+// ESPNOW_REL_PRIO_COPIES keer de lucht in. true = eerste send geaccepteerd.
+static inline bool espnowRel_send(EspNowReliable& rel, const uint8_t* frame, uint8_t len,
+                                  uint32_t nowMs, EspNowRelSendFn send) {
+  const EspNowHeader* hdr = (const EspNowHeader*)frame;
+  bool ok = send(frame, len);
+  if (hdr->flags & ESPNOW_FLAG_PRIORITY) {
+    for (int i = 1; i < ESPNOW_REL_PRIO_COPIES; i++) send(frame, len);
+  }
+  espnowRel_track(rel, frame, len, nowMs);
+  return ok;
+}
+
+// Voorrang frame wacht nog op ACK → bulk verkeer (status, ping, ...) even laten liggen
+static inline bool espnowRel_priorityOpen(const EspNowReliable& rel) {
+  for (int i = 0; i < ESPNOW_REL_WINDOW; i++) {
+    if (rel.pending[i].inUse && rel.pending[i].priority) return true;
+  }
+  return false;
+}
+
+// Vanuit send callback (WiFi task): alleen een vlag zetten
+static inline void espnowRel_onSendStatus(EspNowReliable& rel, bool success) {
+  if (!success) rel.sendFailed = true;
+}
+
+// ACK van peer ontvangen - true als er een frame mee bevestigd werd
+static inline bool espnowRel_onAck(EspNowReliable& rel, uint16_t ackSeq, uint32_t nowMs) {
+  for (int i = 0; i < ESPNOW_REL_WINDOW; i++) {
+    EspNowPending& p = rel.pending[i];
+    if (p.inUse && p.seq == ackSeq) {
+      p.inUse = false;
+      rel.stats.delivered++;
+      uint32_t deliveryMs = nowMs - p.firstSentMs;
+      rel.stats.deliverySumMs += deliveryMs;
+      if (deliveryMs > rel.stats.deliveryMaxMs) rel.stats.deliveryMaxMs = deliveryMs;
+      if (p.priority) {
+        rel.stats.prioDelivered++;
+        if (deliveryMs > rel.stats.prioMaxMs) rel.stats.prioMaxMs = deliveryMs;
+      }
+      return true;
+    }
+  }
+  return false;   // Al bevestigd of al opgegeven
+}
+
+// Elke loop(): herhalen wat verlopen is. Geeft het aantal frames terug dat
+// in deze aanroep definitief is opgegeven.
+static inline uint8_t espnowRel_poll(EspNowReliable& rel, uint32_t nowMs, EspNowRelSendFn send) {
+  // MAC laag meldde verlies → laatste kritieke frame niet op timeout laten wachten
+  if (rel.sendFailed) {
+    rel.sendFailed = false;
+    if (rel.lastPending >= 0) {
+      EspNowPending& p = rel.pending[rel.lastPending];
+      if (p.inUse && p.fastRetries < ESPNOW_REL_FAST_RETRIES) p.fastDue = true;
+    }
+  }
+
+  // Eerst de voorrang lane; zolang daar iets open staat wachten gewone herhalingen
+  uint8_t givenUp = 0;
+  bool prioOpen = false;
+  for (int pass = 0; pass < 2; pass++) {
+    bool prioPass = (pass == 0);
+    if (!prioPass && prioOpen) break;
+    for (int i = 0; i < ESPNOW_REL_WINDOW; i++) {
+      EspNowPending& p = rel.pending[i];
+      if (!p.inUse || p.priority != prioPass) continue;
+      if (prioPass) prioOpen = true;
+      if (p.fastDue) {
+        // Directe herhaling: timeout en pogingen blijven staan
+        p.fastDue = false;
+        p.fastRetries++;
+        p.sentMs = nowMs;
+        rel.stats.retried++;
+        rel.lastPending = i;
+        send(p.frame, p.len);
+        continue;
+      }
+      if (nowMs - p.sentMs < p.timeoutMs) continue;
+
+      if (p.retries >= (p.priority ? ESPNOW_REL_PRIO_MAX_RETRIES : ESPNOW_REL_MAX_RETRIES)) {
+        p.inUse = false;
+        rel.stats.dropped++;
+        if (p.priority) rel.stats.prioDropped++;
+        givenUp++;
+        continue;
+      }
+
+      uint32_t maxTimeout = p.priority ? ESPNOW_REL_PRIO_MAX_TIMEOUT_MS : ESPNOW_REL_MAX_TIMEOUT_MS;
+      p.retries++;
+      p.sentMs = nowMs;
+      p.timeoutMs = (p.timeoutMs * 2 > maxTimeout) ? maxTimeout : p.timeoutMs * 2;
+      rel.stats.retried++;
+      rel.lastPending = i;
+      send(p.frame, p.len);   // Mislukt → volgende timeout probeert opnieuw
+    }
+  }
+  return givenUp;
+}
+
+// Gemiddelde leveringstijd (ms) sinds reset, 0 = nog niets bevestigd
+static inline float espnowRel_avgDeliveryMs(const EspNowReliable& rel) {
+  return rel.stats.delivered ? (float)rel.stats.deliverySumMs / rel.stats.delivered : 0.0f;
+}
+
+static inline uint8_t espnowRel_outstanding(const EspNowReliable& rel) {
+  uint8_t n = 0;
+  for (int i = 0; i < ESPNOW_REL_WINDOW; i++) {
+    if (rel.pending[i].inUse) n++;
+  }
+  return n;
+}
+
+// ===== ONTVANGER =====
+
+// Voor elk geldig frame van deze peer (behalve ACK zelf). true = duplicaat,
+// niet uitvoeren. Moet er een ACK terug: zie espnowRel_buildAck().
+static inline bool espnowRel_onReceive(EspNowReliable& rel, const EspNowHeader& hdr) {
+  // Peer herstart (klok terug) → volgnummers beginnen opnieuw
+  if (rel.rxSynced && hdr.timeMs + ESPNOW_REL_REBOOT_MS < rel.rxLastTimeMs) {
+    rel.rxSynced = false;
+  }
+  // Niet kritiek: andere reeks, wordt niet herhaald → geen duplicaat
+  if (!(hdr.flags & ESPNOW_FLAG_ACK_REQ)) {
+    if (rel.rxSynced && (int32_t)(hdr.timeMs - rel.rxLastTimeMs) > 0) rel.rxLastTimeMs = hdr.timeMs;
+    return false;
+  }
+  if (!rel.rxSynced) {
+    rel.rxSynced = true;
+    rel.rxHighSeq = hdr.seq;
+    rel.rxSeenBits = 1;
+    rel.rxLastTimeMs = hdr.timeMs;
+    return false;
+  }
+  if ((int32_t)(hdr.timeMs - rel.rxLastTimeMs) > 0) rel.rxLastTimeMs = hdr.timeMs;
+
+  int16_t diff = (int16_t)(hdr.seq - rel.rxHighSeq);
+  if (diff > 0) {
+    // Nieuwer: venster opschuiven
+    rel.rxSeenBits = (diff >= ESPNOW_REL_DUP_BITS) ? 0 : (rel.rxSeenBits << diff);
+    rel.rxSeenBits |= 1;
+    rel.rxHighSeq = hdr.seq;
+    return false;
+  }
+
+  uint16_t back = (uint16_t)(-diff);
+  if (back >= ESPNOW_REL_DUP_BITS) {
+    // Ouder dan het venster: alleen een herhaling kan zo laat zijn
+    rel.stats.duplicates++;
+    return true;
+  }
+
+  uint32_t bit = 1UL << back;
+  if (rel.rxSeenBits & bit) {
+    rel.stats.duplicates++;
+    return true;
+  }
+  rel.rxSeenBits |= bit;   // Te laat maar nieuw (volgorde omgedraaid)
+  return false;
+}
+
+// ACK frame voor een ontvangen ACK_REQ frame, geeft lengte terug (0 = geen ACK nodig)
+static inline uint8_t espnowRel_buildAck(EspNowReliable& rel, const EspNowHeader& hdr,
+                                         uint32_t nowMs, uint8_t out[ESPNOW_MAX_FRAME],
+                                         uint8_t extraFlags = 0) {
+  if (!(hdr.flags & ESPNOW_FLAG_ACK_REQ)) return 0;
+
+  EspNowFrame ack;
+  memset(&ack, 0, sizeof(ack));
+  ack.ack.ackSeq = hdr.seq;
+  ack.ack.ackOpcode = hdr.opcode;
+  rel.stats.acksSent++;
+  return espnow_encode(ack, ESPNOW_OP_ACK, espnowRel_nextSeq(rel, ESPNOW_OP_ACK), nowMs, false, out, extraFlags);
+}
@@ -0,0 +1,153 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+// ===============================================================================
+// ESP-NOW TIJD SYNC - Sessie klok over PING/PONG (NTP stijl, 4 tijdstempels)
+// ===============================================================================
+// IDENTIEKE KOPIE in:
+//   Body_ESP_FINAL/Body_ESP/espnow_timesync.h
+//   Hooft_ESP/Hooft_ESP_KEON/espnow_timesync.h
+//
+// Elke node heeft zijn eigen millis(). De HoofdESP is de sessie klok
+// (master): zijn esp_timer_get_time() / millis(). De Body ESP rekent zijn
+// eigen klok om met de PONG van elke link PING (espnow_link.h):
+//
+//   t1 = PING weg (lokaal)      t2 = PING binnen (master)
+//   t3 = PONG weg (master)      t4 = PONG binnen (lokaal)
+//
+//   offset = ((t2 - t1) + (t3 - t4)) / 2      master - lokaal
+//   delay  = (t4 - t1) - (t3 - t2)            radio tijd heen + terug
+//
+// Asymmetrie tussen heen en terug valt binnen delay/2: dat is de fout
+// grens. Een trage sample (WiFi retry, volle queue) is dus een slechte
+// sample → van de laatste ESPNOW_SYNC_FILTER samples telt die met de
+// kleinste delay (NTP clock filter). Kristal drift (tientallen ppm) wordt
+// uit opeenvolgende offsets geschat zodat de klok ook tussen samples en
+// bij verloren PONGs klopt.
+// ===============================================================================
+
+#define ESPNOW_SYNC_FILTER          8         // Samples voor min-delay keuze
+#define ESPNOW_SYNC_MAX_DELAY_US    20000     // Trager = sample weggooien
+#define ESPNOW_SYNC_STEP_US         50000     // Offset sprong = master herstart → opnieuw
+#define ESPNOW_SYNC_DRIFT_MIN_US    10000000  // Min 10 s tussen drift metingen
+#define ESPNOW_SYNC_DRIFT_ALPHA     0.3f
+#define ESPNOW_SYNC_DRIFT_MAX_PPM   200.0f
+#define ESPNOW_SYNC_DRIFT_ERR_PPM   20.0f     // Onzekerheid drift schatting (fout grens)
+#define ESPNOW_SYNC_STALE_US        30000000  // 30 s zonder sample = niet meer sync
+
+struct EspNowSyncSample {
+  int64_t  localUs;       // t4
+  int64_t  offsetUs;
+  uint32_t delayUs;
+};
+
+struct EspNowClockSync {
+  EspNowSyncSample samples[ESPNOW_SYNC_FILTER];
+  uint8_t  count;
+  uint8_t  next;
+
+  bool     synced;
+  int64_t  offsetUs;      // master - lokaal op refLocalUs
+  int64_t  refLocalUs;
+  uint32_t delayUs;       // delay van de gekozen sample
+  float    driftPpm;      // master loopt zoveel ppm sneller dan lokaal
+
+  int64_t  anchorLocalUs; // Vorige drift meting
+  int64_t  anchorOffsetUs;
+  int64_t  lastSampleUs;
+
+  uint32_t accepted;
+  uint32_t rejected;      // delay te groot / negatief
+  uint32_t steps;         // Opnieuw gesynchroniseerd (master herstart)
+};
+
+static inline void espnowSync_reset(EspNowClockSync& sync) {
+  memset(&sync, 0, sizeof(sync));
+}
+
+// 32 bit micros() (bv. EspNowRxItem.rxUs) naar 64 bit esp_timer tijd,
+// geldig zolang de stempel minder dan ~71 minuten oud is
+static inline int64_t espnowSync_extendUs(uint32_t us32, int64_t nowUs) {
+  return nowUs - (uint32_t)((uint32_t)nowUs - us32);
+}
+
+// Master tijd (µs) voor een lokale tijd, alleen geldig als synced
+static inline int64_t espnowSync_toMasterUs(const EspNowClockSync& sync, int64_t localUs) {
+  int64_t since = localUs - sync.refLocalUs;
+  return localUs + sync.offsetUs + (int64_t)(since * (sync.driftPpm / 1e6f));
+}
+
+static inline int64_t espnowSync_toLocalUs(const EspNowClockSync& sync, int64_t masterUs) {
+  int64_t localUs = masterUs - sync.offsetUs;
+  return masterUs - (espnowSync_toMasterUs(sync, localUs) - localUs);
+}
+
+// Fout grens (µs): halve delay van de gekozen sample + drift onzekerheid sindsdien
+static inline uint32_t espnowSync_errorUs(const EspNowClockSync& sync, int64_t localUs) {
+  int64_t since = localUs - sync.refLocalUs;
+  if (since < 0) since = -since;
+  return sync.delayUs / 2 + (uint32_t)(since * (ESPNOW_SYNC_DRIFT_ERR_PPM / 1e6f));
+}
+
+static inline bool espnowSync_isSynced(const EspNowClockSync& sync, int64_t localUs) {
+  return sync.synced && localUs - sync.lastSampleUs < ESPNOW_SYNC_STALE_US;
+}
+
+// PONG ontvangen: t1/t4 lokaal, t2/t3 master. true = sample gebruikt
+static inline bool espnowSync_onSample(EspNowClockSync& sync, int64_t t1, int64_t t2, int64_t t3, int64_t t4) {
+  int64_t delay = (t4 - t1) - (t3 - t2);
+  if (delay < 0 || delay > ESPNOW_SYNC_MAX_DELAY_US || t2 == 0 || t3 < t2) {
+    sync.rejected++;
+    return false;
+  }
+  int64_t offset = ((t2 - t1) + (t3 - t4)) / 2;
+
+  // Master herstart (of eerste sample na lange stilte): filter leeg beginnen
+  if (sync.synced) {
+    int64_t predicted = espnowSync_toMasterUs(sync, t4) - t4;
+    int64_t jump = offset - predicted;
+    if (jump > ESPNOW_SYNC_STEP_US || jump < -ESPNOW_SYNC_STEP_US) {
+      sync.count = 0;
+      sync.next = 0;
+      sync.driftPpm = 0.0f;
+      sync.anchorLocalUs = 0;
+      sync.steps++;
+    }
+  }
+
+  EspNowSyncSample& s = sync.samples[sync.next];
+  s.localUs = t4;
+  s.offsetUs = offset;
+  s.delayUs = (uint32_t)delay;
+  sync.next = (sync.next + 1) % ESPNOW_SYNC_FILTER;
+  if (sync.count < ESPNOW_SYNC_FILTER) sync.count++;
+  sync.accepted++;
+  sync.lastSampleUs = t4;
+
+  // Clock filter: sample met de kleinste delay
+  const EspNowSyncSample* best = &sync.samples[0];
+  for (uint8_t i = 1; i < sync.count; i++) {
+    if (sync.samples[i].delayUs < best->delayUs) best = &sync.samples[i];
+  }
+
+  // Drift uit twee filter uitkomsten die ver genoeg uit elkaar liggen
+  if (sync.anchorLocalUs == 0) {
+    sync.anchorLocalUs = best->localUs;
+    sync.anchorOffsetUs = best->offsetUs;
+  } else if (best->localUs - sync.anchorLocalUs >= ESPNOW_SYNC_DRIFT_MIN_US) {
+    float ppm = (float)(best->offsetUs - sync.anchorOffsetUs) * 1e6f /
+                (float)(best->localUs - sync.anchorLocalUs);
+    if (ppm > ESPNOW_SYNC_DRIFT_MAX_PPM) ppm = ESPNOW_SYNC_DRIFT_MAX_PPM;
+    if (ppm < -ESPNOW_SYNC_DRIFT_MAX_PPM) ppm = -ESPNOW_SYNC_DRIFT_MAX_PPM;
+    sync.driftPpm += ESPNOW_SYNC_DRIFT_ALPHA * (ppm - sync.driftPpm);
+    sync.anchorLocalUs = best->localUs;
+    sync.anchorOffsetUs = best->offsetUs;
+  }
+
+  sync.offsetUs = best->offsetUs;
+  sync.refLocalUs = best->localUs;
+  sync.delayUs = best->delayUs;
+  sync.synced = true;
+  return true;
+}
@@ -11,6 +11,63 @@
 // Global instance
 MLAnnotationManager mlAnnotations;
 
+// Zelfde timestamp (upsert bij journal replay)
+#define ML_ANN_SAME_TIME   0.005f
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         RECORD FORMAAT (.ann en .anj)
+// ═══════════════════════════════════════════════════════════════════════════
+
+// timestamp,line,hr,temp,gsr,ai_level,user_level,is_edge,is_orgasm,note,time,was_correction
+static void writeRecord(File& f, const StressAnnotation& ann) {
+  f.printf("%.2f,%lu,%.1f,%.2f,%.0f,%d,%d,%d,%d,%s,%lu,%d\n",
+           ann.timestamp,
+           ann.lineNumber,
+           ann.heartRate,
+           ann.temperature,
+           ann.gsr,
+           ann.aiPredictedLevel,
+           ann.userAnnotatedLevel,
+           ann.isEdgeMoment ? 1 : 0,
+           ann.isOrgasmMoment ? 1 : 0,
+           ann.note,
+           ann.annotationTime,
+           ann.wasCorrection ? 1 : 0);
+}
+
+static bool parseRecord(const String& line, int start, StressAnnotation& ann) {
+  memset(&ann, 0, sizeof(ann));
+  
+  int fieldNum = 0;
+  int lastComma = start - 1;
+  
+  for (int i = start; i <= line.length(); i++) {
+    if (i == line.length() || line.charAt(i) == ',') {
+      String field = line.substring(lastComma + 1, i);
+      
+      switch (fieldNum) {
+        case 0: ann.timestamp = field.toFloat(); break;
+        case 1: ann.lineNumber = field.toInt(); break;
+        case 2: ann.heartRate = field.toFloat(); break;
+        case 3: ann.temperature = field.toFloat(); break;
+        case 4: ann.gsr = field.toFloat(); break;
+        case 5: ann.aiPredictedLevel = field.toInt(); break;
+        case 6: ann.userAnnotatedLevel = field.toInt(); break;
+        case 7: ann.isEdgeMoment = (field.toInt() == 1); break;
+        case 8: ann.isOrgasmMoment = (field.toInt() == 1); break;
+        case 9: strncpy(ann.note, field.c_str(), 31); break;
+        case 10: ann.annotationTime = field.toInt(); break;
+        case 11: ann.wasCorrection = (field.toInt() == 1); break;
+      }
+      
+      lastComma = i;
+      fieldNum++;
+    }
+  }
+  
+  return fieldNum >= 7;  // Minimaal t/m user_level
+}
+
 // ═══════════════════════════════════════════════════════════════════════════
 //                         CONSTRUCTOR
 // ═══════════════════════════════════════════════════════════════════════════
@@ -19,9 +76,11 @@ MLAnnotationManager::MLAnnotationManager() {
   fileOpen = false;
   currentFilename = "";
   annotationFilename = "";
+  journalFilename = "";
   annotations = nullptr;
   annotationCount = 0;
   annotationCapacity = 0;
+  journalEntries = 0;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
@@ -46,6 +105,9 @@ bool MLAnnotationManager::openFile(const String& csvFilename) {
     annotationFilename = "/recordings/" + annotationFilename;
   }
   
+  journalFilename = annotationFilename;
+  journalFilename.replace(ML_ANNOTATION_EXT, ML_JOURNAL_EXT);
+  
   Serial.printf("[ML ANN] Opening annotation file: %s\n", annotationFilename.c_str());
   
   // Alloceer buffer
@@ -58,6 +120,7 @@ bool MLAnnotationManager::openFile(const String& csvFilename) {
     }
   }
   annotationCount = 0;
+  journalEntries = 0;
   
   // Laad bestaande annotaties indien aanwezig
   if (SD_MMC.exists(annotationFilename.c_str())) {
@@ -67,6 +130,13 @@ bool MLAnnotationManager::openFile(const String& csvFilename) {
     Serial.println("[ML ANN] No existing annotations, starting fresh");
   }
   
+  // Wijzigingen die nog niet in .ann staan (bijv. na stroomuitval)
+  if (SD_MMC.exists(journalFilename.c_str())) {
+    replayJournal();
+    Serial.printf("[ML ANN] Journal replayed: %d entries, %d annotations\n",
+                  journalEntries, annotationCount);
+  }
+  
   fileOpen = true;
   return true;
 }
@@ -74,8 +144,8 @@ bool MLAnnotationManager::openFile(const String& csvFilename) {
 void MLAnnotationManager::closeFile() {
   if (!fileOpen) return;
   
-  // Sla annotaties op
-  if (annotationCount > 0) {
+  // Journal samenvoegen in .ann
+  if (annotationCount > 0 || journalEntries > 0) {
     saveAnnotations();
     Serial.printf("[ML ANN] Saved %d annotations to %s\n", 
                   annotationCount, annotationFilename.c_str());
@@ -84,6 +154,7 @@ void MLAnnotationManager::closeFile() {
   fileOpen = false;
   currentFilename = "";
   annotationFilename = "";
+  journalFilename = "";
 }
 
 bool MLAnnotationManager::loadAnnotations() {
@@ -95,43 +166,44 @@ bool MLAnnotationManager::loadAnnotations() {
   
   annotationCount = 0;
   
-  while (f.available() && annotationCount < annotationCapacity) {
+  while (f.available()) {
     String line = f.readStringUntil('\n');
     line.trim();
     if (line.length() < 5) continue;
     
-    StressAnnotation& ann = annotations[annotationCount];
-    memset(&ann, 0, sizeof(ann));
+    StressAnnotation ann;
+    if (!parseRecord(line, 0, ann)) continue;
     
-    // Parse CSV: timestamp,line,hr,temp,gsr,ai_level,user_level,is_edge,is_orgasm,note,time,was_correction
-    int fieldNum = 0;
-    int lastComma = -1;
+    // Oude bestanden zijn niet gegarandeerd gesorteerd
+    if (insertSorted(ann) < 0) break;
+  }
+  
+  f.close();
+  return true;
+}
+
+bool MLAnnotationManager::replayJournal() {
+  File f = SD_MMC.open(journalFilename.c_str(), FILE_READ);
+  if (!f) return false;
+  
+  while (f.available()) {
+    String line = f.readStringUntil('\n');
+    line.trim();
+    if (line.length() < 3 || line.charAt(1) != ',') continue;
     
-    for (int i = 0; i <= line.length(); i++) {
-      if (i == line.length() || line.charAt(i) == ',') {
-        String field = line.substring(lastComma + 1, i);
-        
-        switch (fieldNum) {
-          case 0: ann.timestamp = field.toFloat(); break;
-          case 1: ann.lineNumber = field.toInt(); break;
-          case 2: ann.heartRate = field.toFloat(); break;
-          case 3: ann.temperature = field.toFloat(); break;
-          case 4: ann.gsr = field.toFloat(); break;
-          case 5: ann.aiPredictedLevel = field.toInt(); break;
-          case 6: ann.userAnnotatedLevel = field.toInt(); break;
-          case 7: ann.isEdgeMoment = (field.toInt() == 1); break;
-          case 8: ann.isOrgasmMoment = (field.toInt() == 1); break;
-          case 9: strncpy(ann.note, field.c_str(), 31); break;
-          case 10: ann.annotationTime = field.toInt(); break;
-          case 11: ann.wasCorrection = (field.toInt() == 1); break;
-        }
-        
-        lastComma = i;
-        fieldNum++;
-      }
-    }
+    StressAnnotation ann;
+    if (!parseRecord(line, 2, ann)) continue;  // Half geschreven regel
+    
+    int idx = findAnnotationIndex(ann.timestamp, ML_ANN_SAME_TIME);
+    char op = line.charAt(0);
     
-    annotationCount++;
+    if (op == 'A') {
+      if (idx >= 0) annotations[idx] = ann;
+      else insertSorted(ann);
+    } else if (op == 'D' && idx >= 0) {
+      removeAt(idx);
+    }
+    journalEntries++;
   }
   
   f.close();
@@ -139,7 +211,9 @@ bool MLAnnotationManager::loadAnnotations() {
 }
 
 bool MLAnnotationManager::saveAnnotations() {
-  File f = SD_MMC.open(annotationFilename.c_str(), FILE_WRITE);
+  // Eerst .tmp, dan pas oude .ann vervangen
+  String tmpPath = annotationFilename + ".tmp";
+  File f = SD_MMC.open(tmpPath.c_str(), FILE_WRITE);
   if (!f) {
     Serial.println("[ML ANN] ERROR: Could not save annotations!");
     return false;
@@ -148,28 +222,124 @@ bool MLAnnotationManager::saveAnnotations() {
   // Header
   f.println("Timestamp,Line,HR,Temp,GSR,AI_Level,User_Level,Is_Edge,Is_Orgasm,Note,Ann_Time,Was_Correction");
   
-  // Data
+  // Data (gesorteerd op timestamp)
   for (int i = 0; i < annotationCount; i++) {
-    StressAnnotation& ann = annotations[i];
-    f.printf("%.2f,%lu,%.1f,%.2f,%.0f,%d,%d,%d,%d,%s,%lu,%d\n",
-             ann.timestamp,
-             ann.lineNumber,
-             ann.heartRate,
-             ann.temperature,
-             ann.gsr,
-             ann.aiPredictedLevel,
-             ann.userAnnotatedLevel,
-             ann.isEdgeMoment ? 1 : 0,
-             ann.isOrgasmMoment ? 1 : 0,
-             ann.note,
-             ann.annotationTime,
-             ann.wasCorrection ? 1 : 0);
+    writeRecord(f, annotations[i]);
+  }
+  
+  f.close();
+  
+  if (SD_MMC.exists(annotationFilename.c_str())) {
+    SD_MMC.remove(annotationFilename.c_str());
+  }
+  if (!SD_MMC.rename(tmpPath.c_str(), annotationFilename.c_str())) {
+    Serial.println("[ML ANN] ERROR: Rename .tmp failed - journal blijft staan");
+    return false;
   }
   
+  // Alles staat nu in .ann
+  SD_MMC.remove(journalFilename.c_str());
+  journalEntries = 0;
+  return true;
+}
+
+bool MLAnnotationManager::appendJournal(char op, const StressAnnotation& ann) {
+  File f = SD_MMC.open(journalFilename.c_str(), FILE_APPEND);
+  if (!f) {
+    Serial.println("[ML ANN] ERROR: Could not append journal!");
+    return false;
+  }
+  
+  f.printf("%c,", op);
+  writeRecord(f, ann);
   f.close();
+  journalEntries++;
+  
+  // Journal begrenzen zodat openen snel blijft
+  if (journalEntries >= ML_JOURNAL_COMPACT_AT) {
+    saveAnnotations();
+  }
   return true;
 }
 
+// ═══════════════════════════════════════════════════════════════════════════
+//                         GESORTEERDE INDEX
+// ═══════════════════════════════════════════════════════════════════════════
+
+bool MLAnnotationManager::ensureCapacity() {
+  if (annotationCount < annotationCapacity) return true;
+  
+  // Probeer te groeien
+  int newCapacity = annotationCapacity * 2;
+  if (newCapacity > ML_MAX_ANNOTATIONS) newCapacity = ML_MAX_ANNOTATIONS;
+  
+  if (annotationCount >= newCapacity) {
+    Serial.println("[ML ANN] ERROR: Max annotations reached!");
+    return false;
+  }
+  
+  StressAnnotation* newBuffer = (StressAnnotation*)realloc(annotations,
+                                  sizeof(StressAnnotation) * newCapacity);
+  if (!newBuffer) {
+    Serial.println("[ML ANN] ERROR: Could not grow buffer!");
+    return false;
+  }
+  
+  annotations = newBuffer;
+  annotationCapacity = newCapacity;
+  return true;
+}
+
+int MLAnnotationManager::lowerBound(float timestamp) {
+  int lo = 0;
+  int hi = annotationCount;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (annotations[mid].timestamp < timestamp) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+int MLAnnotationManager::insertSorted(const StressAnnotation& ann) {
+  if (!ensureCapacity()) return -1;
+  
+  int idx = lowerBound(ann.timestamp);
+  if (idx < annotationCount) {
+    memmove(&annotations[idx + 1], &annotations[idx],
+            (annotationCount - idx) * sizeof(StressAnnotation));
+  }
+  annotations[idx] = ann;
+  annotationCount++;
+  return idx;
+}
+
+void MLAnnotationManager::removeAt(int idx) {
+  if (idx < 0 || idx >= annotationCount) return;
+  if (idx < annotationCount - 1) {
+    memmove(&annotations[idx], &annotations[idx + 1],
+            (annotationCount - idx - 1) * sizeof(StressAnnotation));
+  }
+  annotationCount--;
+}
+
+// Dichtstbijzijnde annotatie binnen tolerance (2 kandidaten rond lowerBound)
+int MLAnnotationManager::findAnnotationIndex(float timestamp, float tolerance) {
+  int idx = lowerBound(timestamp);
+  int best = -1;
+  float bestDist = tolerance;
+  
+  if (idx < annotationCount) {
+    float d = fabsf(annotations[idx].timestamp - timestamp);
+    if (d <= bestDist) { best = idx; bestDist = d; }
+  }
+  if (idx > 0) {
+    float d = fabsf(annotations[idx - 1].timestamp - timestamp);
+    if (d <= bestDist) { best = idx - 1; }
+  }
+  return best;
+}
+
 // ═══════════════════════════════════════════════════════════════════════════
 //                         ANNOTATIES TOEVOEGEN
 // ═══════════════════════════════════════════════════════════════════════════
@@ -190,33 +360,12 @@ bool MLAnnotationManager::addAnnotation(float timestamp, int userLevel,
     annotations[existingIdx].userAnnotatedLevel = userLevel;
     annotations[existingIdx].wasCorrection = true;
     annotations[existingIdx].annotationTime = millis() / 1000;  // Simpele timestamp
+    appendJournal('A', annotations[existingIdx]);
     return true;
   }
   
-  // Check capacity
-  if (annotationCount >= annotationCapacity) {
-    // Probeer te groeien
-    int newCapacity = annotationCapacity * 2;
-    if (newCapacity > ML_MAX_ANNOTATIONS) newCapacity = ML_MAX_ANNOTATIONS;
-    
-    if (annotationCount >= newCapacity) {
-      Serial.println("[ML ANN] ERROR: Max annotations reached!");
-      return false;
-    }
-    
-    StressAnnotation* newBuffer = (StressAnnotation*)realloc(annotations,
-                                    sizeof(StressAnnotation) * newCapacity);
-    if (newBuffer) {
-      annotations = newBuffer;
-      annotationCapacity = newCapacity;
-    } else {
-      Serial.println("[ML ANN] ERROR: Could not grow buffer!");
-      return false;
-    }
-  }
-  
-  // Voeg nieuwe annotatie toe
-  StressAnnotation& ann = annotations[annotationCount];
+  // Nieuwe annotatie
+  StressAnnotation ann;
   memset(&ann, 0, sizeof(ann));
   
   ann.timestamp = timestamp;
@@ -231,15 +380,15 @@ bool MLAnnotationManager::addAnnotation(float timestamp, int userLevel,
   ann.annotationTime = millis() / 1000;
   ann.wasCorrection = false;
   
-  annotationCount++;
+  if (insertSorted(ann) < 0) {
+    return false;
+  }
   
   Serial.printf("[ML ANN] Added annotation #%d at %.2fs: User=%d (AI=%d)\n",
                 annotationCount, timestamp, userLevel, aiLevel);
   
-  // Auto-save elke 10 annotaties
-  if (annotationCount % 10 == 0) {
-    saveAnnotations();
-  }
+  // Direct vastleggen (1 regel append, geen volledige rewrite)
+  appendJournal('A', ann);
   
   return true;
 }
@@ -251,28 +400,32 @@ bool MLAnnotationManager::addAnnotationAtLine(uint32_t lineNumber, int userLevel
   float timestamp = lineNumber / 10.0f;  // Aanname: 10 samples/sec
   
   // Voeg toe met berekende timestamp
-  bool result = addAnnotation(timestamp, userLevel, hr, temp, gsr, aiLevel);
+  if (!addAnnotation(timestamp, userLevel, hr, temp, gsr, aiLevel)) {
+    return false;
+  }
   
-  // Update line number in laatste annotatie
-  if (result && annotationCount > 0) {
-    annotations[annotationCount - 1].lineNumber = lineNumber;
+  // Update line number (index kan verschoven zijn door sortering)
+  int idx = findAnnotationIndex(timestamp, ML_ANN_SAME_TIME);
+  if (idx >= 0 && annotations[idx].lineNumber != lineNumber) {
+    annotations[idx].lineNumber = lineNumber;
+    appendJournal('A', annotations[idx]);
   }
   
-  return result;
+  return true;
 }
 
 bool MLAnnotationManager::markAsEdge(float timestamp) {
   int idx = findAnnotationIndex(timestamp);
   if (idx >= 0) {
     annotations[idx].isEdgeMoment = true;
+    appendJournal('A', annotations[idx]);
     Serial.printf("[ML ANN] Marked %.2fs as EDGE moment\n", timestamp);
     return true;
   }
   
   // Maak nieuwe annotatie alleen met edge marker
   if (addAnnotation(timestamp, -1, 0, 0, 0, -1)) {
-    annotations[annotationCount - 1].isEdgeMoment = true;
-    return true;
+    return markAsEdge(timestamp);
   }
   
   return false;
@@ -282,14 +435,14 @@ bool MLAnnotationManager::markAsOrgasm(float timestamp) {
   int idx = findAnnotationIndex(timestamp);
   if (idx >= 0) {
     annotations[idx].isOrgasmMoment = true;
+    appendJournal('A', annotations[idx]);
     Serial.printf("[ML ANN] Marked %.2fs as ORGASM moment\n", timestamp);
     return true;
   }
   
   // Maak nieuwe annotatie alleen met orgasm marker
   if (addAnnotation(timestamp, 7, 0, 0, 0, -1)) {  // Level 7 = edge zone/orgasm
-    annotations[annotationCount - 1].isOrgasmMoment = true;
-    return true;
+    return markAsOrgasm(timestamp);
   }
   
   return false;
@@ -300,6 +453,7 @@ bool MLAnnotationManager::addNote(float timestamp, const char* note) {
   if (idx >= 0) {
     strncpy(annotations[idx].note, note, 31);
     annotations[idx].note[31] = '\0';
+    appendJournal('A', annotations[idx]);
     return true;
   }
   return false;
@@ -309,15 +463,6 @@ bool MLAnnotationManager::addNote(float timestamp, const char* note) {
 //                         ANNOTATIES OPHALEN
 // ═══════════════════════════════════════════════════════════════════════════
 
-int MLAnnotationManager::findAnnotationIndex(float timestamp, float tolerance) {
-  for (int i = 0; i < annotationCount; i++) {
-    if (abs(annotations[i].timestamp - timestamp) <= tolerance) {
-      return i;
-    }
-  }
-  return -1;
-}
-
 bool MLAnnotationManager::getAnnotationAtTime(float timestamp, StressAnnotation& out) {
   int idx = findAnnotationIndex(timestamp);
   if (idx >= 0) {
@@ -328,11 +473,18 @@ bool MLAnnotationManager::getAnnotationAtTime(float timestamp, StressAnnotation&
 }
 
 bool MLAnnotationManager::getAnnotationAtLine(uint32_t lineNumber, StressAnnotation& out) {
-  for (int i = 0; i < annotationCount; i++) {
-    if (annotations[i].lineNumber == lineNumber) {
-      out = annotations[i];
-      return true;
-    }
+  // lineNumber loopt mee met timestamp → zelfde sortering, binary search
+  int lo = 0;
+  int hi = annotationCount;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (annotations[mid].lineNumber < lineNumber) lo = mid + 1;
+    else hi = mid;
+  }
+  
+  if (lo < annotationCount && annotations[lo].lineNumber == lineNumber) {
+    out = annotations[lo];
+    return true;
   }
   return false;
 }
@@ -347,6 +499,7 @@ bool MLAnnotationManager::updateAnnotation(float timestamp, int newUserLevel) {
     annotations[idx].userAnnotatedLevel = newUserLevel;
     annotations[idx].wasCorrection = true;
     annotations[idx].annotationTime = millis() / 1000;
+    appendJournal('A', annotations[idx]);
     
     Serial.printf("[ML ANN] Updated annotation at %.2fs: new level = %d\n", 
                   timestamp, newUserLevel);
@@ -358,11 +511,9 @@ bool MLAnnotationManager::updateAnnotation(float timestamp, int newUserLevel) {
 bool MLAnnotationManager::deleteAnnotation(float timestamp) {
   int idx = findAnnotationIndex(timestamp);
   if (idx >= 0) {
-    // Shift all annotations after this one
-    for (int i = idx; i < annotationCount - 1; i++) {
-      annotations[i] = annotations[i + 1];
-    }
-    annotationCount--;
+    StressAnnotation removed = annotations[idx];
+    removeAt(idx);
+    appendJournal('D', removed);
     
     Serial.printf("[ML ANN] Deleted annotation at %.2fs\n", timestamp);
     return true;
@@ -438,6 +589,8 @@ bool MLAnnotationManager::exportForTraining(const String& outputFilename) {
   return true;
 }
 
+// Streaming merge: .anl regel voor regel naar .tmp, annotaties (gesorteerd)
+// lopen mee met een tweede pointer. Geheugen is constant, ongeacht lengte.
 bool MLAnnotationManager::mergeWithANL(const String& anlFilename) {
   if (annotationCount == 0) {
     Serial.println("[ML ANN] No annotations to merge!");
@@ -451,71 +604,69 @@ bool MLAnnotationManager::mergeWithANL(const String& anlFilename) {
     return false;
   }
   
-  // Lees hele ANL bestand
-  File f = SD_MMC.open(anlPath.c_str(), FILE_READ);
-  if (!f) return false;
-  
-  // Lees header
-  String header = f.readStringUntil('\n');
+  File in = SD_MMC.open(anlPath.c_str(), FILE_READ);
+  if (!in) return false;
   
-  // Lees alle regels in geheugen (tijdelijk)
-  String* lines = new String[10000];  // Max 10000 regels
-  int lineCount = 0;
-  
-  while (f.available() && lineCount < 10000) {
-    lines[lineCount] = f.readStringUntil('\n');
-    lines[lineCount].trim();
-    lineCount++;
+  String tmpPath = anlPath + ".tmp";
+  File out = SD_MMC.open(tmpPath.c_str(), FILE_WRITE);
+  if (!out) {
+    Serial.println("[ML ANN] ERROR: Could not create merge file!");
+    in.close();
+    return false;
   }
-  f.close();
   
-  Serial.printf("[ML ANN] Read %d lines from ANL\n", lineCount);
+  // Header ongewijzigd
+  String header = in.readStringUntil('\n');
+  header.trim();
+  out.println(header);
   
-  // Update regels met annotaties
+  int annIdx = 0;
+  int lineCount = 0;
   int updatedCount = 0;
-  for (int a = 0; a < annotationCount; a++) {
-    StressAnnotation& ann = annotations[a];
-    if (ann.userAnnotatedLevel < 0) continue;
+  
+  while (in.available()) {
+    String line = in.readStringUntil('\n');
+    line.trim();
+    if (line.length() == 0) continue;
+    lineCount++;
     
-    // Vind corresponderende regel (op basis van timestamp)
-    uint32_t targetLine = (uint32_t)(ann.timestamp * 10);  // ~10 samples/sec
+    // Eerste kolom = tijd in seconden
+    float lineTime = line.toFloat();
+    
+    // Alle annotaties t/m deze regel consumeren, laatste user level wint
+    int userLevel = -1;
+    while (annIdx < annotationCount && annotations[annIdx].timestamp <= lineTime) {
+      if (annotations[annIdx].userAnnotatedLevel >= 0) {
+        userLevel = annotations[annIdx].userAnnotatedLevel;
+      }
+      annIdx++;
+    }
     
-    if (targetLine < lineCount) {
+    if (userLevel >= 0) {
       // Vervang laatste kolom (StressLevel) met user annotatie
-      String& line = lines[targetLine];
       int lastComma = line.lastIndexOf(',');
       if (lastComma > 0) {
-        line = line.substring(0, lastComma + 1) + String(ann.userAnnotatedLevel);
+        line = line.substring(0, lastComma + 1) + String(userLevel);
         updatedCount++;
       }
     }
+    
+    out.println(line);
   }
   
-  Serial.printf("[ML ANN] Updated %d lines with user annotations\n", updatedCount);
+  in.close();
+  out.close();
   
-  // Schrijf terug naar ANL (maak backup eerst)
-  String backupPath = anlPath + ".bak";
-  SD_MMC.rename(anlPath.c_str(), backupPath.c_str());
+  Serial.printf("[ML ANN] Read %d lines from ANL, updated %d with user annotations\n",
+                lineCount, updatedCount);
   
-  f = SD_MMC.open(anlPath.c_str(), FILE_WRITE);
-  if (!f) {
-    // Herstel backup
-    SD_MMC.rename(backupPath.c_str(), anlPath.c_str());
-    delete[] lines;
+  // Origineel pas vervangen als .tmp compleet is
+  SD_MMC.remove(anlPath.c_str());
+  if (!SD_MMC.rename(tmpPath.c_str(), anlPath.c_str())) {
+    Serial.printf("[ML ANN] ERROR: Rename %s failed!\n", tmpPath.c_str());
     return false;
   }
   
-  f.println(header);
-  for (int i = 0; i < lineCount; i++) {
-    f.println(lines[i]);
-  }
-  f.close();
-  
-  delete[] lines;
-  
-  // Verwijder backup
-  SD_MMC.remove(backupPath.c_str());
-  
   Serial.printf("[ML ANN] Merged annotations into %s\n", anlPath.c_str());
   
   return true;
@@ -14,6 +14,12 @@
   3. Je kunt eerdere annotaties corrigeren
   
   Annotaties worden opgeslagen in .ann bestanden naast de .csv/.anl
+  
+  Opslag:
+  - In RAM gesorteerd op timestamp → binary search (O(log n)) lookup
+  - Elke wijziging wordt direct achteraan een journal (.anj) geschreven,
+    .ann wordt pas herschreven bij sluiten of als het journal groot wordt
+  - Merge met .anl is een streaming pass (regel in → regel uit)
 */
 
 #ifndef ML_ANNOTATION_H
@@ -28,7 +34,9 @@
 
 #define ML_ANNOTATION_DIR       "/ml_training"
 #define ML_ANNOTATION_EXT       ".ann"
-#define ML_MAX_ANNOTATIONS      500   // Max annotaties per bestand
+#define ML_JOURNAL_EXT          ".anj"  // Append-only wijzigingen sinds laatste .ann
+#define ML_MAX_ANNOTATIONS      5000  // Max annotaties per bestand (~360KB, PSRAM)
+#define ML_JOURNAL_COMPACT_AT   200   // Herschrijf .ann na zoveel journal regels
 
 // ═══════════════════════════════════════════════════════════════════════════
 //                    ANNOTATIE STRUCTUUR
@@ -112,14 +120,23 @@ private:
   String currentFilename;
   String annotationFilename;
   
-  // In-memory buffer voor snelle toegang
+  String journalFilename;
+  
+  // In-memory buffer, gesorteerd op timestamp
   StressAnnotation* annotations;
   int annotationCount;
   int annotationCapacity;
+  int journalEntries;
   
   // ─── Internal ───
   bool loadAnnotations();
-  bool saveAnnotations();
+  bool saveAnnotations();              // Volledige .ann + journal leeg
+  bool replayJournal();
+  bool appendJournal(char op, const StressAnnotation& ann);
+  bool ensureCapacity();
+  int lowerBound(float timestamp);     // Eerste index met timestamp >= gegeven
+  int insertSorted(const StressAnnotation& ann);
+  void removeAt(int idx);
   int findAnnotationIndex(float timestamp, float tolerance = 0.5f);
 };
 
@@ -387,7 +387,7 @@ void normalizeFeatures(float features[9]) {
   features[3] = normalizeAdem(features[3]);
   // Trust (snelheid), SleevePos (positie), Suction, Vibe zijn 0-100 of 0-255, normaliseer naar 0-1
   for (int i = 4; i < 8; i++) {
-    features[i] = constrain(features[i], 0.0f, 255.0f) / 255.0f;
+    features[i] = constrain(features[i], 0.0f, ML_NORM_ACT_RANGE) / ML_NORM_ACT_RANGE;
   }
   // Time normaliseren is lastig, laat op ruwe milliseconden (of gebruik modulo voor time-of-day)
   // Voor nu: laat Time zoals het is of gebruik als relatieve feature
@@ -395,20 +395,20 @@ void normalizeFeatures(float features[9]) {
 
 float normalizeHR(float hr) {
   // 40-200 BPM -> 0-1
-  return constrain((hr - 40.0f) / 160.0f, 0.0f, 1.0f);
+  return constrain((hr - ML_NORM_HR_MIN) / ML_NORM_HR_RANGE, 0.0f, 1.0f);
 }
 
 float normalizeTemp(float temp) {
   // 30-40°C -> 0-1
-  return constrain((temp - 30.0f) / 10.0f, 0.0f, 1.0f);
+  return constrain((temp - ML_NORM_TEMP_MIN) / ML_NORM_TEMP_RANGE, 0.0f, 1.0f);
 }
 
 float normalizeGSR(float gsr) {
   // 0-4095 -> 0-1
-  return constrain(gsr / 4095.0f, 0.0f, 1.0f);
+  return constrain(gsr / ML_NORM_GSR_RANGE, 0.0f, 1.0f);
 }
 
 float normalizeAdem(float adem) {
   // 0-100% -> 0-1
-  return constrain(adem / 100.0f, 0.0f, 1.0f);
+  return constrain(adem / ML_NORM_ADEM_RANGE, 0.0f, 1.0f);
 }
@@ -84,6 +84,7 @@ public:
   
   // Info
   bool hasModel() { return root != nullptr; }
+  const DecisionNode* getRoot() const { return root; }   // Voor code generator
   void clear();
 };
 
@@ -92,7 +93,15 @@ public:
 // Feature namen voor debugging
 const char* getFeatureName(int index);
 
-// Data normalisatie helpers
+// Data normalisatie helpers (constanten ook gebruikt door ml_model_codegen)
+#define ML_NORM_HR_MIN      40.0f
+#define ML_NORM_HR_RANGE    160.0f
+#define ML_NORM_TEMP_MIN    30.0f
+#define ML_NORM_TEMP_RANGE  10.0f
+#define ML_NORM_GSR_RANGE   4095.0f
+#define ML_NORM_ADEM_RANGE  100.0f
+#define ML_NORM_ACT_RANGE   255.0f   // Trust, SleevePos, Suction, Vibe
+
 void normalizeFeatures(float features[9]);
 float normalizeHR(float hr);       // 40-200 BPM -> 0-1
 float normalizeTemp(float temp);   // 30-40°C -> 0-1
@@ -0,0 +1,255 @@
+/*
+  ML Feature Store Implementation
+
+  Binaire cache van genormaliseerde feature vectors per opname
+*/
+
+#include "ml_feature_store.h"
+#include "ml_data_parser.h"
+
+static FeatureStoreStats stats = {0, 0, 0, 0};
+
+// ===== Helpers =====
+
+// "/dag1/sessie.aly" → "/ml_cache/sessie.aly.<hash>.mlf"
+// Hash (FNV-1a) over het volledige pad: zelfde naam in twee mappen krijgt
+// elk een eigen cache i.p.v. elkaar steeds opnieuw te laten bouwen
+static String cachePathFor(const char* srcPath) {
+  uint32_t hash = 2166136261UL;
+  for (const char* p = srcPath; *p; p++) {
+    hash ^= (uint8_t)*p;
+    hash *= 16777619UL;
+  }
+  String src = String(srcPath);
+  int slash = src.lastIndexOf('/');
+  String base = (slash >= 0) ? src.substring(slash + 1) : src;
+  char suffix[16];
+  snprintf(suffix, sizeof(suffix), ".%08lx.mlf", (unsigned long)hash);
+  return String(FEATURE_STORE_DIR) + "/" + base + suffix;
+}
+
+static bool readHeader(File& file, FeatureStoreHeader& header) {
+  if (file.size() < sizeof(FeatureStoreHeader)) return false;
+  if (file.read((uint8_t*)&header, sizeof(header)) != sizeof(header)) return false;
+  if (header.magic != FEATURE_STORE_MAGIC) return false;
+  if (header.version != FEATURE_STORE_VERSION) return false;
+  if (header.recordSize != sizeof(FeatureStoreRecord)) return false;
+  return file.size() == sizeof(header) + (size_t)header.sampleCount * sizeof(FeatureStoreRecord);
+}
+
+// Geldig = header klopt EN bron niet gewijzigd sinds build
+static bool isCacheValid(const String& cachePath, uint32_t srcSize, uint32_t srcMtime,
+                         FeatureStoreHeader* out) {
+  if (!SD.exists(cachePath.c_str())) return false;
+
+  File file = SD.open(cachePath.c_str());
+  if (!file) return false;
+
+  FeatureStoreHeader header;
+  bool valid = readHeader(file, header) &&
+               header.srcSize == srcSize &&
+               header.srcMtime == srcMtime &&
+               header.sampleCount > 0;       // Oude lege caches opnieuw bouwen
+  file.close();
+
+  if (valid && out) *out = header;
+  return valid;
+}
+
+// Parse bron 1x (streaming, regel voor regel) en schrijf binaire records
+static bool buildCache(const char* srcPath, const String& cachePath,
+                       uint32_t srcSize, uint32_t srcMtime, FeatureStoreHeader* out) {
+  uint32_t startMs = millis();
+
+  File src = SD.open(srcPath);
+  if (!src) {
+    Serial.printf("[FSTORE] Fout: kan %s niet openen\n", srcPath);
+    return false;
+  }
+
+  if (!SD.exists(FEATURE_STORE_DIR)) {
+    SD.mkdir(FEATURE_STORE_DIR);
+  }
+
+  String tmpPath = cachePath + ".tmp";
+  File dst = SD.open(tmpPath.c_str(), FILE_WRITE);
+  if (!dst) {
+    Serial.printf("[FSTORE] Fout: kan %s niet schrijven\n", tmpPath.c_str());
+    src.close();
+    return false;
+  }
+
+  FeatureStoreHeader header;
+  memset(&header, 0, sizeof(header));
+  header.magic = FEATURE_STORE_MAGIC;
+  header.version = FEATURE_STORE_VERSION;
+  header.recordSize = sizeof(FeatureStoreRecord);
+  header.srcSize = srcSize;
+  header.srcMtime = srcMtime;
+  header.normalized = 1;
+
+  // Placeholder header, wordt aan het eind overschreven
+  dst.write((const uint8_t*)&header, sizeof(header));
+
+  // Skip header lijn
+  if (src.available()) {
+    src.readStringUntil('\n');
+  }
+
+  FeatureStoreRecord chunk[FEATURE_STORE_CHUNK];
+  int chunkCount = 0;
+
+  while (src.available()) {
+    String line = src.readStringUntil('\n');
+    line.trim();
+    if (line.length() < 5) continue;
+
+    FeatureStoreRecord& rec = chunk[chunkCount];
+    memset(&rec, 0, sizeof(rec));
+    int label;
+    if (!parseCsvLine(line, rec.features, label)) continue;
+
+    normalizeFeatures(rec.features);
+    rec.label = (int8_t)label;
+    if (label >= 0 && label <= 7) {
+      header.labelCounts[label]++;
+      header.labeled = 1;
+    }
+    header.sampleCount++;
+
+    if (++chunkCount == FEATURE_STORE_CHUNK) {
+      dst.write((const uint8_t*)chunk, chunkCount * sizeof(FeatureStoreRecord));
+      chunkCount = 0;
+    }
+  }
+  if (chunkCount > 0) {
+    dst.write((const uint8_t*)chunk, chunkCount * sizeof(FeatureStoreRecord));
+  }
+  src.close();
+
+  // Geen bruikbare regels: geen cache achterlaten, anders is de volgende
+  // featureStore_ensure() een valse hit op een leeg bestand
+  if (header.sampleCount == 0) {
+    dst.close();
+    SD.remove(tmpPath.c_str());
+    Serial.printf("[FSTORE] Geen samples in %s, geen cache gebouwd\n", srcPath);
+    return false;
+  }
+
+  dst.seek(0);
+  dst.write((const uint8_t*)&header, sizeof(header));
+  dst.close();
+
+  if (SD.exists(cachePath.c_str())) SD.remove(cachePath.c_str());
+  if (!SD.rename(tmpPath.c_str(), cachePath.c_str())) {
+    Serial.printf("[FSTORE] Fout: rename naar %s mislukt\n", cachePath.c_str());
+    SD.remove(tmpPath.c_str());
+    return false;
+  }
+
+  stats.rebuilds++;
+  stats.lastBuildMs = millis() - startMs;
+  Serial.printf("[FSTORE] Cache gebouwd: %s (%u samples, %lums)\n",
+                cachePath.c_str(), header.sampleCount, (unsigned long)stats.lastBuildMs);
+
+  if (out) *out = header;
+  return true;
+}
+
+// ===== Cache beheer =====
+
+bool featureStore_ensure(const char* srcPath, FeatureStoreHeader* header) {
+  File src = SD.open(srcPath);
+  if (!src) {
+    Serial.printf("[FSTORE] Fout: bron %s niet gevonden\n", srcPath);
+    return false;
+  }
+  uint32_t srcSize = src.size();
+  uint32_t srcMtime = (uint32_t)src.getLastWrite();
+  src.close();
+
+  String cachePath = cachePathFor(srcPath);
+  if (isCacheValid(cachePath, srcSize, srcMtime, header)) {
+    stats.hits++;
+    return true;
+  }
+
+  return buildCache(srcPath, cachePath, srcSize, srcMtime, header);
+}
+
+bool featureStore_load(const char* srcPath, std::vector<TrainingSample>& samples) {
+  uint32_t startMs = millis();
+
+  FeatureStoreReader reader;
+  if (!reader.open(srcPath)) return false;
+
+  samples.reserve(samples.size() + reader.count());
+
+  TrainingSample sample;
+  while (reader.next(sample)) {
+    samples.push_back(sample);
+  }
+  reader.close();
+
+  stats.lastLoadMs = millis() - startMs;
+  Serial.printf("[FSTORE] Geladen: %s (%u samples, %lums)\n",
+                srcPath, reader.count(), (unsigned long)stats.lastLoadMs);
+  return true;
+}
+
+void featureStore_invalidate(const char* srcPath) {
+  String cachePath = cachePathFor(srcPath);
+  if (SD.exists(cachePath.c_str())) {
+    SD.remove(cachePath.c_str());
+    Serial.printf("[FSTORE] Cache verwijderd: %s\n", cachePath.c_str());
+  }
+}
+
+FeatureStoreStats featureStore_getStats() {
+  return stats;
+}
+
+// ===== Streaming reader =====
+
+bool FeatureStoreReader::open(const char* srcPath) {
+  close();
+
+  if (!featureStore_ensure(srcPath, &header)) return false;
+
+  String cachePath = cachePathFor(srcPath);
+  file = SD.open(cachePath.c_str());
+  if (!file) return false;
+
+  // Header is al gevalideerd door featureStore_ensure()
+  file.seek(sizeof(FeatureStoreHeader));
+  bufCount = 0;
+  bufPos = 0;
+  readCount = 0;
+  return true;
+}
+
+bool FeatureStoreReader::next(TrainingSample& sample) {
+  if (!file || readCount >= header.sampleCount) return false;
+
+  // Lees volgende chunk in 1 SD read
+  if (bufPos >= bufCount) {
+    uint32_t remaining = header.sampleCount - readCount;
+    uint16_t want = remaining < FEATURE_STORE_CHUNK ? remaining : FEATURE_STORE_CHUNK;
+    size_t got = file.read((uint8_t*)buffer, want * sizeof(FeatureStoreRecord));
+    bufCount = got / sizeof(FeatureStoreRecord);
+    bufPos = 0;
+    if (bufCount == 0) return false;
+  }
+
+  const FeatureStoreRecord& rec = buffer[bufPos++];
+  memcpy(sample.features, rec.features, sizeof(sample.features));
+  sample.label = rec.label;
+  readCount++;
+  return true;
+}
+
+void FeatureStoreReader::close() {
+  if (file) file.close();
+  bufCount = 0;
+  bufPos = 0;
+}
@@ -0,0 +1,95 @@
+/*
+  ML Feature Store - Binaire feature cache per opname
+
+  Elke .aly / .csv wordt 1x geparsed en genormaliseerd naar een binair
+  bestand in /ml_cache/ (<bestandsnaam>.<pad hash>.mlf). Training leest
+  daarna direct de vaste records, zonder tekst parsing.
+
+  Cache sleutel = grootte + laatste wijziging (mtime) van het bronbestand.
+  Na een nieuwe annotatie wordt dus alleen het gewijzigde bestand opnieuw
+  verwerkt, de rest komt rechtstreeks uit de cache.
+
+  Bestandsformaat (.mlf):
+    FeatureStoreHeader (56 bytes)
+    FeatureStoreRecord[sampleCount] (40 bytes per sample)
+*/
+
+#ifndef ML_FEATURE_STORE_H
+#define ML_FEATURE_STORE_H
+
+#include <Arduino.h>
+#include <SD.h>
+#include <vector>
+#include "ml_decision_tree.h"
+
+#define FEATURE_STORE_DIR      "/ml_cache"
+#define FEATURE_STORE_MAGIC    0x31464C4D   // "MLF1"
+#define FEATURE_STORE_VERSION  1
+#define FEATURE_STORE_CHUNK    32           // Records per SD read
+
+// ===== Bestandsformaat =====
+
+struct __attribute__((packed)) FeatureStoreHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t recordSize;
+  uint32_t srcSize;           // Cache sleutel: grootte bronbestand
+  uint32_t srcMtime;          // Cache sleutel: laatste wijziging bronbestand
+  uint32_t sampleCount;
+  uint8_t normalized;         // 1 = features via normalizeFeatures()
+  uint8_t labeled;            // 1 = bron had StressLevel kolom
+  uint8_t reserved[2];
+  uint32_t labelCounts[8];    // Verdeling per label (0-7), -1 telt niet mee
+};
+
+struct __attribute__((packed)) FeatureStoreRecord {
+  float features[9];          // Zelfde volgorde als TrainingSample
+  int8_t label;               // 1-7, -1 = ongelabeld
+  uint8_t reserved[3];
+};
+
+// ===== Statistieken =====
+
+struct FeatureStoreStats {
+  uint32_t hits;              // Cache geldig, direct gelezen
+  uint32_t rebuilds;          // Bron gewijzigd of nieuw, opnieuw geparsed
+  uint32_t lastBuildMs;
+  uint32_t lastLoadMs;
+};
+
+// ===== Cache beheer =====
+
+// Zorg dat er een actuele cache is (bouwt opnieuw indien nodig)
+bool featureStore_ensure(const char* srcPath, FeatureStoreHeader* header = nullptr);
+
+// Laad alle samples (genormaliseerd) uit de cache in een vector
+bool featureStore_load(const char* srcPath, std::vector<TrainingSample>& samples);
+
+// Verwijder cache voor een bronbestand (bijv. na handmatige edit)
+void featureStore_invalidate(const char* srcPath);
+
+FeatureStoreStats featureStore_getStats();
+
+// ===== Streaming reader (zonder alles in RAM) =====
+
+class FeatureStoreReader {
+private:
+  File file;
+  FeatureStoreHeader header;
+  FeatureStoreRecord buffer[FEATURE_STORE_CHUNK];
+  uint16_t bufCount;
+  uint16_t bufPos;
+  uint32_t readCount;
+
+public:
+  FeatureStoreReader() : bufCount(0), bufPos(0), readCount(0) {}
+  ~FeatureStoreReader() { close(); }
+
+  bool open(const char* srcPath);   // Roept featureStore_ensure() aan
+  bool next(TrainingSample& sample);
+  uint32_t count() const { return header.sampleCount; }
+  const FeatureStoreHeader& getHeader() const { return header; }
+  void close();
+};
+
+#endif // ML_FEATURE_STORE_H
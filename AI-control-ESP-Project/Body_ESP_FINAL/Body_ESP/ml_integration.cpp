@@ -10,12 +10,25 @@
 */
 
 #include "ml_integration.h"
+#include "edge_forecaster.h"
+#include "ml_model_codegen.h"
+#include "advanced_stress_manager.h"  // stressLevelToSpeed
+#include "config.h"
+
+#if AI_USE_COMPILED_MODEL
+#include "ml_compiled_model.h"
+#endif
 #include <SD_MMC.h>
 #include <Preferences.h>  // 🔥 NIEUW: NVS voor model opslag (overleeft SD format!)
 
 // NVS voor model opslag
 static Preferences mlPrefs;
 
+#define ML_ACTIVE_MODEL_PATH  "/ml_training/model.bin"
+#define ML_PARITY_DATASET     "/ml_training/parity.csv"
+#define ML_PARITY_SAMPLES     150     // Laatste 5 min AI controle (5.4 KB, alleen tijdens een sessie)
+#define ML_PARITY_INTERVAL_MS 2000
+
 // ═══════════════════════════════════════════════════════════════════════════
 //                         GLOBALE STATE
 // ═══════════════════════════════════════════════════════════════════════════
@@ -28,6 +41,14 @@ static int sessionFeedbackCount = 0;
 static File feedbackFile;
 static bool feedbackFileOpen = false;
 
+// Feature vector van de laatste AI tick + steekproef voor parity checks
+static float liveFeatures[9];
+static bool liveFeaturesValid = false;
+static float (*paritySamples)[9] = nullptr;   // Heap, alleen in een live sessie met model
+static uint16_t parityHead = 0;
+static uint16_t parityCount = 0;
+static uint32_t lastParitySampleMs = 0;
+
 // ═══════════════════════════════════════════════════════════════════════════
 //                         FEEDBACK LOGGING (intern)
 // ═══════════════════════════════════════════════════════════════════════════
@@ -80,6 +101,119 @@ static void closeFeedbackFile() {
   }
 }
 
+// ═══════════════════════════════════════════════════════════════════════════
+//                         MODEL BESTANDEN (SD_MMC)
+// ═══════════════════════════════════════════════════════════════════════════
+// MLTrainer::saveModel/loadModel gaan via SD (SPI), dat is hier niet
+// gemount. Model bestanden in /ml_training altijd via SD_MMC, net als
+// feedback.csv en de shadow kandidaat.
+
+// Eerst naar <path>.tmp, dan hernoemen: een half geschreven bestand
+// vervangt nooit een goed model
+static bool writeTreeFile(DecisionTree* tree, const char* path) {
+  if (!tree || !tree->hasModel()) {
+    Serial.println("[ML INT] ❌ Geen model om op te slaan");
+    return false;
+  }
+  
+  if (!SD_MMC.exists("/ml_training")) {
+    SD_MMC.mkdir("/ml_training");
+  }
+  
+  String tmpPath = String(path) + ".tmp";
+  File file = SD_MMC.open(tmpPath.c_str(), FILE_WRITE);
+  if (!file) {
+    Serial.printf("[ML INT] ❌ Kan %s niet schrijven\n", path);
+    return false;
+  }
+  String json = tree->serialize();
+  size_t written = file.print(json);
+  file.close();
+  
+  if (written != json.length()) {
+    SD_MMC.remove(tmpPath.c_str());
+    Serial.printf("[ML INT] ❌ %s onvolledig geschreven\n", path);
+    return false;
+  }
+  if (SD_MMC.exists(path)) SD_MMC.remove(path);
+  return SD_MMC.rename(tmpPath.c_str(), path);
+}
+
+static bool readTreeFile(DecisionTree* tree, const char* path) {
+  File file = SD_MMC.open(path, FILE_READ);
+  if (!file) return false;
+  String json = file.readString();
+  file.close();
+  
+  if (!tree || !tree->deserialize(json) || !tree->hasModel()) {
+    Serial.printf("[ML INT] ❌ Model %s ongeldig\n", path);
+    return false;
+  }
+  return true;
+}
+
+static bool writeModelFile(const char* path) {
+  return writeTreeFile(mlTrainer.getModel(), path);
+}
+
+static bool readModelFile(const char* path) {
+  return readTreeFile(mlTrainer.getModel(), path);
+}
+
+// Live features van de laatste ticks als .csv (Time,HR,...,Vibe zoals
+// parseCsvLine), dataset voor mlCodegen_parityCheck en host/ml_parity
+static bool writeParityDataset() {
+  if (parityCount == 0) return false;
+  
+  File file = SD_MMC.open(ML_PARITY_DATASET, FILE_WRITE);
+  if (!file) {
+    Serial.println("[ML INT] ❌ Kan " ML_PARITY_DATASET " niet schrijven");
+    return false;
+  }
+  
+  file.println("Time,HR,Temp,GSR,Adem,Trust,SleevePos,Suction,Vibe");
+  uint16_t start = (parityHead + ML_PARITY_SAMPLES - parityCount) % ML_PARITY_SAMPLES;
+  for (uint16_t i = 0; i < parityCount; i++) {
+    const float* f = paritySamples[(start + i) % ML_PARITY_SAMPLES];
+    file.printf("%.1f,%.1f,%.2f,%.1f,%.1f,%.2f,%.1f,%.1f,%.1f\n",
+                f[8], f[0], f[1], f[2], f[3], f[4], f[5], f[6], f[7]);
+  }
+  file.close();
+  
+  Serial.printf("[ML INT] Parity dataset: %u samples → " ML_PARITY_DATASET "\n", parityCount);
+  return true;
+}
+
+// Steekproef is alleen nodig als er een model.bin is om tegen te checken
+// (checkCompiledParity, host/ml_parity): buffer leeft van sessie start tot
+// de dataset op SD staat
+static void parityBegin() {
+  parityHead = 0;
+  parityCount = 0;
+  if (paritySamples || !mlTrainer.hasModel()) return;
+  paritySamples = (float (*)[9])malloc(sizeof(float) * 9 * ML_PARITY_SAMPLES);
+  if (!paritySamples) Serial.println("[ML INT] ⚠️ Geen RAM voor parity steekproef");
+}
+
+static void parityEnd() {
+  if (!paritySamples) return;
+  writeParityDataset();
+  free(paritySamples);
+  paritySamples = nullptr;
+  parityCount = 0;
+}
+
+// Gecompileerd model (flash) tegen model.bin: na export en bij boot
+static void checkCompiledParity() {
+#if AI_USE_COMPILED_MODEL
+  if (!mlTrainer.hasModel() || !SD_MMC.exists(ML_PARITY_DATASET)) return;
+  
+  if (!mlCodegen_parityCheck(mlTrainer.getModel(), ML_PARITY_DATASET)) {
+    Serial.println("[ML INT] ⚠️ Gecompileerd model wijkt af van model.bin → " ML_CODEGEN_PATH " opnieuw flashen");
+  }
+#endif
+}
+
 // ═══════════════════════════════════════════════════════════════════════════
 //                         NVS MODEL OPSLAG (overleeft SD format!)
 // ═══════════════════════════════════════════════════════════════════════════
@@ -111,7 +245,7 @@ static bool saveModelToNVS() {
   Serial.println("[ML INT] 💾 Saving model to NVS (internal flash)...");
   
   // Eerst model naar tijdelijk SD bestand exporteren
-  if (!mlTrainer.saveModel("/ml_training/temp_model.bin")) {
+  if (!writeModelFile("/ml_training/temp_model.bin")) {
     Serial.println("[ML INT] ❌ Kan model niet exporteren");
     return false;
   }
@@ -201,7 +335,7 @@ static bool loadModelFromNVS() {
   }
   
   // Schrijf model naar SD
-  File modelFile = SD_MMC.open("/ml_training/model.bin", FILE_WRITE);
+  File modelFile = SD_MMC.open(ML_ACTIVE_MODEL_PATH, FILE_WRITE);
   if (!modelFile) {
     Serial.println("[ML INT] ❌ Kan model niet naar SD schrijven");
     return false;
@@ -211,7 +345,7 @@ static bool loadModelFromNVS() {
   modelFile.close();
   
   // Laad model in trainer
-  if (mlTrainer.loadModel("/ml_training/model.bin")) {
+  if (readModelFile(ML_ACTIVE_MODEL_PATH)) {
     mlState.modelTrained = true;
     mlState.modelAccuracy = nvsModel.accuracy;
     mlState.totalFeedbackSamples = nvsModel.sampleCount;
@@ -239,8 +373,8 @@ void mlIntegration_begin() {
   Serial.println("[ML INT] ML Integration System Startup");
   Serial.println("[ML INT] ═══════════════════════════════════════════════");
   
-  // Reset state
-  memset(&mlState, 0, sizeof(mlState));
+  // Reset state (geen memset: bevat een String)
+  mlState = MLIntegrationState();
   mlState.userCorrectedLevel = -1;
   mlState.aiPredictedLevel = -1;
   
@@ -249,7 +383,7 @@ void mlIntegration_begin() {
   ml_begin();
   
   // Check voor bestaand model op SD
-  if (mlTrainer.hasModel()) {
+  if (SD_MMC.exists(ML_ACTIVE_MODEL_PATH) && readModelFile(ML_ACTIVE_MODEL_PATH)) {
     mlState.modelTrained = true;
     TrainingStatus status = mlTrainer.getStatus();
     mlState.modelAccuracy = status.currentAccuracy;
@@ -266,6 +400,18 @@ void mlIntegration_begin() {
     }
   }
   
+#if AI_USE_COMPILED_MODEL
+  Serial.printf("[ML INT] Gecompileerd model actief (hash 0x%08lX, %d nodes)\n",
+                (unsigned long)ML_COMPILED_MODEL_HASH, ML_COMPILED_MODEL_NODES);
+  mlState.modelTrained = true;
+  checkCompiledParity();
+#endif
+  
+  // Shadow kandidaat van vorige training (optioneel)
+  if (mlState.modelTrained && SD_MMC.exists(SHADOW_CANDIDATE_PATH)) {
+    mlShadow_loadCandidate();
+  }
+  
   // Reset counters
   if (!mlState.modelTrained) {
     mlState.totalFeedbackSamples = 0;
@@ -300,9 +446,11 @@ void mlIntegration_startLiveSession() {
   
   // Reset ML sessie state
   ml_resetSessie();
+  edgeForecast_reset();
   
   // Open feedback file
   openFeedbackFile();
+  parityBegin();
   
   Serial.println("[ML INT] Live session started - nunchuk feedback enabled");
 }
@@ -321,6 +469,18 @@ void mlIntegration_stopLiveSession() {
   
   // Sluit feedback file
   closeFeedbackFile();
+  parityEnd();
+  
+  // Shadow resultaten van deze sessie vastleggen (tellen over sessies en
+  // reboots door), kandidaat promoveren zodra de metingen dat rechtvaardigen
+  if (mlShadow_hasCandidate()) {
+    if (mlShadow_evaluate() == SHADOW_PROMOTE) {
+      mlIntegration_promoteCandidate();
+    } else {
+      mlShadow_saveState();
+      mlShadow_writeSummary();
+    }
+  }
   
   mlState.isLiveSession = false;
   mlState.liveSessionActive = false;
@@ -351,13 +511,17 @@ void mlIntegration_logNunchukCorrection(int aiLevel, int userLevel) {
   mlState.userCorrectedLevel = userLevel;
   sessionFeedbackCount++;
   
-  int diff = userLevel - aiLevel;
+  // userLevel = Hooft speed step, aiLevel = stress level: diff in speed steps
+  int diff = userLevel - stressLevelToSpeed((StressLevel)aiLevel);
   Serial.printf("[ML INT] 📝 Nunchuk correctie: AI=%d → User=%d (diff: %+d)\n",
                 aiLevel, userLevel, diff);
   
   // Log naar feedback file
   logFeedback(mlState.currentHR, mlState.currentTemp, mlState.currentGSR,
               aiLevel, userLevel, "nunchuk");
+  
+  // Vergelijk kandidaat en actief model met gebruiker
+  mlShadow_logUserSpeedStep(userLevel);
 }
 
 void mlIntegration_logEdge() {
@@ -366,6 +530,7 @@ void mlIntegration_logEdge() {
   
   // Registreer in ML systeem
   ml_registreerEdge();
+  edgeForecast_markEdge();
   
   // Log naar feedback file
   logFeedback(mlState.currentHR, mlState.currentTemp, mlState.currentGSR,
@@ -470,19 +635,15 @@ int mlIntegration_getExistingFeedback() {
 int mlIntegration_getOptimalLevel(uint8_t autonomyPercent) {
   int recommendedLevel = mlState.currentStressLevel;
   
-  // Als we een getraind model hebben, gebruik dat
-  if (mlState.modelTrained && mlTrainer.hasModel()) {
-    // Maak feature array voor predict
-    float features[9] = {
-      mlState.currentHR,
-      mlState.currentTemp,
-      mlState.currentGSR,
-      0, 0, 0, 0, 0, 0  // Trends en andere features (TODO)
-    };
-    
-    recommendedLevel = mlTrainer.predict(features);
+  // Actief model (gecompileerd of model.bin) op de volledige vector van de
+  // laatste AI tick
+  float features[9];
+  int predicted = mlIntegration_getLiveFeatures(features) ? mlIntegration_predictActive(features) : -1;
+  if (predicted >= 0) {
+    recommendedLevel = predicted;
     
-    Serial.printf("[ML INT] 🤖 ML prediction: %d (rule-based: %d)\n",
+    Serial.printf("[ML INT] 🤖 ML prediction%s: %d (rule-based: %d)\n",
+                  AI_USE_COMPILED_MODEL ? " (compiled)" : "",
                   recommendedLevel, mlState.currentStressLevel);
   }
   
@@ -504,6 +665,44 @@ bool mlIntegration_aiMagNaarLevel(uint8_t autonomyPercent, int level) {
   return aiBijbel_magNaarLevel(autonomyPercent, level);
 }
 
+int mlIntegration_predictActive(const float rawFeatures[9]) {
+#if AI_USE_COMPILED_MODEL
+  // Model zit in flash: geen JSON, geen heap, normalisatie ingebakken
+  int label = mlCompiled_predict(rawFeatures);
+#else
+  if (!mlState.modelTrained || !mlTrainer.hasModel()) return -1;
+  
+  // Zelfde normalisatie als bij training (TrainingConfig.normalizeFeatures)
+  float features[9];
+  memcpy(features, rawFeatures, sizeof(features));
+  normalizeFeatures(features);
+  
+  int label = mlTrainer.getModel()->predict(features);
+#endif
+  if (label < 1) return -1;
+  return constrain(label - 1, 0, SHADOW_LEVELS - 1);   // 1-7 → 0-6
+}
+
+void mlIntegration_setLiveFeatures(const float rawFeatures[9]) {
+  memcpy(liveFeatures, rawFeatures, sizeof(liveFeatures));
+  liveFeaturesValid = true;
+  
+  if (!paritySamples) return;
+  uint32_t now = millis();
+  if (parityCount > 0 && now - lastParitySampleMs < ML_PARITY_INTERVAL_MS) return;
+  lastParitySampleMs = now;
+  
+  memcpy(paritySamples[parityHead], rawFeatures, sizeof(liveFeatures));
+  parityHead = (parityHead + 1) % ML_PARITY_SAMPLES;
+  if (parityCount < ML_PARITY_SAMPLES) parityCount++;
+}
+
+bool mlIntegration_getLiveFeatures(float rawFeatures[9]) {
+  if (!liveFeaturesValid) return false;
+  memcpy(rawFeatures, liveFeatures, sizeof(liveFeatures));
+  return true;
+}
+
 // ═══════════════════════════════════════════════════════════════════════════
 //                         TRAINING
 // ═══════════════════════════════════════════════════════════════════════════
@@ -529,34 +728,95 @@ bool mlIntegration_trainModel() {
   }
   
   // Start training
-  bool success = mlTrainer.startTraining();
+  if (!mlTrainer.startTraining()) {
+    Serial.println("[ML INT] ❌ Training failed!");
+    Serial.println("[ML INT] ═══════════════════════════════════════════════");
+    return false;
+  }
   
-  if (success) {
-    TrainingStatus status = mlTrainer.getStatus();
-    mlState.modelTrained = true;
-    mlState.modelAccuracy = status.currentAccuracy;
-    
-    Serial.printf("[ML INT] ✅ Training complete! Accuracy: %.1f%%\n",
-                  mlState.modelAccuracy * 100);
-    
-    // Save model naar SD
-    mlTrainer.saveModel("/ml_training/model.bin");
-    Serial.println("[ML INT] Model saved to /ml_training/model.bin");
-    
-    // 🔥 NIEUW: Backup naar NVS (overleeft SD format!)
-    if (saveModelToNVS()) {
-      Serial.println("[ML INT] ✅ Model backed up to NVS (safe from SD format!)");
-    } else {
-      Serial.println("[ML INT] ⚠️ NVS backup failed - model only on SD");
-    }
+  // Nieuw model is altijd eerst een kandidaat: alleen promoteCandidate()
+  // schrijft model.bin
+  TrainingStatus status = mlTrainer.getStatus();
+  bool success = writeModelFile(SHADOW_CANDIDATE_PATH);
+  
+  // Actief model terug in trainer (training heeft het vervangen)
+  if (mlState.modelTrained && !readModelFile(ML_ACTIVE_MODEL_PATH)) {
+    Serial.println("[ML INT] ⚠️ Actief model niet terug te laden");
+  }
+  
+  if (!success || !mlShadow_loadCandidate()) {
+    Serial.println("[ML INT] ❌ Kandidaat opslaan mislukt");
+    success = false;
+  } else if (mlState.modelTrained) {
+    // Niet direct live: eerst als shadow kandidaat meten
+    Serial.printf("[ML INT] ✅ Training complete! Accuracy: %.1f%% → shadow kandidaat\n",
+                  status.currentAccuracy * 100);
   } else {
-    Serial.println("[ML INT] ❌ Training failed!");
+    // Nog geen actief model: niets om tegen te meten
+    Serial.printf("[ML INT] ✅ Training complete! Accuracy: %.1f%% → eerste model, direct actief\n",
+                  status.currentAccuracy * 100);
+    
+    mlState.modelAccuracy = status.currentAccuracy;
+    success = mlIntegration_promoteCandidate(true);
   }
   
   Serial.println("[ML INT] ═══════════════════════════════════════════════");
   return success;
 }
 
+bool mlIntegration_promoteCandidate(bool force) {
+  ShadowVerdict verdict = mlShadow_evaluate();
+  ShadowReport report = mlShadow_getReport();
+  
+  Serial.printf("[ML INT] Shadow: %u ticks, %.1f%% eens, gebruiker %.1f%% vs %.1f%%, +%.0fus → %s\n",
+                report.ticks, report.agreementRate * 100,
+                report.candidateUserRate * 100, report.activeUserRate * 100,
+                report.candidateAvgUs, mlShadow_verdictName(verdict));
+  
+  if (verdict == SHADOW_NO_CANDIDATE) return false;
+  if (verdict != SHADOW_PROMOTE && !force) {
+    Serial.println("[ML INT] Kandidaat niet gepromoveerd");
+    mlShadow_saveState();
+    return false;
+  }
+  
+  mlShadow_writeSummary();
+  
+  // Kandidaat in een los model: het actieve model blijft staan tot
+  // model.bin veilig geschreven is, pas dan wisselen
+  DecisionTree* promoted = new DecisionTree();
+  if (!readTreeFile(promoted, SHADOW_CANDIDATE_PATH)) {
+    Serial.println("[ML INT] ❌ Kan kandidaat niet laden");
+    delete promoted;
+    return false;
+  }
+  
+  if (!writeTreeFile(promoted, ML_ACTIVE_MODEL_PATH)) {
+    Serial.println("[ML INT] ❌ Kan model.bin niet schrijven - actief model blijft");
+    delete promoted;
+    return false;
+  }
+  mlTrainer.adoptModel(promoted);
+  Serial.println("[ML INT] Model saved to " ML_ACTIVE_MODEL_PATH);
+  mlCodegen_writeHeader(mlTrainer.getModel());
+  checkCompiledParity();
+  mlState.modelTrained = true;
+  if (report.userOverrides > 0) {
+    mlState.modelAccuracy = report.candidateUserRate;
+  }
+  
+  if (!saveModelToNVS()) {
+    Serial.println("[ML INT] ⚠️ NVS backup failed - model only on SD");
+  }
+  
+  mlShadow_unloadCandidate();
+  SD_MMC.remove(SHADOW_CANDIDATE_PATH);
+  SD_MMC.remove(SHADOW_STATE_PATH);
+  
+  Serial.println("[ML INT] ✅ Kandidaat is nu het actieve model");
+  return true;
+}
+
 void mlIntegration_getStats(int* feedbackCount, int* annotationCount, 
                              bool* modelTrained, float* accuracy) {
   if (feedbackCount) *feedbackCount = mlState.totalFeedbackSamples;
@@ -45,6 +45,7 @@
 #include "ml_stress_analyzer.h"
 #include "ai_bijbel.h"
 #include "playback_screen_v2.h"
+#include "ml_shadow_model.h"
 
 // ═══════════════════════════════════════════════════════════════════════════
 //                         GLOBALE STATE
@@ -105,6 +106,7 @@ void mlIntegration_stopLiveSession();
 void mlIntegration_updateSensors(float hr, float temp, float gsr);
 
 // Log nunchuk correctie (roep aan vanuit ESP-NOW handler)
+// aiLevel = stress level (0-7), userLevel = nieuwe Hooft speed step (0-7)
 void mlIntegration_logNunchukCorrection(int aiLevel, int userLevel);
 
 // Log edge event
@@ -142,13 +144,31 @@ int mlIntegration_getOptimalLevel(uint8_t autonomyPercent);
 // Check of AI naar level mag (AI Bijbel regels)
 bool mlIntegration_aiMagNaarLevel(uint8_t autonomyPercent, int level);
 
+// Level van het actieve model op ruwe features [HR, Temp, GSR, Adem, Trust,
+// SleevePos, Suction, Vibe, Time]: 0-6, -1 = geen model. Met
+// AI_USE_COMPILED_MODEL het gecompileerde model, anders model.bin.
+// Referentie voor de shadow kandidaat (zelfde schaal als StressDecision)
+int mlIntegration_predictActive(const float rawFeatures[9]);
+
+// Ruwe feature vector van de huidige AI tick (roep aan vóór de beslissing).
+// Wordt ook 1x per sec bewaard als parity dataset voor het gecompileerde model
+void mlIntegration_setLiveFeatures(const float rawFeatures[9]);
+bool mlIntegration_getLiveFeatures(float rawFeatures[9]);  // false = nog geen tick
+
 // ═══════════════════════════════════════════════════════════════════════════
 //                         TRAINING
 // ═══════════════════════════════════════════════════════════════════════════
 
 // Combineer alle feedback bronnen en train model
+// Nieuw model wordt altijd eerst kandidaat. Is er al een actief model, dan
+// draait het als shadow mee; anders wordt het direct gepromoveerd
 bool mlIntegration_trainModel();
 
+// Maak kandidaat actief als mlShadow_evaluate() SHADOW_PROMOTE geeft
+// (force = true negeert de metingen). Enige plek die model.bin schrijft;
+// wordt ook aan het eind van elke live sessie geprobeerd
+bool mlIntegration_promoteCandidate(bool force = false);
+
 // Krijg training statistieken
 void mlIntegration_getStats(int* feedbackCount, int* annotationCount, 
                              bool* modelTrained, float* accuracy);
@@ -0,0 +1,232 @@
+/*
+  ML Model Codegen Implementation
+
+  Schrijft een DecisionTree als geneste if's naar een C++ header
+*/
+
+#include "ml_model_codegen.h"
+#include "ml_data_parser.h"
+#include "config.h"
+#include <SD_MMC.h>
+
+#if AI_USE_COMPILED_MODEL
+#include "ml_compiled_model.h"
+#endif
+
+// ===== Helpers =====
+
+// Float literal die exact terugleest als dezelfde float ("0.5f", "2.0f")
+static String floatLiteral(float value) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.9g", value);
+  String lit = String(buf);
+  if (lit.indexOf('.') < 0 && lit.indexOf('e') < 0) {
+    lit += ".0";
+  }
+  return lit + "f";
+}
+
+static void measureTree(const DecisionNode* node, int depth, int& nodes, int& maxDepth) {
+  if (!node) return;
+  nodes++;
+  if (depth > maxDepth) maxDepth = depth;
+  if (!node->isLeaf) {
+    measureTree(node->left, depth + 1, nodes, maxDepth);
+    measureTree(node->right, depth + 1, nodes, maxDepth);
+  }
+}
+
+static void writeIndent(File& file, int depth) {
+  for (int i = 0; i < depth; i++) {
+    file.print("  ");
+  }
+}
+
+// Zelfde pad als DecisionTree::predictNode(): <= links, > rechts, null = -1
+static void writeNode(File& file, const DecisionNode* node, int depth) {
+  writeIndent(file, depth);
+
+  if (!node) {
+    file.println("return -1;");
+    return;
+  }
+
+  if (node->isLeaf) {
+    file.printf("return %d;\n", node->label);
+    return;
+  }
+
+  file.printf("if (f[%d] <= %s) {  // %s\n", node->featureIndex,
+              floatLiteral(node->threshold).c_str(), getFeatureName(node->featureIndex));
+  writeNode(file, node->left, depth + 1);
+  writeIndent(file, depth);
+  file.println("} else {");
+  writeNode(file, node->right, depth + 1);
+  writeIndent(file, depth);
+  file.println("}");
+}
+
+// ===== Public API =====
+
+uint32_t mlCodegen_modelHash(DecisionTree* tree) {
+  if (!tree || !tree->hasModel()) return 0;
+
+  String json = tree->serialize();
+  uint32_t hash = 2166136261UL;
+  for (unsigned int i = 0; i < json.length(); i++) {
+    hash ^= (uint8_t)json[i];
+    hash *= 16777619UL;
+  }
+  return hash;
+}
+
+bool mlCodegen_writeHeader(DecisionTree* tree, const char* path) {
+  if (!tree || !tree->hasModel()) {
+    Serial.println("[CODEGEN] Fout: geen model om te compileren");
+    return false;
+  }
+
+  // Genereer uit het model zoals het op SD staat (drempels op 4 decimalen),
+  // anders wijkt firmware af van model.bin na een herstart
+  DecisionTree persisted;
+  if (!persisted.deserialize(tree->serialize())) {
+    Serial.println("[CODEGEN] Fout: model serialisatie mislukt");
+    return false;
+  }
+
+  int nodes = 0;
+  int depth = 0;
+  measureTree(persisted.getRoot(), 0, nodes, depth);
+  uint32_t hash = mlCodegen_modelHash(&persisted);
+
+  if (!SD_MMC.exists("/ml_training")) {
+    SD_MMC.mkdir("/ml_training");
+  }
+
+  File file = SD_MMC.open(path, FILE_WRITE);
+  if (!file) {
+    Serial.printf("[CODEGEN] Fout: kan %s niet schrijven\n", path);
+    return false;
+  }
+
+  file.println("/*");
+  file.println("  GEGENEREERD door mlCodegen_writeHeader() - niet handmatig aanpassen");
+  file.println();
+  file.printf("  Model hash 0x%08lX, %d nodes, diepte %d\n", (unsigned long)hash, nodes, depth);
+  file.println("  Gebruik: kopieer naast Body_ESP.ino, zet AI_USE_COMPILED_MODEL op true");
+  file.println("*/");
+  file.println();
+  file.println("#pragma once");
+  file.println("#include <Arduino.h>");
+  file.println();
+  file.printf("#define ML_COMPILED_MODEL_HASH   0x%08lXUL\n", (unsigned long)hash);
+  file.printf("#define ML_COMPILED_MODEL_NODES  %d\n", nodes);
+  file.printf("#define ML_COMPILED_MODEL_DEPTH  %d\n", depth);
+  file.println();
+
+  file.println("// Genormaliseerde features (zelfde schaal als normalizeFeatures)");
+  file.println("static inline int mlCompiled_predictNormalized(const float f[9]) {");
+  writeNode(file, persisted.getRoot(), 1);
+  file.println("}");
+  file.println();
+
+  file.println("// Ruwe features [HR, Temp, GSR, Adem, Trust, SleevePos, Suction, Vibe, Time]");
+  file.println("static inline int mlCompiled_predict(const float raw[9]) {");
+  file.println("  float f[9];");
+  file.printf("  f[0] = constrain((raw[0] - %s) / %s, 0.0f, 1.0f);\n",
+              floatLiteral(ML_NORM_HR_MIN).c_str(), floatLiteral(ML_NORM_HR_RANGE).c_str());
+  file.printf("  f[1] = constrain((raw[1] - %s) / %s, 0.0f, 1.0f);\n",
+              floatLiteral(ML_NORM_TEMP_MIN).c_str(), floatLiteral(ML_NORM_TEMP_RANGE).c_str());
+  file.printf("  f[2] = constrain(raw[2] / %s, 0.0f, 1.0f);\n",
+              floatLiteral(ML_NORM_GSR_RANGE).c_str());
+  file.printf("  f[3] = constrain(raw[3] / %s, 0.0f, 1.0f);\n",
+              floatLiteral(ML_NORM_ADEM_RANGE).c_str());
+  file.println("  for (int i = 4; i < 8; i++) {");
+  file.printf("    f[i] = constrain(raw[i], 0.0f, %s) / %s;\n",
+              floatLiteral(ML_NORM_ACT_RANGE).c_str(), floatLiteral(ML_NORM_ACT_RANGE).c_str());
+  file.println("  }");
+  file.println("  f[8] = raw[8];");
+  file.println("  return mlCompiled_predictNormalized(f);");
+  file.println("}");
+
+  file.close();
+
+  Serial.printf("[CODEGEN] ✅ %s geschreven (hash 0x%08lX, %d nodes, diepte %d)\n",
+                path, (unsigned long)hash, nodes, depth);
+  return true;
+}
+
+bool mlCodegen_parityCheck(DecisionTree* tree, const char* datasetPath, ParityResult* result) {
+#if AI_USE_COMPILED_MODEL
+  if (!tree || !tree->hasModel()) {
+    Serial.println("[CODEGEN] Fout: geen interpreter model voor parity check");
+    return false;
+  }
+
+  uint32_t hash = mlCodegen_modelHash(tree);
+  if (hash != ML_COMPILED_MODEL_HASH) {
+    Serial.printf("[CODEGEN] ⚠️ Model hash verschilt: interpreter 0x%08lX, firmware 0x%08lX\n",
+                  (unsigned long)hash, (unsigned long)ML_COMPILED_MODEL_HASH);
+  }
+
+  File file = SD_MMC.open(datasetPath);
+  if (!file) {
+    Serial.printf("[CODEGEN] Fout: dataset %s niet gevonden\n", datasetPath);
+    return false;
+  }
+
+  // Skip header
+  if (file.available()) {
+    file.readStringUntil('\n');
+  }
+
+  ParityResult r = {0, 0, 0, 0};
+
+  while (file.available()) {
+    String line = file.readStringUntil('\n');
+    line.trim();
+    if (line.length() < 5) continue;
+
+    float raw[9];
+    int label;
+    if (!parseCsvLine(line, raw, label)) continue;
+
+    float normalized[9];
+    memcpy(normalized, raw, sizeof(normalized));
+    normalizeFeatures(normalized);
+
+    uint32_t t0 = micros();
+    int interpreted = tree->predict(normalized);
+    uint32_t t1 = micros();
+    int compiled = mlCompiled_predict(raw);
+    uint32_t t2 = micros();
+
+    r.interpreterUs += t1 - t0;
+    r.compiledUs += t2 - t1;
+    r.samples++;
+
+    if (interpreted != compiled) {
+      if (r.mismatches < 5) {
+        Serial.printf("[CODEGEN] Verschil sample %lu: interpreter %d, gecompileerd %d\n",
+                      (unsigned long)r.samples, interpreted, compiled);
+      }
+      r.mismatches++;
+    }
+  }
+  file.close();
+
+  Serial.printf("[CODEGEN] Parity %s: %lu samples, %lu verschillen, %.2f vs %.2f us/sample\n",
+                datasetPath, (unsigned long)r.samples, (unsigned long)r.mismatches,
+                r.samples ? (float)r.interpreterUs / r.samples : 0.0f,
+                r.samples ? (float)r.compiledUs / r.samples : 0.0f);
+
+  if (result) *result = r;
+  return r.samples > 0 && r.mismatches == 0;
+#else
+  (void)tree;
+  (void)datasetPath;
+  Serial.println("[CODEGEN] Parity check vereist AI_USE_COMPILED_MODEL true");
+  if (result) memset(result, 0, sizeof(ParityResult));
+  return false;
+#endif
+}
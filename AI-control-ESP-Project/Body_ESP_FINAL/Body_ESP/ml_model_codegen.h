@@ -0,0 +1,49 @@
+/*
+  ML Model Codegen - Decision tree → C++ bron voor in flash
+
+  ═══════════════════════════════════════════════════════════════════════════
+  Een gevalideerd model kan in de firmware gebakken worden in plaats van
+  bij boot JSON te parsen en een boom op de heap te bouwen:
+
+  1. mlCodegen_writeHeader() schrijft /ml_training/ml_compiled_model.h
+     (geneste if's, drempels + normalisatie constanten ingebakken)
+  2. Kopieer dat bestand naast Body_ESP.ino
+  3. Zet AI_USE_COMPILED_MODEL op true in config.h en compileer opnieuw
+
+  Op de PC doet host/ml_codegen stap 1 vanaf model.bin, en `make ml-parity`
+  bouwt de header met AI_USE_COMPILED_MODEL aan en vergelijkt hem met de
+  interpreter vóór het flashen.
+
+  Het gegenereerde model heeft geen heap, geen laadtijd en geen recursie.
+  mlCodegen_parityCheck() vergelijkt (met AI_USE_COMPILED_MODEL aan) het
+  gecompileerde model met de interpreter over een opgenomen dataset. De
+  Body draait hem na elke export en bij boot op /ml_training/parity.csv.
+  ═══════════════════════════════════════════════════════════════════════════
+*/
+
+#ifndef ML_MODEL_CODEGEN_H
+#define ML_MODEL_CODEGEN_H
+
+#include <Arduino.h>
+#include "ml_decision_tree.h"
+
+#define ML_CODEGEN_PATH   "/ml_training/ml_compiled_model.h"
+
+struct ParityResult {
+  uint32_t samples;
+  uint32_t mismatches;
+  uint32_t interpreterUs;   // Totaal over alle samples
+  uint32_t compiledUs;
+};
+
+// FNV-1a over serialize(): identificeert welk model gecompileerd is
+uint32_t mlCodegen_modelHash(DecisionTree* tree);
+
+// Schrijf C++ header voor dit model naar SD
+bool mlCodegen_writeHeader(DecisionTree* tree, const char* path = ML_CODEGEN_PATH);
+
+// Interpreter vs gecompileerd over een .aly/.csv opname (ruwe features).
+// Zonder AI_USE_COMPILED_MODEL: false (niets om mee te vergelijken)
+bool mlCodegen_parityCheck(DecisionTree* tree, const char* datasetPath, ParityResult* result = nullptr);
+
+#endif // ML_MODEL_CODEGEN_H
@@ -0,0 +1,333 @@
+/*
+  ML SHADOW MODEL - Implementatie
+
+  Kandidaat decision tree draait mee op elke AI tick, stuurt niets aan
+*/
+
+#include "ml_shadow_model.h"
+#include "ml_decision_tree.h"
+#include "advanced_stress_manager.h"  // stressLevelToSpeed
+#include <SD_MMC.h>
+
+#define SHADOW_STATE_MAGIC    0x31534853   // "SHS1"
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         STATE
+// ═══════════════════════════════════════════════════════════════════════════
+
+static DecisionTree* candidate = nullptr;
+static ShadowReport report;
+
+static uint64_t candidateUsTotal = 0;
+static uint64_t activeUsTotal = 0;
+
+static ShadowTick ring[SHADOW_RING_SIZE];
+static uint16_t ringHead = 0;     // Volgende schrijfpositie
+static uint16_t ringCount = 0;
+
+// Laatste tick, voor vergelijking met gebruiker correctie
+static int lastActiveLevel = -1;
+static int lastCandidateLevel = -1;
+
+// Hash van de kandidaat JSON: koppelt shadow_state.bin aan dit model
+static uint32_t candidateHash = 0;
+
+// Bestandsformaat shadow_state.bin
+struct ShadowStateFile {
+  uint32_t magic;
+  uint16_t size;              // sizeof(ShadowStateFile), andere build → opnieuw
+  uint16_t reserved;
+  uint32_t candidateHash;
+  uint64_t candidateUsTotal;
+  uint64_t activeUsTotal;
+  ShadowReport report;
+};
+
+static inline bool validLevel(int level) {
+  return level >= 0 && level < SHADOW_LEVELS;
+}
+
+// Model level (0-7) → speed step zoals de AI hem zou sturen
+static inline int levelToSpeedStep(int level) {
+  return stressLevelToSpeed((StressLevel)level);
+}
+
+static uint32_t hashJson(const String& json) {
+  uint32_t hash = 2166136261UL;   // FNV-1a
+  for (size_t i = 0; i < json.length(); i++) {
+    hash ^= (uint8_t)json[i];
+    hash *= 16777619UL;
+  }
+  return hash;
+}
+
+static bool restoreState(const char* path) {
+  File file = SD_MMC.open(path, FILE_READ);
+  if (!file) return false;
+  ShadowStateFile state;
+  bool ok = file.read((uint8_t*)&state, sizeof(state)) == sizeof(state);
+  file.close();
+  if (!ok || state.magic != SHADOW_STATE_MAGIC || state.size != sizeof(state) ||
+      state.candidateHash != candidateHash) {
+    return false;
+  }
+
+  report = state.report;
+  report.candidateLoaded = true;
+  candidateUsTotal = state.candidateUsTotal;
+  activeUsTotal = state.activeUsTotal;
+  return true;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         KANDIDAAT BEHEER
+// ═══════════════════════════════════════════════════════════════════════════
+
+void mlShadow_reset() {
+  bool loaded = report.candidateLoaded;
+  memset(&report, 0, sizeof(report));
+  report.candidateLoaded = loaded;
+
+  candidateUsTotal = 0;
+  activeUsTotal = 0;
+  ringHead = 0;
+  ringCount = 0;
+  lastActiveLevel = -1;
+  lastCandidateLevel = -1;
+}
+
+bool mlShadow_loadCandidate(const char* path) {
+  File file = SD_MMC.open(path, FILE_READ);
+  if (!file) {
+    Serial.printf("[SHADOW] Geen kandidaat model: %s\n", path);
+    return false;
+  }
+
+  String json = file.readString();
+  file.close();
+
+  DecisionTree* tree = new DecisionTree();
+  if (!tree->deserialize(json) || !tree->hasModel()) {
+    Serial.printf("[SHADOW] ❌ Kandidaat ongeldig: %s\n", path);
+    delete tree;
+    return false;
+  }
+
+  mlShadow_unloadCandidate();
+  candidate = tree;
+  candidateHash = hashJson(json);
+  report.candidateLoaded = true;
+  mlShadow_reset();
+
+  Serial.printf("[SHADOW] ✅ Kandidaat geladen (%d bytes) - shadow mode actief\n", json.length());
+  if (restoreState(SHADOW_STATE_PATH)) {
+    Serial.printf("[SHADOW] Tellers hersteld: %u ticks, %u correcties\n",
+                  report.ticks, report.userOverrides);
+  }
+  return true;
+}
+
+void mlShadow_unloadCandidate() {
+  if (candidate) {
+    delete candidate;
+    candidate = nullptr;
+  }
+  report.candidateLoaded = false;
+}
+
+bool mlShadow_hasCandidate() {
+  return candidate != nullptr;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         METEN
+// ═══════════════════════════════════════════════════════════════════════════
+
+void mlShadow_observe(const float rawFeatures[9], int activeLevel, uint32_t activeUs) {
+  if (!candidate || !validLevel(activeLevel)) return;
+
+  // Zelfde normalisatie als bij training (TrainingConfig.normalizeFeatures)
+  float features[9];
+  memcpy(features, rawFeatures, sizeof(features));
+  normalizeFeatures(features);
+
+  uint32_t startUs = micros();
+  int label = candidate->predict(features);
+  uint32_t candidateUs = micros() - startUs;
+
+  int candidateLevel = constrain(label - 1, 0, SHADOW_LEVELS - 1);  // 1-7 → 0-6
+
+  report.ticks++;
+  if (candidateLevel == activeLevel) report.agreements++;
+  if (report.confusionActive[activeLevel][candidateLevel] < 0xFFFF) {
+    report.confusionActive[activeLevel][candidateLevel]++;
+  }
+
+  candidateUsTotal += candidateUs;
+  activeUsTotal += activeUs;
+  if (candidateUs > report.candidateMaxUs) report.candidateMaxUs = candidateUs;
+
+  ShadowTick& tick = ring[ringHead];
+  tick.timeMs = millis();
+  tick.activeLevel = activeLevel;
+  tick.candidateLevel = candidateLevel;
+  tick.userLevel = -1;
+  tick.candidateUs = candidateUs > 0xFFFF ? 0xFFFF : candidateUs;
+  ringHead = (ringHead + 1) % SHADOW_RING_SIZE;
+  if (ringCount < SHADOW_RING_SIZE) ringCount++;
+
+  lastActiveLevel = activeLevel;
+  lastCandidateLevel = candidateLevel;
+}
+
+void mlShadow_logUserSpeedStep(int speedStep) {
+  if (!candidate || !validLevel(speedStep) || lastCandidateLevel < 0) return;
+
+  int candidateStep = levelToSpeedStep(lastCandidateLevel);
+  int activeStep = levelToSpeedStep(lastActiveLevel);
+
+  report.userOverrides++;
+  if (candidateStep == speedStep) report.candidateMatchesUser++;
+  if (activeStep == speedStep) report.activeMatchesUser++;
+  if (report.confusionUser[speedStep][candidateStep] < 0xFFFF) {
+    report.confusionUser[speedStep][candidateStep]++;
+  }
+
+  // Markeer in laatste ring entry
+  if (ringCount > 0) {
+    uint16_t last = (ringHead + SHADOW_RING_SIZE - 1) % SHADOW_RING_SIZE;
+    ring[last].userLevel = speedStep;
+  }
+
+  Serial.printf("[SHADOW] Correctie step %d: actief=%d kandidaat=%d\n",
+                speedStep, activeStep, candidateStep);
+
+  // Correcties zijn schaars: meteen vastleggen
+  mlShadow_saveState();
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         RAPPORT & PROMOTIE
+// ═══════════════════════════════════════════════════════════════════════════
+
+ShadowReport mlShadow_getReport() {
+  ShadowReport out = report;
+  if (out.ticks > 0) {
+    out.agreementRate = (float)out.agreements / out.ticks;
+    out.candidateAvgUs = (float)candidateUsTotal / out.ticks;
+    out.activeAvgUs = (float)activeUsTotal / out.ticks;
+  }
+  if (out.userOverrides > 0) {
+    out.candidateUserRate = (float)out.candidateMatchesUser / out.userOverrides;
+    out.activeUserRate = (float)out.activeMatchesUser / out.userOverrides;
+  }
+  return out;
+}
+
+ShadowVerdict mlShadow_evaluate() {
+  if (!candidate) return SHADOW_NO_CANDIDATE;
+
+  ShadowReport r = mlShadow_getReport();
+  if (r.ticks < SHADOW_MIN_TICKS || r.userOverrides < SHADOW_MIN_OVERRIDES) {
+    return SHADOW_NOT_ENOUGH_DATA;
+  }
+
+  // Gebruiker is de referentie: kandidaat moet vaker met correcties overeenkomen
+  if (r.candidateUserRate < r.activeUserRate + SHADOW_MIN_GAIN) return SHADOW_KEEP_ACTIVE;
+  if (r.candidateAvgUs > SHADOW_MAX_INFER_US) return SHADOW_KEEP_ACTIVE;
+
+  return SHADOW_PROMOTE;
+}
+
+const char* mlShadow_verdictName(ShadowVerdict verdict) {
+  switch (verdict) {
+    case SHADOW_NO_CANDIDATE:    return "Geen kandidaat";
+    case SHADOW_NOT_ENOUGH_DATA: return "Te weinig data";
+    case SHADOW_KEEP_ACTIVE:     return "Actief houden";
+    case SHADOW_PROMOTE:         return "Promoveren";
+    default:                     return "Onbekend";
+  }
+}
+
+bool mlShadow_writeSummary(const char* path) {
+  if (!candidate) return false;
+
+  if (!SD_MMC.exists("/ml_training")) {
+    SD_MMC.mkdir("/ml_training");
+  }
+
+  File file = SD_MMC.open(path, FILE_WRITE);
+  if (!file) {
+    Serial.printf("[SHADOW] ❌ Kan %s niet schrijven\n", path);
+    return false;
+  }
+
+  ShadowReport r = mlShadow_getReport();
+  ShadowVerdict verdict = mlShadow_evaluate();
+
+  file.println("# Shadow model evaluatie");
+  file.printf("Ticks: %u\n", r.ticks);
+  file.printf("Overeenstemming kandidaat/actief: %.1f%%\n", r.agreementRate * 100);
+  file.printf("Gebruiker correcties: %u\n", r.userOverrides);
+  file.printf("Kandidaat gelijk aan gebruiker: %.1f%%\n", r.candidateUserRate * 100);
+  file.printf("Actief gelijk aan gebruiker: %.1f%%\n", r.activeUserRate * 100);
+  file.printf("Inferentie kandidaat: gem %.0fus, max %uus\n", r.candidateAvgUs, r.candidateMaxUs);
+  file.printf("Inferentie actief model: gem %.0fus\n", r.activeAvgUs);
+  file.printf("Oordeel: %s\n", mlShadow_verdictName(verdict));
+
+  file.println("\n# Confusion actief (rij) x kandidaat (kolom)");
+  for (int a = 0; a < SHADOW_LEVELS; a++) {
+    for (int c = 0; c < SHADOW_LEVELS; c++) {
+      file.printf(c == 0 ? "%u" : ",%u", r.confusionActive[a][c]);
+    }
+    file.println();
+  }
+
+  file.println("\n# Confusion gebruiker (rij) x kandidaat (kolom), speed steps");
+  for (int u = 0; u < SHADOW_LEVELS; u++) {
+    for (int c = 0; c < SHADOW_LEVELS; c++) {
+      file.printf(c == 0 ? "%u" : ",%u", r.confusionUser[u][c]);
+    }
+    file.println();
+  }
+
+  file.println("\n# Laatste ticks: TimeMs,Actief,Kandidaat,GebruikerStep,KandidaatUs");
+  uint16_t start = (ringHead + SHADOW_RING_SIZE - ringCount) % SHADOW_RING_SIZE;
+  for (uint16_t i = 0; i < ringCount; i++) {
+    const ShadowTick& t = ring[(start + i) % SHADOW_RING_SIZE];
+    file.printf("%lu,%d,%d,%d,%u\n", (unsigned long)t.timeMs,
+                t.activeLevel, t.candidateLevel, t.userLevel, t.candidateUs);
+  }
+
+  file.close();
+
+  Serial.printf("[SHADOW] Samenvatting: %u ticks, %.1f%% eens, kandidaat %.0fus → %s\n",
+                r.ticks, r.agreementRate * 100, r.candidateAvgUs, mlShadow_verdictName(verdict));
+  return true;
+}
+
+bool mlShadow_saveState(const char* path) {
+  if (!candidate) return false;
+
+  if (!SD_MMC.exists("/ml_training")) {
+    SD_MMC.mkdir("/ml_training");
+  }
+
+  ShadowStateFile state;
+  memset(&state, 0, sizeof(state));
+  state.magic = SHADOW_STATE_MAGIC;
+  state.size = sizeof(state);
+  state.candidateHash = candidateHash;
+  state.candidateUsTotal = candidateUsTotal;
+  state.activeUsTotal = activeUsTotal;
+  state.report = report;
+
+  File file = SD_MMC.open(path, FILE_WRITE);
+  if (!file) {
+    Serial.printf("[SHADOW] ❌ Kan %s niet schrijven\n", path);
+    return false;
+  }
+  bool ok = file.write((const uint8_t*)&state, sizeof(state)) == sizeof(state);
+  file.close();
+  return ok;
+}
@@ -0,0 +1,111 @@
+/*
+  ML SHADOW MODEL - Kandidaat model live meten zonder dat het iets aanstuurt
+
+  ═══════════════════════════════════════════════════════════════════════════
+  Een nieuw getraind model wordt eerst als KANDIDAAT geladen
+  (/ml_training/candidate.bin). Elke AI tick krijgt het dezelfde feature
+  vector als het actieve model, maar de uitkomst gaat NERGENS heen:
+  alleen statistiek.
+
+  Gemeten:
+  - Overeenstemming kandidaat ↔ actief model (+ confusion matrix 8x8)
+  - Kandidaat ↔ gebruiker correcties (nunchuk) en actief ↔ gebruiker
+  - Inferentie tijd kandidaat (extra kosten) naast die van het actieve model
+
+  Laatste ticks staan in een ring buffer, samenvatting + ring buffer gaan
+  naar /ml_training/shadow_summary.txt. Promotie naar actief gebeurt pas
+  als mlShadow_evaluate() op basis van de metingen SHADOW_PROMOTE geeft.
+
+  De tellers overleven een reboot: mlShadow_saveState() schrijft ze naar
+  /ml_training/shadow_state.bin, mlShadow_loadCandidate() leest ze terug
+  als de hash van de kandidaat klopt. SHADOW_MIN_TICKS en
+  SHADOW_MIN_OVERRIDES mogen dus over meerdere sessies verzameld worden.
+
+  Model levels in dezelfde schaal als StressDecision.currentLevel (0-7).
+  Decision tree labels (1-7) worden net als in makeMLDecision() -1 gedaan.
+  Gebruiker correcties zijn Hooft speed steps: model levels gaan via
+  stressLevelToSpeed() (wat de AI zou sturen) naar die schaal.
+  ═══════════════════════════════════════════════════════════════════════════
+*/
+
+#ifndef ML_SHADOW_MODEL_H
+#define ML_SHADOW_MODEL_H
+
+#include <Arduino.h>
+
+#define SHADOW_CANDIDATE_PATH     "/ml_training/candidate.bin"
+#define SHADOW_SUMMARY_PATH       "/ml_training/shadow_summary.txt"
+#define SHADOW_STATE_PATH         "/ml_training/shadow_state.bin"
+#define SHADOW_RING_SIZE          120     // Laatste ticks (120 x 100ms = 12 sec)
+#define SHADOW_LEVELS             8       // Stress levels 0-7
+
+// Promotie criteria
+#define SHADOW_MIN_TICKS          3000    // Min. gemeten ticks (~5 min AI controle)
+#define SHADOW_MIN_OVERRIDES      5       // Min. gebruiker correcties om te vergelijken
+#define SHADOW_MIN_GAIN           0.05f   // Kandidaat moet 5% vaker gelijk hebben dan actief
+#define SHADOW_MAX_INFER_US       2000    // Max gemiddelde inferentie tijd kandidaat
+
+struct ShadowTick {
+  uint32_t timeMs;
+  int8_t activeLevel;
+  int8_t candidateLevel;
+  int8_t userLevel;           // Speed step, -1 = geen correctie in deze tick
+  uint16_t candidateUs;       // Inferentie tijd kandidaat
+};
+
+struct ShadowReport {
+  bool candidateLoaded;
+  uint32_t ticks;
+  uint32_t agreements;        // Kandidaat == actief
+  float agreementRate;
+
+  uint32_t userOverrides;
+  uint32_t candidateMatchesUser;
+  uint32_t activeMatchesUser;
+  float candidateUserRate;
+  float activeUserRate;
+
+  float candidateAvgUs;
+  uint32_t candidateMaxUs;
+  float activeAvgUs;
+
+  // [rij][kolom]: rij = referentie (actief / gebruiker), kolom = kandidaat.
+  // confusionActive in stress levels, confusionUser in speed steps
+  uint16_t confusionActive[SHADOW_LEVELS][SHADOW_LEVELS];
+  uint16_t confusionUser[SHADOW_LEVELS][SHADOW_LEVELS];
+};
+
+enum ShadowVerdict : uint8_t {
+  SHADOW_NO_CANDIDATE = 0,
+  SHADOW_NOT_ENOUGH_DATA,
+  SHADOW_KEEP_ACTIVE,         // Kandidaat niet beter of te traag
+  SHADOW_PROMOTE              // Kandidaat meetbaar beter
+};
+
+// Laad kandidaat, statistiek uit SHADOW_STATE_PATH als die bij deze
+// kandidaat hoort (anders vanaf 0). false = niet gevonden / ongeldig
+bool mlShadow_loadCandidate(const char* path = SHADOW_CANDIDATE_PATH);
+void mlShadow_unloadCandidate();
+bool mlShadow_hasCandidate();
+void mlShadow_reset();
+
+// Elke AI tick: ruwe features [HR, Temp, GSR, Adem, Trust, SleevePos,
+// Suction, Vibe, Time] + wat het actieve model op dezelfde features zegt
+// (mlIntegration_predictActive) en hoe lang dat duurde. -1 = geen actief model
+void mlShadow_observe(const float rawFeatures[9], int activeLevel, uint32_t activeUs);
+
+// Gebruiker correctie (nunchuk): nieuwe Hooft speed step (0-7), vergeleken
+// met stressLevelToSpeed() van de laatste tick
+void mlShadow_logUserSpeedStep(int speedStep);
+
+ShadowReport mlShadow_getReport();
+ShadowVerdict mlShadow_evaluate();
+const char* mlShadow_verdictName(ShadowVerdict verdict);
+
+// Schrijf samenvatting + ring buffer naar SD
+bool mlShadow_writeSummary(const char* path = SHADOW_SUMMARY_PATH);
+
+// Tellers naar SD (zonder ring buffer), terug bij de volgende loadCandidate
+bool mlShadow_saveState(const char* path = SHADOW_STATE_PATH);
+
+#endif // ML_SHADOW_MODEL_H
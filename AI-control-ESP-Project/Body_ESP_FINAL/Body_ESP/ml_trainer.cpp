@@ -13,7 +13,7 @@ MLTrainer mlTrainer;
 
 // ===== Constructor / Destructor =====
 
-MLTrainer::MLTrainer() {
+MLTrainer::MLTrainer() : dataNormalized(false) {
   model = new DecisionTree(config.maxDepth, config.minSamplesLeaf);
 }
 
@@ -29,16 +29,33 @@ MLTrainer::~MLTrainer() {
 bool MLTrainer::loadAlyFile(const char* filename) {
   Serial.printf("[TRAINER] Laden .aly bestand: %s\n", filename);
   
+  // Normalisatie gebeurt bij het laden: alles in trainingData moet dezelfde
+  // vorm hebben, dus geen mix na een wijziging van normalizeFeatures
+  if (!trainingData.empty() && dataNormalized != config.normalizeFeatures) {
+    Serial.println("[TRAINER] Fout: normalizeFeatures gewijzigd, eerst clearData()");
+    return false;
+  }
+  
   std::vector<TrainingSample> samples;
-  DatasetStats stats;
   
-  if (!parseAlyFile(filename, samples, stats)) {
-    Serial.println("[TRAINER] Fout: kan bestand niet laden");
-    return false;
+  if (config.normalizeFeatures) {
+    // Binaire cache: alleen opnieuw parsen als het bestand gewijzigd is
+    // (feature store levert de samples al genormaliseerd)
+    if (!featureStore_load(filename, samples)) {
+      Serial.println("[TRAINER] Fout: kan bestand niet laden");
+      return false;
+    }
+  } else {
+    DatasetStats stats;
+    if (!parseAlyFile(filename, samples, stats)) {
+      Serial.println("[TRAINER] Fout: kan bestand niet laden");
+      return false;
+    }
   }
   
   // Voeg samples toe aan training data
   trainingData.insert(trainingData.end(), samples.begin(), samples.end());
+  dataNormalized = config.normalizeFeatures;
   
   Serial.printf("[TRAINER] Geladen: %d samples (totaal nu: %d)\n", 
                 samples.size(), trainingData.size());
@@ -61,6 +78,7 @@ bool MLTrainer::loadMultipleAlyFiles(const char** filenames, int count) {
 void MLTrainer::clearData() {
   trainingData.clear();
   validationData.clear();
+  dataNormalized = false;
   Serial.println("[TRAINER] Training data gewist");
 }
 
@@ -91,15 +109,14 @@ bool MLTrainer::startTraining() {
   Serial.printf("[TRAINER] Training: %d, Validation: %d\n", 
                 trainingData.size(), validationData.size());
   
-  // Normaliseer features indien gewenst
-  if (config.normalizeFeatures) {
-    status.currentPhase = "Normaliseren";
-    for (auto& sample : trainingData) {
-      normalizeFeatures(sample.features);
-    }
-    for (auto& sample : validationData) {
-      normalizeFeatures(sample.features);
-    }
+  // Features zijn bij het laden al genormaliseerd (loadAlyFile); config
+  // daarna gewijzigd → model zou op de verkeerde schaal trainen
+  if (dataNormalized != config.normalizeFeatures) {
+    Serial.println("[TRAINER] Fout: normalizeFeatures gewijzigd na het laden");
+    status.isTraining = false;
+    status.hasError = true;
+    status.errorMessage = "Data opnieuw laden";
+    return false;
   }
   
   // Train model
@@ -174,6 +191,39 @@ float MLTrainer::evaluateModel(const std::vector<TrainingSample>& testData) {
   return (float)correct / testData.size();
 }
 
+float MLTrainer::evaluateFile(const char* filename) {
+  if (!model || !model->hasModel()) {
+    return 0.0f;
+  }
+  
+  // Feature store bevat alleen genormaliseerde features
+  if (!config.normalizeFeatures) {
+    Serial.println("[TRAINER] evaluateFile vereist normalizeFeatures");
+    return 0.0f;
+  }
+  
+  FeatureStoreReader reader;
+  if (!reader.open(filename)) {
+    Serial.printf("[TRAINER] Fout: kan %s niet evalueren\n", filename);
+    return 0.0f;
+  }
+  
+  int correct = 0;
+  int total = 0;
+  TrainingSample sample;
+  
+  while (reader.next(sample)) {
+    if (sample.label < 1) continue;  // Ongelabeld
+    if (model->predict(sample.features) == sample.label) {
+      correct++;
+    }
+    total++;
+  }
+  reader.close();
+  
+  return total > 0 ? (float)correct / total : 0.0f;
+}
+
 // ===== Model Management =====
 
 bool MLTrainer::saveModel(const char* filename) {
@@ -202,6 +252,12 @@ bool MLTrainer::saveModel(const char* filename) {
   return true;
 }
 
+void MLTrainer::adoptModel(DecisionTree* tree) {
+  if (!tree || tree == model) return;
+  delete model;
+  model = tree;
+}
+
 bool MLTrainer::loadModel(const char* filename) {
   Serial.printf("[TRAINER] Laden model van: %s\n", filename);
   
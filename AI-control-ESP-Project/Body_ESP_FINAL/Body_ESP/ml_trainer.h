@@ -4,6 +4,7 @@
   Integreert:
   - Decision Tree (ID3)
   - Data parsing (.aly / .csv)
+  - Binaire feature cache (ml_feature_store)
   - Model save/load (SD kaart)
   - Training progress tracking
   - AI-assisted annotation
@@ -16,6 +17,7 @@
 #include <vector>
 #include "ml_decision_tree.h"
 #include "ml_data_parser.h"
+#include "ml_feature_store.h"
 
 // ===== Training Configuration =====
 
@@ -55,6 +57,7 @@ private:
   
   std::vector<TrainingSample> trainingData;
   std::vector<TrainingSample> validationData;
+  bool dataNormalized;       // Vorm van trainingData: normalizeFeatures bij het laden
   
   // Helper functions
   void splitTrainValidation(const std::vector<TrainingSample>& allData, float validationRatio = 0.2f);
@@ -73,6 +76,9 @@ public:
   bool loadMultipleAlyFiles(const char** filenames, int count);
   void clearData();
   
+  // Evaluatie direct vanuit feature store (streaming, geen vector)
+  float evaluateFile(const char* filename);
+  
   // Training
   bool startTraining();
   void stopTraining();
@@ -82,6 +88,7 @@ public:
   bool saveModel(const char* filename);
   bool loadModel(const char* filename);
   DecisionTree* getModel() { return model; }
+  void adoptModel(DecisionTree* tree);   // Neemt eigendom over, oud model weg
   bool hasModel() { return model && model->hasModel(); }
   
   // Prediction (voor AI annotation)
@@ -935,6 +935,14 @@ bool mlTraining_loadModel(const String& filename) {
   
   if (mlTrainer.loadModel(fullPath.c_str())) {
     Serial.println("[ML TRAINING] Model loaded successfully");
+    
+    // Accuracy op de geselecteerde opname, streaming uit de feature store
+    if (selectedFileIndex >= 0) {
+      const char* dataPath = fileList[selectedFileIndex].fullPath.c_str();
+      trainingProgress.currentAccuracy = mlTrainer.evaluateFile(dataPath);
+      Serial.printf("[ML TRAINING] Accuracy op %s: %.1f%%\n", dataPath,
+                    trainingProgress.currentAccuracy * 100);
+    }
     return true;
   }
   
@@ -0,0 +1,315 @@
+/*
+  ML WINDOW FEATURES - Implementatie
+
+  Slot ringen per window, incrementele sommen + monotone min/max deques
+*/
+
+#include "ml_window_features.h"
+#include "ml_decision_tree.h"
+
+static const MLWindowConfig WINDOW_CONFIGS[MLWF_WINDOWS] = {
+  { "5s",     5000,  20 },   // 250ms slots
+  { "30s",   30000,  30 },   // 1s slots
+  { "120s", 120000,  60 }    // 2s slots
+};
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         STATE
+// ═══════════════════════════════════════════════════════════════════════════
+
+struct ChannelRing {
+  float* values;          // [slots], index = seq % slots
+  uint32_t* minDq;        // Seq nummers, oplopende waarden
+  uint32_t* maxDq;        // Seq nummers, aflopende waarden
+  uint16_t minHead, minSize;
+  uint16_t maxHead, maxSize;
+
+  // x = 0 voor oudste slot
+  float sy, syy, sxy;
+
+  float bucketSum;
+  float lastValue;
+};
+
+struct WindowState {
+  uint8_t* block;         // Eén allocatie voor alle kanalen
+  bool inPsram;
+  uint32_t bucketStartMs;
+  uint16_t bucketCount;   // Samples in open slot
+  bool hasValue;          // Ooit een slot gevuld
+  uint32_t seq;           // Volgende slot nummer
+  uint16_t count;         // Gevulde slots (max slots)
+  uint16_t sinceResync;
+  ChannelRing ch[MLWF_CHANNELS];
+
+  uint32_t updates;
+  uint64_t updateUsTotal;
+  uint32_t updateUsMax;
+};
+
+static WindowState windows[MLWF_WINDOWS];
+static bool initialized = false;
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         RING OPERATIES
+// ═══════════════════════════════════════════════════════════════════════════
+
+static inline uint16_t dqIndex(uint16_t head, uint16_t i, uint16_t n) {
+  return (head + i) % n;
+}
+
+// Volledige herberekening tegen float drift (1x per window rondgang)
+static void resyncSums(WindowState& w, uint16_t n) {
+  uint32_t oldest = w.seq - w.count;
+  for (uint8_t c = 0; c < MLWF_CHANNELS; c++) {
+    ChannelRing& r = w.ch[c];
+    r.sy = r.syy = r.sxy = 0;
+    for (uint16_t i = 0; i < w.count; i++) {
+      float y = r.values[(oldest + i) % n];
+      r.sy += y;
+      r.syy += y * y;
+      r.sxy += i * y;
+    }
+  }
+  w.sinceResync = 0;
+}
+
+static void pushSlot(WindowState& w, uint16_t n, uint8_t c, float v) {
+  ChannelRing& r = w.ch[c];
+  uint32_t s = w.seq;
+  bool full = (w.count == n);
+
+  // Verlopen seq uit de deques (alleen de voorste kan verlopen zijn)
+  if (s >= n) {
+    uint32_t expired = s - n;
+    if (r.minSize > 0 && r.minDq[r.minHead] <= expired) {
+      r.minHead = (r.minHead + 1) % n;
+      r.minSize--;
+    }
+    if (r.maxSize > 0 && r.maxDq[r.maxHead] <= expired) {
+      r.maxHead = (r.maxHead + 1) % n;
+      r.maxSize--;
+    }
+  }
+
+  // Incrementele sommen
+  if (full) {
+    float old = r.values[s % n];
+    r.sxy = r.sxy - (r.sy - old) + (n - 1) * v;
+    r.sy = r.sy - old + v;
+    r.syy = r.syy - old * old + v * v;
+  } else {
+    r.sxy += w.count * v;
+    r.sy += v;
+    r.syy += v * v;
+  }
+  r.values[s % n] = v;
+
+  // Monotone deques
+  while (r.minSize > 0 && r.values[r.minDq[dqIndex(r.minHead, r.minSize - 1, n)] % n] >= v) {
+    r.minSize--;
+  }
+  r.minDq[dqIndex(r.minHead, r.minSize, n)] = s;
+  r.minSize++;
+
+  while (r.maxSize > 0 && r.values[r.maxDq[dqIndex(r.maxHead, r.maxSize - 1, n)] % n] <= v) {
+    r.maxSize--;
+  }
+  r.maxDq[dqIndex(r.maxHead, r.maxSize, n)] = s;
+  r.maxSize++;
+
+  r.lastValue = v;
+}
+
+static void closeSlot(WindowState& w, uint16_t n) {
+  if (w.bucketCount == 0 && !w.hasValue) return;  // Nog nooit data
+
+  for (uint8_t c = 0; c < MLWF_CHANNELS; c++) {
+    ChannelRing& r = w.ch[c];
+    // Leeg slot (loop haperde) → laatste waarde vasthouden
+    float v = (w.bucketCount > 0) ? r.bucketSum / w.bucketCount : r.lastValue;
+    pushSlot(w, n, c, v);
+    r.bucketSum = 0;
+  }
+
+  w.hasValue = true;
+  w.bucketCount = 0;
+  w.seq++;
+  if (w.count < n) w.count++;
+
+  if (++w.sinceResync >= n) {
+    resyncSums(w, n);
+  }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         PUBLIC API
+// ═══════════════════════════════════════════════════════════════════════════
+
+bool mlWindows_begin() {
+  if (initialized) return true;
+
+  for (uint8_t wi = 0; wi < MLWF_WINDOWS; wi++) {
+    WindowState& w = windows[wi];
+    uint16_t n = WINDOW_CONFIGS[wi].slots;
+    size_t perChannel = n * (sizeof(float) + 2 * sizeof(uint32_t));
+    size_t bytes = perChannel * MLWF_CHANNELS;
+
+    w.block = (uint8_t*)ps_malloc(bytes);
+    w.inPsram = (w.block != nullptr);
+    if (!w.block) {
+      w.block = (uint8_t*)malloc(bytes);
+    }
+    if (!w.block) {
+      Serial.printf("[MLWF] ❌ Geen geheugen voor window %s (%u bytes)\n",
+                    WINDOW_CONFIGS[wi].name, (unsigned)bytes);
+      return false;
+    }
+
+    uint8_t* p = w.block;
+    for (uint8_t c = 0; c < MLWF_CHANNELS; c++) {
+      w.ch[c].values = (float*)p;       p += n * sizeof(float);
+      w.ch[c].minDq = (uint32_t*)p;     p += n * sizeof(uint32_t);
+      w.ch[c].maxDq = (uint32_t*)p;     p += n * sizeof(uint32_t);
+    }
+  }
+
+  initialized = true;
+  mlWindows_reset();
+  mlWindows_printBudget();
+  return true;
+}
+
+void mlWindows_reset() {
+  for (uint8_t wi = 0; wi < MLWF_WINDOWS; wi++) {
+    WindowState& w = windows[wi];
+    w.bucketStartMs = 0;
+    w.bucketCount = 0;
+    w.hasValue = false;
+    w.seq = 0;
+    w.count = 0;
+    w.sinceResync = 0;
+    w.updates = 0;
+    w.updateUsTotal = 0;
+    w.updateUsMax = 0;
+    for (uint8_t c = 0; c < MLWF_CHANNELS; c++) {
+      ChannelRing& r = w.ch[c];
+      r.minHead = r.minSize = 0;
+      r.maxHead = r.maxSize = 0;
+      r.sy = r.syy = r.sxy = 0;
+      r.bucketSum = 0;
+      r.lastValue = 0;
+    }
+  }
+}
+
+void mlWindows_addSample(float heartRate, float temperature, float gsr, float breath) {
+  if (!initialized) return;
+
+  float v[MLWF_CHANNELS] = {
+    normalizeHR(heartRate),
+    normalizeTemp(temperature),
+    normalizeGSR(gsr),
+    normalizeAdem(breath)
+  };
+
+  uint32_t now = millis();
+
+  for (uint8_t wi = 0; wi < MLWF_WINDOWS; wi++) {
+    uint32_t startUs = micros();
+    WindowState& w = windows[wi];
+    const MLWindowConfig& cfg = WINDOW_CONFIGS[wi];
+    uint32_t slotMs = cfg.windowMs / cfg.slots;
+
+    if (w.bucketStartMs == 0) w.bucketStartMs = now;
+
+    // Verstreken slots sluiten (begrensd: lange stilte = max 1 rondgang)
+    uint16_t closed = 0;
+    while (now - w.bucketStartMs >= slotMs) {
+      closeSlot(w, cfg.slots);
+      w.bucketStartMs += slotMs;
+      if (++closed >= cfg.slots) {
+        w.bucketStartMs = now;
+        break;
+      }
+    }
+
+    for (uint8_t c = 0; c < MLWF_CHANNELS; c++) {
+      w.ch[c].bucketSum += v[c];
+    }
+    w.bucketCount++;
+
+    uint32_t us = micros() - startUs;
+    w.updates++;
+    w.updateUsTotal += us;
+    if (us > w.updateUsMax) w.updateUsMax = us;
+  }
+}
+
+MLWindowStats mlWindows_getStats(uint8_t window, MLWFChannel channel) {
+  MLWindowStats st = {0, 0, 0, 0, 0, 0};
+  if (!initialized || window >= MLWF_WINDOWS || channel >= MLWF_CHANNELS) return st;
+
+  const WindowState& w = windows[window];
+  const ChannelRing& r = w.ch[channel];
+  uint16_t n = WINDOW_CONFIGS[window].slots;
+  uint16_t cnt = w.count;
+  if (cnt == 0) return st;
+
+  st.count = cnt;
+  st.mean = r.sy / cnt;
+  st.std = sqrtf(max(0.0f, r.syy / cnt - st.mean * st.mean));
+  st.min = r.values[r.minDq[r.minHead] % n];
+  st.max = r.values[r.maxDq[r.maxHead] % n];
+
+  if (cnt >= 3) {
+    float fn = cnt;
+    float sx = fn * (fn - 1) / 2.0f;
+    float sxx = (fn - 1) * fn * (2 * fn - 1) / 6.0f;
+    float den = fn * sxx - sx * sx;
+    if (den > 0) {
+      float slopePerSlot = (fn * r.sxy - sx * r.sy) / den;
+      float slotSec = (WINDOW_CONFIGS[window].windowMs / n) / 1000.0f;
+      st.slope = slopePerSlot / slotSec;
+    }
+  }
+  return st;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         BUDGET RAPPORT
+// ═══════════════════════════════════════════════════════════════════════════
+
+const MLWindowConfig& mlWindows_getConfig(uint8_t window) {
+  return WINDOW_CONFIGS[window < MLWF_WINDOWS ? window : 0];
+}
+
+MLWindowBudget mlWindows_getBudget(uint8_t window) {
+  MLWindowBudget b = {0, false, 0, 0, 0};
+  if (window >= MLWF_WINDOWS) return b;
+
+  const MLWindowConfig& cfg = WINDOW_CONFIGS[window];
+  const WindowState& w = windows[window];
+  b.bytes = cfg.slots * (sizeof(float) + 2 * sizeof(uint32_t)) * MLWF_CHANNELS;
+  b.inPsram = w.inPsram;
+  b.slotMs = cfg.windowMs / cfg.slots;
+  b.avgUpdateUs = w.updates > 0 ? (uint32_t)(w.updateUsTotal / w.updates) : 0;
+  b.maxUpdateUs = w.updateUsMax;
+  return b;
+}
+
+void mlWindows_printBudget() {
+  Serial.println("[MLWF] ───── Window ── slots ── slot ──── bytes ─ geheugen ── avg/max us");
+  uint32_t totalBytes = 0;
+  for (uint8_t wi = 0; wi < MLWF_WINDOWS; wi++) {
+    MLWindowBudget b = mlWindows_getBudget(wi);
+    totalBytes += b.bytes;
+    Serial.printf("[MLWF] %-10s %6u %5lums %8lu   %-8s %5lu/%lu\n",
+                  WINDOW_CONFIGS[wi].name, WINDOW_CONFIGS[wi].slots,
+                  (unsigned long)b.slotMs, (unsigned long)b.bytes,
+                  b.inPsram ? "PSRAM" : "heap",
+                  (unsigned long)b.avgUpdateUs, (unsigned long)b.maxUpdateUs);
+  }
+  Serial.printf("[MLWF] Totaal %lu bytes, %d stats\n",
+                (unsigned long)totalBytes, MLWF_WINDOWS * MLWF_CHANNELS * MLWF_STATS);
+}
@@ -0,0 +1,87 @@
+/*
+  ML WINDOW FEATURES - Tijd-gebaseerde multi-schaal features per sensor kanaal
+
+  ═══════════════════════════════════════════════════════════════════════════
+  extractFeatures() kijkt naar de laatste 30 SAMPLES en biometricHistory[10]
+  naar de laatste 10 update() calls: de betekenis verschuift mee met de loop
+  snelheid. Deze engine werkt op TIJD:
+
+  - Per window (5s / 30s / 120s) een vast aantal slots van windowMs / slots
+  - Samples binnen een slot worden gemiddeld, lege slots houden laatste waarde
+  - Per kanaal (HR, Temp, GSR, Adem) per window incrementeel bijgehouden:
+      mean, std, slope (per sec), min, max
+    Sommen O(1) per slot, min/max via monotone deque (amortized O(1))
+  - Ring buffers in PSRAM (ps_malloc), fallback naar interne heap
+
+  Waarden zijn genormaliseerd zoals normalizeFeatures() (0-1).
+
+  Nog GEEN tree features: TrainingSample, de feature store en de
+  gecompileerde modellen zijn vast 9 breed, en opnames bevatten geen
+  window waarden om op te trainen. Daarom niet aangesloten in
+  Body_ESP.ino (geen PSRAM, geen werk per tick). Aansluiten: include,
+  mlWindows_begin() in setup() en mlWindows_addSample() naast
+  changePoint_update(), uitlezen per window/kanaal via mlWindows_getStats().
+  ═══════════════════════════════════════════════════════════════════════════
+*/
+
+#ifndef ML_WINDOW_FEATURES_H
+#define ML_WINDOW_FEATURES_H
+
+#include <Arduino.h>
+
+#define MLWF_CHANNELS         4       // HR, Temp, GSR, Adem
+#define MLWF_WINDOWS          3       // 5s, 30s, 120s
+#define MLWF_STATS            5       // mean, std, slope, min, max
+
+enum MLWFChannel : uint8_t {
+  MLWF_HR = 0,
+  MLWF_TEMP,
+  MLWF_GSR,
+  MLWF_ADEM
+};
+
+enum MLWFStat : uint8_t {
+  MLWF_MEAN = 0,
+  MLWF_STD,
+  MLWF_SLOPE,       // Genormaliseerde eenheden per seconde
+  MLWF_MIN,
+  MLWF_MAX
+};
+
+struct MLWindowConfig {
+  const char* name;
+  uint32_t windowMs;
+  uint16_t slots;
+};
+
+struct MLWindowStats {
+  uint16_t count;   // Gevulde slots
+  float mean;
+  float std;
+  float slope;
+  float min;
+  float max;
+};
+
+struct MLWindowBudget {
+  uint32_t bytes;           // Ring + deques, alle kanalen
+  bool inPsram;
+  uint32_t slotMs;
+  uint32_t avgUpdateUs;     // Gemiddeld per addSample (alle windows samen)
+  uint32_t maxUpdateUs;
+};
+
+// Alloceer ring buffers (eenmalig in setup)
+bool mlWindows_begin();
+void mlWindows_reset();
+
+// Elke sensor tick, ruwe waarden (normalisatie gebeurt intern)
+void mlWindows_addSample(float heartRate, float temperature, float gsr, float breath);
+
+MLWindowStats mlWindows_getStats(uint8_t window, MLWFChannel channel);
+
+const MLWindowConfig& mlWindows_getConfig(uint8_t window);
+MLWindowBudget mlWindows_getBudget(uint8_t window);
+void mlWindows_printBudget();
+
+#endif // ML_WINDOW_FEATURES_H
@@ -7,6 +7,7 @@
 
 #include "multifunplayer_client.h"
 #include "body_config.h"
+#include "espnow_protocol.h"
 
 // Global instance
 MultiFunPlayerClient mfpClient;
@@ -288,15 +289,15 @@ void MultiFunPlayerClient::executeAction(const MLEnhancedAction& action) {
   
   // Stuur ESP-NOW bericht naar HoofdESP
   // Gebruik extern gedeclareerde functie uit Body_ESP.ino
-  extern void sendESPNowMessage(float trust, float sleeve, bool overrule, 
-                                const char* cmd, uint8_t stressLvl, 
+  extern bool sendESPNowMessage(float trust, float sleeve, bool overrule, 
+                                uint8_t opcode, uint8_t stressLvl, 
                                 bool vibe, bool zuig);
   
   sendESPNowMessage(
     trustValue,           // Trust speed berekend uit ML speed
     sleeveValue,         // Sleeve speed berekend uit ML positie
     true,                // Overrule actief (Funscript neemt over)
-    "FUNSCRIPT_ACTION",  // Command type
+    ESPNOW_OP_FUNSCRIPT_ACTION,  // Opcode
     0,                   // Stress level (niet gebruikt in funscript mode)
     action.vibeActive,   // Vibe status van ML
     action.suctionActive // Suction status van ML
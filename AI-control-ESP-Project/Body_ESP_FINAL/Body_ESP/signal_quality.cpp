@@ -0,0 +1,287 @@
+/*
+  SIGNAL QUALITY - Implementatie
+
+  Bereik / clipping / vlak / spike per kanaal, PPG template correlatie per beat
+*/
+
+#include "signal_quality.h"
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         CONFIG PER KANAAL
+// ═══════════════════════════════════════════════════════════════════════════
+
+struct SQLimits {
+  float minVolts;         // Daaronder: los / kortsluiting naar GND
+  float maxVolts;         // Daarboven: tegen VDD
+  int16_t flatDelta;      // |Δraw| <= dit telt als "beweegt niet"
+  float spikeMinDelta;    // Spike moet ook absoluut groot zijn (ADC counts)
+};
+
+static const SQLimits LIMITS[SQ_CHANNELS] = {
+  { 0.02f, 3.25f, 1,  400.0f },   // GSR
+  { 0.20f, 3.20f, 1,  400.0f },   // Flex
+  { 0.02f, 3.25f, 2,  800.0f },   // Pulse
+  { 0.10f, 3.20f, 0,  200.0f }    // NTC (ADC ruis hoort er altijd te zijn)
+};
+
+static const char* CHANNEL_NAMES[SQ_CHANNELS] = { "GSR", "Adem", "Pulse", "NTC" };
+
+// Plausibel bereik van de verwerkte waarden
+#define SQ_BPM_MIN            40
+#define SQ_BPM_MAX            180
+#define SQ_TEMP_MIN           28.0f   // Losse NTC meet kamertemperatuur
+#define SQ_TEMP_MAX           42.0f
+#define SQ_DELTA_ALPHA        0.05f
+#define SQ_DELTA_WARMUP       10
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         STATE
+// ═══════════════════════════════════════════════════════════════════════════
+
+struct SQState {
+  int16_t lastRaw;
+  float avgDelta;         // EWMA van |Δraw|
+  uint16_t samples;
+  uint16_t flatCount;
+  uint8_t spikeHold;
+  uint8_t flags;
+  uint8_t sqi;
+  float lastGood;
+  bool hasGood;
+};
+
+static SQState channels[SQ_CHANNELS];
+
+// PPG template
+static int16_t beatBuf[SQ_PPG_MAX_SAMPLES];
+static uint8_t beatLen = 0;
+static bool beatOverflow = false;
+static bool lastBeat = false;
+static float ppgTemplate[SQ_PPG_TEMPLATE_LEN];
+static uint8_t templateBeats = 0;
+static float ppgCorr = 0.0f;
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         PPG VORM
+// ═══════════════════════════════════════════════════════════════════════════
+
+// Resample naar vaste lengte en normaliseer (gemiddelde 0, norm 1)
+static bool normalizeBeat(const int16_t* buf, uint8_t len, float out[SQ_PPG_TEMPLATE_LEN]) {
+  if (len < 4) return false;
+
+  float mean = 0.0f;
+  for (int i = 0; i < SQ_PPG_TEMPLATE_LEN; i++) {
+    float pos = i * (len - 1) / (float)(SQ_PPG_TEMPLATE_LEN - 1);
+    int idx = (int)pos;
+    float frac = pos - idx;
+    float next = (idx + 1 < len) ? buf[idx + 1] : buf[idx];
+    out[i] = buf[idx] + frac * (next - buf[idx]);
+    mean += out[i];
+  }
+  mean /= SQ_PPG_TEMPLATE_LEN;
+
+  float norm = 0.0f;
+  for (int i = 0; i < SQ_PPG_TEMPLATE_LEN; i++) {
+    out[i] -= mean;
+    norm += out[i] * out[i];
+  }
+  if (norm < 1.0f) return false;   // Geen amplitude = geen vorm
+
+  norm = sqrtf(norm);
+  for (int i = 0; i < SQ_PPG_TEMPLATE_LEN; i++) {
+    out[i] /= norm;
+  }
+  return true;
+}
+
+static void onBeat() {
+  float beat[SQ_PPG_TEMPLATE_LEN];
+
+  if (beatOverflow || !normalizeBeat(beatBuf, beatLen, beat)) {
+    ppgCorr = 0.0f;
+    return;
+  }
+
+  if (templateBeats == 0) {
+    memcpy(ppgTemplate, beat, sizeof(ppgTemplate));
+    templateBeats = 1;
+    ppgCorr = 1.0f;
+    return;
+  }
+
+  // Beide genormaliseerd: inproduct = Pearson r
+  float r = 0.0f;
+  for (int i = 0; i < SQ_PPG_TEMPLATE_LEN; i++) {
+    r += beat[i] * ppgTemplate[i];
+  }
+  ppgCorr = r;
+
+  // Template alleen met goede beats bijwerken (eerste paar altijd)
+  if (r > 0.5f || templateBeats < 3) {
+    float norm = 0.0f;
+    for (int i = 0; i < SQ_PPG_TEMPLATE_LEN; i++) {
+      ppgTemplate[i] = 0.8f * ppgTemplate[i] + 0.2f * beat[i];
+      norm += ppgTemplate[i] * ppgTemplate[i];
+    }
+    norm = sqrtf(norm);
+    if (norm > 0.0f) {
+      for (int i = 0; i < SQ_PPG_TEMPLATE_LEN; i++) {
+        ppgTemplate[i] /= norm;
+      }
+    }
+    if (templateBeats < 255) templateBeats++;
+  }
+}
+
+static void updatePulseShape(const ADS1115_SensorData& data) {
+  // Nieuwe beat (stijgende flank) → vorige beat afsluiten
+  if (data.beatDetected && !lastBeat) {
+    onBeat();
+    beatLen = 0;
+    beatOverflow = false;
+  }
+  lastBeat = data.beatDetected;
+
+  if (beatLen < SQ_PPG_MAX_SAMPLES) {
+    beatBuf[beatLen++] = data.pulseRaw;
+  } else {
+    beatOverflow = true;
+    ppgCorr = 0.0f;   // Te lang geen beat
+  }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         PER KANAAL
+// ═══════════════════════════════════════════════════════════════════════════
+
+static uint8_t updateChannel(SQChannel ch, int16_t raw, float volts, bool inRange) {
+  SQState& s = channels[ch];
+  const SQLimits& lim = LIMITS[ch];
+  uint8_t flags = 0;
+
+  if (!inRange) flags |= SQ_FLAG_RANGE;
+  if (volts <= lim.minVolts || volts >= lim.maxVolts) flags |= SQ_FLAG_CLIP;
+
+  if (s.samples > 0) {
+    float delta = abs(raw - s.lastRaw);
+
+    // Vlak
+    if (delta <= lim.flatDelta) {
+      if (s.flatCount < 0xFFFF) s.flatCount++;
+    } else {
+      s.flatCount = 0;
+    }
+
+    // Spike: groot t.o.v. normale beweging én absoluut groot
+    bool spike = s.samples > SQ_DELTA_WARMUP &&
+                 delta > SQ_SPIKE_FACTOR * s.avgDelta &&
+                 delta > lim.spikeMinDelta;
+    if (spike) {
+      s.spikeHold = SQ_SPIKE_HOLD;
+    } else {
+      s.avgDelta += SQ_DELTA_ALPHA * (delta - s.avgDelta);   // Spikes niet meetellen
+    }
+  }
+  s.lastRaw = raw;
+  if (s.samples < 0xFFFF) s.samples++;
+
+  if (s.flatCount >= SQ_FLAT_SAMPLES) flags |= SQ_FLAG_FLAT;
+  if (s.spikeHold > 0) {
+    flags |= SQ_FLAG_SPIKE;
+    s.spikeHold--;
+  }
+
+  uint8_t sqi = 100;
+  if (flags & (SQ_FLAG_RANGE | SQ_FLAG_CLIP | SQ_FLAG_FLAT)) {
+    sqi = 0;
+  } else if (flags & SQ_FLAG_SPIKE) {
+    sqi = 40;
+  }
+
+  if (ch == SQ_PULSE && sqi > 0) {
+    // r 0.5 → 0, r 1.0 → 100: bij 8 punten haalt ruis makkelijk r ~0.7
+    uint8_t shapeSqi = (uint8_t)(constrain((ppgCorr - 0.5f) * 2.0f, 0.0f, 1.0f) * 100.0f);
+    if (shapeSqi < SQ_MIN_USABLE) flags |= SQ_FLAG_SHAPE;
+    sqi = min(sqi, shapeSqi);
+  }
+
+  // Alleen wisselingen loggen
+  if (flags != s.flags) {
+    if (flags) {
+      Serial.printf("[SQ] %s kwaliteit %d (%s)\n", CHANNEL_NAMES[ch], sqi,
+                    sigQuality_flagString(flags).c_str());
+    } else {
+      Serial.printf("[SQ] %s weer OK\n", CHANNEL_NAMES[ch]);
+    }
+  }
+
+  s.flags = flags;
+  s.sqi = sqi;
+  return sqi;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         PUBLIC API
+// ═══════════════════════════════════════════════════════════════════════════
+
+void sigQuality_reset() {
+  memset(channels, 0, sizeof(channels));
+  beatLen = 0;
+  beatOverflow = false;
+  lastBeat = false;
+  templateBeats = 0;
+  ppgCorr = 0.0f;
+}
+
+void sigQuality_update(ADS1115_SensorData& data) {
+  updatePulseShape(data);
+
+  bool bpmOk = data.BPM >= SQ_BPM_MIN && data.BPM <= SQ_BPM_MAX;
+  bool tempOk = data.temperature >= SQ_TEMP_MIN && data.temperature <= SQ_TEMP_MAX;
+
+  data.gsrQuality = updateChannel(SQ_GSR, data.gsrRaw, data.gsrVolts, true);
+  data.flexQuality = updateChannel(SQ_FLEX, data.flexRaw, data.flexVolts, true);
+  data.pulseQuality = updateChannel(SQ_PULSE, data.pulseRaw, data.pulseVolts, bpmOk);
+  data.ntcQuality = updateChannel(SQ_NTC, data.ntcRaw, data.ntcVolts, tempOk);
+}
+
+uint8_t sigQuality_get(SQChannel channel) {
+  return (channel < SQ_CHANNELS) ? channels[channel].sqi : 0;
+}
+
+uint8_t sigQuality_flags(SQChannel channel) {
+  return (channel < SQ_CHANNELS) ? channels[channel].flags : 0;
+}
+
+float sigQuality_ppgCorrelation() {
+  return ppgCorr;
+}
+
+uint8_t sigQuality_stressQuality() {
+  return min(channels[SQ_PULSE].sqi, min(channels[SQ_GSR].sqi, channels[SQ_NTC].sqi));
+}
+
+float sigQuality_gate(SQChannel channel, float value) {
+  if (channel >= SQ_CHANNELS) return value;
+  SQState& s = channels[channel];
+
+  if (s.sqi >= SQ_MIN_USABLE) {
+    s.lastGood = value;
+    s.hasGood = true;
+    return value;
+  }
+  return s.hasGood ? s.lastGood : value;
+}
+
+String sigQuality_flagString(uint8_t flags) {
+  if (flags == 0) return "OK";
+
+  String out = "";
+  if (flags & SQ_FLAG_RANGE) out += "BEREIK+";
+  if (flags & SQ_FLAG_CLIP)  out += "CLIP+";
+  if (flags & SQ_FLAG_FLAT)  out += "VLAK+";
+  if (flags & SQ_FLAG_SPIKE) out += "SPIKE+";
+  if (flags & SQ_FLAG_SHAPE) out += "VORM+";
+  out.remove(out.length() - 1);
+  return out;
+}
@@ -0,0 +1,74 @@
+/*
+  SIGNAL QUALITY - Artefact detectie per sensor kanaal (SQI 0-100)
+
+  ═══════════════════════════════════════════════════════════════════════════
+  Losse GSR elektroden, beweging op de pulse sensor en een losgeraakte NTC
+  gingen ongefilterd naar stressManager.update() → wilde level sprongen en
+  onnodige AI_OVERRIDE berichten. Per sample, per kanaal:
+
+    - Bereik:    waarde buiten plausibel bereik (BPM, °C, spanning)  → SQI 0
+    - Clipping:  ADC tegen de rail (0V of VDD)                       → SQI 0
+    - Vlak:      ruwe ADC waarde beweegt SQ_FLAT_SAMPLES niet        → SQI 0
+    - Spike:     |Δ| > SQ_SPIKE_FACTOR x gemiddelde |Δ|              → SQI 40
+                 (blijft SQ_SPIKE_HOLD samples staan)
+    - PPG vorm:  elke beat wordt vergeleken met een lopend template
+                 (Pearson r over SQ_PPG_TEMPLATE_LEN punten)   → r 0.5..1 = SQI 0..100
+
+  Incrementeel vanuit ads1115_readAll(): O(1) per kanaal per sample,
+  de PPG vergelijking alleen bij een beat.
+
+  Gebruik:
+    - sigQuality_gate() houdt de laatste goede waarde vast zolang het
+      kanaal onder SQ_MIN_USABLE zit
+    - BiometricData.quality (0-1) laat de stress manager twijfelachtige
+      samples minder zwaar meewegen
+  ═══════════════════════════════════════════════════════════════════════════
+*/
+
+#ifndef SIGNAL_QUALITY_H
+#define SIGNAL_QUALITY_H
+
+#include <Arduino.h>
+#include "ads1115_sensors.h"
+
+#define SQ_CHANNELS           4
+#define SQ_MIN_USABLE         50      // Onder deze SQI: laatste goede waarde vasthouden
+#define SQ_FLAT_SAMPLES       30      // 3 sec zonder beweging = vlak / los
+#define SQ_SPIKE_FACTOR       8.0f    // x gemiddelde |Δ| = spike
+#define SQ_SPIKE_HOLD         10      // 1 sec lage kwaliteit na een spike
+#define SQ_PPG_TEMPLATE_LEN   8       // Punten per beat na resamplen
+#define SQ_PPG_MAX_SAMPLES    20      // Langer dan 2 sec geen beat = geen bruikbare vorm
+
+// Kwaliteit flags (per kanaal)
+#define SQ_FLAG_RANGE         0x01
+#define SQ_FLAG_CLIP          0x02
+#define SQ_FLAG_FLAT          0x04
+#define SQ_FLAG_SPIKE         0x08
+#define SQ_FLAG_SHAPE         0x10    // Alleen pulse: beat lijkt niet op template
+
+enum SQChannel : uint8_t {
+  SQ_GSR = 0,
+  SQ_FLEX,
+  SQ_PULSE,
+  SQ_NTC
+};
+
+void sigQuality_reset();
+
+// Na het verwerken van alle kanalen (vult de *Quality velden in data)
+void sigQuality_update(ADS1115_SensorData& data);
+
+uint8_t sigQuality_get(SQChannel channel);      // 0-100
+uint8_t sigQuality_flags(SQChannel channel);
+float sigQuality_ppgCorrelation();              // Laatste beat vs template (-1..1)
+
+// Slechtste van HR, GSR en Temp (de stress kanalen), 0-100
+uint8_t sigQuality_stressQuality();
+
+// value bij goede kwaliteit, anders de laatste goede waarde van dit kanaal
+float sigQuality_gate(SQChannel channel, float value);
+
+// Korte omschrijving voor log/debug, bv. "VLAK+SPIKE"
+String sigQuality_flagString(uint8_t flags);
+
+#endif // SIGNAL_QUALITY_H
@@ -10,6 +10,23 @@
 #include "ui.h"
 #include "espnow_comm.h"
 #include "keon_ble.h"
+#include "latency_trace.h"
+#include "frame_pacer.h"
+
+// ESP-NOW, vacuum en safety: elke loop() ronde, en vanuit uiTick() vóór de
+// canvas flush als een frame lang duurt (framePacer_controlPoint)
+static void controlTasks() {
+  framePacer_controlTick(micros());   // Meet de tijd tussen control rondes
+  processESPNowPriority();
+  processESPNowRx();    // Frames uit de receive callback queue
+  processESPNowReliable();  // Kritieke frames zonder ACK herhalen
+  processESPNowLink();      // RTT / verlies / RSSI per peer
+  checkCommunicationTimeouts();
+  updateVacuumControl();
+  sendPumpControlMessages();
+  sendStatusUpdates();
+  performSafetyChecks();
+}
 
 void setup() {
   // ═══════════════════════════════════════════════════════════════════════
@@ -29,6 +46,8 @@ void setup() {
 
   keonStartTask();  // ✅ START CORE 0 TASK
   
+  framePacer_setControl(controlTasks);
+  
   // ═══════════════════════════════════════════════════════════════════════
   // STARTUP BANNER
   // ═══════════════════════════════════════════════════════════════════════
@@ -49,9 +68,20 @@ void loop() {
   // ═══════════════════════════════════════════════════════════════════════
   
   // ───────────────────────────────────────────────────────────────────────
-  // 1. UI HANDLING (menu, animation, input)
+  // 0. ESP-NOW VOORRANG (stop / nood pauze / vacuum los vóór alles)
   // ───────────────────────────────────────────────────────────────────────
-  uiTick();
+  processESPNowPriority();
+  
+  // ───────────────────────────────────────────────────────────────────────
+  // 1. UI HANDLING (menu, animation, input) - alleen als er een frame aan
+  //    de beurt is (frame_pacer.h), anders meteen door naar de control taken
+  // ───────────────────────────────────────────────────────────────────────
+  uint32_t nowUs = micros();
+  if (framePacer_frameDue(nowUs)) {
+    framePacer_beginFrame(nowUs);
+    uiTick();
+    framePacer_endFrame(micros());
+  }
   
   // ───────────────────────────────────────────────────────────────────────
   // 2. KEON BLE HANDLING (autonomous control)
@@ -66,14 +96,12 @@ void loop() {
   //keonIndependentTick();
   
   // ───────────────────────────────────────────────────────────────────────
-  // 3. ESP-NOW COMMUNICATION (Body ESP, Pump, M5Atom)
+  // 3. ESP-NOW COMMUNICATION (Body ESP, Pump, M5Atom) - elke ronde
   // ───────────────────────────────────────────────────────────────────────
   
-  checkCommunicationTimeouts();
-  updateVacuumControl();
-  sendPumpControlMessages();
-  sendStatusUpdates();
-  performSafetyChecks();
+  controlTasks();
+  latencyTrace_tick();  // Periodiek latency rapport over serial
+  framePacer_tick();    // Periodiek frame tijden rapport
   
 
   // ───────────────────────────────────────────────────────────────────────
@@ -91,6 +119,12 @@ void loop() {
 // NOTES:
 // ═══════════════════════════════════════════════════════════════════════════
 //
+// FRAME PACING:
+// - uiTick() draait op FRAME_TARGET_FPS, de control taken elke ronde
+// - Werk past niet in het budget → frame niet tekenen; na elk frame eerst
+//   control, en bij een lang frame ook halverwege (vóór de canvas flush)
+// - [FRAME] rapport toont p50/p95/max + histogram, ook tijd tussen control rondes
+//
 // RADIO CONFLICT MINIMIZATION:
 // - Keon BLE en ESP-NOW delen dezelfde 2.4GHz radio
 // - Volgorde is belangrijk: UI → Keon → ESP-NOW
@@ -1,5 +1,6 @@
 #include <math.h>
 #include "display.h"
+#include "frame_pacer.h"
 
 // ------------------ Display pinout ------------------
 const int LCD_DC   = 2;
@@ -39,6 +40,178 @@ const int R_WIN_Y = 0;
 const int R_WIN_W = 320 - R_WIN_X;
 const int R_WIN_H = 240;
 
+// ---------- canvas flush: dirty tegels ----------
+// Vroeger elke frame cv->flush(): 96x136x2 = 26 KB over SPI, ook als alleen de
+// cap een paar pixels verschoof. Nu per tegel een hash van de inhoud; alleen
+// tegels die gemeld zijn (dit of vorige frame) worden vergeleken, alleen
+// gewijzigde worden verstuurd. Per tegelrij worden aaneengesloten tegels één
+// rechthoek, gelijke rechthoeken in opeenvolgende rijen worden samengevoegd.
+static const int CANVAS_TILES_X = (L_CANVAS_W + CANVAS_TILE - 1) / CANVAS_TILE;
+static const int CANVAS_TILES_Y = (L_CANVAS_H + CANVAS_TILE - 1) / CANVAS_TILE;
+static const int CANVAS_TILES   = CANVAS_TILES_X * CANVAS_TILES_Y;
+static_assert(CANVAS_TILES <= 64, "CANVAS_TILE te klein: tegels passen niet in het 64-bit masker");
+
+static uint64_t canvasDirtyNow = 0;        // Gemeld dit frame
+static uint64_t canvasDirtyPrev = 0;       // Gemeld vorig frame (daar staat nu misschien achtergrond)
+static uint32_t canvasTileHash[CANVAS_TILES];
+static bool     canvasFullNext = true;
+static bool     canvasBgValid = false;
+static uint16_t canvasBg = 0;
+static uint32_t canvasLastFullMs = 0;
+static uint32_t canvasLastLogMs = 0;
+static uint16_t canvasScratch[L_CANVAS_W * CANVAS_TILE];   // Smalle rechthoek aaneengesloten maken
+static CanvasFlushStats canvasStats = {0, 0, 0, 0, 0, 0, 0};
+
+void canvasClear(uint16_t bg){
+  cv->fillScreen(bg);
+  if (!canvasBgValid || bg != canvasBg) {
+    canvasBg = bg;
+    canvasBgValid = true;
+    canvasFullNext = true;
+  }
+}
+
+void canvasMarkDirty(int x, int y, int w, int h){
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if (x + w > L_CANVAS_W) w = L_CANVAS_W - x;
+  if (y + h > L_CANVAS_H) h = L_CANVAS_H - y;
+  if (w <= 0 || h <= 0) return;
+  int tx0 = x / CANVAS_TILE, tx1 = (x + w - 1) / CANVAS_TILE;
+  int ty0 = y / CANVAS_TILE, ty1 = (y + h - 1) / CANVAS_TILE;
+  for (int ty = ty0; ty <= ty1; ++ty)
+    for (int tx = tx0; tx <= tx1; ++tx)
+      canvasDirtyNow |= 1ULL << (ty * CANVAS_TILES_X + tx);
+}
+
+void canvasMarkAll(){
+  canvasFullNext = true;
+}
+
+static uint32_t canvasHashTile(const uint16_t* fb, int tx, int ty){
+  int x0 = tx * CANVAS_TILE, x1 = min(x0 + CANVAS_TILE, L_CANVAS_W);
+  int y0 = ty * CANVAS_TILE, y1 = min(y0 + CANVAS_TILE, L_CANVAS_H);
+  uint32_t h = 2166136261u;                       // FNV-1a
+  for (int y = y0; y < y1; ++y) {
+    const uint16_t* row = fb + y * L_CANVAS_W;
+    for (int x = x0; x < x1; ++x) h = (h ^ row[x]) * 16777619u;
+  }
+  return h;
+}
+
+// Tegels tx0..tx1 x ty0..ty1 naar het scherm, geeft bytes terug
+static uint32_t canvasPushRect(uint16_t* fb, int tx0, int tx1, int ty0, int ty1){
+  int x = tx0 * CANVAS_TILE, w = min((tx1 + 1) * CANVAS_TILE, L_CANVAS_W) - x;
+  int y = ty0 * CANVAS_TILE, h = min((ty1 + 1) * CANVAS_TILE, L_CANVAS_H) - y;
+  if (w == L_CANVAS_W) {
+    // Volle breedte: staat al aaneengesloten in de framebuffer
+    gfx->draw16bitRGBBitmap(L_CANVAS_X, L_CANVAS_Y + y, fb + y * L_CANVAS_W, w, h);
+  } else {
+    int rowsPerChunk = (L_CANVAS_W * CANVAS_TILE) / w;
+    for (int yy = y; yy < y + h; yy += rowsPerChunk) {
+      int rows = min(rowsPerChunk, y + h - yy);
+      for (int r = 0; r < rows; ++r)
+        memcpy(canvasScratch + r * w, fb + (yy + r) * L_CANVAS_W + x, w * sizeof(uint16_t));
+      gfx->draw16bitRGBBitmap(L_CANVAS_X + x, L_CANVAS_Y + yy, canvasScratch, w, rows);
+    }
+  }
+  return (uint32_t)w * h * sizeof(uint16_t);
+}
+
+static uint32_t canvasPushTiles(uint16_t* fb, uint64_t tiles, uint32_t& rects){
+  struct Run { int8_t tx0, tx1, ty0, ty1; };
+  Run active[CANVAS_TILES_X];
+  int nActive = 0;
+  uint32_t bytes = 0;
+  for (int ty = 0; ty <= CANVAS_TILES_Y; ++ty) {
+    // Runs in deze rij (rij CANVAS_TILES_Y = leeg: alles wat nog open staat versturen)
+    Run row[CANVAS_TILES_X];
+    int nRow = 0;
+    for (int tx = 0; ty < CANVAS_TILES_Y && tx < CANVAS_TILES_X; ++tx) {
+      if (!(tiles & (1ULL << (ty * CANVAS_TILES_X + tx)))) continue;
+      if (nRow > 0 && row[nRow-1].tx1 == tx - 1) row[nRow-1].tx1 = tx;
+      else row[nRow++] = {(int8_t)tx, (int8_t)tx, (int8_t)ty, (int8_t)ty};
+    }
+    Run next[CANVAS_TILES_X];
+    int nNext = 0;
+    bool used[CANVAS_TILES_X] = {false};
+    for (int i = 0; i < nActive; ++i) {
+      int j = 0;
+      while (j < nRow && (used[j] || row[j].tx0 != active[i].tx0 || row[j].tx1 != active[i].tx1)) ++j;
+      if (j < nRow) {
+        used[j] = true;
+        active[i].ty1 = ty;
+        next[nNext++] = active[i];
+      } else {
+        bytes += canvasPushRect(fb, active[i].tx0, active[i].tx1, active[i].ty0, active[i].ty1);
+        rects++;
+      }
+    }
+    for (int j = 0; j < nRow; ++j) if (!used[j]) next[nNext++] = row[j];
+    memcpy(active, next, nNext * sizeof(Run));
+    nActive = nNext;
+  }
+  return bytes;
+}
+
+void canvasFlush(){
+  uint32_t t0 = micros();
+  uint32_t bytes = 0, rects = 0;
+  uint16_t* fb = cv->getFramebuffer();
+  bool full = !CANVAS_DIRTY_RECTS || canvasFullNext || fb == nullptr ||
+              millis() - canvasLastFullMs > CANVAS_FULL_REFRESH_MS;
+
+  uint64_t candidates = canvasDirtyNow | canvasDirtyPrev;
+  canvasDirtyPrev = canvasDirtyNow;
+  canvasDirtyNow = 0;
+
+  uint64_t changed = 0;
+  int nChanged = 0;
+  if (fb != nullptr) {
+    for (int i = 0; i < CANVAS_TILES; ++i) {
+      if (!full && !(candidates & (1ULL << i))) continue;
+      uint32_t h = canvasHashTile(fb, i % CANVAS_TILES_X, i / CANVAS_TILES_X);
+      if (h != canvasTileHash[i]) { changed |= 1ULL << i; nChanged++; }
+      canvasTileHash[i] = h;
+    }
+  }
+  if (!full && nChanged * 100 > CANVAS_TILES * CANVAS_FULL_PCT) full = true;
+
+  if (full) {
+    cv->flush();
+    bytes = (uint32_t)L_CANVAS_W * L_CANVAS_H * sizeof(uint16_t);
+    rects = 1;
+    canvasFullNext = false;
+    canvasLastFullMs = millis();
+    canvasStats.fullFrames++;
+  } else if (changed) {
+    bytes = canvasPushTiles(fb, changed, rects);
+  } else {
+    canvasStats.emptyFrames++;
+  }
+
+  canvasStats.frames++;
+  canvasStats.bytesLast = bytes;
+  canvasStats.rectsLast = rects;
+  canvasStats.bytesTotal += bytes;
+  canvasStats.flushUsLast = micros() - t0;
+
+  if (millis() - canvasLastLogMs > 30000) {
+    if (canvasStats.frames > 0) {
+      Serial.printf("[CANVAS] %lu frames  vol:%lu leeg:%lu  gem %lu B/frame (vol %u B)\n",
+                    (unsigned long)canvasStats.frames, (unsigned long)canvasStats.fullFrames,
+                    (unsigned long)canvasStats.emptyFrames,
+                    (unsigned long)(canvasStats.bytesTotal / canvasStats.frames),
+                    (unsigned)(L_CANVAS_W * L_CANVAS_H * sizeof(uint16_t)));
+    }
+    canvasLastLogMs = millis();
+  }
+}
+
+CanvasFlushStats canvasGetFlushStats(){
+  return canvasStats;
+}
+
 // ---------- interne helpers ----------
 static inline void HLineClamped(int x, int y, int w, uint16_t col){
   if (y < 0 || y >= L_CANVAS_H || w <= 0) return;
@@ -84,6 +257,8 @@ static inline void drawVEdges(int triBaseY, int triApexY, uint16_t col){
   const float wStart=1.0f, wPeak=8.0f;
   bandSegCentered(leftBaseX, baseY, apexX, apexY, wStart, wPeak, col);
   bandSegCentered(rightBaseX, baseY, apexX, apexY, wStart, wPeak, col);
+  const int m = (int)wPeak;   // Halve band breedte + afronding
+  canvasMarkDirty(leftBaseX - m, apexY - m, rightBaseX - leftBaseX + 2*m + 1, baseY - apexY + 2*m + 1);
 }
 
 // ------------- Vibe lightning zigzag (bottom half) -------------
@@ -104,6 +279,9 @@ void drawVibeLightning(bool leftSide) {
   const uint16_t vibeColor = 0xFBE0;  // Light red
   const uint16_t glowColor = 0x7800;  // Dimmer red glow
   
+  // Zigzag + glow + sparkles blijven binnen zigWidth+1 van de lijn
+  canvasMarkDirty(lightningX - zigWidth - 1, startY - 1, 2 * zigWidth + 3, height + 3);
+  
   // Draw zigzag from top to bottom
   for (int seg = 0; seg < segments; seg++) {
     // Calculate start and end points of this segment
@@ -172,6 +350,8 @@ void drawSuctionSymbol(bool leftSide) {
   const uint16_t suctionColor = CFG.SPEEDBAR_BORDER;  // Cyaan (0x07FF)
   const uint16_t glowColor = 0x0410;  // Donker cyaan glow
   
+  canvasMarkDirty(leftSide ? symbolX - 1 : symbolX - curveWidth - 1, topY - 1, curveWidth + 3, height + 2);
+  
   // Draw curved lines to form )( shape
   for (int i = 0; i < height; i++) {
     float t = (float)i / (float)height; // 0 to 1
@@ -203,6 +383,34 @@ void drawSuctionSymbol(bool leftSide) {
   }
 }
 
+// ------------- Frame overlay (debug) -------------
+void drawFrameOverlay() {
+#if FRAME_OVERLAY_ENABLED
+  // Percentielen sorteren kost wat: twee keer per seconde verversen
+  static FrameStats fr = {0, 0, 0, 0}, rd = {0, 0, 0, 0}, fl = {0, 0, 0, 0};
+  static uint32_t skipped = 0;
+  static float fps = 0.0f;
+  static uint32_t lastMs = 0;
+  if (millis() - lastMs > 500) {
+    lastMs = millis();
+    fr = framePacer_getStats(FRAME_STAGE_FRAME);
+    rd = framePacer_getStats(FRAME_STAGE_RENDER);
+    fl = framePacer_getStats(FRAME_STAGE_FLUSH);
+    skipped = framePacer_getCounters().renderSkipped;
+    fps = framePacer_fps();
+  }
+  
+  cv->setFont(nullptr);
+  cv->setTextSize(1);
+  cv->setTextColor(0xFFE0);
+  cv->setCursor(1, 1);
+  cv->printf("%2.0ffps %4.1f", fps, fr.p95Us / 1000.0f);
+  cv->setCursor(1, 10);
+  cv->printf("r%4.1f f%4.1f %lu", rd.p95Us / 1000.0f, fl.p95Us / 1000.0f, (unsigned long)skipped);
+  canvasMarkDirty(0, 0, L_CANVAS_W, 18);
+#endif
+}
+
 // ------------- publieke tekenfuncties -------------
 void drawSpeedBarTop(uint8_t step, uint8_t stepsTotal){
   int barX = L_PANE_X;
@@ -353,6 +561,8 @@ void drawSleeveFixedTop(int capY, uint16_t colTan) {
   int topTrapY  = baseY - TRAP_H;
   int baseWTrap = max(4, SL_SHAFT_W - 2 * TRAP_INSET_BASE);
   int topWTrap  = max(4, baseWTrap - 2 * TRAP_TAPER_PX);
+  const int markW = max(SL_SHAFT_W, SL_CAP_W);
+  canvasMarkDirty(cx - markW/2, topTrapY, markW, max(capY + SL_CAP_H, topY + 1) - topTrapY);
   // fillTaperTop inline:
   if (!(baseY <= 0 || topY >= L_CANVAS_H)) {
     int tY = topTrapY; if (tY < 0) tY = 0;
@@ -375,6 +585,7 @@ void drawRodFromCap_Vinside_NoSeam(int capY, int drawBaselineY, uint16_t rodCol,
   int rodH = (drawBaselineY - rodTopY);
   if (rodH < TIP_RECT_MIN_H) rodH = TIP_RECT_MIN_H;
   fillRectCenterClamped(cx, rodTopY, TIP_RECT_W, rodH, rodCol);
+  canvasMarkDirty(cx - TIP_RECT_W/2, rodTopY, TIP_RECT_W, rodH);
 
   const int overlapY = capBottomY - V_INSET_IN_CAP;
   const int sideW = max(0, (TIP_RECT_W - TIP_TRI_W) / 2);
@@ -391,6 +602,7 @@ void drawRodFromCap_Vinside_NoSeam(int capY, int drawBaselineY, uint16_t rodCol,
   int leftX  = cx - TIP_TRI_W/2;
   int rightX = cx + TIP_TRI_W/2;
   cv->fillTriangle(leftX, triBaseY, rightX, triBaseY, cx, triApexY, rodCol);
+  canvasMarkDirty(leftX, triApexY, rightX - leftX + 1, triBaseY - triApexY + 1);
   // randen
   drawVEdges(triBaseY, triApexY, edgeCol);
 }
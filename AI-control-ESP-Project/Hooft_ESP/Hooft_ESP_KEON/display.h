@@ -18,6 +18,34 @@ extern const int L_PAD, L_HEADER_H;
 extern const int L_CANVAS_W, L_CANVAS_H, L_CANVAS_X, L_CANVAS_Y;
 extern const int R_WIN_X, R_WIN_Y, R_WIN_W, R_WIN_H;
 
+// Canvas flush: alleen gewijzigde tegels naar het scherm (display.cpp)
+// Tekenhelpers melden hun bounding box met canvasMarkDirty(); canvasFlush()
+// vergelijkt in die tegels (dit + vorige frame) de inhoud met het vorige
+// frame en stuurt alleen wat echt anders is, aaneengesloten tegels samen.
+// Tekenen in het canvas zonder te melden → pas zichtbaar bij de volgende
+// volledige refresh (andere achtergrond, canvasMarkAll, of elke
+// CANVAS_FULL_REFRESH_MS).
+#define CANVAS_DIRTY_RECTS       1      // 0 = altijd het hele canvas (cv->flush)
+#define CANVAS_TILE              16     // Tegel (px)
+#define CANVAS_FULL_REFRESH_MS   5000   // Toch af en toe alles (hash botsing)
+#define CANVAS_FULL_PCT          70     // Meer gewijzigd → één keer het hele canvas
+
+struct CanvasFlushStats {
+  uint32_t frames;
+  uint32_t fullFrames;      // Hele canvas verstuurd
+  uint32_t emptyFrames;     // Niets gewijzigd, niets verstuurd
+  uint32_t bytesLast;       // Bytes over SPI, laatste frame
+  uint32_t rectsLast;       // Rechthoeken, laatste frame
+  uint32_t flushUsLast;     // Vergelijken + versturen, laatste frame
+  uint64_t bytesTotal;
+};
+
+void canvasClear(uint16_t bg);                      // fillScreen, andere achtergrond → alles
+void canvasMarkDirty(int x, int y, int w, int h);   // Canvas coördinaten
+void canvasMarkAll();                               // Volgende flush: hele canvas
+void canvasFlush();                                 // I.p.v. cv->flush()
+CanvasFlushStats canvasGetFlushStats();
+
 // API voor UI
 void drawSpeedBarTop(uint8_t step, uint8_t stepsTotal);
 void drawLeftFrame();
@@ -34,6 +62,9 @@ void drawZigzagSegment(int x1, int y1, int x2, int y2, uint16_t mainColor, uint1
 // Suction symbol effects
 void drawSuctionSymbol(bool leftSide);
 
+// Frame tijden linksboven in het canvas (frame_pacer.h, FRAME_OVERLAY_ENABLED)
+void drawFrameOverlay();
+
 // External states (defined in ui.cpp)
 extern bool vibeState;
 extern bool suctionState;
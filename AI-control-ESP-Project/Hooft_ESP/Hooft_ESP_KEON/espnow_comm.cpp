@@ -2,10 +2,19 @@
 #include "ui.h"
 #include "vacuum.h"
 #include "config.h"
+#include "latency_trace.h"
+#include "espnow_rx_queue.h"
+#include "espnow_reliable.h"
+#include "espnow_publisher.h"
+#include "espnow_link.h"
+#include "espnow_timesync.h"
+#include "espnow_netem.h"
+#include "keon_motion.h"
 
 // External Vibe state from ui.cpp
 extern bool vibeState;
 #include <esp_wifi.h>
+#include <esp_timer.h>
 
 // ===============================================================================
 // MAC ADDRESSES
@@ -68,20 +77,65 @@ float bodyESP_trustOverride = 1.0f;      // Default: geen override
 float bodyESP_sleeveOverride = 1.0f;     // Default: geen override
 
 // Timing constants
-const uint32_t BODY_ESP_UPDATE_INTERVAL = 500;   // 500ms (2Hz)
-const uint32_t M5ATOM_UPDATE_INTERVAL = 250;     // 250ms (4Hz)
+const uint32_t BODY_ESP_UPDATE_INTERVAL = 500;   // Trage status velden max 2Hz
+const uint32_t BODY_ESP_MIN_GAP = 40;            // Urgente status wijziging: max 25Hz
+const uint32_t BODY_ESP_KEEPALIVE = 2000;        // Volledige status zonder wijzigingen
+const uint32_t M5ATOM_UPDATE_INTERVAL = 250;     // Speeds naar M5Atom max 4Hz
+const uint32_t M5ATOM_KEEPALIVE = 1000;          // Colors zonder wijzigingen
 const uint32_t BODY_ESP_TIMEOUT = 10000;         // 10 seconds
 const uint32_t PUMP_UNIT_TIMEOUT = 5000;         // 5 seconds
 const uint32_t M5ATOM_TIMEOUT = 15000;           // 15 seconds
 const uint32_t PUMP_HEARTBEAT_INTERVAL = 1000;   // 1 second heartbeat
 
 // Internal timing variables
-static uint32_t lastBodyESPUpdate = 0;
-static uint32_t lastM5AtomUpdate = 0;
 static uint32_t lastPumpControlUpdate = 0;
 static uint32_t lastPumpHeartbeat = 0;
 const uint32_t PUMP_CONTROL_UPDATE_INTERVAL = 2000; // Send pump control every 2 seconds
 
+static EspNowRxQueue rxQueue;
+static EspNowRxQueue rxPrioQueue;     // ESPNOW_FLAG_PRIORITY frames (stop, nood pauze, vacuum los)
+static EspNowReliable bodyRel;   // Volgnummers, ack/herhaling, duplicaten (Body ESP)
+static EspNowPublisher bodyPub;  // Wanneer status naar Body ESP (delta / volledig)
+static EspNowPublisher m5Pub;    // Wanneer colors naar M5Atom
+static EspNowLinkStats bodyLink; // RTT, verlies, RSSI per peer (espnow_link.h)
+static EspNowLinkStats pumpLink;
+static EspNowLinkStats m5Link;
+
+#if ESPNOW_NETEM_ENABLED
+// Test kanaal voor alle peers (Body, Pomp, M5): zelfde waarden op de Body ESP
+static const EspNowNetemConfig NETEM_CONFIG = { 10, 5, 10, 5 };   // verlies %, latency ms, jitter ms, volgorde %
+static EspNowNetem netem;
+#endif
+
+// Status velden: deadband in fixed point eenheden van EspNowStatusPayload
+static const uint16_t BODY_STATUS_DEADBAND[ESPNOW_SF_COUNT] = {
+  20,   // trust       0.02
+  20,   // sleeve      0.02
+  5,    // suction     0.5 cmHg
+  0,    // pause
+  5,    // vacuum      0.5 mbar
+  5,    // cyclusTijd  0.05
+  20,   // sleevePct   2%
+  0,    // speedStep
+  0     // bits
+};
+// Zichtbaar voor de gebruiker / AI beslissing → direct; rest is traag
+static const uint16_t BODY_STATUS_URGENT = (1u << ESPNOW_SF_TRUST) | (1u << ESPNOW_SF_SLEEVE) |
+                                           (1u << ESPNOW_SF_PAUSE) | (1u << ESPNOW_SF_SPEED_STEP) |
+                                           (1u << ESPNOW_SF_BITS);
+static EspNowStatusPayload bodyLastSent;   // Wat Body ESP nu heeft
+
+static bool sendBodyFrame(const uint8_t *frame, uint8_t len) {
+  return esp_now_send(bodyESP_MAC, frame, len) == ESP_OK;
+}
+
+// WiFi task: alleen MAC laag verlies naar Body ESP doorgeven
+static void onESPNowSent(const uint8_t *mac, esp_now_send_status_t status) {
+  if (memcmp(mac, bodyESP_MAC, 6) == 0) {
+    espnowRel_onSendStatus(bodyRel, status == ESP_NOW_SEND_SUCCESS);
+  }
+}
+
 // ===============================================================================
 // ESP-NOW SETUP
 // ===============================================================================
@@ -95,6 +149,18 @@ void initESPNow() {
   esp_wifi_set_promiscuous(false);
   Serial.printf("[ESP-NOW] WiFi channel forced to 4\n");
   
+  espnowRel_reset(bodyRel);
+  espnowPub_init(bodyPub, BODY_ESP_MIN_GAP, BODY_ESP_UPDATE_INTERVAL, BODY_ESP_KEEPALIVE);
+  espnowPub_init(m5Pub, BODY_ESP_MIN_GAP, M5ATOM_UPDATE_INTERVAL, M5ATOM_KEEPALIVE);
+  espnowLink_reset(bodyLink);
+  espnowLink_reset(pumpLink);
+  espnowLink_reset(m5Link);
+#if ESPNOW_NETEM_ENABLED
+  espnowNetem_init(netem, NETEM_CONFIG, 0x400F);
+  Serial.printf("[NETEM] ⚠️ Test kanaal actief: verlies %d%% latency %d ms jitter %d ms volgorde %d%%\n",
+                NETEM_CONFIG.lossPct, NETEM_CONFIG.latencyMs, NETEM_CONFIG.jitterMs, NETEM_CONFIG.reorderPct);
+#endif
+  
   // Initialize ESP-NOW after channel setup
   if (esp_now_init() != ESP_OK) {
     Serial.println("[ESP-NOW] Init failed!");
@@ -104,6 +170,7 @@ void initESPNow() {
   Serial.println("[ESP-NOW] Initialized successfully");
   Serial.printf("[ESP-NOW] WiFi Channel: %d\n", WiFi.channel());
   esp_now_register_recv_cb(onESPNowReceive);
+  esp_now_register_send_cb(onESPNowSent);
   
   // Use channel 4 for all peers (consistent with M5Atom and Pump Unit)
   const int peerChannel = 4;  // Fixed channel 4
@@ -149,22 +216,88 @@ void initESPNow() {
 // ===============================================================================
 // RECEIVE CALLBACK
 // ===============================================================================
+// WiFi task: alleen kopiëren, verwerking in processESPNowRx() (loop context)
 void onESPNowReceive(const esp_now_recv_info *info, const uint8_t *data, int len) {
+  int8_t rssi = info->rx_ctrl ? info->rx_ctrl->rssi : 0;
+  EspNowRxQueue& q = espnow_peekPriority(data, len) ? rxPrioQueue : rxQueue;
+  espnowRx_push(q, info->src_addr, data, len, rssi, micros());
+}
+
+static void dispatchESPNowFrame(const uint8_t *src, const uint8_t *data, int len, int8_t rssi, uint32_t rxUs) {
   // Reduced debug spam - only show important messages
   
   // Check sender MAC address
-  if (memcmp(info->src_addr, bodyESP_MAC, 6) == 0) {
+  if (memcmp(src, bodyESP_MAC, 6) == 0) {
     // Message from Body ESP (uitgebreide AI overrule)
-    if (len == sizeof(bodyESP_message_t)) {
+    EspNowFrame frame;
+    EspNowDecodeResult decoded = espnow_decode(data, len, frame);
+    // Wij zijn de sessie klok (millis() = esp_timer / 1000): geen omrekening
+    int64_t rxUs64 = espnowSync_extendUs(rxUs, esp_timer_get_time());
+    if (decoded == ESPNOW_DECODE_OK) {
+      espnowLink_onFrame(bodyLink, frame.hdr, rssi, millis());
+      if (frame.hdr.flags & ESPNOW_FLAG_SYNCED) {
+        espnowLink_onOneWay(bodyLink, (int32_t)((uint32_t)(rxUs64 / 1000) - frame.hdr.timeMs));
+      }
+    }
+    if (decoded == ESPNOW_DECODE_OK && frame.hdr.opcode == ESPNOW_OP_ACK) {
+      bodyESP_lastContact = millis();
+      espnowRel_onAck(bodyRel, frame.ack.ackSeq, millis());
+    }
+    else if (decoded == ESPNOW_DECODE_OK && frame.hdr.opcode == ESPNOW_OP_PING) {
+      // Direct terug: RTT van de Body ESP meet ook onze loop() vertraging
+      bodyESP_lastContact = millis();
+      EspNowFrame pong;
+      memset(&pong, 0, sizeof(pong));
+      // t2 = ontvangst in de callback, t3 = nu: de Body ESP synchroniseert hierop
+      espnowLink_buildPong(bodyLink, frame, millis(), rxUs64, esp_timer_get_time(), pong);
+      uint8_t buf[ESPNOW_MAX_FRAME];
+      uint8_t pongLen = espnow_encode(pong, ESPNOW_OP_PONG, espnowRel_nextSeq(bodyRel, ESPNOW_OP_PONG), millis(), false, buf, ESPNOW_FLAG_SYNCED);
+      sendBodyFrame(buf, pongLen);
+    }
+    else if (decoded == ESPNOW_DECODE_OK && frame.hdr.opcode == ESPNOW_OP_PONG) {
+      bodyESP_lastContact = millis();
+      espnowLink_onPong(bodyLink, frame, millis(), rxUs64);
+    }
+    else if (decoded == ESPNOW_DECODE_OK && espnow_isBodyOpcode(frame.hdr.opcode)) {
+      // ACK altijd terug (ook bij duplicaat: eerste ACK kan verloren zijn)
+      uint8_t ackFrame[ESPNOW_MAX_FRAME];
+      uint8_t ackLen = espnowRel_buildAck(bodyRel, frame.hdr, millis(), ackFrame, ESPNOW_FLAG_SYNCED);
+      if (ackLen) sendBodyFrame(ackFrame, ackLen);
+      if (espnowRel_onReceive(bodyRel, frame.hdr)) {
+        Serial.printf("[ESP-NOW] Body ESP duplicaat %s #%u genegeerd\n", espnow_opcodeName(frame.hdr.opcode), frame.hdr.seq);
+        return;
+      }
+      
       bodyESP_message_t msg;
-      memcpy(&msg, data, sizeof(msg));
+      msg.opcode = frame.hdr.opcode;
+      msg.seq = frame.hdr.seq;
+      msg.newTrust = frame.ai.trust_x1000 / 1000.0f;
+      msg.newSleeve = frame.ai.sleeve_x1000 / 1000.0f;
+      msg.overruleActive = frame.ai.bits & ESPNOW_AI_OVERRULE;
+      msg.stressLevel = frame.ai.stressLevel;
+      msg.vibeOn = frame.ai.bits & ESPNOW_AI_VIBE;
+      msg.zuigenOn = frame.ai.bits & ESPNOW_AI_ZUIGEN;
+      msg.timeMs = frame.hdr.timeMs;
+      msg.timeSynced = frame.hdr.flags & ESPNOW_FLAG_SYNCED;
+      msg.traceId = frame.trace.traceId;   // 0 zonder ESPNOW_FLAG_TRACE
+      msg.traceSensorUs = frame.trace.sensorUs;
+      msg.traceDecisionUs = frame.trace.decisionUs;
+      msg.traceSendUs = frame.trace.sendUs;
+      msg.traceAirUs = frame.trace.airUs;
+      
+      extern uint8_t g_speedStep;
+      uint8_t stepBefore = g_speedStep;
       handleBodyESPMessage(msg);
+      latencyTrace_onBodyMessage(msg, rxUs, g_speedStep != stepBefore);
+    } else if (decoded == ESPNOW_DECODE_OK) {
+      Serial.printf("[ESP-NOW] Body ESP opcode %s hoort niet bij Body ESP\n", espnow_opcodeName(frame.hdr.opcode));
     } else {
-      Serial.printf("[ESP-NOW] Body ESP message size mismatch: got %d, expected %d\n", len, sizeof(bodyESP_message_t));
+      Serial.printf("[ESP-NOW] Body ESP bericht afgewezen (%d bytes): %s\n", len, espnow_decodeError(decoded));
     }
   }
-  else if (memcmp(info->src_addr, pumpUnit_MAC, 6) == 0) {
+  else if (memcmp(src, pumpUnit_MAC, 6) == 0) {
     // Message from Pump Unit
+    espnowLink_onRssi(pumpLink, rssi, millis());
     if (len == sizeof(PumpStatusMsg)) {
       PumpStatusMsg status;
       memcpy(&status, data, sizeof(status));
@@ -178,14 +311,15 @@ void onESPNowReceive(const esp_now_recv_info *info, const uint8_t *data, int len
       Serial.printf("[ESP-NOW] Pump Unit message size mismatch: got %d, expected %d\n", len, sizeof(PumpStatusMsg));
     }
   }
-  else if (memcmp(info->src_addr, m5atom_MAC, 6) == 0) {
+  else if (memcmp(src, m5atom_MAC, 6) == 0) {
     // Message from M5Atom
+    espnowLink_onRssi(m5Link, rssi, millis());
     if (len == sizeof(atomMotion_message_t)) {
       // Motion data message
       atomMotion_message_t msg;
       memcpy(&msg, data, sizeof(msg));
       Serial.printf("[ESP-NOW] M5Atom motion: ver=%d, kind=%d\n", msg.ver, msg.kind);
-      if (msg.ver == 1 && msg.kind == 1) {  // MK_ATOM_MOTION
+      if (msg.ver == 1 && msg.kind == ESPNOW_MK_ATOM_MOTION) {
         handleM5AtomMotionMessage(msg);
       } else {
         Serial.printf("[ESP-NOW] M5Atom motion header mismatch: ver=%d (exp:1), kind=%d (exp:1)\n", msg.ver, msg.kind);
@@ -205,8 +339,7 @@ void onESPNowReceive(const esp_now_recv_info *info, const uint8_t *data, int len
   }
   else {
     Serial.printf("[ESP-NOW] Message from UNKNOWN MAC: %02X:%02X:%02X:%02X:%02X:%02X (len=%d)\n",
-                  info->src_addr[0], info->src_addr[1], info->src_addr[2],
-                  info->src_addr[3], info->src_addr[4], info->src_addr[5], len);
+                  src[0], src[1], src[2], src[3], src[4], src[5], len);
     Serial.printf("[ESP-NOW] Expected Pump Unit MAC: 62:01:94:59:18:86\n");
     //Serial.printf("[ESP-NOW] Expected Body ESP MAC:  08:D1:F9:DC:C3:A4\n");
     Serial.printf("[ESP-NOW] Expected Body ESP MAC:  E8:06:90:DD:7E:18\n");
@@ -214,19 +347,140 @@ void onESPNowReceive(const esp_now_recv_info *info, const uint8_t *data, int len
   }
 }
 
+// Voorrang frames: vanuit loop() vóór de UI, en opnieuw vóór safety checks en
+// pomp besturing zodat een stop nooit achter status verkeer of een trage
+// UI tick wacht. Leeg = vrijwel gratis.
+void processESPNowPriority() {
+  EspNowRxItem item;
+  while (espnowRx_pop(rxPrioQueue, item)) {
+#if ESPNOW_NETEM_ENABLED
+    // Test kanaal: wel verlies, geen vertraging (voorrang lane blijft voorrang)
+    if (espnowNetem_chance(netem, NETEM_CONFIG.lossPct)) { netem.lost++; continue; }
+#endif
+    dispatchESPNowFrame(item.mac, item.data, item.len, item.rssi, item.rxUs);
+  }
+}
+
+void processESPNowRx() {
+  static uint32_t lastDropped = 0;
+  EspNowRxItem item;
+  processESPNowPriority();
+#if ESPNOW_NETEM_ENABLED
+  while (espnowRx_pop(rxQueue, item)) {
+    espnowNetem_push(netem, item, micros());
+  }
+  while (espnowNetem_pop(netem, micros(), item)) {
+    dispatchESPNowFrame(item.mac, item.data, item.len, item.rssi, item.rxUs);
+  }
+#else
+  while (espnowRx_pop(rxQueue, item)) {
+    dispatchESPNowFrame(item.mac, item.data, item.len, item.rssi, item.rxUs);
+  }
+#endif
+  
+  uint32_t dropped = espnowRx_dropped(rxQueue) + espnowRx_dropped(rxPrioQueue);
+  if (dropped != lastDropped) {
+    Serial.printf("[ESP-NOW RX] %lu frames weggegooid (vol:%lu te lang:%lu, max bezet %d/%d)\n",
+                  (unsigned long)(dropped - lastDropped), (unsigned long)rxQueue.overflows,
+                  (unsigned long)rxQueue.tooLong, rxQueue.highWater, ESPNOW_RXQ_DEPTH);
+    lastDropped = dropped;
+  }
+}
+
+void processESPNowReliable() {
+  uint8_t givenUp = espnowRel_poll(bodyRel, millis(), sendBodyFrame);
+  if (givenUp > 0) {
+    Serial.printf("[ESP-NOW REL] %d frame(s) naar Body ESP opgegeven na %d pogingen\n", givenUp, ESPNOW_REL_MAX_RETRIES + 1);
+  }
+  
+  static uint32_t lastStats = 0;
+  if (millis() - lastStats > 30000) {
+    lastStats = millis();
+    const EspNowRelStats& st = bodyRel.stats;
+    Serial.printf("[ESP-NOW REL] Body: sent:%lu ok:%lu retry:%lu drop:%lu dup:%lu ack:%lu open:%d\n",
+                  (unsigned long)st.sent, (unsigned long)st.delivered, (unsigned long)st.retried,
+                  (unsigned long)st.dropped, (unsigned long)st.duplicates, (unsigned long)st.acksSent,
+                  espnowRel_outstanding(bodyRel));
+    // Benchmark: leveringstijd en doorvoer van kritieke frames over dit interval
+    static uint32_t lastDelivered = 0;
+    Serial.printf("[ESP-NOW REL] Body levering gem:%.1f ms max:%lu ms, %.2f frames/s | voorrang %lu/%lu weg:%lu slechtst:%lu ms\n",
+                  espnowRel_avgDeliveryMs(bodyRel), (unsigned long)st.deliveryMaxMs,
+                  (st.delivered - lastDelivered) / 30.0f,
+                  (unsigned long)st.prioDelivered, (unsigned long)st.prioSent,
+                  (unsigned long)st.prioDropped, (unsigned long)st.prioMaxMs);
+    lastDelivered = st.delivered;
+#if ESPNOW_NETEM_ENABLED
+    Serial.printf("[NETEM] door:%lu weg:%lu volgorde:%lu vol:%lu\n",
+                  (unsigned long)netem.passed, (unsigned long)netem.lost,
+                  (unsigned long)netem.reordered, (unsigned long)netem.overflow);
+#endif
+    Serial.printf("[ESP-NOW PUB] Body: full:%lu delta:%lu skip:%lu | M5: full:%lu delta:%lu skip:%lu\n",
+                  (unsigned long)bodyPub.fullSent, (unsigned long)bodyPub.deltaSent, (unsigned long)bodyPub.suppressed,
+                  (unsigned long)m5Pub.fullSent, (unsigned long)m5Pub.deltaSent, (unsigned long)m5Pub.suppressed);
+  }
+}
+
+void processESPNowLink() {
+  uint32_t now = millis();
+  
+  // Eigen RTT meting naar Body ESP (Body ESP pingt ons ook)
+  if (bodyESP_connected && !espnowRel_priorityOpen(bodyRel) && espnowLink_pingDue(bodyLink, now)) {
+    EspNowFrame ping;
+    memset(&ping, 0, sizeof(ping));
+    espnowLink_buildPing(bodyLink, now, esp_timer_get_time(), ping);
+    uint8_t buf[ESPNOW_MAX_FRAME];
+    uint8_t len = espnow_encode(ping, ESPNOW_OP_PING, espnowRel_nextSeq(bodyRel, ESPNOW_OP_PING), now, false, buf, ESPNOW_FLAG_SYNCED);
+    sendBodyFrame(buf, len);
+  }
+  
+  // Waarschuwen zodra de Body link achteruit gaat (voor de besturing hapert)
+  static bool bodyLinkWarned = false;
+  uint8_t quality = espnowLink_quality(bodyLink, now);
+  if (bodyESP_connected && quality < 40 && !bodyLinkWarned) {
+    bodyLinkWarned = true;
+    Serial.printf("[LINK] ⚠️ Body ESP link %s (Q:%d): RTT %.1f ms, verlies %d%%, RSSI %.0f dBm\n",
+                  espnowLink_qualityName(quality), quality, bodyLink.rttAvgMs,
+                  espnowLink_lossPct(bodyLink), bodyLink.rssiAvg);
+  } else if (quality >= 60 && bodyLinkWarned) {
+    bodyLinkWarned = false;
+    Serial.printf("[LINK] Body ESP link hersteld (Q:%d)\n", quality);
+  }
+  
+  static uint32_t lastLinkLog = 0;
+  if (now - lastLinkLog > 10000) {
+    lastLinkLog = now;
+    Serial.printf("[LINK] Body Q:%d RTT:%.1f/%.1f ms 1-weg:%.1f ms jit:%.1f verl:%d%% (peer %d%%) RSSI:%.0f (peer %d) ping:%lu/%lu\n",
+                  quality, bodyLink.rttAvgMs, bodyLink.rttMaxMs, bodyLink.oneWayAvgMs, bodyLink.rttJitterMs,
+                  espnowLink_lossPct(bodyLink), bodyLink.peerLossPct, bodyLink.rssiAvg, bodyLink.peerRssi,
+                  (unsigned long)bodyLink.pongs, (unsigned long)bodyLink.pingsSent);
+    Serial.printf("[LINK] Pomp RSSI:%.0f (min %d)  M5 RSSI:%.0f (min %d)  RXq max %d/%d\n",
+                  pumpLink.rssiAvg, pumpLink.rssiMin, m5Link.rssiAvg, m5Link.rssiMin,
+                  rxQueue.highWater, ESPNOW_RXQ_DEPTH);
+  }
+}
+
+const EspNowLinkStats& getBodyLinkStats() { return bodyLink; }
+const EspNowLinkStats& getPumpLinkStats() { return pumpLink; }
+const EspNowLinkStats& getM5LinkStats() { return m5Link; }
+const EspNowRxQueue& getESPNowRxQueue() { return rxQueue; }
+uint8_t getBodyPendingFrames() { return espnowRel_outstanding(bodyRel); }
+uint32_t getBodyDroppedFrames() { return bodyRel.stats.dropped; }
+
 // ===============================================================================
 // MESSAGE HANDLERS
 // ===============================================================================
 
 void handleBodyESPMessage(const bodyESP_message_t &msg) {
   bodyESP_lastContact = millis();
+  if (!bodyESP_connected) espnowPub_restart(bodyPub);   // (Her)verbonden → eerst volledige status
   bodyESP_connected = true;
   
-  Serial.printf("[RX Body ESP] Cmd:'%s' Trust:%.2f Sleeve:%.2f Active:%d\n",
-                msg.command, msg.newTrust, msg.newSleeve, msg.overruleActive);
+  Serial.printf("[RX Body ESP] Cmd:%s #%u Trust:%.2f Sleeve:%.2f Active:%d\n",
+                espnow_opcodeName(msg.opcode), msg.seq, msg.newTrust, msg.newSleeve, msg.overruleActive);
   
-  // AI override functies
-  if (strcmp(msg.command, "AI_OVERRIDE") == 0) {
+  // Opcode dispatch (switch → jump table)
+  switch (msg.opcode) {
+  case ESPNOW_OP_AI_OVERRIDE: {
     // Normale AI - GEEN level forceren (subtiele aanpassingen only)
     bodyESP_trustOverride = (msg.newTrust < 0.0f) ? 0.0f : (msg.newTrust > 1.0f) ? 1.0f : msg.newTrust;
     bodyESP_sleeveOverride = (msg.newSleeve < 0.0f) ? 0.0f : (msg.newSleeve > 1.0f) ? 1.0f : msg.newSleeve;
@@ -234,8 +488,9 @@ void handleBodyESPMessage(const bodyESP_message_t &msg) {
     
     Serial.printf("[AI Override] Trust: %.2f, Sleeve: %.2f (factors only)\n", 
                   bodyESP_trustOverride, bodyESP_sleeveOverride);
+    break;
   }
-  else if (strcmp(msg.command, "AI_WARMUP") == 0) {
+  case ESPNOW_OP_AI_WARMUP: {
     // Warmup na emergency pause - MAG level forceren!
     bodyESP_trustOverride = (msg.newTrust < 0.0f) ? 0.0f : (msg.newTrust > 1.0f) ? 1.0f : msg.newTrust;
     bodyESP_sleeveOverride = (msg.newSleeve < 0.0f) ? 0.0f : (msg.newSleeve > 1.0f) ? 1.0f : msg.newSleeve;
@@ -246,15 +501,18 @@ void handleBodyESPMessage(const bodyESP_message_t &msg) {
     
     Serial.printf("[AI Warmup] Speed: %d, Trust: %.2f, Sleeve: %.2f\n", 
                   g_speedStep, bodyESP_trustOverride, bodyESP_sleeveOverride);
+    break;
   }
-  else if (strcmp(msg.command, "HEARTBEAT") == 0) {
+  case ESPNOW_OP_HEARTBEAT: {
     // Heartbeat update - connection status al bijgewerkt
+    break;
   }
-  else if (strcmp(msg.command, "EMERGENCY_STOP") == 0) {
+  case ESPNOW_OP_EMERGENCY_STOP: {
     Serial.println("[EMERGENCY] Body ESP emergency stop!");
     handleEmergencyStop();
+    break;
   }
-  else if (strcmp(msg.command, "AI_TEST_START") == 0) {
+  case ESPNOW_OP_AI_TEST_START: {
     Serial.printf("[AI TEST] AI neemt controle - target trust: %.1f\n", msg.newTrust);
     // Converteer trust speed naar speed step (0.0-2.0 trust -> 0-7 steps)
     extern uint8_t g_speedStep;
@@ -263,8 +521,9 @@ void handleBodyESPMessage(const bodyESP_message_t &msg) {
     g_speedStep = (uint8_t)(clampedTrust / 2.0f * 7.0f);  // 0-7 bereik
     paused = false;   // Zorg dat animatie loopt
     Serial.printf("[AI TEST] Trust %.1f -> Speed step %d, unpaused\n", msg.newTrust, g_speedStep);
+    break;
   }
-  else if (strcmp(msg.command, "AI_RESUME_SLOW") == 0) {
+  case ESPNOW_OP_AI_RESUME_SLOW: {
     Serial.printf("[AI TEST] AI herstart - target trust: %.1f\n", msg.newTrust);
     // Converteer trust speed naar speed step
     extern uint8_t g_speedStep;
@@ -273,8 +532,9 @@ void handleBodyESPMessage(const bodyESP_message_t &msg) {
     g_speedStep = (uint8_t)(clampedTrust / 2.0f * 7.0f);  // 0-7 bereik
     paused = false;   // Zorg dat animatie loopt
     Serial.printf("[AI TEST] Trust %.1f -> Speed step %d, unpaused\n", msg.newTrust, g_speedStep);
+    break;
   }
-  else if (strcmp(msg.command, "AI_STRESS_START") == 0) {
+  case ESPNOW_OP_AI_STRESS_START: {
     Serial.printf("[AI STRESS] AI Stress Management start - trust: %.1f\n", msg.newTrust);
     extern uint8_t g_speedStep;
     extern bool paused;
@@ -282,15 +542,17 @@ void handleBodyESPMessage(const bodyESP_message_t &msg) {
     g_speedStep = (uint8_t)(clampedTrust / 2.0f * 7.0f);
     paused = false;
     Serial.printf("[AI STRESS] Start vanaf speed step %d\n", g_speedStep);
+    break;
   }
-  else if (strcmp(msg.command, "AI_STRESS_ADJUST") == 0) {
+  case ESPNOW_OP_AI_STRESS_ADJUST: {
     Serial.printf("[AI STRESS] AI aanpassing - trust: %.1f\n", msg.newTrust);
     extern uint8_t g_speedStep;
     float clampedTrust = max(0.0f, min(2.0f, msg.newTrust));
     g_speedStep = (uint8_t)(clampedTrust / 2.0f * 7.0f);
     Serial.printf("[AI STRESS] Speed aangepast naar %d\n", g_speedStep);
+    break;
   }
-  else if (strcmp(msg.command, "AI_STRESS_RESUME") == 0) {
+  case ESPNOW_OP_AI_STRESS_RESUME: {
     Serial.printf("[AI STRESS] AI resume na pauze - trust: %.1f\n", msg.newTrust);
     extern uint8_t g_speedStep;
     extern bool paused;
@@ -298,18 +560,21 @@ void handleBodyESPMessage(const bodyESP_message_t &msg) {
     g_speedStep = (uint8_t)(clampedTrust / 2.0f * 7.0f);
     paused = false;
     Serial.printf("[AI STRESS] Resume naar speed %d, unpaused\n", g_speedStep);
+    break;
   }
-  else if (strcmp(msg.command, "AI_VIBE_ON") == 0) {
+  case ESPNOW_OP_AI_VIBE_ON: {
     Serial.println("[AI STRESS] AI activates VIBE - stress level 7 emergency!");
     vibeState = true;
     Serial.printf("[AI VIBE] Vibe automatisch ingeschakeld door AI (stress 7)\n");
+    break;
   }
-  else if (strcmp(msg.command, "AI_VIBE_OFF") == 0) {
+  case ESPNOW_OP_AI_VIBE_OFF: {
     Serial.println("[AI STRESS] AI deactivates VIBE");
     vibeState = false;
     Serial.printf("[AI VIBE] Vibe automatisch uitgeschakeld door AI\n");
+    break;
   }
-  else if (strcmp(msg.command, "AI_VACUUM_ON") == 0) {
+  case ESPNOW_OP_AI_VACUUM_ON: {
     Serial.println("[AI STRESS] AI activates VACUUM - stress level 7 emergency!");
     // Controleer of vacuum al actief is
     if (!pompUnitZuigActive) {
@@ -318,8 +583,9 @@ void handleBodyESPMessage(const bodyESP_message_t &msg) {
     } else {
       Serial.println("[AI VACUUM] Vacuum was al actief - geen actie nodig");
     }
+    break;
   }
-  else if (strcmp(msg.command, "AI_VACUUM_OFF") == 0) {
+  case ESPNOW_OP_AI_VACUUM_OFF: {
     Serial.println("[AI STRESS] AI deactivates VACUUM");
     // Controleer of vacuum actief is
     if (pompUnitZuigActive) {
@@ -328,8 +594,9 @@ void handleBodyESPMessage(const bodyESP_message_t &msg) {
     } else {
       Serial.println("[AI VACUUM] Vacuum was al uit - geen actie nodig");
     }
+    break;
   }
-  else if (strcmp(msg.command, "PLAYBACK_STRESS") == 0) {
+  case ESPNOW_OP_PLAYBACK_STRESS: {
     // Handle playback stress level data from Body ESP
     Serial.printf("[PLAYBACK] Stress level %d, Vibe: %s, Zuigen: %s received during playback\n", 
                   msg.stressLevel, msg.vibeOn ? "ON" : "OFF", msg.zuigenOn ? "ON" : "OFF");
@@ -370,15 +637,38 @@ void handleBodyESPMessage(const bodyESP_message_t &msg) {
     
     Serial.printf("[PLAYBACK] Animation updated - Speed: %d, Vibe: %s, Zuigen: %s, Paused: %s\n", 
                   g_speedStep, vibeState ? "ON" : "OFF", pompUnitZuigActive ? "ON" : "OFF", paused ? "YES" : "NO");
+    break;
   }
-  else if (strcmp(msg.command, "PLAYBACK_STOP") == 0) {
+  case ESPNOW_OP_PLAYBACK_STOP: {
     // Handle playback stop notification from Body ESP
     Serial.println("[PLAYBACK] Playback stopped - returning to manual control");
     
-    // Optionally reset to a neutral state or keep current settings
-    // For now, just log the event and let user continue with current settings
+    // Funscript waypoints nog in de rij → meteen terug naar de level slagen
+    if (keonMotion_source() == KEON_MOTION_SCRIPT) keonMotion_endScript();
+    break;
   }
-  else if (strcmp(msg.command, "AI_EMERGENCY_OVERRIDE") == 0) {
+  case ESPNOW_OP_FUNSCRIPT_ACTION: {
+    // Funscript actie (MultiFunPlayer via Body ESP) als waypoint in de Keon
+    // motion engine. Body stuurt sleeve = positie / 50 (multifunplayer_client.cpp)
+    extern bool paused;
+    if (paused) break;   // C-knop pauze gaat voor, keonIndependentTick parkeert
+    
+    float posF = constrain(msg.newSleeve * 50.0f, 0.0f, 100.0f);
+    uint8_t pos = (uint8_t)(posF * 99.0f / 100.0f + 0.5f);
+    // Op sessie klok: vaste afstand tot het verzendmoment, radio jitter telt niet mee
+    uint32_t atMs = (msg.timeSynced ? msg.timeMs : millis()) + KEON_MOTION_SCRIPT_DELAY_MS;
+    
+    if (keonMotion_source() != KEON_MOTION_SCRIPT) {
+      keonMotion_start(KEON_MOTION_SCRIPT);
+      Serial.println("[KEON MOTION] Funscript van Body ESP neemt over");
+    }
+    if (!keonMotion_push(atMs, pos)) {
+      Serial.printf("[KEON MOTION] Funscript actie pos %u @%lu geweigerd (rij vol / niet oplopend)\n",
+                    pos, (unsigned long)atMs);
+    }
+    break;
+  }
+  case ESPNOW_OP_AI_EMERGENCY_OVERRIDE: {
     Serial.println("[AI EMERGENCY] C-knop emergency override - stress level 7!");
     Serial.println("[AI EMERGENCY] Activeer safe mode: pauze, min speed, vibe uit, zuigen uit");
     
@@ -406,19 +696,22 @@ void handleBodyESPMessage(const bodyESP_message_t &msg) {
     aiOverruleActive = false;
     
     Serial.println("[AI EMERGENCY] Safe mode actief - gebruiker heeft volledige controle");
+    break;
   }
-  else if (strcmp(msg.command, "RESUME_SESSION") == 0) {
+  case ESPNOW_OP_RESUME_SESSION: {
       Serial.println("[PAUSE] Resume ontvangen van Body ESP - unpause!");
     
       extern void resetPauseState();
       resetPauseState();  // Roep ui.cpp functie aan
     
       Serial.println("[PAUSE] Resume complete!");
-    }
-  else {
+    break;
+  }
+  default:
     // Unknown command - log for debugging
-    Serial.printf("[WARNING] Unknown command from Body ESP: '%s' (Trust:%.2f, Sleeve:%.2f, StressLevel:%d, Vibe:%d, Zuigen:%d)\n", 
-                  msg.command, msg.newTrust, msg.newSleeve, msg.stressLevel, msg.vibeOn, msg.zuigenOn);
+    Serial.printf("[WARNING] Unknown command from Body ESP: %s (0x%02X) (Trust:%.2f, Sleeve:%.2f, StressLevel:%d, Vibe:%d, Zuigen:%d)\n", 
+                  espnow_opcodeName(msg.opcode), msg.opcode, msg.newTrust, msg.newSleeve, msg.stressLevel, msg.vibeOn, msg.zuigenOn);
+    break;
   }
 }
 
@@ -517,10 +810,45 @@ void sendPumpControlMessage(const MainMsgV3 &msg) {
   }
 }
 
+static void buildStatusPayload(const machineStatus_message_t &msg, EspNowStatusPayload &st) {
+  st.trust_x1000 = espnow_toFixed(msg.trust, 1000.0f);
+  st.sleeve_x1000 = espnow_toFixed(msg.sleeve, 1000.0f);
+  st.suction_x10 = espnow_toUFixed(msg.suction, 10.0f);
+  st.pause_x100 = espnow_toUFixed(msg.pause, 100.0f);
+  st.vacuumMbar_x10 = espnow_toFixed(msg.vacuumMbar, 10.0f);
+  st.cyclusTijd_x100 = espnow_toUFixed(msg.cyclusTijd, 100.0f);
+  st.sleevePct_x10 = espnow_toUFixed(msg.sleevePercentage, 10.0f);
+  st.speedStep = msg.currentSpeedStep;
+  st.bits = (msg.vibeOn ? ESPNOW_ST_VIBE : 0) |
+            (msg.zuigActive ? ESPNOW_ST_ZUIG : 0) |
+            (msg.pauseActive ? ESPNOW_ST_PAUSE : 0) |
+            (msg.lubeTrigger ? ESPNOW_ST_LUBE : 0);
+}
+
 void sendBodyESPStatusUpdate(const machineStatus_message_t &msg) {
-  esp_err_t result = esp_now_send(bodyESP_MAC, (uint8_t*)&msg, sizeof(msg));
+  EspNowFrame frame;
+  memset(&frame, 0, sizeof(frame));
+  buildStatusPayload(msg, frame.status);
+  
+  uint8_t buf[ESPNOW_MAX_FRAME];
+  uint8_t len = espnow_encode(frame, msg.opcode, espnowRel_nextSeq(bodyRel, msg.opcode), millis(), false, buf, ESPNOW_FLAG_SYNCED);
+  // ORGASM_TRIGGER e.d. tot ACK herhalen, voorrang opcodes direct dubbel
+  if (!espnowRel_send(bodyRel, buf, len, millis(), sendBodyFrame)) {
+    Serial.printf("[TX Body ESP ERROR] Send failed: %s\n", espnow_opcodeName(msg.opcode));
+  }
+}
+
+// Alleen de velden in mask (geen ACK: volgende delta of keepalive herstelt verlies)
+static void sendBodyESPStatusDelta(const EspNowStatusPayload &st, uint16_t mask) {
+  EspNowFrame frame;
+  memset(&frame, 0, sizeof(frame));
+  espnow_buildStatusDelta(frame, st, mask);
+  
+  uint8_t buf[ESPNOW_MAX_FRAME];
+  uint8_t len = espnow_encode(frame, ESPNOW_OP_STATUS_DELTA, espnowRel_nextSeq(bodyRel, ESPNOW_OP_STATUS_DELTA), millis(), false, buf, ESPNOW_FLAG_SYNCED);
+  esp_err_t result = esp_now_send(bodyESP_MAC, buf, len);
   if (result != ESP_OK) {
-    Serial.printf("[TX Body ESP ERROR] Send failed: %d\n", result);
+    Serial.printf("[TX Body ESP ERROR] Delta send failed: %d\n", result);
   }
 }
 
@@ -574,6 +902,7 @@ void updateVacuumControl() {
 }
 
 void sendPumpControlMessages() {
+  processESPNowPriority();   // Stop / vacuum los van Body ESP eerst toepassen
   uint32_t now = millis();
   
   // Skip sending als Pump Unit niet connected is
@@ -662,10 +991,11 @@ void sendStatusUpdates() {
     sendM5AtomStatusUpdate(heartbeatMsg);
   }
   
-  // Status naar Body ESP (2Hz) - alleen als connected
-  if (bodyESP_connected && (now - lastBodyESPUpdate >= BODY_ESP_UPDATE_INTERVAL)) {
-    lastBodyESPUpdate = now;
-    
+  // Status naar Body ESP - alleen als connected. Adaptief (espnow_publisher.h):
+  // urgente wijziging direct als delta, trage velden max 2Hz, volledig frame
+  // als keepalive / resync (deltas hebben geen ACK). Wacht zolang een
+  // voorrang frame (ORGASM_TRIGGER) nog niet bevestigd is.
+  if (bodyESP_connected && !espnowRel_priorityOpen(bodyRel)) {
     machineStatus_message_t msg;
     memset(&msg, 0, sizeof(msg));
     
@@ -691,15 +1021,16 @@ void sendStatusUpdates() {
     
     // Lube sync systeem - SIMPEL: bij elke punch count reset animatie
     static uint32_t lastPunchCount = 0;
+    static bool lubePending = false;   // Puls vasthouden tot hij echt verstuurd is
     
     // Check of er een nieuwe lube cyclus is gestart (punch count verhoogd)
-    bool newLubeTrigger = (punchCount > lastPunchCount);
-    if (newLubeTrigger) {
+    if (punchCount > lastPunchCount) {
       lastPunchCount = punchCount;
+      lubePending = true;
       Serial.printf("[LUBE SYNC] Animatie reset! Punch: %lu, Speed: %.1f\n", punchCount, getUserTrustSpeed());
     }
     
-    msg.lubeTrigger = newLubeTrigger;
+    msg.lubeTrigger = lubePending;
     msg.cyclusTijd = getUserTrustSpeed();  // Stuur gewoon de speed door
     msg.sleevePercentage = getSleevePercentage();  // Echte sleeve positie
     
@@ -707,61 +1038,83 @@ void sendStatusUpdates() {
     extern uint8_t g_speedStep;
     msg.currentSpeedStep = g_speedStep;
     
-    strcpy(msg.command, "STATUS_UPDATE");
+    msg.opcode = ESPNOW_OP_STATUS_UPDATE;
     
-    sendBodyESPStatusUpdate(msg);
-  }
-  
-  // Status en Colors naar M5Atom (4Hz) - altijd versturen (M5Atom is optioneel)
-  if (now - lastM5AtomUpdate >= M5ATOM_UPDATE_INTERVAL) {
-    lastM5AtomUpdate = now;
-    
-    // Send pump colors for display
-    pumpColors_message_t colorMsg;
-    memset(&colorMsg, 0, sizeof(colorMsg));
-    colorMsg.ver = 1;
-    colorMsg.kind = 2;  // MK_PUMP_COLORS
-    
-    // Set pump colors based on pump status
-    if (vacuumPumpStatus) {
-      colorMsg.a_r = 255; colorMsg.a_g = 0; colorMsg.a_b = 255;  // Vacuum: Magenta
-    } else {
-      colorMsg.a_r = 0; colorMsg.a_g = 0; colorMsg.a_b = 0;     // Off: Black
+    EspNowStatusPayload current;
+    buildStatusPayload(msg, current);
+    uint16_t changed = espnow_statusDiff(current, bodyLastSent, BODY_STATUS_DEADBAND);
+    EspNowPubSend kind = espnowPub_decide(bodyPub, now, changed & BODY_STATUS_URGENT,
+                                          changed & ~BODY_STATUS_URGENT);
+    if (kind == ESPNOW_PUB_FULL) {
+      sendBodyESPStatusUpdate(msg);
+    } else if (kind == ESPNOW_PUB_DELTA) {
+      // Alles wat afwijkt mee (ook binnen deadband): Body ESP komt exact op current
+      sendBodyESPStatusDelta(current, espnow_statusDiff(current, bodyLastSent, nullptr));
     }
-    
-    if (lubePumpStatus) {
-      colorMsg.b_r = 0; colorMsg.b_g = 255; colorMsg.b_b = 0;    // Lube: Green
-    } else {
-      colorMsg.b_r = 0; colorMsg.b_g = 0; colorMsg.b_b = 0;     // Off: Black
+    if (kind != ESPNOW_PUB_NONE) {
+      bodyLastSent = current;
+      lubePending = false;
+      espnowPub_sent(bodyPub, now, kind);
     }
-    
-    colorMsg.flags = (vacuumPumpStatus ? 0x01 : 0x00) | (lubePumpStatus ? 0x02 : 0x00);
-    
-    // LED commands: bit 2 = vacuum LED (follows vacuumPumpStatus), bit 3 = debug LED toggle
-    if (vacuumPumpStatus) colorMsg.flags |= 0x04;  // Set bit 2 for vacuum LED
-    
-    // Vibe (bit 3) - controlled by Z button double-click
-    if (vibeState) {
-      colorMsg.flags |= 0x08;  // Set bit 3
-      Serial.printf("[VIBE] vibeState=true, setting bit 3 in flags=0x%02X\n", colorMsg.flags);
+  }
+  
+  // Status en Colors naar M5Atom - bij wijziging, anders keepalive (M5Atom is optioneel)
+  pumpColors_message_t colorMsg;
+  memset(&colorMsg, 0, sizeof(colorMsg));
+  colorMsg.ver = 1;
+  colorMsg.kind = ESPNOW_MK_PUMP_COLORS;
+  
+  // Set pump colors based on pump status
+  if (vacuumPumpStatus) {
+    colorMsg.a_r = 255; colorMsg.a_g = 0; colorMsg.a_b = 255;  // Vacuum: Magenta
+  } else {
+    colorMsg.a_r = 0; colorMsg.a_g = 0; colorMsg.a_b = 0;     // Off: Black
+  }
+  
+  if (lubePumpStatus) {
+    colorMsg.b_r = 0; colorMsg.b_g = 255; colorMsg.b_b = 0;    // Lube: Green
+  } else {
+    colorMsg.b_r = 0; colorMsg.b_g = 0; colorMsg.b_b = 0;     // Off: Black
+  }
+  
+  colorMsg.flags = (vacuumPumpStatus ? 0x01 : 0x00) | (lubePumpStatus ? 0x02 : 0x00);
+  
+  // LED commands: bit 2 = vacuum LED (follows vacuumPumpStatus), bit 3 = debug LED toggle
+  if (vacuumPumpStatus) colorMsg.flags |= 0x04;  // Set bit 2 for vacuum LED
+  
+  // Vibe (bit 3) - controlled by Z button double-click
+  if (vibeState) colorMsg.flags |= 0x08;  // Set bit 3
+  
+  // Status update
+  monitoring_message_t m5Msg;
+  memset(&m5Msg, 0, sizeof(m5Msg));
+  
+  m5Msg.trustSpeed = getUserTrustSpeed();
+  m5Msg.sleeveSpeed = getUserSleeveSpeed();
+  m5Msg.aiOverruleActive = aiOverruleActive;
+  m5Msg.sessionTime = sessionActive ? (now / 1000.0f) : 0.0f;
+  
+  if (emergencyStop) strcpy(m5Msg.status, "EMERGENCY");
+  else if (sessionActive) strcpy(m5Msg.status, "ACTIVE");
+  else strcpy(m5Msg.status, "PAUSED");
+  
+  static pumpColors_message_t m5LastColors;
+  static monitoring_message_t m5LastStatus;
+  bool m5Urgent = memcmp(&colorMsg, &m5LastColors, sizeof(colorMsg)) != 0 ||
+                  strcmp(m5Msg.status, m5LastStatus.status) != 0 ||
+                  m5Msg.aiOverruleActive != m5LastStatus.aiOverruleActive;
+  bool m5Slow = m5Msg.trustSpeed != m5LastStatus.trustSpeed ||
+                m5Msg.sleeveSpeed != m5LastStatus.sleeveSpeed;
+  EspNowPubSend m5Kind = espnowPub_decide(m5Pub, now, m5Urgent, m5Slow);
+  if (m5Kind != ESPNOW_PUB_NONE) {
+    if ((colorMsg.flags ^ m5LastColors.flags) & 0x08) {
+      Serial.printf("[VIBE] vibeState=%d, flags=0x%02X\n", vibeState, colorMsg.flags);
     }
-    
     sendM5AtomPumpColors(colorMsg);
-    
-    // Send status update
-    monitoring_message_t msg;
-    memset(&msg, 0, sizeof(msg));
-    
-    msg.trustSpeed = getUserTrustSpeed();
-    msg.sleeveSpeed = getUserSleeveSpeed();
-    msg.aiOverruleActive = aiOverruleActive;
-    msg.sessionTime = sessionActive ? (now / 1000.0f) : 0.0f;
-    
-    if (emergencyStop) strcpy(msg.status, "EMERGENCY");
-    else if (sessionActive) strcpy(msg.status, "ACTIVE");
-    else strcpy(msg.status, "PAUSED");
-    
-    sendM5AtomStatusUpdate(msg);
+    sendM5AtomStatusUpdate(m5Msg);
+    m5LastColors = colorMsg;
+    m5LastStatus = m5Msg;
+    espnowPub_sent(m5Pub, now, m5Kind);
   }
 }
 
@@ -814,6 +1167,8 @@ void checkCommunicationTimeouts() {
 }
 
 void performSafetyChecks() {
+  processESPNowPriority();   // Nood stop van Body ESP vóór de checks verwerken
+  
   // Controleer AI override bounds
   bodyESP_trustOverride = (bodyESP_trustOverride < 0.0f) ? 0.0f : (bodyESP_trustOverride > 1.0f) ? 1.0f : bodyESP_trustOverride;
   bodyESP_sleeveOverride = (bodyESP_sleeveOverride < 0.0f) ? 0.0f : (bodyESP_sleeveOverride > 1.0f) ? 1.0f : bodyESP_sleeveOverride;
@@ -1086,7 +1441,7 @@ void sendOrgasmTrigger() {
   machineStatus_message_t msg;
   memset(&msg, 0, sizeof(msg));
   
-  strcpy(msg.command, "ORGASM_TRIGGER");
+  msg.opcode = ESPNOW_OP_ORGASM_TRIGGER;
   msg.trust = getUserTrustSpeed();
   msg.sleeve = getUserSleeveSpeed();
   msg.suction = abs(currentVacuumReading);
@@ -1112,7 +1467,7 @@ void sendFunscriptCommand(bool enabled) {
   machineStatus_message_t msg;
   memset(&msg, 0, sizeof(msg));
   
-  strcpy(msg.command, enabled ? "FUNSCRIPT_ON" : "FUNSCRIPT_OFF");
+  msg.opcode = enabled ? ESPNOW_OP_FUNSCRIPT_ON : ESPNOW_OP_FUNSCRIPT_OFF;
   msg.trust = getUserTrustSpeed();
   msg.sleeve = getUserSleeveSpeed();
   msg.suction = abs(currentVacuumReading);
@@ -2,6 +2,7 @@
 #include <Arduino.h>
 #include <esp_now.h>
 #include <WiFi.h>
+#include "espnow_protocol.h"
 
 // ===============================================================================
 // ESP-NOW COMMUNICATIE DEFINITTIES - HOOFDESP (E4:65:B8:7A:85:E4)
@@ -17,56 +18,31 @@ extern const uint8_t m5atom_MAC[6];     // M5Atom (50:02:91:87:23:F8) - Channel
 // MESSAGE STRUCTURES
 // ===============================================================================
 
-// Ontvangen van Body ESP - AI Commands (SIMPLE VERSION)
-typedef struct __attribute__((packed)) {
+// Ontvangen van Body ESP - AI Commands, gedecodeerd uit EspNowAiPayload
+// (wire formaat: espnow_protocol.h)
+typedef struct {
+  uint8_t opcode;         // ESPNOW_OP_AI_OVERRIDE, ESPNOW_OP_HEARTBEAT, ESPNOW_OP_PLAYBACK_STRESS, ...
+  uint16_t seq;           // Volgnummer van Body ESP
   float newTrust;         // AI berekende trust override (0.0-1.0)
   float newSleeve;        // AI berekende sleeve override (0.0-1.0)
   bool overruleActive;    // AI overrule status
   uint8_t stressLevel;    // Stress level 1-7 voor playback/AI
   bool vibeOn;           // Vibe status voor playback
   bool zuigenOn;         // Zuigen status voor playback
-  char command[32];       // "AI_OVERRIDE", "EMERGENCY_STOP", "HEARTBEAT", "PLAYBACK_STRESS"
+  uint32_t timeMs;        // hdr.timeMs: verzendmoment van de Body ESP
+  bool timeSynced;        // timeMs is sessie klok (HoofdESP millis), anders Body klok
+  // Latency trace (zie latency_trace.h) - duur per stap op Body ESP in us
+  uint32_t traceId;         // 0 = geen trace
+  uint32_t traceSensorUs;   // ads1115_readAll()
+  uint32_t traceDecisionUs; // stressManager.update() + beslissing
+  uint32_t traceSendUs;     // Beslissing klaar → esp_now_send()
+  uint32_t traceAirUs;      // Vorig trace bericht: send → send callback
 } bodyESP_message_t;
 
-// Body ESP AI Commands (Body ESP beslist, HoofdESP voert uit):
-// "AI_OVERRIDE"   - Trust/sleeve override (bestaand)
-// "AI_COMMAND"    - AI commando (speed/vacuum/pause/LED)
-// "HEARTBEAT"     - Verbinding check
-
-
-// Verzenden naar Pomp Unit - MainMsgV3 (backwards compatible)
-struct __attribute__((packed)) MainMsgV3 {
-  uint8_t  version;           // Bericht versie (3)
-  uint8_t  arrow_full;        // Pijl vol status (0/1)
-  uint8_t  session_started;   // Sessie start trigger
-  uint32_t punch_count;       // Huidige punch teller
-  uint32_t punch_goal;        // Punch doel voor lube trigger
-  int16_t  vacuum_set_x10;    // Vacuum setpoint (tienden cmHg)
-  uint8_t  force_pump_state;  // 0=AUTO, 1=FORCE_OFF, 2=FORCE_ON
-  uint8_t  cmd_lube_prime_now;// Pulse commando: lube prime
-  uint8_t  cmd_lube_shot_now; // Pulse commando: lube shot
-  uint16_t lube_duration_ms;  // Lube timing in milliseconden (0-20000ms)
-  uint8_t  cmd_toggle_zuigen; // Pulse commando: toggle zuigen mode (0/1)
-  int16_t  zuig_target_x10;   // Zuig target vacuum (tienden cmHg)
-};
-
-// Ontvangen van Pomp Unit - Vacuum System Telemetry
-struct __attribute__((packed)) PumpStatusMsg {
-  uint8_t  version;              // Message versie (1)
-  float    current_vacuum_cmHg;  // 🎯 HX711 vacuum waarde (real-time!)
-  uint8_t  vacuum_pump_on;       // Vacuum pomp status (0/1)
-  uint8_t  lube_pump_on;         // Lube pomp status (0/1)
-  uint8_t  servo_open;           // Servo valve positie (0/1)
-  uint8_t  air_relay_open;       // Air relay status (0/1)
-  float    lube_remaining_sec;   // Resterende lube tijd
-  char     system_status[8];     // "OK"/"TARE"/"ERROR"
-  uint8_t  force_pump_state;     // Huidige force state
-  uint8_t  zuig_active;          // Zuigen mode actief op Pomp Unit (0/1)
-  uint32_t uptime_sec;           // System uptime
-};
-
-// Verzenden naar Body ESP - Machine Status Update
-typedef struct __attribute__((packed)) {
+// Pomp Unit: MainMsgV3 (verzenden) en PumpStatusMsg (ontvangen) staan in espnow_protocol.h
+
+// Verzenden naar Body ESP - Machine Status Update (wordt EspNowStatusPayload)
+typedef struct {
   float trust;            // Huidige trust speed (0.0-2.0)
   float sleeve;           // Huidige sleeve speed (0.0-2.0)  
   float suction;          // Suction level (0.0-100.0)
@@ -79,17 +55,11 @@ typedef struct __attribute__((packed)) {
   float cyclusTijd;       // Verwachte cyclus duur in seconden
   float sleevePercentage; // Sleeve positie percentage (0.0-100.0)
   uint8_t currentSpeedStep; // Huidige versnelling (0-7)
-  char command[32];       // "STATUS_UPDATE"
+  uint8_t opcode;         // ESPNOW_OP_STATUS_UPDATE, ESPNOW_OP_ORGASM_TRIGGER, ...
 } machineStatus_message_t;
 
-// Ontvangen van M5Atom - Motion Data (AtomMotion from M5Atom)
-typedef struct __attribute__((packed)) {
-  uint8_t ver;     // Message version (1)
-  uint8_t kind;    // Message kind (1 = MK_ATOM_MOTION)
-  int8_t dir;      // Motion direction: +1=UP, -1=DOWN, 0=STILL
-  uint8_t speed;   // Motion speed (0-100)
-  uint8_t flags;   // Extra flags
-} atomMotion_message_t;
+// Ontvangen van M5Atom - Motion Data (AtomMotion, espnow_protocol.h)
+typedef AtomMotion atomMotion_message_t;
 
 // Ontvangen van M5Atom - Remote Commands (future use)
 typedef struct __attribute__((packed)) {
@@ -99,14 +69,8 @@ typedef struct __attribute__((packed)) {
   int duration;          // Session duur (minuten)
 } m5atom_command_message_t;
 
-// Verzenden naar M5Atom - Pump Colors (matches M5Atom PumpColors struct)
-typedef struct __attribute__((packed)) {
-  uint8_t ver;     // Message version (1)
-  uint8_t kind;    // Message kind (2 = MK_PUMP_COLORS)
-  uint8_t a_r, a_g, a_b;  // Pump A color
-  uint8_t b_r, b_g, b_b;  // Pump B color
-  uint8_t flags;   // Status flags
-} pumpColors_message_t;
+// Verzenden naar M5Atom - Pump Colors (PumpColors, espnow_protocol.h)
+typedef PumpColors pumpColors_message_t;
 
 // Verzenden naar M5Atom - Status & Data Streaming
 typedef struct __attribute__((packed)) {
@@ -160,8 +124,11 @@ extern bool debugLedState;
 extern bool vibeState;  // Z-knop debug LED toggle state
 
 // Timing constants
-extern const uint32_t BODY_ESP_UPDATE_INTERVAL;   // 500ms (2Hz)
-extern const uint32_t M5ATOM_UPDATE_INTERVAL;     // 250ms (4Hz)
+extern const uint32_t BODY_ESP_UPDATE_INTERVAL;   // Trage status velden max 2Hz
+extern const uint32_t BODY_ESP_MIN_GAP;           // Urgente status wijziging: max 25Hz
+extern const uint32_t BODY_ESP_KEEPALIVE;         // Volledige status zonder wijzigingen
+extern const uint32_t M5ATOM_UPDATE_INTERVAL;     // Speeds naar M5Atom max 4Hz
+extern const uint32_t M5ATOM_KEEPALIVE;           // Colors zonder wijzigingen
 extern const uint32_t BODY_ESP_TIMEOUT;           // 10 seconds
 extern const uint32_t PUMP_UNIT_TIMEOUT;          // 5 seconds
 extern const uint32_t M5ATOM_TIMEOUT;             // 15 seconds
@@ -172,6 +139,20 @@ extern const uint32_t M5ATOM_TIMEOUT;             // 15 seconds
 
 void initESPNow();
 void onESPNowReceive(const esp_now_recv_info *info, const uint8_t *data, int len);
+void processESPNowRx();   // Vanuit loop(): ontvangen frames verwerken
+void processESPNowPriority();   // Alleen voorrang frames (stop, nood pauze, vacuum los)
+void processESPNowReliable();   // Vanuit loop(): herhalingen naar Body ESP
+void processESPNowLink();   // Vanuit loop(): PING naar Body ESP + link waarschuwing
+
+// Link kwaliteit per peer (espnow_link.h) voor de ESP status pagina
+struct EspNowLinkStats;
+struct EspNowRxQueue;
+const EspNowLinkStats& getBodyLinkStats();
+const EspNowLinkStats& getPumpLinkStats();
+const EspNowLinkStats& getM5LinkStats();
+const EspNowRxQueue& getESPNowRxQueue();
+uint8_t getBodyPendingFrames();     // Kritieke frames zonder ACK
+uint32_t getBodyDroppedFrames();    // Opgegeven na max herhalingen
 
 // Message handlers
 void handleBodyESPMessage(const bodyESP_message_t &msg);                    // Uitgebreide AI overrule
@@ -0,0 +1,230 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include "espnow_protocol.h"
+
+// ===============================================================================
+// ESP-NOW LINK KWALITEIT - RTT, verlies, RSSI per peer
+// ===============================================================================
+// IDENTIEKE KOPIE in:
+//   Body_ESP_FINAL/Body_ESP/espnow_link.h
+//   Hooft_ESP/Hooft_ESP_KEON/espnow_link.h
+//
+// "Recent iets gezien" zegt niet of de radio link slechter wordt. Per peer
+// een EspNowLinkStats die alles uit het normale verkeer haalt:
+//
+//   Verlies:  gaten in hdr.seq (elke zender nummert al zijn frames naar
+//             deze peer, herhalingen hergebruiken hun seq → geen verlies).
+//             Kritieke en overige frames hebben elk een eigen reeks
+//             (espnowRel_nextSeq), dus per reeks bijgehouden
+//   RSSI:     uit de receive callback (esp_now_recv_info.rx_ctrl)
+//   RTT:      elke ESPNOW_LINK_PING_MS een PING, peer stuurt direct PONG
+//             met t1Us terug. Geen PONG binnen de timeout = ping verloren.
+//             De t1..t4 stempels voeden ook espnow_timesync.h
+//   1-weg:    frames met ESPNOW_FLAG_SYNCED: ontvangst - hdr.timeMs
+//   Peer:     PING en PONG dragen de eigen RSSI/verlies mee, dus beide
+//             kanten kennen beide richtingen
+//
+// Gemiddelden zijn EWMA (geen buffers), min/max lopen sinds reset.
+// Peers zonder binair protocol (Pomp, M5) alleen RSSI + laatste contact.
+// ===============================================================================
+
+#define ESPNOW_LINK_PING_MS          1000
+#define ESPNOW_LINK_PING_TIMEOUT_MS  1000    // PONG later dan dit = verloren
+#define ESPNOW_LINK_MAX_GAP          64      // Grotere sprong in seq = peer herstart
+#define ESPNOW_LINK_STALE_MS         3000    // Zo lang niets ontvangen = geen link
+#define ESPNOW_LINK_RTT_ALPHA        0.125f  // Zelfde gewichten als TCP SRTT/RTTVAR
+#define ESPNOW_LINK_JITTER_ALPHA     0.25f
+#define ESPNOW_LINK_RSSI_ALPHA       0.1f
+#define ESPNOW_LINK_LOSS_ALPHA       0.02f   // Per frame: ~50 frames geheugen
+
+struct EspNowLinkStats {
+  // Ontvangst (seq gaten), [0] overige frames, [1] kritieke (ACK_REQ)
+  bool     rxSynced[2];
+  uint16_t rxNextSeq[2];
+  uint32_t rxFrames;
+  uint32_t rxLost;
+  float    lossAvg;            // 0-1
+  uint32_t lastRxMs;
+
+  // RSSI (dBm)
+  int8_t   rssiLast;
+  int8_t   rssiMin;
+  float    rssiAvg;            // 0 = nog niets gemeten
+
+  // RTT (ms)
+  uint16_t pingId;
+  bool     pingOpen;
+  uint32_t pingSentMs;
+  uint32_t pingsSent;
+  uint32_t pongs;
+  uint32_t pingsLost;
+  float    rttLastMs;
+  float    rttAvgMs;
+  float    rttJitterMs;
+  float    rttMinMs;
+  float    rttMaxMs;
+
+  // One-way (alleen met gesynchroniseerde klokken, ms resolutie)
+  uint32_t oneWayCount;
+  float    oneWayLastMs;
+  float    oneWayAvgMs;
+
+  // Zoals de peer ons ontvangt (uit PING/PONG)
+  int8_t   peerRssi;
+  uint8_t  peerLossPct;
+  uint32_t peerReportMs;
+};
+
+static inline void espnowLink_reset(EspNowLinkStats& link) {
+  memset(&link, 0, sizeof(link));
+}
+
+static inline uint8_t espnowLink_lossPct(const EspNowLinkStats& link) {
+  return (uint8_t)(link.lossAvg * 100.0f + 0.5f);
+}
+
+static inline void espnowLink_onRssi(EspNowLinkStats& link, int8_t rssi, uint32_t nowMs) {
+  link.lastRxMs = nowMs;
+  if (rssi == 0) return;   // Onbekend (bv. ESP8266 callback)
+  link.rssiLast = rssi;
+  if (link.rssiAvg == 0.0f) {
+    link.rssiAvg = rssi;
+    link.rssiMin = rssi;
+  } else {
+    link.rssiAvg += ESPNOW_LINK_RSSI_ALPHA * (rssi - link.rssiAvg);
+    if (rssi < link.rssiMin) link.rssiMin = rssi;
+  }
+}
+
+// Elk geldig frame van deze peer (ook ACK/PING/PONG en duplicaten)
+static inline void espnowLink_onFrame(EspNowLinkStats& link, const EspNowHeader& hdr, int8_t rssi, uint32_t nowMs) {
+  espnowLink_onRssi(link, rssi, nowMs);
+  link.rxFrames++;
+
+  uint8_t r = (hdr.flags & ESPNOW_FLAG_ACK_REQ) ? 1 : 0;
+  if (!link.rxSynced[r]) {
+    link.rxSynced[r] = true;
+    link.rxNextSeq[r] = hdr.seq + 1;
+    return;
+  }
+
+  int16_t gap = (int16_t)(hdr.seq - link.rxNextSeq[r]);
+  if (gap < 0) return;                 // Herhaling / te laat: al geteld
+  if (gap > ESPNOW_LINK_MAX_GAP) {     // Peer herstart: opnieuw beginnen
+    link.rxNextSeq[r] = hdr.seq + 1;
+    return;
+  }
+
+  link.rxNextSeq[r] = hdr.seq + 1;
+  link.rxLost += gap;
+  for (int16_t i = 0; i < gap; i++) {
+    link.lossAvg += ESPNOW_LINK_LOSS_ALPHA * (1.0f - link.lossAvg);
+  }
+  link.lossAvg -= ESPNOW_LINK_LOSS_ALPHA * link.lossAvg;
+}
+
+// Tijd voor een PING? Houdt ook verlopen pings bij.
+static inline bool espnowLink_pingDue(EspNowLinkStats& link, uint32_t nowMs) {
+  if (link.pingOpen && nowMs - link.pingSentMs > ESPNOW_LINK_PING_TIMEOUT_MS) {
+    link.pingOpen = false;
+    link.pingsLost++;
+  }
+  return link.pingsSent == 0 || nowMs - link.pingSentMs >= ESPNOW_LINK_PING_MS;
+}
+
+// Eigen ontvangst kwaliteit in een PING/PONG payload
+static inline void espnowLink_fillView(const EspNowLinkStats& link, EspNowLinkPayload& p) {
+  p.rssi = (int8_t)(link.rssiAvg - 0.5f);
+  p.lossPct = espnowLink_lossPct(link);
+}
+
+// PING payload vullen (daarna espnow_encode met ESPNOW_OP_PING), t1Us = esp_timer_get_time()
+static inline void espnowLink_buildPing(EspNowLinkStats& link, uint32_t nowMs, int64_t t1Us, EspNowFrame& frame) {
+  link.pingId++;
+  link.pingOpen = true;
+  link.pingSentMs = nowMs;
+  link.pingsSent++;
+  frame.link.t1Us = t1Us;
+  frame.link.t2Us = 0;
+  frame.link.t3Us = 0;
+  frame.link.pingId = link.pingId;
+  espnowLink_fillView(link, frame.link);
+}
+
+static inline void espnowLink_onPeerView(EspNowLinkStats& link, const EspNowLinkPayload& p, uint32_t nowMs) {
+  link.peerRssi = p.rssi;
+  link.peerLossPct = p.lossPct;
+  link.peerReportMs = nowMs;
+}
+
+// Ontvangen PING → PONG payload (daarna espnow_encode met ESPNOW_OP_PONG).
+// t2Us = ontvangst van de PING (receive callback), t3Us = nu (vlak voor send)
+static inline void espnowLink_buildPong(EspNowLinkStats& link, const EspNowFrame& ping, uint32_t nowMs,
+                                        int64_t t2Us, int64_t t3Us, EspNowFrame& pong) {
+  espnowLink_onPeerView(link, ping.link, nowMs);
+  pong.link.t1Us = ping.link.t1Us;
+  pong.link.t2Us = t2Us;
+  pong.link.t3Us = t3Us;
+  pong.link.pingId = ping.link.pingId;
+  espnowLink_fillView(link, pong.link);
+}
+
+// Ontvangen PONG: RTT bijwerken (t4Us = ontvangst). false = onbekende / te late ping.
+// RTT is inclusief de loop() vertraging van de peer: dat is wat besturing merkt.
+static inline bool espnowLink_onPong(EspNowLinkStats& link, const EspNowFrame& pong, uint32_t nowMs, int64_t t4Us) {
+  espnowLink_onPeerView(link, pong.link, nowMs);
+  if (!link.pingOpen || pong.link.pingId != link.pingId) return false;
+  link.pingOpen = false;
+  link.pongs++;
+
+  float rtt = (t4Us - pong.link.t1Us) / 1000.0f;
+  link.rttLastMs = rtt;
+  if (link.pongs == 1) {
+    link.rttAvgMs = rtt;
+    link.rttJitterMs = rtt / 2.0f;
+    link.rttMinMs = rtt;
+    link.rttMaxMs = rtt;
+  } else {
+    float dev = rtt > link.rttAvgMs ? rtt - link.rttAvgMs : link.rttAvgMs - rtt;
+    link.rttJitterMs += ESPNOW_LINK_JITTER_ALPHA * (dev - link.rttJitterMs);
+    link.rttAvgMs += ESPNOW_LINK_RTT_ALPHA * (rtt - link.rttAvgMs);
+    if (rtt < link.rttMinMs) link.rttMinMs = rtt;
+    if (rtt > link.rttMaxMs) link.rttMaxMs = rtt;
+  }
+  return true;
+}
+
+// Frame met ESPNOW_FLAG_SYNCED: ontvangst (sessie klok) - hdr.timeMs
+static inline void espnowLink_onOneWay(EspNowLinkStats& link, int32_t oneWayMs) {
+  if (oneWayMs < 0) oneWayMs = 0;     // Klok fout binnen de sync marge
+  link.oneWayLastMs = oneWayMs;
+  link.oneWayAvgMs = (link.oneWayCount == 0) ? oneWayMs
+                   : link.oneWayAvgMs + ESPNOW_LINK_RTT_ALPHA * (oneWayMs - link.oneWayAvgMs);
+  link.oneWayCount++;
+}
+
+// 0-100: slechtste van verlies (0-20%), RTT (5-50 ms) en RSSI (-60..-90 dBm)
+static inline uint8_t espnowLink_quality(const EspNowLinkStats& link, uint32_t nowMs) {
+  if (link.lastRxMs == 0 || nowMs - link.lastRxMs > ESPNOW_LINK_STALE_MS) return 0;
+
+  float q = 100.0f - link.lossAvg * 500.0f;
+  if (link.pongs > 0) {
+    float qRtt = 100.0f - (link.rttAvgMs - 5.0f) * (100.0f / 45.0f);
+    if (qRtt < q) q = qRtt;
+  }
+  if (link.rssiAvg != 0.0f) {
+    float qRssi = (link.rssiAvg + 90.0f) * (100.0f / 30.0f);
+    if (qRssi < q) q = qRssi;
+  }
+  if (q < 0.0f) q = 0.0f;
+  if (q > 100.0f) q = 100.0f;
+  return (uint8_t)q;
+}
+
+static inline const char* espnowLink_qualityName(uint8_t quality) {
+  if (quality >= 70) return "GOED";
+  if (quality >= 40) return "MATIG";
+  if (quality > 0) return "SLECHT";
+  return "GEEN";
+}
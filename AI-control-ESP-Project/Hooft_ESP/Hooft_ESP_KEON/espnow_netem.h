@@ -0,0 +1,127 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include "espnow_rx_queue.h"
+
+// ===============================================================================
+// ESP-NOW NETEM - Nagebootst slecht radio kanaal (test / benchmark)
+// ===============================================================================
+// IDENTIEKE KOPIE in:
+//   Body_ESP_FINAL/Body_ESP/espnow_netem.h
+//   Hooft_ESP/Hooft_ESP_KEON/espnow_netem.h
+//
+// Ack/herhaling, delta status en tijd sync gedragen zich pas echt anders
+// bij verlies en vertraging, en die zijn op een bureau met twee borden
+// naast elkaar niet na te maken. Tussen espnowRx_pop() en de dispatch zit
+// daarom een virtueel medium (zoals Linux netem):
+//
+//   verlies   lossPct % van de frames verdwijnt
+//   latency   elk frame komt latencyMs later binnen
+//   jitter    + willekeurig 0..jitterMs
+//   volgorde  reorderPct % krijgt nog eens latencyMs + jitterMs extra,
+//             dus latere frames halen het in
+//
+// Alleen de ontvangst kant: op beide nodes aanzetten = beide richtingen.
+// rxUs wordt het moment van vrijgeven, zodat RTT / 1-weg / tijd sync het
+// nagebootste kanaal meten. Vaste seed → een scenario is herhaalbaar.
+// Uit (ESPNOW_NETEM_ENABLED 0) kost het niets: de aanroeper slaat alles over.
+// ===============================================================================
+
+#ifndef ESPNOW_NETEM_ENABLED
+#define ESPNOW_NETEM_ENABLED   0
+#endif
+#define ESPNOW_NETEM_SLOTS     16      // Frames tegelijk "in de lucht"
+
+struct EspNowNetemConfig {
+  uint8_t  lossPct;
+  uint16_t latencyMs;
+  uint16_t jitterMs;
+  uint8_t  reorderPct;
+};
+
+struct EspNowNetemSlot {
+  bool     inUse;
+  uint32_t releaseUs;
+  uint32_t order;       // Aankomst volgorde bij gelijke releaseUs
+  EspNowRxItem item;
+};
+
+struct EspNowNetem {
+  EspNowNetemConfig cfg;
+  EspNowNetemSlot slots[ESPNOW_NETEM_SLOTS];
+  uint32_t rng;
+  uint32_t nextOrder;
+
+  uint32_t passed;
+  uint32_t lost;
+  uint32_t reordered;
+  uint32_t overflow;    // Geen slot vrij → frame als verloren geteld
+};
+
+static inline void espnowNetem_init(EspNowNetem& net, const EspNowNetemConfig& cfg, uint32_t seed) {
+  memset(&net, 0, sizeof(net));
+  net.cfg = cfg;
+  net.rng = seed ? seed : 0x2545F491;
+}
+
+// xorshift32: klein, snel en herhaalbaar
+static inline uint32_t espnowNetem_rand(EspNowNetem& net) {
+  uint32_t x = net.rng;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  net.rng = x;
+  return x;
+}
+
+static inline bool espnowNetem_chance(EspNowNetem& net, uint8_t pct) {
+  return pct > 0 && (espnowNetem_rand(net) % 100) < pct;
+}
+
+// Frame uit de rx queue het medium in. false = "verloren"
+static inline bool espnowNetem_push(EspNowNetem& net, const EspNowRxItem& item, uint32_t nowUs) {
+  if (espnowNetem_chance(net, net.cfg.lossPct)) {
+    net.lost++;
+    return false;
+  }
+
+  uint32_t delayUs = (uint32_t)net.cfg.latencyMs * 1000;
+  if (net.cfg.jitterMs > 0) delayUs += espnowNetem_rand(net) % ((uint32_t)net.cfg.jitterMs * 1000 + 1);
+  if (espnowNetem_chance(net, net.cfg.reorderPct)) {
+    delayUs += ((uint32_t)net.cfg.latencyMs + net.cfg.jitterMs) * 1000 + 1000;
+    net.reordered++;
+  }
+
+  for (int i = 0; i < ESPNOW_NETEM_SLOTS; i++) {
+    EspNowNetemSlot& s = net.slots[i];
+    if (s.inUse) continue;
+    s.inUse = true;
+    s.releaseUs = nowUs + delayUs;
+    s.order = net.nextOrder++;
+    s.item = item;
+    return true;
+  }
+  net.overflow++;
+  net.lost++;
+  return false;
+}
+
+// Eerstvolgende frame waarvan de tijd om is (vroegste eerst). false = niets klaar
+static inline bool espnowNetem_pop(EspNowNetem& net, uint32_t nowUs, EspNowRxItem& out) {
+  int best = -1;
+  for (int i = 0; i < ESPNOW_NETEM_SLOTS; i++) {
+    const EspNowNetemSlot& s = net.slots[i];
+    if (!s.inUse || (int32_t)(nowUs - s.releaseUs) < 0) continue;
+    if (best < 0 || (int32_t)(s.releaseUs - net.slots[best].releaseUs) < 0 ||
+        (s.releaseUs == net.slots[best].releaseUs && (int32_t)(s.order - net.slots[best].order) < 0)) {
+      best = i;
+    }
+  }
+  if (best < 0) return false;
+
+  net.slots[best].inUse = false;
+  out = net.slots[best].item;
+  out.rxUs = nowUs;
+  net.passed++;
+  return true;
+}
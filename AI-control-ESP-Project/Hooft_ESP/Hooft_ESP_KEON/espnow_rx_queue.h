@@ -0,0 +1,95 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+// ===============================================================================
+// ESP-NOW ONTVANGST QUEUE - Lock-free SPSC (1 producer, 1 consumer)
+// ===============================================================================
+// IDENTIEKE KOPIE in:
+//   Body_ESP_FINAL/Body_ESP/espnow_rx_queue.h
+//   Hooft_ESP/Hooft_ESP_KEON/espnow_rx_queue.h
+//   Pomp_unit_V1.0/espnow_rx_queue.h
+//
+// De receive callback draait in de WiFi task. Daar globals schrijven geeft
+// halve updates in loop() en Serial.printf blokkeert de WiFi task.
+//
+//   callback (producer): espnowRx_push() - alleen kopiëren, geen Serial
+//   loop()   (consumer): espnowRx_pop()  - decoderen + state bijwerken
+//
+// head wordt alleen door de producer geschreven, tail alleen door de
+// consumer: geen lock nodig, alleen release/acquire ordening op de index.
+// Vol = nieuw frame weggooien (oude frames blijven in volgorde) + teller.
+// ===============================================================================
+
+#ifndef ESPNOW_RXQ_DEPTH
+#define ESPNOW_RXQ_DEPTH      8       // Macht van 2
+#endif
+#ifndef ESPNOW_RXQ_MAX_LEN
+#define ESPNOW_RXQ_MAX_LEN    48      // Grootste verwachte frame (bytes)
+#endif
+
+static_assert((ESPNOW_RXQ_DEPTH & (ESPNOW_RXQ_DEPTH - 1)) == 0, "ESPNOW_RXQ_DEPTH moet macht van 2 zijn");
+
+struct EspNowRxItem {
+  uint8_t  mac[6];      // Afzender
+  uint8_t  len;
+  int8_t   rssi;        // 0 = onbekend
+  uint32_t rxUs;        // micros() bij ontvangst
+  uint8_t  data[ESPNOW_RXQ_MAX_LEN];
+};
+
+struct EspNowRxQueue {
+  EspNowRxItem items[ESPNOW_RXQ_DEPTH];
+  volatile uint32_t head;       // Producer: volgende schrijfpositie
+  volatile uint32_t tail;       // Consumer: volgende leespositie
+  volatile uint32_t received;   // Alle frames die de callback zag
+  volatile uint32_t overflows;  // Queue vol → weggegooid
+  volatile uint32_t tooLong;    // Groter dan ESPNOW_RXQ_MAX_LEN → weggegooid
+  volatile uint8_t  highWater;  // Hoogste bezetting
+};
+
+// Producer (WiFi task / receive callback)
+static inline bool espnowRx_push(EspNowRxQueue& q, const uint8_t* mac, const uint8_t* data,
+                                 int len, int8_t rssi, uint32_t rxUs) {
+  q.received++;
+  if (len < 0 || len > ESPNOW_RXQ_MAX_LEN) {
+    q.tooLong++;
+    return false;
+  }
+
+  uint32_t head = q.head;
+  uint32_t tail = __atomic_load_n(&q.tail, __ATOMIC_ACQUIRE);
+  uint32_t used = head - tail;
+  if (used >= ESPNOW_RXQ_DEPTH) {
+    q.overflows++;
+    return false;
+  }
+
+  EspNowRxItem& item = q.items[head & (ESPNOW_RXQ_DEPTH - 1)];
+  memcpy(item.mac, mac, 6);
+  item.len = (uint8_t)len;
+  item.rssi = rssi;
+  item.rxUs = rxUs;
+  memcpy(item.data, data, len);
+
+  // Item eerst volledig schrijven, dan pas zichtbaar maken
+  __atomic_store_n(&q.head, head + 1, __ATOMIC_RELEASE);
+  if (used + 1 > q.highWater) q.highWater = used + 1;
+  return true;
+}
+
+// Consumer (loop) - false = leeg
+static inline bool espnowRx_pop(EspNowRxQueue& q, EspNowRxItem& out) {
+  uint32_t tail = q.tail;
+  uint32_t head = __atomic_load_n(&q.head, __ATOMIC_ACQUIRE);
+  if (tail == head) return false;
+
+  out = q.items[tail & (ESPNOW_RXQ_DEPTH - 1)];
+  __atomic_store_n(&q.tail, tail + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+// Aantal weggegooide frames (vol + te lang)
+static inline uint32_t espnowRx_dropped(const EspNowRxQueue& q) {
+  return q.overflows + q.tooLong;
+}
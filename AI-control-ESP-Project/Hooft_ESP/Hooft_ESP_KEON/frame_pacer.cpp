@@ -0,0 +1,206 @@
+#include "frame_pacer.h"
+
+// ===============================================================================
+// STATE - alleen loop() (Core 1), geen lock nodig
+// ===============================================================================
+
+static SampleRing rings[FRAME_STAGE_COUNT];
+static FrameCounters counters = {0, 0, 0, 0, 0};
+
+static const uint32_t FRAME_PERIOD_US = 1000000UL / FRAME_TARGET_FPS;
+static const uint32_t FRAME_BUDGET_US = FRAME_PERIOD_US * FRAME_BUDGET_PCT / 100;
+
+static uint32_t nextFrameUs = 0;
+static uint32_t frameStartUs = 0;
+static uint32_t lastFrameEndUs = 0;
+static uint32_t frameFlushUs = 0;
+static bool frameFlushed = false;
+static bool skipThisFrame = false;
+static bool skipNextFrame = false;
+static uint32_t workEstUs = 0;         // Frame werk van getekende frames (EMA)
+
+static uint32_t animLastUs = 0;
+static uint32_t animAccUs = 0;
+
+static uint32_t lastControlUs = 0;
+static void (*controlTasks)() = nullptr;
+static bool inControl = false;
+static uint32_t frameControlUs = 0;    // Control rondes binnen dit frame
+
+static uint32_t lastReportedFrames = 0;
+static uint32_t lastReportMs = 0;
+
+static const char* STAGE_NAMES[FRAME_STAGE_COUNT] = {
+  "Frame", "Render", "Flush", "Control"
+};
+
+// Histogram grenzen (ms) voor het serial rapport, laatste vak = daarboven
+static const uint8_t HIST_EDGES_MS[] = {2, 4, 8, 12, 17, 25, 33, 50};
+static const uint8_t HIST_BUCKETS = sizeof(HIST_EDGES_MS) + 1;
+
+static void addSample(FrameStage stage, uint32_t us) {
+  sampleRing_add(rings[stage], us);
+}
+
+// ===============================================================================
+// FRAMES
+// ===============================================================================
+
+void framePacer_setControl(void (*controlFn)()) {
+  controlTasks = controlFn;
+}
+
+bool framePacer_frameDue(uint32_t nowUs) {
+  if (counters.frames == 0) return true;
+  if ((int32_t)(nowUs - nextFrameUs) < 0) return false;
+  return nowUs - lastFrameEndUs >= FRAME_CONTROL_GAP_US;
+}
+
+void framePacer_beginFrame(uint32_t nowUs) {
+  uint32_t lateUs = 0;
+  if (counters.frames > 0) {
+    addSample(FRAME_STAGE_FRAME, nowUs - frameStartUs);
+    if (nowUs - nextFrameUs > FRAME_PERIOD_US) {
+      counters.late++;
+      nextFrameUs = nowUs;            // Niet inhalen: tempo vanaf nu
+    } else {
+      lateUs = nowUs - nextFrameUs;   // Al van de frame tijd op
+    }
+    nextFrameUs += FRAME_PERIOD_US;
+  } else {
+    nextFrameUs = nowUs + FRAME_PERIOD_US;
+  }
+  frameStartUs = nowUs;
+  frameFlushUs = 0;
+  frameFlushed = false;
+  frameControlUs = 0;
+
+  // Vooraf: past het verwachte werk nog in het budget? Anders nu al niet
+  // tekenen i.p.v. pas het frame na een te duur frame
+  bool wontFit = workEstUs != 0 && lateUs + workEstUs > FRAME_BUDGET_US;
+  skipThisFrame = !skipThisFrame && (skipNextFrame || wontFit);
+  skipNextFrame = false;
+  if (skipThisFrame) counters.renderSkipped++;
+  counters.frames++;
+}
+
+void framePacer_endFrame(uint32_t nowUs) {
+  uint32_t workUs = nowUs - frameStartUs - frameControlUs;
+  lastFrameEndUs = nowUs;
+  if (skipThisFrame) return;          // Niet representatief voor de render tijd
+
+  addSample(FRAME_STAGE_RENDER, workUs > frameFlushUs ? workUs - frameFlushUs : 0);
+  if (frameFlushed) addSample(FRAME_STAGE_FLUSH, frameFlushUs);
+  workEstUs = workEstUs ? workEstUs + ((int32_t)workUs - (int32_t)workEstUs) / 4 : workUs;
+
+  if (workUs > FRAME_BUDGET_US) {
+    counters.overBudget++;
+    skipNextFrame = true;             // Volgende frame control taken voor laten gaan
+  }
+}
+
+bool framePacer_skipRender() {
+  return skipThisFrame;
+}
+
+void framePacer_onFlush(uint32_t flushUs) {
+  frameFlushUs += flushUs;
+  frameFlushed = true;
+}
+
+// Midden in uiTick(): control taken niet een heel frame laten wachten
+void framePacer_controlPoint() {
+  if (!controlTasks || inControl) return;
+  uint32_t startUs = micros();
+  if (startUs - lastControlUs < FRAME_CONTROL_GAP_US) return;
+
+  inControl = true;
+  controlTasks();                     // Roept zelf framePacer_controlTick()
+  inControl = false;
+  frameControlUs += micros() - startUs;
+  counters.controlInFrame++;
+}
+
+uint8_t framePacer_animSteps(uint32_t nowUs) {
+  if (animLastUs == 0) {
+    animLastUs = nowUs;
+    return 0;
+  }
+  animAccUs += nowUs - animLastUs;
+  animLastUs = nowUs;
+  uint32_t steps = animAccUs / FRAME_ANIM_STEP_US;
+  animAccUs -= steps * FRAME_ANIM_STEP_US;
+  if (steps > FRAME_ANIM_MAX_STEPS) steps = FRAME_ANIM_MAX_STEPS;   // Rest vervalt
+  return (uint8_t)steps;
+}
+
+void framePacer_controlTick(uint32_t nowUs) {
+  if (lastControlUs != 0) addSample(FRAME_STAGE_CONTROL, nowUs - lastControlUs);
+  lastControlUs = nowUs;
+}
+
+// ===============================================================================
+// STATISTIEK
+// ===============================================================================
+
+FrameStats framePacer_getStats(FrameStage stage) {
+  if (stage >= FRAME_STAGE_COUNT) return FrameStats{0, 0, 0, 0};
+  return sampleRing_stats(rings[stage]);
+}
+
+// Gemiddelde over de ring: p50 zegt weinig als frames om en om getekend worden
+float framePacer_fps() {
+  const SampleRing &r = rings[FRAME_STAGE_FRAME];
+  uint8_t n = sampleRing_size(r);
+  uint32_t sumUs = 0;
+  for (uint8_t i = 0; i < n; i++) sumUs += r.samples[i];
+  return sumUs ? n * 1e6f / sumUs : 0.0f;
+}
+
+FrameCounters framePacer_getCounters() {
+  return counters;
+}
+
+const char* framePacer_stageName(FrameStage stage) {
+  return (stage < FRAME_STAGE_COUNT) ? STAGE_NAMES[stage] : "?";
+}
+
+// ===============================================================================
+// SERIAL RAPPORT
+// ===============================================================================
+
+void framePacer_printReport() {
+  Serial.printf("[FRAME] %.1f fps (doel %d)  frames:%lu niet getekend:%lu te duur:%lu te laat:%lu control in frame:%lu\n",
+                framePacer_fps(), FRAME_TARGET_FPS,
+                (unsigned long)counters.frames, (unsigned long)counters.renderSkipped,
+                (unsigned long)counters.overBudget, (unsigned long)counters.late,
+                (unsigned long)counters.controlInFrame);
+  Serial.print("[FRAME] ───── Stap ──── p50 ──── p95 ──── max (ms) │");
+  for (uint8_t b = 0; b < HIST_BUCKETS - 1; b++) Serial.printf(" <%-3u", HIST_EDGES_MS[b]);
+  Serial.println(" rest");
+
+  for (uint8_t s = 0; s < FRAME_STAGE_COUNT; s++) {
+    FrameStats st = framePacer_getStats((FrameStage)s);
+    const SampleRing &r = rings[s];
+    uint8_t n = sampleRing_size(r);
+    uint8_t hist[HIST_BUCKETS] = {0};
+    for (uint8_t i = 0; i < n; i++) {
+      uint8_t b = 0;
+      while (b < HIST_BUCKETS - 1 && r.samples[i] >= HIST_EDGES_MS[b] * 1000UL) b++;
+      hist[b]++;
+    }
+    Serial.printf("[FRAME] %-10s %8.1f %8.1f %8.1f       │", framePacer_stageName((FrameStage)s),
+                  st.p50Us / 1000.0f, st.p95Us / 1000.0f, st.maxUs / 1000.0f);
+    for (uint8_t b = 0; b < HIST_BUCKETS; b++) Serial.printf(" %4u", hist[b]);
+    Serial.println();
+  }
+}
+
+void framePacer_tick() {
+  if (millis() - lastReportMs < FRAME_REPORT_INTERVAL_MS) return;
+  lastReportMs = millis();
+
+  if (counters.frames == lastReportedFrames) return;   // loop() stond stil
+  lastReportedFrames = counters.frames;
+  framePacer_printReport();
+}
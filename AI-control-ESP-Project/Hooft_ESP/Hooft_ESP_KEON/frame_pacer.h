@@ -0,0 +1,80 @@
+#pragma once
+#include <Arduino.h>
+#include "sample_ring.h"
+
+// ===============================================================================
+// FRAME PACER - UI frames op een vast tempo, control taken altijd aan de beurt
+// ===============================================================================
+// Vroeger riep loop() elke ronde uiTick() aan: hoe duurder het tekenen, hoe
+// later pomp control / safety checks en hoe ongelijker de animatie (dt per
+// frame). Nu:
+//
+//   - uiTick() alleen als er een frame aan de beurt is (FRAME_TARGET_FPS).
+//     Te laat → niet inhalen, gewoon het volgende frame
+//   - Na elk frame minstens FRAME_CONTROL_GAP_US alleen control taken
+//   - Binnen uiTick() vóór de canvas flush framePacer_controlPoint(): een
+//     duur frame houdt de control taken niet meer een heel frame op
+//   - Frame werk (schatting uit de vorige getekende frames) past niet in
+//     FRAME_BUDGET_PCT van wat er van de frame tijd over is → dit frame al
+//     alleen input + animatie; een frame boven budget → het volgende ook.
+//     Nooit twee keer achter elkaar niet tekenen
+//   - Animatie in vaste stappen van FRAME_ANIM_STEP_US: tempo hangt niet
+//     meer af van de frame tijd
+//
+// Per stap een ring (sample_ring.h) van de laatste metingen → p50/p95/max en
+// een histogram. Elke FRAME_REPORT_INTERVAL_MS over serial, en met
+// FRAME_OVERLAY_ENABLED linksboven in het animatie canvas.
+// ===============================================================================
+
+#define FRAME_TARGET_FPS          60
+#define FRAME_BUDGET_PCT          75      // Frame werk boven dit % → volgend frame niet tekenen
+#define FRAME_CONTROL_GAP_US      2000    // Na een frame zo lang alleen control taken
+#define FRAME_ANIM_STEP_US        8333    // Vaste animatie stap (120 Hz)
+#define FRAME_ANIM_MAX_STEPS      12      // Na een hapering max ~100 ms inhalen
+#define FRAME_REPORT_INTERVAL_MS  10000
+#define FRAME_OVERLAY_ENABLED     0       // 1 = fps + p95 tijden over de animatie
+
+enum FrameStage : uint8_t {
+  FRAME_STAGE_FRAME = 0,    // Begin frame → begin volgend frame
+  FRAME_STAGE_RENDER,       // uiTick() zonder canvas flush en control (input, animatie, tekenen)
+  FRAME_STAGE_FLUSH,        // canvasFlush()
+  FRAME_STAGE_CONTROL,      // Tussen twee rondes control taken
+  FRAME_STAGE_COUNT
+};
+
+typedef SampleStats FrameStats;
+
+struct FrameCounters {
+  uint32_t frames;
+  uint32_t renderSkipped;   // Frames zonder tekenen (werk past niet / vorig frame te duur)
+  uint32_t overBudget;      // Frames boven FRAME_BUDGET_PCT
+  uint32_t late;            // Meer dan een frame te laat begonnen
+  uint32_t controlInFrame;  // Control rondes vanuit framePacer_controlPoint()
+};
+
+// setup(): control taken die ook midden in een frame mogen draaien
+void framePacer_setControl(void (*controlFn)());
+
+// loop(): frame → uiTick() tussen begin en end
+bool framePacer_frameDue(uint32_t nowUs);
+void framePacer_beginFrame(uint32_t nowUs);
+void framePacer_endFrame(uint32_t nowUs);
+
+// uiTick()
+bool framePacer_skipRender();               // Dit frame niet tekenen
+void framePacer_onFlush(uint32_t flushUs);
+void framePacer_controlPoint();             // Control ronde als de vorige FRAME_CONTROL_GAP_US geleden is
+uint8_t framePacer_animSteps(uint32_t nowUs);   // Vaste stappen sinds de vorige aanroep
+#define FRAME_ANIM_DT  (FRAME_ANIM_STEP_US / 1e6f)
+
+// loop(): elke ronde vóór de control taken
+void framePacer_controlTick(uint32_t nowUs);
+
+FrameStats framePacer_getStats(FrameStage stage);
+FrameCounters framePacer_getCounters();
+float framePacer_fps();                     // Gemiddeld over de frames in de ring
+const char* framePacer_stageName(FrameStage stage);
+
+// Serial rapport
+void framePacer_printReport();
+void framePacer_tick();   // In loop(): periodiek rapport
@@ -1,6 +1,11 @@
 #include "keon_ble.h"
 #include "config.h"
+#include "latency_trace.h"
+#include "keon_motion.h"
+#include "stroker_mock.h"
 #include <BLEUtils.h>
+#include <Preferences.h>
+#include <esp_gattc_api.h>
 
 // ═══════════════════════════════════════════════════════════════════════════
 // 8 LEVELS
@@ -44,6 +49,30 @@ static bool keonInitialized = false;
 static String lastConnectedMAC = "";
 static bool keonActive = false;
 
+// Schrijven via de TX handle als er (nog) geen BLERemoteCharacteristic is:
+// na een verbinding met de handle uit de cache wordt niets opgezocht
+static uint16_t keonTxHandle = 0;
+static bool keonTxNoRsp = false;              // Write zonder response mogelijk
+static volatile bool keonTxValidated = false; // Eerste write via gecachte handle bevestigd
+static volatile bool keonWriteDone = false;   // ESP_GATTC_WRITE_CHAR_EVT voor de TX handle
+static volatile uint8_t keonWriteStatus = 0;
+
+// Verbinding herstellen (keonLinkService)
+static volatile bool keonLinkWanted = false;  // Verbonden geweest en niet bewust verbroken
+static volatile bool keonNeedDiscovery = false;
+static portMUX_TYPE keonLinkMux = portMUX_INITIALIZER_UNLOCKED;
+static bool keonLinkBusy = false;             // connect bezig (UI of Keon task)
+static uint32_t keonLinkDownMs = 0;           // 0 = verbinding niet weg
+static uint32_t keonLinkRetryMs = 0;
+static uint32_t keonLinkBackoffMs = KEON_RECONNECT_MIN_MS;
+static KeonLinkStats keonLinkStats = {0, 0, 0, 0, 0, 0, 0, 0};
+
+// Preferences cache (KEON_PREFS_NS)
+static Preferences keonPrefs;
+static String keonPeerMAC = KEON_MAC_ADDRESS;
+static uint16_t keonCachedHandle = 0;
+static bool keonCachedNoRsp = false;
+
 // ═══════════════════════════════════════════════════════════════════════════
 // BLE CALLBACK
 // ═══════════════════════════════════════════════════════════════════════════
@@ -54,52 +83,340 @@ class KeonClientCallback : public BLEClientCallbacks {
     Serial.println("[KEON] ✅ BLE Connected");
   }
   void onDisconnect(BLEClient* pclient) {
+    // keonActive blijft: na het herstellen loopt de sessie gewoon door
     keonConnected = false;
-    keonActive = false;
     Serial.println("[KEON] ❌ BLE Disconnected");
   }
 };
 
+// Alle GATT client events (BLE task). Alleen de bevestiging van een write op
+// de TX handle is interessant: daarmee wordt een gecachte handle gecontroleerd
+static void keonGattcEvent(esp_gattc_cb_event_t event, esp_gatt_if_t gattcIf, esp_ble_gattc_cb_param_t* param) {
+  if (event != ESP_GATTC_WRITE_CHAR_EVT || keonClient == nullptr || keonTxHandle == 0) return;
+  if (param->write.conn_id != keonClient->getConnId() || param->write.handle != keonTxHandle) return;
+  keonWriteStatus = param->write.status;
+  keonWriteDone = true;
+}
+
 // ═══════════════════════════════════════════════════════════════════════════
-// MOVEMENT - ZOALS ESP32-C3 (direct send, delay erna!)
+// COMMAND PIPELINE - niet blokkerend, laatste positie wint
 // ═══════════════════════════════════════════════════════════════════════════
+// Vroeger: writeValue(cmd, 5, true) + delay(200) in keonMove() → max ~4
+// commando's/sec in stappen van 200 ms, en de aanroeper (ook de UI) stond
+// zo lang stil. Nu zet keonMove() alleen klaar en keert direct terug; de
+// Keon task (Core 0) schrijft in keonPipelineService():
+//
+//   - Volgorde commando's (stop reeks) in een kleine FIFO: gaan altijd voor
+//   - Positie/snelheid in één slot: een nieuwer commando vervangt een nog
+//     niet verstuurd commando (coalescing) → nooit achterstand
+//   - Write zonder response als de characteristic dat kan; elke
+//     KEON_PROBE_EVERY writes één met response om te meten hoe snel de
+//     Keon commando's accepteert
+//   - Tussenruimte = max(KEON_CMD_MIN_SPACING_MS, 1.5x gemeten acceptatie),
+//     verdubbelt na een mislukte write en zakt daarna weer terug
+//   - Verbinding even weg (keonLinkService herstelt): commando's blijven
+//     staan en gaan na het herstellen weg, ook hier laatste wint
 
-bool keonMove(uint8_t position, uint8_t speed) {
-  if (!keonConnected || keonTxCharacteristic == nullptr) {
+struct KeonCmd {
+  uint8_t position;
+  uint8_t speed;
+  uint32_t queuedUs;
+  StrokerDoneFn done;
+  uint32_t traceId;     // latency_trace: commando van een level wijziging (0 = geen)
+};
+
+static portMUX_TYPE keonCmdMux = portMUX_INITIALIZER_UNLOCKED;
+static KeonCmd keonSeq[KEON_SEQ_DEPTH];
+static uint8_t keonSeqHead = 0;
+static uint8_t keonSeqCount = 0;
+static KeonCmd keonSlot;
+static bool keonSlotFull = false;
+static uint8_t keonLastPos = 0xFF;       // Laatst geschreven (0xFF = onbekend)
+static uint8_t keonLastSpeed = 0xFF;
+static uint32_t keonLastWriteUs = 0;
+static uint16_t keonWritesSinceProbe = 0;
+static KeonPipelineStats keonStats = {0, 0, 0, 0, 0, 0, 0, 0, 0.0f, KEON_CMD_MIN_SPACING_MS * 1000UL};
+
+static bool keonTxReady() {
+  return keonConnected && keonTxHandle != 0;
+}
+
+// Eén write naar de TX handle. rsp = met response: wacht tot de Keon de
+// write bevestigt (acceptatie meting, controle van een gecachte handle).
+// Ook na discovery via de handle en niet via writeValue(): die geeft
+// (core 2.x) geen resultaat terug, zo is false altijd een echte fout
+static bool keonWriteTx(uint8_t* data, size_t len, bool rsp) {
+  keonWriteDone = false;
+  esp_err_t err = esp_ble_gattc_write_char(keonClient->getGattcIf(), keonClient->getConnId(), keonTxHandle,
+                                           len, data, rsp ? ESP_GATT_WRITE_TYPE_RSP : ESP_GATT_WRITE_TYPE_NO_RSP,
+                                           ESP_GATT_AUTH_REQ_NONE);
+  if (err != ESP_OK) return false;
+  if (!rsp) return true;
+  
+  uint32_t start = millis();
+  while (!keonWriteDone) {
+    if (!keonConnected || millis() - start > KEON_HANDLE_CHECK_MS) return false;
+    delay(1);
+  }
+  return keonWriteStatus == ESP_GATT_OK;
+}
+
+static void keonCmdDone(const KeonCmd& cmd, StrokerCmdResult result, uint32_t latencyUs) {
+  if (cmd.done) cmd.done(cmd.position, cmd.speed, result, latencyUs);
+}
+
+// Alles wat nog klaar staat vervalt (verbinding weg)
+static void keonPipelineClear() {
+  KeonCmd dropped[KEON_SEQ_DEPTH + 1];
+  uint8_t n = 0;
+  portENTER_CRITICAL(&keonCmdMux);
+  while (keonSeqCount > 0) {
+    dropped[n++] = keonSeq[keonSeqHead];
+    keonSeqHead = (keonSeqHead + 1) % KEON_SEQ_DEPTH;
+    keonSeqCount--;
+  }
+  if (keonSlotFull) {
+    dropped[n++] = keonSlot;
+    keonSlotFull = false;
+  }
+  keonLastPos = 0xFF;
+  keonLastSpeed = 0xFF;
+  keonStats.failed += n;
+  portEXIT_CRITICAL(&keonCmdMux);
+  for (uint8_t i = 0; i < n; i++) keonCmdDone(dropped[i], STROKER_CMD_FAILED, 0);
+}
+
+bool keonMoveAsync(uint8_t position, uint8_t speed, StrokerDoneFn done) {
+  if (!keonTxReady() && !keonLinkWanted) {
     return false;
   }
   
   if (position > 99) position = 99;
   if (speed > 99) speed = 99;
 
-  uint8_t cmd[5] = {0x04, 0x00, position, 0x00, speed};
+  KeonCmd cmd = {position, speed, (uint32_t)micros(), done, latencyTrace_claimCommand()};
+  KeonCmd replaced;
+  bool hasReplaced = false;
+  bool unchanged = false;
   
-  Serial.printf("[KEON] Move: pos=%u, speed=%u\n", position, speed);
+  portENTER_CRITICAL(&keonCmdMux);
+  keonStats.queued++;
+  if (!keonSlotFull && keonSeqCount == 0 && position == keonLastPos && speed == keonLastSpeed) {
+    unchanged = true;          // Bv. UI die elke frame keonMove(0, 0) roept tijdens pauze
+    keonStats.unchanged++;
+  } else {
+    if (keonSlotFull) {
+      replaced = keonSlot;
+      hasReplaced = true;
+      keonStats.coalesced++;
+      if (!cmd.traceId) cmd.traceId = replaced.traceId;   // Vervanger voert de wijziging uit
+    }
+    keonSlot = cmd;
+    keonSlotFull = true;
+  }
+  portEXIT_CRITICAL(&keonCmdMux);
   
-  try {
-    keonTxCharacteristic->writeValue(cmd, 5, true);
-    delay(200);  // Delay ERNA, zoals ESP32-C3!
-    return true;
-  } catch (...) {
-    return false;
+  if (hasReplaced) keonCmdDone(replaced, STROKER_CMD_SKIPPED, 0);
+  if (unchanged) keonCmdDone(cmd, STROKER_CMD_SKIPPED, 0);
+  return true;
+}
+
+bool keonMove(uint8_t position, uint8_t speed) {
+  return keonMoveAsync(position, speed, nullptr);
+}
+
+// Commando's die alle drie aan moeten komen (niet samenvoegen). Een nog niet
+// verstuurde beweging vervalt: de reeks is nieuwer.
+static bool keonQueueSequence(const uint8_t moves[][2], uint8_t count) {
+  if (!keonTxReady() && !keonLinkWanted) return false;
+  
+  KeonCmd replaced;
+  bool hasReplaced = false;
+  uint32_t now = micros();
+  
+  portENTER_CRITICAL(&keonCmdMux);
+  if (keonSlotFull) {
+    replaced = keonSlot;
+    hasReplaced = true;
+    keonSlotFull = false;
+    keonStats.coalesced++;
+  }
+  keonSeqHead = 0;             // Oude reeks (nog niet verstuurd) vervangen
+  keonSeqCount = 0;
+  for (uint8_t i = 0; i < count && i < KEON_SEQ_DEPTH; i++) {
+    keonSeq[i] = {moves[i][0], moves[i][1], now, nullptr};
+    keonSeqCount++;
+    keonStats.queued++;
   }
+  portEXIT_CRITICAL(&keonCmdMux);
+  
+  if (hasReplaced) keonCmdDone(replaced, STROKER_CMD_SKIPPED, 0);
+  return true;
 }
 
 bool keonStop() {
-  if (!keonConnected) return false;
+  if (!keonConnected && !keonLinkWanted) return false;
   
   Serial.println("[KEON] Stopping...");
   keonActive = false;
   
-  // Meerdere stop commando's
-  keonMove(50, 0);
-  delay(100);
-  keonMove(50, 0);
-  delay(100);
-  keonMove(0, 0);
+  // Meerdere stop commando's (tussenruimte via de pipeline i.p.v. delay)
+  const uint8_t stopMoves[3][2] = {{50, 0}, {50, 0}, {0, 0}};
+  return keonQueueSequence(stopMoves, 3);
+}
+
+bool keonStopAtPosition(uint8_t position) {
+  if (position > 99) position = 99;
+  const uint8_t stopMoves[3][2] = {{50, 0}, {50, 0}, {position, 0}};
+  return keonQueueSequence(stopMoves, 3);
+}
+
+bool keonFlush(uint32_t timeoutMs) {
+  uint32_t start = millis();
+  while (millis() - start < timeoutMs) {
+    portENTER_CRITICAL(&keonCmdMux);
+    bool empty = !keonSlotFull && keonSeqCount == 0;
+    portEXIT_CRITICAL(&keonCmdMux);
+    if (empty) return true;
+    delay(5);
+  }
+  return false;
+}
+
+void keonPipelineService() {
+  if (!keonTxReady()) {
+    if (!keonLinkWanted) {
+      keonPipelineClear();
+      return;
+    }
+    // Wordt hersteld: laten staan, wel alles opnieuw sturen (stand onbekend)
+    portENTER_CRITICAL(&keonCmdMux);
+    keonLastPos = 0xFF;
+    keonLastSpeed = 0xFF;
+    portEXIT_CRITICAL(&keonCmdMux);
+    return;
+  }
+  if (keonLastWriteUs != 0 && micros() - keonLastWriteUs < keonStats.spacingUs) return;
   
-  Serial.println("[KEON] ✅ Stopped");
-  return true;
+  KeonCmd cmd;
+  bool have = false;
+  portENTER_CRITICAL(&keonCmdMux);
+  if (keonSeqCount > 0) {
+    cmd = keonSeq[keonSeqHead];
+    keonSeqHead = (keonSeqHead + 1) % KEON_SEQ_DEPTH;
+    keonSeqCount--;
+    have = true;
+  } else if (keonSlotFull) {
+    cmd = keonSlot;
+    keonSlotFull = false;
+    have = true;
+  }
+  portEXIT_CRITICAL(&keonCmdMux);
+  if (!have) return;
+  
+  uint8_t data[5] = {0x04, 0x00, cmd.position, 0x00, cmd.speed};
+  bool noResponse = KEON_WRITE_NO_RESPONSE && keonTxNoRsp;
+  bool check = keonTxCharacteristic == nullptr && !keonTxValidated;   // Eerste write via gecachte handle
+  bool probe = check || !noResponse || ++keonWritesSinceProbe >= KEON_PROBE_EVERY;
+  if (probe) keonWritesSinceProbe = 0;
+  
+  uint32_t writeStart = micros();
+  bool ok = keonWriteTx(data, 5, probe);
+  uint32_t writeUs = micros() - writeStart;
+  
+  if (check && keonConnected) {
+    if (!ok) {
+      // Handle klopt niet (meer): keonLinkService zoekt hem op, commando terug (laatste wint)
+      keonTxHandle = 0;
+      keonNeedDiscovery = true;
+      bool requeued = false;
+      portENTER_CRITICAL(&keonCmdMux);
+      if (!keonSlotFull && keonSeqCount == 0) {
+        keonSlot = cmd;
+        keonSlotFull = true;
+        requeued = true;
+      }
+      portEXIT_CRITICAL(&keonCmdMux);
+      if (!requeued) keonCmdDone(cmd, STROKER_CMD_SKIPPED, 0);
+      return;
+    }
+    keonTxValidated = true;
+    Serial.printf("[KEON] Cached handle 0x%04X OK\n", keonTxHandle);
+  }
+  keonLastWriteUs = micros();
+  uint32_t latencyUs = keonLastWriteUs - cmd.queuedUs;
+  
+  portENTER_CRITICAL(&keonCmdMux);
+  if (ok) {
+    keonStats.sent++;
+    keonStats.latencySumUs += latencyUs;
+    if (latencyUs > keonStats.latencyMaxUs) keonStats.latencyMaxUs = latencyUs;
+    keonLastPos = cmd.position;
+    keonLastSpeed = cmd.speed;
+    if (probe) {
+      keonStats.probes++;
+      keonStats.acceptAvgUs = (keonStats.probes == 1) ? writeUs
+                            : keonStats.acceptAvgUs + 0.2f * (writeUs - keonStats.acceptAvgUs);
+    }
+    uint32_t target = (uint32_t)(keonStats.acceptAvgUs * 1.5f);
+    if (target < KEON_CMD_MIN_SPACING_MS * 1000UL) target = KEON_CMD_MIN_SPACING_MS * 1000UL;
+    if (target > KEON_CMD_MAX_SPACING_MS * 1000UL) target = KEON_CMD_MAX_SPACING_MS * 1000UL;
+    // Na een backoff geleidelijk terug, omhoog direct
+    keonStats.spacingUs = (keonStats.spacingUs > target) ? keonStats.spacingUs - (keonStats.spacingUs - target) / 4 : target;
+  } else {
+    keonStats.failed++;
+    keonStats.spacingUs = (keonStats.spacingUs * 2 > KEON_CMD_MAX_SPACING_MS * 1000UL) ? KEON_CMD_MAX_SPACING_MS * 1000UL : keonStats.spacingUs * 2;
+    keonLastPos = 0xFF;
+  }
+  portEXIT_CRITICAL(&keonCmdMux);
+  
+  latencyTrace_onKeonWrite(cmd.traceId, writeUs, writeStart - cmd.queuedUs);
+  keonCmdDone(cmd, ok ? STROKER_CMD_DONE : STROKER_CMD_FAILED, latencyUs);
+}
+
+KeonPipelineStats keonGetPipelineStats() {
+  portENTER_CRITICAL(&keonCmdMux);
+  KeonPipelineStats copy = keonStats;
+  portEXIT_CRITICAL(&keonCmdMux);
+  return copy;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// STROKER DEVICE - Keon achter de gemeenschappelijke interface
+// ═══════════════════════════════════════════════════════════════════════════
+
+static const StrokerCaps KEON_CAPS = {
+  true,                       // Positie
+  100,                        // Snelheid 0-99
+  KEON_CMD_MIN_SPACING_MS,
+  KEON_AIR_MS,
+  KEON_MAX_UPS,
+  KEON_ACCEL_UPS2
+};
+
+class KeonDevice : public StrokerDevice {
+public:
+  const char* name() const override { return "Keon"; }
+  const StrokerCaps& caps() const override { return KEON_CAPS; }
+  bool connect() override { return keonConnect(); }
+  void disconnect() override { keonDisconnect(); }
+  bool isConnected() override { return keonIsConnected(); }
+  bool moveAsync(uint8_t position, uint8_t speed, StrokerDoneFn done) override {
+    return keonMoveAsync(position, speed, done);
+  }
+  bool stop() override { return keonStop(); }
+  bool flush(uint32_t timeoutMs) override { return keonFlush(timeoutMs); }
+  void service() override { keonPipelineService(); }
+  uint32_t avgLatencyUs() override {
+    KeonPipelineStats st = keonGetPipelineStats();
+    return st.sent ? st.latencySumUs / st.sent : 0;
+  }
+};
+
+static KeonDevice keonDevice;
+
+StrokerDevice* keonGetDevice() {
+  return &keonDevice;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
@@ -114,8 +431,13 @@ void keonSetLevel(uint8_t level) {
                 level, KEON_LEVEL_POSITIONS[level]);
   
   // Als actief, direct update!
-  if (keonActive && keonConnected) {
-    keonMove(KEON_LEVEL_POSITIONS[level], 99);
+  if (keonActive) {
+#if KEON_MOTION_LEVEL_WAYPOINTS
+    keonMotion_setLevel(level);
+#else
+    // Funscript stuurt de Keon: level positie pas na het script
+    if (keonMotion_source() != KEON_MOTION_SCRIPT) keonMove(KEON_LEVEL_POSITIONS[level], 99);
+#endif
   }
 }
 
@@ -292,45 +614,95 @@ float keonGetStrokeFrequency(uint8_t level) {
 // CONNECTION
 // ═══════════════════════════════════════════════════════════════════════════
 
+// Vroeger: elke verbinding een nieuwe client, service + characteristic
+// opzoeken, delay(500), en keonReconnect() met delay(1000). Een korte
+// dropout kostte zo seconden zonder beweging. Nu:
+//
+//   - Adres en TX handle staan in Preferences (KEON_PREFS_NS). Met een
+//     handle voor dit adres: direct verbinden, geen discovery, schrijven
+//     via de handle. De eerste write gaat met response; bevestigt de Keon
+//     die niet, dan alsnog discovery op de bestaande verbinding
+//   - Eén client, hergebruikt voor elke verbinding
+//   - Verbinding weg terwijl die gewild is → keonLinkService() (Keon task)
+//     probeert opnieuw: meteen, daarna met backoff KEON_RECONNECT_MIN_MS
+//     verdubbelend tot KEON_RECONNECT_MAX_MS. Hersteltijd wordt gemeten
+//   - UI blokkeert niet meer op herstellen; commando's van tijdens het
+//     herstellen staan in de pipeline en gaan daarna weg (laatste wint)
+
+static void keonCacheLoad() {
+  if (!keonPrefs.begin(KEON_PREFS_NS, true)) return;   // Nog niets opgeslagen
+  String mac = keonPrefs.getString("mac", "");
+  String txMac = keonPrefs.getString("tx_mac", "");
+  uint16_t handle = keonPrefs.getUShort("tx", 0);
+  bool noRsp = keonPrefs.getBool("norsp", false);
+  keonPrefs.end();
+  
+  if (mac.length() == 17) keonPeerMAC = mac;        // keonSetMAC() gaat voor KEON_MAC_ADDRESS
+  keonAddress = BLEAddress(keonPeerMAC.c_str());
+  
+  // Handle geldt alleen voor het device waar hij van is
+  if (handle != 0 && txMac.equalsIgnoreCase(keonPeerMAC)) {
+    keonCachedHandle = handle;
+    keonCachedNoRsp = noRsp;
+    Serial.printf("[KEON] Cache: %s TX handle 0x%04X\n", keonPeerMAC.c_str(), handle);
+  }
+}
+
+static void keonCacheSaveHandle(uint16_t handle, bool noRsp) {
+  if (handle == keonCachedHandle && noRsp == keonCachedNoRsp) return;   // Flash sparen
+  keonCachedHandle = handle;
+  keonCachedNoRsp = noRsp;
+  if (!keonPrefs.begin(KEON_PREFS_NS, false)) {
+    Serial.println("[KEON] ERROR: Failed to open Preferences for writing!");
+    return;
+  }
+  keonPrefs.putString("tx_mac", keonPeerMAC);
+  keonPrefs.putUShort("tx", handle);
+  keonPrefs.putBool("norsp", noRsp);
+  keonPrefs.end();
+}
+
 void keonInit() {
   if (keonInitialized) return;
   BLEDevice::init("HoofdESP_KeonController");
+  BLEDevice::setCustomGattcHandler(keonGattcEvent);
+  keonCacheLoad();
   keonInitialized = true;
   Serial.println("[KEON] BLE initialized");
 }
 
-bool keonConnect() {
-  if (!keonInitialized) keonInit();
-
-  Serial.println("[KEON] Attempting connection...");
-  
-  keonClient = BLEDevice::createClient();
-  keonClient->setClientCallbacks(new KeonClientCallback());
-
-  if (!keonClient->connect(keonAddress)) {
-    Serial.println("[KEON] Connection failed!");
-    return false;
-  }
+static bool keonLinkTryLock() {
+  portENTER_CRITICAL(&keonLinkMux);
+  bool got = !keonLinkBusy;
+  keonLinkBusy = true;
+  portEXIT_CRITICAL(&keonLinkMux);
+  return got;
+}
 
-  delay(500);
+static void keonLinkUnlock() {
+  portENTER_CRITICAL(&keonLinkMux);
+  keonLinkBusy = false;
+  portEXIT_CRITICAL(&keonLinkMux);
+}
 
+// Service + TX characteristic opzoeken op de bestaande verbinding
+static bool keonDiscover() {
   BLERemoteService* pRemoteService = keonClient->getService(KEON_SERVICE_UUID);
   if (pRemoteService == nullptr) {
     Serial.println("[KEON] Service not found!");
-    keonClient->disconnect();
     return false;
   }
 
-  keonTxCharacteristic = pRemoteService->getCharacteristic(KEON_TX_CHAR_UUID);
+  BLERemoteCharacteristic* tx = pRemoteService->getCharacteristic(KEON_TX_CHAR_UUID);
 
-  if (keonTxCharacteristic == nullptr) {
+  if (tx == nullptr) {
     Serial.println("[KEON] TX Characteristic not found, searching...");
     std::map<std::string, BLERemoteCharacteristic*>* characteristics = pRemoteService->getCharacteristics();
     if (characteristics != nullptr) {
       for (auto &entry : *characteristics) {
         BLERemoteCharacteristic* pChar = entry.second;
         if (pChar->canWrite() || pChar->canWriteNoResponse()) {
-          keonTxCharacteristic = pChar;
+          tx = pChar;
           Serial.println("[KEON] Found writable characteristic!");
           break;
         }
@@ -338,52 +710,169 @@ bool keonConnect() {
     }
   }
 
-  if (keonTxCharacteristic == nullptr) {
+  if (tx == nullptr) {
     Serial.println("[KEON] No writable characteristic found!");
+    return false;
+  }
+
+  keonTxNoRsp = tx->canWriteNoResponse();
+  keonTxValidated = true;
+  keonTxCharacteristic = tx;
+  keonTxHandle = tx->getHandle();    // Pipeline schrijft via deze handle (keonWriteTx)
+  keonCacheSaveHandle(keonTxHandle, keonTxNoRsp);
+  return true;
+}
+
+// Verbinden zonder wachten: met gecachte handle klaar na de connect
+static bool keonOpenLink() {
+  if (keonClient == nullptr) {
+    keonClient = BLEDevice::createClient();
+    keonClient->setClientCallbacks(new KeonClientCallback());
+  }
+  
+  // Oude characteristic hoort bij de vorige verbinding
+  keonTxCharacteristic = nullptr;
+  keonTxHandle = 0;
+  keonNeedDiscovery = false;
+
+  if (!keonClient->connect(keonAddress)) {
+    return false;
+  }
+
+  if (keonCachedHandle != 0) {
+    keonTxHandle = keonCachedHandle;
+    keonTxNoRsp = keonCachedNoRsp;
+    keonTxValidated = false;           // Eerste write controleert de handle
+    keonLinkStats.fastPath++;
+  } else if (!keonDiscover()) {
     keonClient->disconnect();
     return false;
   }
 
   keonConnected = true;
-  lastConnectedMAC = String(KEON_MAC_ADDRESS);
-  Serial.printf("[KEON] ✅ Connected to %s\n", KEON_MAC_ADDRESS);
+  lastConnectedMAC = keonPeerMAC;
+  return true;
+}
+
+bool keonConnect() {
+  if (!keonInitialized) keonInit();
+
+  if (!keonLinkTryLock()) {
+    Serial.println("[KEON] Connection already in progress");
+    return false;
+  }
+  Serial.println("[KEON] Attempting connection...");
+  bool ok = keonOpenLink();
+  keonLinkUnlock();
+  
+  if (!ok) {
+    Serial.println("[KEON] Connection failed!");
+    return false;
+  }
+
+  keonLinkDownMs = 0;
+  keonLinkWanted = true;
+  Serial.printf("[KEON] ✅ Connected to %s%s\n", keonPeerMAC.c_str(),
+                keonTxCharacteristic == nullptr ? " (cached handle)" : "");
   return true;
 }
 
 void keonDisconnect() {
+  keonLinkWanted = false;            // Niet herstellen
+  keonLinkDownMs = 0;
   if (keonConnected && keonClient != nullptr) {
     Serial.println("[KEON] Disconnecting...");
     keonStop();
-    delay(500);
+    keonFlush(500);   // Stop reeks eerst echt naar de Keon
     keonClient->disconnect();
     keonConnected = false;
     keonTxCharacteristic = nullptr;
+    keonTxHandle = 0;
     keonActive = false;
   }
 }
 
 bool keonIsConnected() {
-  return keonConnected && keonClient != nullptr && keonTxCharacteristic != nullptr;
+  return keonClient != nullptr && keonTxReady();
 }
 
+// Alleen vlaggen: de characteristic wordt bij de volgende verbinding vervangen
 void keonCheckConnection() {
   if (keonConnected && keonClient != nullptr) {
     if (!keonClient->isConnected()) {
       Serial.println("[KEON] Connection lost!");
       keonConnected = false;
-      keonTxCharacteristic = nullptr;
-      keonActive = false;
     }
   }
 }
 
 void keonReconnect() {
   Serial.println("[KEON] Manual reconnect...");
-  if (keonConnected) {
-    keonDisconnect();
+  keonLinkWanted = true;
+  if (keonConnected && keonClient != nullptr) {
+    keonClient->disconnect();        // keonLinkService verbindt meteen opnieuw
+  }
+}
+
+void keonLinkService() {
+  keonCheckConnection();
+  
+  // Gecachte handle bleek ongeldig: opzoeken op de bestaande verbinding
+  if (keonNeedDiscovery && keonConnected) {
+    keonNeedDiscovery = false;
+    keonLinkStats.fallbacks++;
+    keonCacheSaveHandle(0, false);
+    Serial.println("[KEON] Cached handle rejected, discovering...");
+    if (!keonDiscover()) {
+      keonClient->disconnect();      // Volgende poging met volledige discovery
+      return;
+    }
   }
-  delay(1000);
-  keonConnect();
+  
+  if (keonConnected || !keonLinkWanted) return;
+  
+  uint32_t now = millis();
+  if (keonLinkDownMs == 0) {
+    keonLinkDownMs = now ? now : 1;
+    keonLinkRetryMs = now;           // Eerste poging meteen
+    keonLinkBackoffMs = KEON_RECONNECT_MIN_MS;
+    keonLinkStats.drops++;
+    Serial.println("[KEON] ♻️ Link lost, reconnecting...");
+  }
+  if ((int32_t)(now - keonLinkRetryMs) < 0) return;
+  if (!keonLinkTryLock()) return;    // UI is al aan het verbinden
+  
+  keonLinkStats.attempts++;
+  bool ok = keonOpenLink();
+  keonLinkUnlock();
+  
+  if (!ok) {
+    keonLinkRetryMs = millis() + keonLinkBackoffMs;
+    Serial.printf("[KEON] ♻️ Reconnect failed, retry in %lu ms\n", (unsigned long)keonLinkBackoffMs);
+    keonLinkBackoffMs = (keonLinkBackoffMs * 2 > KEON_RECONNECT_MAX_MS) ? KEON_RECONNECT_MAX_MS : keonLinkBackoffMs * 2;
+    return;
+  }
+  
+  if (!keonLinkWanted) {             // Tijdens het verbinden bewust verbroken
+    keonClient->disconnect();
+    keonConnected = false;
+    keonLinkDownMs = 0;
+    return;
+  }
+  
+  uint32_t tookMs = millis() - keonLinkDownMs;
+  keonLinkDownMs = 0;
+  keonLinkStats.reconnects++;
+  keonLinkStats.lastMs = tookMs;
+  keonLinkStats.sumMs += tookMs;
+  if (tookMs > keonLinkStats.maxMs) keonLinkStats.maxMs = tookMs;
+  Serial.printf("[KEON] ♻️ Reconnect %lu ms (%s, attempt %lu)\n", (unsigned long)tookMs,
+                keonTxCharacteristic == nullptr ? "cached handle" : "discovery",
+                (unsigned long)keonLinkStats.attempts);
+}
+
+KeonLinkStats keonGetLinkStats() {
+  return keonLinkStats;
 }
 
 String keonGetLastMAC() {
@@ -391,16 +880,14 @@ String keonGetLastMAC() {
 }
 
 void keonSetMAC(const char* mac) {
-  lastConnectedMAC = String(mac);
-  Serial.printf("[KEON] MAC set to: %s (requires recompile)\n", mac);
-}
-
-bool keonStopAtPosition(uint8_t position) {
-  if (position > 99) position = 99;
-  keonMove(50, 0);
-  keonMove(50, 0);
-  keonMove(position, 0);
-  return true;
+  if (keonPrefs.begin(KEON_PREFS_NS, false)) {
+    keonPrefs.putString("mac", mac);
+    keonPrefs.end();
+  }
+  keonPeerMAC = String(mac);
+  keonAddress = BLEAddress(mac);
+  keonCachedHandle = 0;              // Hoort bij het oude device
+  Serial.printf("[KEON] MAC set to: %s (next connection)\n", mac);
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
@@ -408,7 +895,9 @@ bool keonStopAtPosition(uint8_t position) {
 // ═══════════════════════════════════════════════════════════════════════════
 
 void keonIndependentTick() {
-  if (!keonConnected) return;
+  // Level slagen gaan naar het actieve device (Keon, Solace of mock)
+  StrokerDevice* dev = strokerActive();
+  if (!dev || !dev->isConnected()) return;
   
   extern bool paused;
   extern uint8_t g_speedStep;
@@ -419,7 +908,8 @@ void keonIndependentTick() {
   if (paused) {
     if (wasRunning || keonActive) {
       Serial.println("[KEON CORE0] ⏸️ Paused");
-      keonStop();
+      keonMotion_stop();
+      dev->stop();
       wasRunning = false;
       keonActive = false;
     }
@@ -433,22 +923,53 @@ void keonIndependentTick() {
     wasRunning = true;
     
     keonCurrentLevel = g_speedStep;
+    latencyTrace_onKeonPickup();
+    
+#if KEON_MOTION_LEVEL_WAYPOINTS
+    Serial.printf("[KEON CORE0] Level %u (%.2f Hz waypoints)\n",
+                  keonCurrentLevel, keonGetStrokeFrequency(keonCurrentLevel));
     
+    // Script / AI waypoints hebben voorrang op de level slagen
+    keonMotion_setLevel(keonCurrentLevel);
+    if (keonMotion_source() == KEON_MOTION_IDLE) keonMotion_start(KEON_MOTION_LEVEL);
+#else
     Serial.printf("[KEON CORE0] Level %u (pos %u)\n", 
                   keonCurrentLevel, KEON_LEVEL_POSITIONS[keonCurrentLevel]);
     
-    keonMove(KEON_LEVEL_POSITIONS[keonCurrentLevel], 99);
+    if (keonMotion_source() != KEON_MOTION_SCRIPT) keonMove(KEON_LEVEL_POSITIONS[keonCurrentLevel], 99);
+#endif
     return;
   }
   
+#if !KEON_MOTION_LEVEL_WAYPOINTS
+  // Funscript (motion engine) klaar → level positie opnieuw, anders blijft
+  // de Keon op de laatste script positie staan
+  static bool scriptWasActive = false;
+  bool scriptActive = keonMotion_source() == KEON_MOTION_SCRIPT;
+  if (scriptWasActive && !scriptActive && keonActive) {
+    Serial.printf("[KEON CORE0] Script klaar → L%u (pos %u)\n",
+                  keonCurrentLevel, KEON_LEVEL_POSITIONS[keonCurrentLevel]);
+    keonMove(KEON_LEVEL_POSITIONS[keonCurrentLevel], 99);
+  }
+  scriptWasActive = scriptActive;
+#endif
+  
   // LEVEL CHANGE - Direct zoals ESP32-C3!
   if (keonActive && keonCurrentLevel != g_speedStep) {
     keonCurrentLevel = g_speedStep;
+    latencyTrace_onKeonPickup();
+    
+#if KEON_MOTION_LEVEL_WAYPOINTS
+    Serial.printf("[KEON CORE0] → L%u (%.2f Hz)\n",
+                  keonCurrentLevel, keonGetStrokeFrequency(keonCurrentLevel));
     
+    keonMotion_setLevel(keonCurrentLevel);
+#else
     Serial.printf("[KEON CORE0] → L%u (pos %u)\n",
                   keonCurrentLevel, KEON_LEVEL_POSITIONS[keonCurrentLevel]);
     
-    keonMove(KEON_LEVEL_POSITIONS[keonCurrentLevel], 99);
+    if (keonMotion_source() != KEON_MOTION_SCRIPT) keonMove(KEON_LEVEL_POSITIONS[keonCurrentLevel], 99);
+#endif
   }
 }
 
@@ -459,10 +980,51 @@ void keonIndependentTick() {
 void keonTask(void* parameter) {
   Serial.println("[KEON TASK] Started on Core 0");
   
+  uint32_t lastStatsMs = 0;
+  uint32_t lastStatsSent = 0;
+  uint32_t lastMotionIssued = 0;
+  uint32_t lastReconnects = 0;
   while(true) {
-    keonCheckConnection();
+    keonLinkService();
     keonIndependentTick();
-    vTaskDelay(10 / portTICK_PERIOD_MS);
+    keonMotion_tick(millis());
+    StrokerDevice* dev = strokerActive();
+    if (dev) dev->service();
+    if (dev != &keonDevice) keonPipelineService();   // Keon stop reeks / opruimen ook als ander device actief is
+    
+    // Pipeline statistiek (alleen als er iets verstuurd is)
+    if (millis() - lastStatsMs > 30000) {
+      KeonPipelineStats st = keonGetPipelineStats();
+      if (st.sent != lastStatsSent) {
+        float secs = (millis() - lastStatsMs) / 1000.0f;
+        Serial.printf("[KEON] %.1f cmd/s  lat gem %.1f max %.1f ms  accept %.1f ms  spacing %lu ms  "
+                      "samengevoegd:%lu zelfde:%lu fout:%lu\n",
+                      (st.sent - lastStatsSent) / secs, st.sent ? st.latencySumUs / 1000.0f / st.sent : 0.0f,
+                      st.latencyMaxUs / 1000.0f, st.acceptAvgUs / 1000.0f, (unsigned long)(st.spacingUs / 1000),
+                      (unsigned long)st.coalesced, (unsigned long)st.unchanged, (unsigned long)st.failed);
+        lastStatsSent = st.sent;
+      }
+      
+      KeonMotionStats ms = keonMotion_getStats();
+      if (ms.issued != lastMotionIssued) {
+        Serial.printf("[KEON MOTION] %s commando's:%lu overgeslagen:%lu te snel:%lu lead %lu ms  "
+                      "volg fout gem %.1f rms %.1f max %.1f pos\n",
+                      dev ? dev->name() : "-",
+                      (unsigned long)ms.issued, (unsigned long)ms.skipped, (unsigned long)ms.clipped,
+                      (unsigned long)ms.leadMs, ms.trackAvg, ms.trackRms, ms.trackMax);
+        lastMotionIssued = ms.issued;
+      }
+      
+      KeonLinkStats ls = keonGetLinkStats();
+      if (ls.reconnects != lastReconnects) {
+        Serial.printf("[KEON] Link: weg:%lu hersteld:%lu (cache:%lu discovery terug:%lu) herstel gem %lu max %lu ms\n",
+                      (unsigned long)ls.drops, (unsigned long)ls.reconnects, (unsigned long)ls.fastPath,
+                      (unsigned long)ls.fallbacks, (unsigned long)(ls.sumMs / ls.reconnects), (unsigned long)ls.maxMs);
+        lastReconnects = ls.reconnects;
+      }
+      lastStatsMs = millis();
+    }
+    vTaskDelay(5 / portTICK_PERIOD_MS);
   }
 }
 
@@ -474,6 +1036,12 @@ void keonStartTask() {
     return;
   }
   
+#if STROKER_MOCK_ENABLED
+  strokerSelect(strokerMockDevice());
+#else
+  if (strokerActive() == nullptr) strokerSelect(keonGetDevice());
+#endif
+  
   xTaskCreatePinnedToCore(
     keonTask,
     "KeonTask",
@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include <BLEDevice.h>
 #include <BLEClient.h>
+#include "stroker_device.h"
 
 // ===============================================================================
 // KEON BLE PROTOCOL CONSTANTS
@@ -16,7 +17,26 @@
 #define KEON_SERVICE_UUID "00001900-0000-1000-8000-00805f9b34fb"
 #define KEON_TX_CHAR_UUID "00001902-0000-1000-8000-00805f9b34fb"
 
-#define KEON_COMMAND_DELAY_MS 200
+// Command pipeline (keonPipelineService in de Keon task)
+#define KEON_CMD_MIN_SPACING_MS   40     // Nooit sneller dan dit naar de Keon
+#define KEON_CMD_MAX_SPACING_MS   400    // Bovengrens na mislukte writes
+#define KEON_WRITE_NO_RESPONSE    1      // Write zonder response als de characteristic het kan
+#define KEON_PROBE_EVERY          10     // Elke Nde write met response: acceptatie meten
+#define KEON_SEQ_DEPTH            4      // Volgorde commando's (stop reeks)
+
+// Kinematica / timing voor de motion engine (StrokerCaps). Benaderd uit de
+// level tabel (L7 ≈ 2 volle slagen/sec bij snelheid 99), kalibreren met een
+// echte Keon: volle slag 0→99 bij snelheid 50 timen
+#define KEON_MAX_UPS              400.0f // Posities/sec bij snelheid 99
+#define KEON_ACCEL_UPS2           4000.0f
+#define KEON_AIR_MS               30     // BLE connection interval + Keon firmware
+
+// Snel herverbinden (keonLinkService in de Keon task). Adres + TX handle
+// staan in Preferences; met een bekende handle geen service discovery
+#define KEON_PREFS_NS             "keon_ble"
+#define KEON_RECONNECT_MIN_MS     250    // Wachttijd na de eerste mislukte poging
+#define KEON_RECONNECT_MAX_MS     8000   // Verdubbelt per mislukte poging tot dit
+#define KEON_HANDLE_CHECK_MS      500    // Write met response via handle: max wachten op bevestiging
 
 // ═══════════════════════════════════════════════════════════════════════════
 // 8 LEVELS - OSCILLATIE FREQUENTIE (Positie-based)
@@ -42,12 +62,45 @@ bool keonConnect();
 void keonDisconnect();
 bool keonIsConnected();
 void keonCheckConnection();
-void keonReconnect();
-
-// Movement control
+void keonReconnect();      // Niet blokkerend: Keon task verbindt opnieuw
+void keonLinkService();    // Vanuit Keon task: verbinding bewaken / herstellen
+
+struct KeonLinkStats {
+  uint32_t drops;         // Verbinding onverwacht weg
+  uint32_t attempts;      // Pogingen om te herstellen
+  uint32_t reconnects;    // Gelukt
+  uint32_t fastPath;      // Verbonden met handle uit de cache (geen discovery)
+  uint32_t fallbacks;     // Gecachte handle ongeldig → alsnog discovery
+  uint32_t lastMs;        // Weg → weer schrijven (laatste herstel)
+  uint32_t maxMs;
+  uint32_t sumMs;
+};
+KeonLinkStats keonGetLinkStats();
+
+// StrokerDevice driver voor de Keon (stroker_device.h)
+StrokerDevice* keonGetDevice();
+
+// Movement control - niet blokkerend: zet klaar, Keon task schrijft
 bool keonMove(uint8_t position, uint8_t speed);
+bool keonMoveAsync(uint8_t position, uint8_t speed, StrokerDoneFn done);
 bool keonStop();
 bool keonStopAtPosition(uint8_t position);
+bool keonFlush(uint32_t timeoutMs);   // Wacht tot alles geschreven is (niet vanuit Keon task)
+
+struct KeonPipelineStats {
+  uint32_t queued;        // keonMove aanroepen
+  uint32_t sent;          // Writes naar de Keon
+  uint32_t coalesced;     // Vervangen voor ze verstuurd waren
+  uint32_t unchanged;     // Zelfde als laatst geschreven → overgeslagen
+  uint32_t failed;
+  uint32_t probes;        // Writes met response (acceptatie meting)
+  uint32_t latencySumUs;  // keonMove → write klaar
+  uint32_t latencyMaxUs;
+  float    acceptAvgUs;   // Gemeten write-met-response duur
+  uint32_t spacingUs;     // Huidige min tijd tussen writes
+};
+KeonPipelineStats keonGetPipelineStats();
+void keonPipelineService();   // Vanuit Keon task
 
 // Level control (NEW - oscillation based!)
 void keonSetLevel(uint8_t level);  // 0-7
@@ -56,7 +109,7 @@ float keonGetStrokeFrequency(uint8_t level);  // Get Hz for animation sync
 
 // MAC address management
 String keonGetLastMAC();
-void keonSetMAC(const char* mac);
+void keonSetMAC(const char* mac);   // Opgeslagen, geldt vanaf de volgende verbinding
 
 // Core 0 control tick
 void keonIndependentTick();
@@ -0,0 +1,138 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+
+// ===============================================================================
+// KEON KINEMATICA - Model van hoe een stroker (Keon) naar een positie beweegt
+// ===============================================================================
+// Een stroker commando is (positie 0-99, snelheid 0-99): de firmware rijdt
+// zelf naar de positie met een snelheid die bij de snelheid byte hoort.
+// De motion engine (keon_motion.cpp) rekent met dit model:
+//
+//   plannen   snelheid byte = afstand / tijd van het segment
+//   schaduw   waar het device nu (ongeveer) is → volg fout t.o.v. het script
+//
+// Het model is bewust simpel: snelheid lineair met de byte, begrensde
+// versnelling. De twee getallen komen per device uit StrokerCaps
+// (stroker_device.h). Geen Arduino afhankelijkheden, dus ook op de PC te
+// compileren om scripts door te rekenen.
+// ===============================================================================
+
+#define KEON_KIN_MIN_SPEED    1         // Snelheid 0 = stilstaan, niet gebruiken voor beweging
+
+struct KeonKinModel {
+  float maxUps;       // Posities/sec bij snelheid 99
+  float accelUps2;    // Versnelling (posities/sec²)
+};
+
+struct KeonKinState {
+  KeonKinModel model;
+  float   pos;        // Huidige positie (0-99)
+  float   vel;        // Huidige snelheid (posities/sec, + = omhoog)
+  uint8_t target;     // Laatst ontvangen commando
+  uint8_t speed;
+};
+
+static inline void keonKin_reset(KeonKinState& st, const KeonKinModel& model, float pos) {
+  st.model = model;
+  st.pos = pos;
+  st.vel = 0.0f;
+  st.target = (uint8_t)(pos + 0.5f);
+  st.speed = 0;
+}
+
+// Kruissnelheid (posities/sec) voor een snelheid byte
+static inline float keonKin_velocity(const KeonKinModel& model, uint8_t speed) {
+  if (speed > 99) speed = 99;
+  return model.maxUps * speed / 99.0f;
+}
+
+// Snelheid byte om 'distance' posities in 'durationMs' af te leggen.
+// *clipped = true als het niet haalbaar is (dan 99 = zo snel mogelijk)
+static inline uint8_t keonKin_speedFor(const KeonKinModel& model, float distance, uint32_t durationMs, bool* clipped) {
+  if (clipped) *clipped = false;
+  if (distance < 0.0f) distance = -distance;
+  if (distance < 0.5f) return KEON_KIN_MIN_SPEED;
+  if (durationMs == 0) {
+    if (clipped) *clipped = true;
+    return 99;
+  }
+  // Trapezium: optrekken + afremmen kost v/a extra → t = d/v + v/a,
+  // dus v = (a·t - sqrt(a²t² - 4ad)) / 2. Wortel negatief = niet haalbaar
+  float t = durationMs / 1000.0f;
+  float a = model.accelUps2;
+  float disc = a * a * t * t - 4.0f * a * distance;
+  float need = (disc >= 0.0f) ? (a * t - sqrtf(disc)) / 2.0f : model.maxUps * 2.0f;
+  float byteF = need * 99.0f / model.maxUps;
+  uint8_t speed = (uint8_t)(byteF + 0.999f);   // Naar boven: liever iets vroeg dan te laat
+  if (byteF > 99.0f) {
+    if (clipped) *clipped = true;
+    speed = 99;
+  }
+  if (speed < KEON_KIN_MIN_SPEED) speed = KEON_KIN_MIN_SPEED;
+  return speed;
+}
+
+// Grootste afstand die in durationMs haalbaar is (stilstand → stilstand):
+// omgekeerde van keonKin_speedFor() op snelheid 99
+static inline float keonKin_reach(const KeonKinModel& model, uint32_t durationMs) {
+  float t = durationMs / 1000.0f;
+  float v = model.maxUps;
+  float a = model.accelUps2;
+  if (v <= 0.0f || a <= 0.0f) return 99.0f;
+  if (t >= 2.0f * v / a) return v * (t - v / a);   // Trapezium
+  return a * t * t / 4.0f;                         // Driehoek: kruissnelheid niet gehaald
+}
+
+// Commando komt aan bij de Keon
+static inline void keonKin_command(KeonKinState& st, uint8_t pos, uint8_t speed) {
+  if (pos > 99) pos = 99;
+  st.target = pos;
+  st.speed = speed;
+}
+
+// dtMs verder: versnellen/afremmen naar de kruissnelheid, stoppen op target.
+// Omkeren kost dus tijd (eerst afremmen), zoals bij de echte motor
+static inline void keonKin_step(KeonKinState& st, float dtMs) {
+  if (dtMs <= 0.0f) return;
+  float dt = dtMs / 1000.0f;
+  float remaining = (float)st.target - st.pos;
+  float dist = fabsf(remaining);
+  if (dist < 0.01f && fabsf(st.vel) < 1.0f) {
+    st.pos = st.target;
+    st.vel = 0.0f;
+    return;
+  }
+
+  // Gewenste snelheid: kruissnelheid, maar niet harder dan nog af te remmen is
+  float want = keonKin_velocity(st.model, st.speed);
+  float brake = sqrtf(2.0f * st.model.accelUps2 * dist);
+  if (want > brake) want = brake;
+  if (remaining < 0.0f) want = -want;
+
+  float dv = st.model.accelUps2 * dt;
+  if (st.vel < want) st.vel = (st.vel + dv > want) ? want : st.vel + dv;
+  else               st.vel = (st.vel - dv < want) ? want : st.vel - dv;
+
+  float next = st.pos + st.vel * dt;
+  // Over het target heen in de goede richting → aangekomen
+  if ((remaining > 0.0f && next >= st.target) || (remaining < 0.0f && next <= st.target)) {
+    st.pos = st.target;
+    st.vel = 0.0f;
+  } else {
+    st.pos = next;
+  }
+  if (st.pos < 0.0f) st.pos = 0.0f;
+  if (st.pos > 99.0f) st.pos = 99.0f;
+}
+
+// Waar staat de Keon over aheadMs (zonder nieuwe commando's)
+static inline float keonKin_predict(const KeonKinState& st, uint32_t aheadMs) {
+  KeonKinState copy = st;
+  while (aheadMs > 0) {
+    uint32_t dt = aheadMs > 5 ? 5 : aheadMs;
+    keonKin_step(copy, (float)dt);
+    aheadMs -= dt;
+  }
+  return copy.pos;
+}
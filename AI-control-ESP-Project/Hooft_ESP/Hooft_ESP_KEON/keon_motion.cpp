@@ -0,0 +1,421 @@
+#include "keon_motion.h"
+#include "keon_ble.h"
+#include "keon_kinematics.h"
+#include "stroker_device.h"
+
+// ===============================================================================
+// STATE - rij + bron gedeeld (UI Core 1 / ESP-NOW / Keon task), rest alleen Keon task
+// ===============================================================================
+
+static portMUX_TYPE motionMux = portMUX_INITIALIZER_UNLOCKED;
+static KeonWaypoint wpQueue[KEON_MOTION_QUEUE];
+static uint8_t wpHead = 0;
+static uint8_t wpCount = 0;
+static KeonMotionSource motionSource = KEON_MOTION_IDLE;
+static uint8_t motionLevel = 0;
+static uint32_t motionGen = 0;          // +1 bij start/stop → Keon task begint opnieuw
+static bool levelReplan = false;        // Nieuw level: niet verstuurde slagen opnieuw plannen
+static uint32_t scriptLastMs = 0;       // SCRIPT: laatste waypoint / start (stil → level)
+static KeonMotionStats motionStats;
+static double trackSumAbs = 0.0;
+static double trackSumSq = 0.0;
+
+// Alleen Keon task (tick + pipeline callback)
+#define KEON_MOTION_HISTORY  8
+#define KEON_MOTION_APPLY    4
+
+struct KeonShadowApply {
+  uint32_t applyMs;
+  uint8_t  pos;
+  uint8_t  speed;
+};
+
+static KeonWaypoint history[KEON_MOTION_HISTORY];   // Script zoals het had moeten lopen
+static uint8_t historyHead = 0;
+static uint8_t historyCount = 0;
+static KeonWaypoint segFrom;                        // Begin van het volgende segment
+static bool haveFrom = false;
+static uint32_t localGen = 0;
+static bool wasConnected = false;
+
+static KeonKinState shadow;
+static uint32_t shadowMs = 0;
+static bool shadowValid = false;                    // Pas na het eerste commando
+static KeonShadowApply applyRing[KEON_MOTION_APPLY];
+static uint8_t applyHead = 0;
+static uint8_t applyCount = 0;
+
+// Gepubliceerde tijdlijn (onder motionMux) voor keonMotion_predictPos()
+struct KeonTimeline {
+  bool valid;
+  KeonKinState state;
+  uint32_t stateMs;
+  KeonShadowApply pending[KEON_MOTION_APPLY];
+  uint8_t pendingCount;
+};
+static KeonTimeline timeline;
+
+static StrokerDevice* motionDevice = nullptr;       // Device waar schaduw + lead bij horen
+static uint16_t deviceAirMs = 0;
+static float leadEwmaUs = 20000.0f;                 // moveAsync → write klaar
+
+// LEVEL generator
+static uint32_t levelLastAtMs = 0;
+static bool levelAtHigh = false;        // Laatste level waypoint was het bovenste punt
+
+// ═══════════════════════════════════════════════════════════════════════════
+// RIJ
+// ═══════════════════════════════════════════════════════════════════════════
+
+// Onder motionMux
+static bool queuePushLocked(uint32_t atMs, uint8_t pos) {
+  if (wpCount >= KEON_MOTION_QUEUE) {
+    motionStats.overflow++;
+    return false;
+  }
+  if (wpCount > 0) {
+    const KeonWaypoint& tail = wpQueue[(wpHead + wpCount - 1) % KEON_MOTION_QUEUE];
+    if ((int32_t)(atMs - tail.atMs) <= 0) return false;
+  }
+  KeonWaypoint& w = wpQueue[(wpHead + wpCount) % KEON_MOTION_QUEUE];
+  w.atMs = atMs;
+  w.pos = pos > 99 ? 99 : pos;
+  wpCount++;
+  scriptLastMs = atMs;
+  return true;
+}
+
+static void queueClearLocked() {
+  wpHead = 0;
+  wpCount = 0;
+}
+
+bool keonMotion_push(uint32_t atMs, uint8_t pos) {
+  portENTER_CRITICAL(&motionMux);
+  bool ok = queuePushLocked(atMs, pos);
+  portEXIT_CRITICAL(&motionMux);
+  return ok;
+}
+
+uint16_t keonMotion_pushScript(const KeonWaypoint* actions, uint16_t count, uint32_t startMs) {
+  uint16_t accepted = 0;
+  portENTER_CRITICAL(&motionMux);
+  for (uint16_t i = 0; i < count; i++) {
+    if (queuePushLocked(startMs + actions[i].atMs, actions[i].pos)) accepted++;
+  }
+  portEXIT_CRITICAL(&motionMux);
+  return accepted;
+}
+
+uint16_t keonMotion_free() {
+  portENTER_CRITICAL(&motionMux);
+  uint16_t n = KEON_MOTION_QUEUE - wpCount;
+  portEXIT_CRITICAL(&motionMux);
+  return n;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// BRON
+// ═══════════════════════════════════════════════════════════════════════════
+
+void keonMotion_start(KeonMotionSource source) {
+  portENTER_CRITICAL(&motionMux);
+  queueClearLocked();
+  motionSource = source;
+  motionGen++;
+  scriptLastMs = millis();
+  portEXIT_CRITICAL(&motionMux);
+}
+
+void keonMotion_stop() {
+  keonMotion_start(KEON_MOTION_IDLE);
+}
+
+KeonMotionSource keonMotion_source() {
+  return motionSource;
+}
+
+void keonMotion_endScript() {
+  keonMotion_start(KEON_MOTION_LEVEL_WAYPOINTS ? KEON_MOTION_LEVEL : KEON_MOTION_IDLE);
+}
+
+void keonMotion_setLevel(uint8_t level) {
+  if (level > 7) level = 7;
+  portENTER_CRITICAL(&motionMux);
+  if (level != motionLevel) {
+    motionLevel = level;
+    if (motionSource == KEON_MOTION_LEVEL) levelReplan = true;
+  }
+  portEXIT_CRITICAL(&motionMux);
+}
+
+// Onder motionMux: rij aanvullen met halve slagen op het tempo van het level.
+// Slag lengte = wat het device (model) in een halve periode haalt, met
+// marge: hoge levels worden kortere slagen rond het midden op het juiste
+// tempo i.p.v. geclipte slagen die achterlopen
+static void levelRefillLocked(const KeonKinModel& model) {
+  float hz = keonGetStrokeFrequency(motionLevel);
+  uint32_t halfMs = (uint32_t)(500.0f / (hz > 0.1f ? hz : 0.1f));
+  float range = KEON_MOTION_STROKE_HIGH - KEON_MOTION_STROKE_LOW;
+  float stroke = keonKin_reach(model, (uint32_t)(halfMs * KEON_MOTION_LEVEL_MARGIN));
+  if (stroke > range) stroke = range;
+  float mid = (KEON_MOTION_STROKE_HIGH + KEON_MOTION_STROKE_LOW) / 2.0f;
+  uint8_t low = (uint8_t)(mid - stroke / 2.0f + 0.5f);
+  uint8_t high = (uint8_t)(mid + stroke / 2.0f + 0.5f);
+  while (wpCount < KEON_MOTION_LEVEL_AHEAD * 2) {
+    if (!queuePushLocked(levelLastAtMs + halfMs, levelAtHigh ? low : high)) break;
+    levelLastAtMs += halfMs;
+    levelAtHigh = !levelAtHigh;
+  }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// SCHADUW MODEL + VOLG FOUT
+// ═══════════════════════════════════════════════════════════════════════════
+
+// Pipeline callback (Keon task): commando geschreven → over AIR ms bij de Keon
+static void onStrokerCmdDone(uint8_t position, uint8_t speed, StrokerCmdResult result, uint32_t latencyUs) {
+  if (result != STROKER_CMD_DONE) return;
+  leadEwmaUs += 0.2f * ((float)latencyUs - leadEwmaUs);
+
+  if (applyCount >= KEON_MOTION_APPLY) {
+    // Vol: oudste direct toepassen
+    KeonShadowApply& old = applyRing[applyHead];
+    keonKin_command(shadow, old.pos, old.speed);
+    applyHead = (applyHead + 1) % KEON_MOTION_APPLY;
+    applyCount--;
+  }
+  KeonShadowApply& a = applyRing[(applyHead + applyCount) % KEON_MOTION_APPLY];
+  a.applyMs = millis() + deviceAirMs;
+  a.pos = position;
+  a.speed = speed;
+  applyCount++;
+  shadowValid = true;
+}
+
+static void shadowAdvance(uint32_t nowMs) {
+  if (!shadowValid) {
+    shadowMs = nowMs;
+    return;
+  }
+  // In stappen tot elk commando dat onderweg is, zodat het op tijd ingaat
+  while (applyCount > 0 && (int32_t)(nowMs - applyRing[applyHead].applyMs) >= 0) {
+    KeonShadowApply& a = applyRing[applyHead];
+    if ((int32_t)(a.applyMs - shadowMs) > 0) {
+      keonKin_step(shadow, (float)(a.applyMs - shadowMs));
+      shadowMs = a.applyMs;
+    }
+    keonKin_command(shadow, a.pos, a.speed);
+    applyHead = (applyHead + 1) % KEON_MOTION_APPLY;
+    applyCount--;
+  }
+  if ((int32_t)(nowMs - shadowMs) > 0) {
+    keonKin_step(shadow, (float)(nowMs - shadowMs));
+    shadowMs = nowMs;
+  }
+}
+
+static void timelinePublish(bool active) {
+  portENTER_CRITICAL(&motionMux);
+  timeline.valid = active && shadowValid;
+  timeline.state = shadow;
+  timeline.stateMs = shadowMs;
+  timeline.pendingCount = applyCount;
+  for (uint8_t i = 0; i < applyCount; i++) {
+    timeline.pending[i] = applyRing[(applyHead + i) % KEON_MOTION_APPLY];
+  }
+  portEXIT_CRITICAL(&motionMux);
+}
+
+bool keonMotion_predictPos(uint32_t atMs, float& pos) {
+  portENTER_CRITICAL(&motionMux);
+  KeonTimeline tl = timeline;
+  portEXIT_CRITICAL(&motionMux);
+  if (!tl.valid || (int32_t)(atMs - tl.stateMs) > KEON_MOTION_STALE_MS) return false;
+
+  // Commando's die vóór atMs bij de Keon aankomen op hun moment toepassen
+  KeonKinState st = tl.state;
+  uint32_t t = tl.stateMs;
+  for (uint8_t i = 0; i < tl.pendingCount; i++) {
+    const KeonShadowApply& a = tl.pending[i];
+    if ((int32_t)(atMs - a.applyMs) < 0) break;
+    if ((int32_t)(a.applyMs - t) > 0) {
+      keonKin_step(st, (float)(a.applyMs - t));
+      t = a.applyMs;
+    }
+    keonKin_command(st, a.pos, a.speed);
+  }
+  if ((int32_t)(atMs - t) > 0) keonKin_step(st, (float)(atMs - t));
+  pos = st.pos;
+  return true;
+}
+
+static void historyAdd(const KeonWaypoint& w) {
+  history[(historyHead + historyCount) % KEON_MOTION_HISTORY] = w;
+  if (historyCount < KEON_MOTION_HISTORY) historyCount++;
+  else historyHead = (historyHead + 1) % KEON_MOTION_HISTORY;
+}
+
+// Script positie op nowMs (lineair tussen waypoints). false = buiten de geschiedenis
+static bool historyPosAt(uint32_t nowMs, float& pos) {
+  for (uint8_t i = 0; i + 1 < historyCount; i++) {
+    const KeonWaypoint& a = history[(historyHead + i) % KEON_MOTION_HISTORY];
+    const KeonWaypoint& b = history[(historyHead + i + 1) % KEON_MOTION_HISTORY];
+    if ((int32_t)(nowMs - a.atMs) < 0 || (int32_t)(nowMs - b.atMs) >= 0) continue;
+    float t = (float)(nowMs - a.atMs) / (float)(b.atMs - a.atMs);
+    pos = a.pos + t * ((float)b.pos - a.pos);
+    return true;
+  }
+  return false;
+}
+
+static void trackSample(uint32_t nowMs) {
+  float ref;
+  if (!shadowValid || !historyPosAt(nowMs, ref)) return;
+  float err = fabsf(ref - shadow.pos);
+  portENTER_CRITICAL(&motionMux);
+  motionStats.trackSamples++;
+  trackSumAbs += err;
+  trackSumSq += err * err;
+  if (err > motionStats.trackMax) motionStats.trackMax = err;
+  portEXIT_CRITICAL(&motionMux);
+}
+
+void keonMotion_resetTracking() {
+  portENTER_CRITICAL(&motionMux);
+  motionStats.trackSamples = 0;
+  motionStats.trackMax = 0.0f;
+  trackSumAbs = 0.0;
+  trackSumSq = 0.0;
+  portEXIT_CRITICAL(&motionMux);
+}
+
+KeonMotionStats keonMotion_getStats() {
+  portENTER_CRITICAL(&motionMux);
+  KeonMotionStats copy = motionStats;
+  double sumAbs = trackSumAbs;
+  double sumSq = trackSumSq;
+  portEXIT_CRITICAL(&motionMux);
+  if (copy.trackSamples > 0) {
+    copy.trackAvg = (float)(sumAbs / copy.trackSamples);
+    copy.trackRms = sqrtf((float)(sumSq / copy.trackSamples));
+  }
+  return copy;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// TICK - Keon task (Core 0)
+// ═══════════════════════════════════════════════════════════════════════════
+
+static void localRestart() {
+  historyHead = 0;
+  historyCount = 0;
+  haveFrom = false;
+}
+
+// Ander device gekozen: schaduw en lead horen bij het oude device
+static void deviceChanged(StrokerDevice* dev) {
+  motionDevice = dev;
+  if (!dev) return;
+  const StrokerCaps& caps = dev->caps();
+  KeonKinModel model = {caps.maxUnitsPerSec, caps.accelUps2};
+  keonKin_reset(shadow, model, 0.0f);
+  shadowValid = false;
+  applyCount = 0;
+  deviceAirMs = caps.airMs;
+  leadEwmaUs = caps.minSpacingMs * 500.0f;
+  wasConnected = false;
+  keonMotion_resetTracking();
+  Serial.printf("[KEON MOTION] Device %s: %s, min %u ms, air %u ms\n", dev->name(),
+                caps.position ? "positie" : "alleen tempo", caps.minSpacingMs, caps.airMs);
+}
+
+void keonMotion_tick(uint32_t nowMs) {
+  StrokerDevice* dev = strokerActive();
+  if (dev != motionDevice) deviceChanged(dev);
+  shadowAdvance(nowMs);
+
+  bool connected = dev && dev->isConnected();
+  if (!connected) {
+    wasConnected = false;
+    timelinePublish(false);
+    return;
+  }
+
+  const StrokerCaps& caps = dev->caps();
+  uint32_t minSegMs = caps.minSpacingMs > KEON_MOTION_MIN_SEG_MS ? caps.minSpacingMs : KEON_MOTION_MIN_SEG_MS;
+  uint32_t leadMs = (uint32_t)(leadEwmaUs / 1000.0f) + deviceAirMs;
+  if (leadMs > KEON_MOTION_LEAD_MAX_MS) leadMs = KEON_MOTION_LEAD_MAX_MS;
+  uint32_t arrivalMs = nowMs + leadMs;
+
+  portENTER_CRITICAL(&motionMux);
+  motionStats.leadMs = leadMs;
+  bool scriptDone = motionSource == KEON_MOTION_SCRIPT && wpCount == 0 &&
+                    (int32_t)(nowMs - scriptLastMs) > KEON_MOTION_SCRIPT_HOLD_MS;
+  if (scriptDone) {
+    motionSource = KEON_MOTION_LEVEL_WAYPOINTS ? KEON_MOTION_LEVEL : KEON_MOTION_IDLE;
+    motionGen++;
+  }
+  KeonMotionSource src = motionSource;
+  bool restart = (localGen != motionGen) || !wasConnected;
+  localGen = motionGen;
+  if (src == KEON_MOTION_LEVEL) {
+    if (restart || levelReplan) {
+      // Vanaf het eerstvolgende commando opnieuw: begin waar de Keon dan (ongeveer) is
+      queueClearLocked();
+      levelLastAtMs = arrivalMs;
+      levelAtHigh = shadowValid && shadow.pos >= 50.0f;
+      levelReplan = false;
+    }
+    levelRefillLocked(shadow.model);
+  }
+  portEXIT_CRITICAL(&motionMux);
+
+  if (scriptDone) Serial.println("[KEON MOTION] Script stil → level slagen");
+  if (restart) localRestart();
+  wasConnected = true;
+  if (src == KEON_MOTION_IDLE) {
+    timelinePublish(false);
+    return;
+  }
+
+  if (caps.position) trackSample(nowMs);
+
+  // Volgende waypoint kiezen: één commando per tick, de pipeline doet de spacing
+  float predicted = shadowValid ? keonKin_predict(shadow, leadMs) : -1.0f;
+  KeonWaypoint target;
+  bool issue = false;
+  bool clipped = false;
+  uint8_t speed = 0;
+  portENTER_CRITICAL(&motionMux);
+  while (wpCount > 0) {
+    KeonWaypoint h = wpQueue[wpHead];
+    // Segment begint bij het vorige waypoint, pas zo laat mogelijk sturen
+    if (haveFrom && (int32_t)(arrivalMs - segFrom.atMs) < 0) break;
+
+    int32_t durMs = (int32_t)(h.atMs - arrivalMs);
+    wpHead = (wpHead + 1) % KEON_MOTION_QUEUE;
+    wpCount--;
+    segFrom = h;
+    haveFrom = true;
+    historyAdd(h);
+
+    if (durMs < (int32_t)minSegMs && wpCount > 0) {
+      motionStats.skipped++;
+      continue;
+    }
+    target = h;
+    if (durMs < (int32_t)minSegMs) durMs = minSegMs;
+    float fromPos = (predicted >= 0.0f) ? predicted : (float)h.pos;
+    speed = keonKin_speedFor(shadow.model, (float)h.pos - fromPos, (uint32_t)durMs, &clipped);
+    issue = true;
+    motionStats.issued++;
+    if (clipped) motionStats.clipped++;
+    break;
+  }
+  portEXIT_CRITICAL(&motionMux);
+
+  if (issue) dev->moveAsync(target.pos, speed, onStrokerCmdDone);
+  // Alleen tempo (Solace): geen positie tijdlijn, UI houdt zijn eigen phase
+  timelinePublish(caps.position);
+}
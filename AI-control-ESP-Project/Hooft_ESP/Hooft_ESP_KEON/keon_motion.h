@@ -0,0 +1,117 @@
+#pragma once
+#include <Arduino.h>
+
+// ===============================================================================
+// KEON MOTION ENGINE - Waypoints (funscript stijl) met vooruitkijken
+// ===============================================================================
+// Een rij (tijd, positie) waypoints, tijd in millis() van de HoofdESP. Dat
+// is ook de sessie klok (espnow_timesync.h), dus waypoints van de Body ESP
+// kunnen zonder omrekenen in de rij.
+//
+// Bronnen:
+//   LEVEL   slagen op de frequentie van keonGetStrokeFrequency() (zelfde
+//           tempo als de animatie), rij wordt zelf bijgevuld. Volle slag
+//           0↔99 zolang het device dat in een halve periode haalt, anders
+//           korter rond het midden (keonKin_reach())
+//   SCRIPT  funscript acties: keonMotion_pushScript() (at relatief aan
+//           startMs) of losse ESPNOW_OP_FUNSCRIPT_ACTION frames van de Body
+//           ESP (espnow_comm.cpp). Stil → terug naar de level slagen
+//   AI      losse waypoints, bv. een patroon van de AI
+//
+// Stuurt het actieve StrokerDevice (stroker_device.h), standaard de Keon.
+// Per segment (vorige waypoint → volgende) rekent de engine de snelheid
+// uit afstand/tijd (keon_kinematics.h, model uit de device caps) en zet het
+// commando 'lead' ms VOOR het begin van het segment klaar. lead = gemeten
+// tijd in de driver (moveAsync → write klaar) + caps.airMs. Te korte
+// (< max(KEON_MOTION_MIN_SEG_MS, caps.minSpacingMs)) of al verlopen segmenten
+// worden overgeslagen: het device gaat dan meteen naar het eerstvolgende
+// haalbare waypoint.
+//
+// Een schaduw model van de Keon krijgt elk geschreven commando en wordt
+// vergeleken met het script → volg fout (gem/rms/max) in de statistiek.
+// LET OP: dat is script vs wat het model van onze EIGEN commando's maakt,
+// geen meting aan het device. Het zegt of de planning haalbaar is (te
+// korte segmenten, clipping, lead); hoe ver de echte Keon ernaast zit ziet
+// de engine niet. Die fout meet host/keon_motion_sim.cpp tegen de mock
+// (stroker_mock.h simPos(), eigen air tijd) - met een echte Keon alleen
+// door te filmen / kalibreren.
+//
+// TIJDLIJN: het schaduw model + commando's die nog onderweg zijn worden na
+// elke tick gepubliceerd. keonMotion_predictPos() rekent daaruit de stand
+// van de Keon op een willekeurig moment (bv. wanneer het frame op het
+// scherm staat). De animatie en de sleeve % naar de Body ESP lezen allebei
+// deze tijdlijn, zodat scherm, telemetrie en Keon dezelfde beweging volgen.
+// ===============================================================================
+
+#define KEON_MOTION_QUEUE          64      // Waypoints in de rij
+#define KEON_MOTION_LEAD_MAX_MS    250     // Vooruit sturen nooit meer dan dit
+#define KEON_MOTION_MIN_SEG_MS     60      // Korter segment → samenvoegen met het volgende
+#define KEON_MOTION_LEVEL_AHEAD    4       // LEVEL: zoveel slagen vooruit in de rij
+#define KEON_MOTION_STROKE_LOW     0
+#define KEON_MOTION_STROKE_HIGH    99
+#define KEON_MOTION_LEVEL_MARGIN   0.85f   // LEVEL: slag moet in dit deel van een halve periode passen
+#define KEON_MOTION_DISPLAY_MS     15      // Berekenen → frame op het scherm
+#define KEON_MOTION_STALE_MS       500     // Tijdlijn ouder → niet meer gebruiken
+// Funscript actie van de Body ESP = waar de Keon op het verzendmoment moet
+// zijn. Het segment ernaartoe kan pas gepland worden als de actie binnen is,
+// dus waypoint = verzendmoment + langste segment + lead. Korter → lange
+// segmenten worden te laat en te snel gereden (host/keon_motion_sim.cpp).
+// Video sync: offset in de player met dezelfde waarde naar voren
+#define KEON_MOTION_SCRIPT_DELAY_MS 750
+#define KEON_MOTION_SCRIPT_HOLD_MS 2000    // Script rij zo lang leeg → terug naar de level slagen
+
+// 1 = levels als waypoint slagen (KEON_FUNSCRIPT_COMPLETE_DOCUMENTATIE).
+// Alleen dan is er in level mode een tijdlijn: animatie en sleeve % naar de
+// Body ESP volgen de Keon (keonTimelineStroke01() in ui.cpp).
+// 0 = oude oscillatie: positie uit KEON_LEVEL_POSITIONS[], de Keon firmware
+// beweegt op een eigen klok; animatie valt terug op 'phase' en loopt niet
+// gelijk. Tempo van de waypoint slagen = keonGetStrokeFrequency(); het model
+// (KEON_MAX_UPS / KEON_ACCEL_UPS2 / KEON_AIR_MS, keon_ble.h) bepaalt alleen
+// de slag lengte bij hoge levels. Funscript (SCRIPT) gebruikt de engine altijd
+#define KEON_MOTION_LEVEL_WAYPOINTS 1
+
+enum KeonMotionSource : uint8_t {
+  KEON_MOTION_IDLE = 0,
+  KEON_MOTION_LEVEL,
+  KEON_MOTION_SCRIPT,
+  KEON_MOTION_AI
+};
+
+struct KeonWaypoint {
+  uint32_t atMs;
+  uint8_t  pos;       // 0-99
+};
+
+struct KeonMotionStats {
+  uint32_t issued;        // Commando's naar de pipeline
+  uint32_t skipped;       // Waypoints overgeslagen (te kort / te laat)
+  uint32_t clipped;       // Segment sneller dan de Keon kan
+  uint32_t overflow;      // Rij vol → waypoint geweigerd
+  uint32_t leadMs;        // Huidige vooruit tijd
+  uint32_t trackSamples;
+  float    trackAvg;      // Gem |script - schaduw| (posities), schaduw = model, geen meting
+  float    trackRms;
+  float    trackMax;
+};
+
+// Bron kiezen: rij leeg, schaduw blijft. LEVEL begint meteen met slagen
+void keonMotion_start(KeonMotionSource source);
+void keonMotion_stop();                         // Rij leeg, geen commando's meer
+KeonMotionSource keonMotion_source();
+void keonMotion_endScript();                    // SCRIPT klaar → LEVEL (waypoints) of IDLE
+
+void keonMotion_setLevel(uint8_t level);        // LEVEL: nieuw tempo vanaf de volgende slag
+
+// Waypoints toevoegen (moeten oplopend in tijd). false = rij vol / te oud
+bool keonMotion_push(uint32_t atMs, uint8_t pos);
+uint16_t keonMotion_pushScript(const KeonWaypoint* actions, uint16_t count, uint32_t startMs);
+uint16_t keonMotion_free();
+
+void keonMotion_tick(uint32_t nowMs);           // Vanuit Keon task, vóór service() van het device
+
+// Voorspelde Keon stand (0-99) op atMs. false = geen tijdlijn (idle, geen
+// commando geschreven, Keon task loopt niet)
+bool keonMotion_predictPos(uint32_t atMs, float& pos);
+
+KeonMotionStats keonMotion_getStats();
+void keonMotion_resetTracking();
@@ -0,0 +1,156 @@
+#include "latency_trace.h"
+
+// ===============================================================================
+// STATE - gedeeld tussen ESP-NOW callback, Keon task (Core 0) en UI (Core 1)
+// ===============================================================================
+
+static SampleRing rings[LAT_STAGE_COUNT];
+static portMUX_TYPE traceMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Trace die wacht op Keon pickup
+static bool pendingActive = false;
+static uint32_t pendingId = 0;
+static uint32_t pendingBodyUs = 0;     // Som Body stappen (sensor + decision + send)
+static uint32_t pendingHooftUs = 0;    // Som Hooft stappen tot nu toe
+static uint32_t pendingAppliedUs = 0;  // micros() op moment g_speedStep gezet
+static uint32_t pendingAppliedMs = 0;
+static bool pickedUp = false;
+static bool claimed = false;           // Keon commando draagt pendingId
+
+static uint32_t lastReportedCount = 0;
+static uint32_t lastReportMs = 0;
+
+static const char* STAGE_NAMES[LAT_STAGE_COUNT] = {
+  "Sensor", "Decision", "Send", "Air", "Apply", "Pickup", "BLE wr", "BLE wacht", "TOTAAL"
+};
+
+// Alleen aanroepen binnen traceMux
+static void addSample(LatencyStage stage, uint32_t us) {
+  sampleRing_add(rings[stage], us);
+}
+
+// ===============================================================================
+// TRACE POINTS
+// ===============================================================================
+
+void latencyTrace_onBodyMessage(const bodyESP_message_t &msg, uint32_t rxUs, bool levelChanged) {
+  if (msg.traceId == 0) return;
+
+  uint32_t now = micros();
+  uint32_t applyUs = now - rxUs;
+
+  portENTER_CRITICAL(&traceMux);
+  addSample(LAT_SENSOR, msg.traceSensorUs);
+  addSample(LAT_DECISION, msg.traceDecisionUs);
+  addSample(LAT_SEND, msg.traceSendUs);
+  if (msg.traceAirUs > 0) addSample(LAT_AIR, msg.traceAirUs);
+  addSample(LAT_APPLY, applyUs);
+
+  // Alleen een level wijziging leidt tot een Keon commando
+  if (levelChanged) {
+    pendingActive = true;
+    pendingId = msg.traceId;
+    pendingBodyUs = msg.traceSensorUs + msg.traceDecisionUs + msg.traceSendUs;
+    pendingHooftUs = applyUs;
+    pendingAppliedUs = now;
+    pendingAppliedMs = millis();
+    pickedUp = false;
+    claimed = false;
+  }
+  portEXIT_CRITICAL(&traceMux);
+}
+
+void latencyTrace_onKeonPickup() {
+  uint32_t now = micros();
+
+  portENTER_CRITICAL(&traceMux);
+  if (pendingActive && !pickedUp) {
+    if (millis() - pendingAppliedMs > LATENCY_PENDING_TIMEOUT_MS) {
+      pendingActive = false;   // Keon niet verbonden of gepauzeerd geweest
+    } else {
+      uint32_t pickupUs = now - pendingAppliedUs;
+      addSample(LAT_PICKUP, pickupUs);
+      pendingHooftUs += pickupUs;
+      pickedUp = true;
+    }
+  }
+  portEXIT_CRITICAL(&traceMux);
+}
+
+uint32_t latencyTrace_claimCommand() {
+  uint32_t id = 0;
+  portENTER_CRITICAL(&traceMux);
+  if (pendingActive && pickedUp && !claimed) {
+    claimed = true;
+    id = pendingId;
+  }
+  portEXIT_CRITICAL(&traceMux);
+  return id;
+}
+
+void latencyTrace_onKeonWrite(uint32_t traceId, uint32_t writeUs, uint32_t blockUs) {
+  portENTER_CRITICAL(&traceMux);
+  addSample(LAT_BLE_WRITE, writeUs);
+  addSample(LAT_BLE_BLOCK, blockUs);
+  if (traceId != 0 && pendingActive && claimed && traceId == pendingId) {
+    addSample(LAT_TOTAL, pendingBodyUs + pendingHooftUs + blockUs + writeUs);
+    pendingActive = false;
+  }
+  portEXIT_CRITICAL(&traceMux);
+}
+
+// ===============================================================================
+// STATISTIEK
+// ===============================================================================
+
+LatencyStats latencyTrace_getStats(LatencyStage stage) {
+  if (stage >= LAT_STAGE_COUNT) return LatencyStats{0, 0, 0, 0};
+
+  // Kopie binnen de lock, sorteren daarbuiten
+  portENTER_CRITICAL(&traceMux);
+  SampleRing copy = rings[stage];
+  portEXIT_CRITICAL(&traceMux);
+  return sampleRing_stats(copy);
+}
+
+const char* latencyTrace_stageName(LatencyStage stage) {
+  return (stage < LAT_STAGE_COUNT) ? STAGE_NAMES[stage] : "?";
+}
+
+void latencyTrace_reset() {
+  portENTER_CRITICAL(&traceMux);
+  memset(rings, 0, sizeof(rings));
+  pendingActive = false;
+  pickedUp = false;
+  claimed = false;
+  portEXIT_CRITICAL(&traceMux);
+  lastReportedCount = 0;
+}
+
+// ===============================================================================
+// SERIAL RAPPORT
+// ===============================================================================
+
+void latencyTrace_printReport() {
+  Serial.println("[LATENCY] ───── Stap ─────── n ──── p50 ──── p95 ──── max (ms)");
+  for (uint8_t s = 0; s < LAT_STAGE_COUNT; s++) {
+    LatencyStats st = latencyTrace_getStats((LatencyStage)s);
+    Serial.printf("[LATENCY] %-10s %6lu %8.1f %8.1f %8.1f\n",
+                  latencyTrace_stageName((LatencyStage)s), (unsigned long)st.count,
+                  st.p50Us / 1000.0f, st.p95Us / 1000.0f, st.maxUs / 1000.0f);
+  }
+}
+
+void latencyTrace_tick() {
+  if (millis() - lastReportMs < LATENCY_REPORT_INTERVAL_MS) return;
+  lastReportMs = millis();
+
+  uint32_t count;
+  portENTER_CRITICAL(&traceMux);
+  count = rings[LAT_APPLY].count;
+  portEXIT_CRITICAL(&traceMux);
+
+  if (count == lastReportedCount) return;  // Geen nieuwe traces
+  lastReportedCount = count;
+  latencyTrace_printReport();
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <Arduino.h>
+#include "espnow_comm.h"
+#include "sample_ring.h"
+
+// ===============================================================================
+// LATENCY TRACE - Sensor sample (Body ESP) → Keon beweging (HoofdESP)
+// ===============================================================================
+// Body ESP meet zijn eigen stappen en stuurt de duur mee in bodyESP_message_t
+// (traceId != 0). HoofdESP meet ontvangst → g_speedStep, Keon task pickup en
+// de BLE write. Klokken zijn niet gesynchroniseerd: alleen DUUR per stap wordt
+// vergeleken, nooit absolute tijden van verschillende ESP's.
+//
+// Het eerste Keon commando na de pickup draagt de traceId door de pipeline
+// (latencyTrace_claimCommand); TOTAAL sluit alleen op de write van dát
+// commando, niet op een ouder commando dat toevallig eerst weggaat.
+//
+// Per stap een ring (sample_ring.h) van de laatste metingen → p50/p95/max.
+// Zichtbaar op menu pagina "LATENCY" (via ESP STATUS) en elke
+// LATENCY_REPORT_INTERVAL_MS over serial.
+// ===============================================================================
+
+#define LATENCY_REPORT_INTERVAL_MS   10000
+#define LATENCY_PENDING_TIMEOUT_MS   3000   // Geen Keon pickup → trace vervalt
+
+enum LatencyStage : uint8_t {
+  LAT_SENSOR = 0,   // Body: ads1115_readAll()
+  LAT_DECISION,     // Body: stressManager.update() + getStressDecision()
+  LAT_SEND,         // Body: beslissing klaar → esp_now_send()
+  LAT_AIR,          // Body: esp_now_send() → send callback (vorig trace bericht)
+  LAT_APPLY,        // Hooft: ontvangst → bericht verwerkt (g_speedStep gezet)
+  LAT_PICKUP,       // Hooft: g_speedStep gezet → Keon task ziet nieuw level
+  LAT_BLE_WRITE,    // Hooft: writeValue() duur (met response: tot bevestiging)
+  LAT_BLE_BLOCK,    // Hooft: wachttijd in de Keon pipeline (spacing) voor de write
+  LAT_TOTAL,        // Sensor → BLE write klaar (som, excl. AIR)
+  LAT_STAGE_COUNT
+};
+
+typedef SampleStats LatencyStats;
+
+// Aanroepen vanuit de ESP-NOW dispatch (loop) na handleBodyESPMessage(),
+// rxUs = micros() in de receive callback
+void latencyTrace_onBodyMessage(const bodyESP_message_t &msg, uint32_t rxUs, bool levelChanged);
+
+// Aanroepen vanuit Keon task (Core 0)
+void latencyTrace_onKeonPickup();
+uint32_t latencyTrace_claimCommand();   // traceId voor een nieuw Keon commando, 0 = geen
+void latencyTrace_onKeonWrite(uint32_t traceId, uint32_t writeUs, uint32_t blockUs);
+
+LatencyStats latencyTrace_getStats(LatencyStage stage);
+const char* latencyTrace_stageName(LatencyStage stage);
+void latencyTrace_reset();
+
+// Serial rapport
+void latencyTrace_printReport();
+void latencyTrace_tick();   // In loop(): periodiek rapport als er nieuwe metingen zijn
@@ -0,0 +1,63 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+// ===============================================================================
+// SAMPLE RING - Laatste SAMPLE_RING_SIZE metingen (µs) → p50/p95/max
+// ===============================================================================
+// Gedeeld door latency_trace (Body → Keon stappen) en frame_pacer (frame
+// tijden). Geen lock: de aanroeper bepaalt dat (latency_trace kopieert de
+// ring binnen zijn mux en sorteert daarbuiten).
+// ===============================================================================
+
+#define SAMPLE_RING_SIZE  64
+
+struct SampleRing {
+  uint32_t samples[SAMPLE_RING_SIZE];
+  uint8_t head;
+  uint32_t count;   // Totaal aantal metingen
+  uint32_t maxUs;   // Sinds reset
+};
+
+struct SampleStats {
+  uint32_t count;   // Totaal aantal metingen
+  uint32_t p50Us;
+  uint32_t p95Us;
+  uint32_t maxUs;   // Sinds reset
+};
+
+static inline void sampleRing_add(SampleRing &r, uint32_t us) {
+  r.samples[r.head] = us;
+  r.head = (r.head + 1) % SAMPLE_RING_SIZE;
+  r.count++;
+  if (us > r.maxUs) r.maxUs = us;
+}
+
+// Aantal geldige samples in de ring
+static inline uint8_t sampleRing_size(const SampleRing &r) {
+  return (r.count < SAMPLE_RING_SIZE) ? r.count : SAMPLE_RING_SIZE;
+}
+
+static inline SampleStats sampleRing_stats(const SampleRing &r) {
+  SampleStats stats = {r.count, 0, 0, r.maxUs};
+  uint8_t n = sampleRing_size(r);
+  if (n == 0) return stats;
+
+  uint32_t sorted[SAMPLE_RING_SIZE];
+  memcpy(sorted, r.samples, n * sizeof(uint32_t));
+
+  // Insertion sort - max 64 elementen
+  for (uint8_t i = 1; i < n; i++) {
+    uint32_t v = sorted[i];
+    int8_t j = i - 1;
+    while (j >= 0 && sorted[j] > v) {
+      sorted[j + 1] = sorted[j];
+      j--;
+    }
+    sorted[j + 1] = v;
+  }
+
+  stats.p50Us = sorted[(n - 1) * 50 / 100];
+  stats.p95Us = sorted[(n - 1) * 95 / 100];
+  return stats;
+}
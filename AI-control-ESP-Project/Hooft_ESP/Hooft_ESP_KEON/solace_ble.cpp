@@ -0,0 +1,276 @@
+#include "solace_ble.h"
+#include "keon_ble.h"
+#include <BLEDevice.h>
+#include <BLEClient.h>
+
+// ═══════════════════════════════════════════════════════════════════════════
+// GLOBAL STATE
+// ═══════════════════════════════════════════════════════════════════════════
+
+static BLEClient* solaceClient = nullptr;
+static BLERemoteCharacteristic* solaceTx = nullptr;
+static BLERemoteCharacteristic* solaceRx = nullptr;
+static volatile bool solaceLinkUp = false;
+
+struct SolaceCmd {
+  uint8_t position;
+  uint8_t speed;
+  uint32_t queuedUs;
+  StrokerDoneFn done;
+};
+
+static portMUX_TYPE solaceMux = portMUX_INITIALIZER_UNLOCKED;
+static SolaceCmd solaceSlot;
+static bool solaceSlotFull = false;
+static uint8_t solaceLastLevel = 0xFF;    // Laatst geschreven stoot niveau (0xFF = onbekend)
+static uint32_t solaceLastWriteUs = 0;
+static uint32_t solaceSent = 0;
+static uint32_t solaceLatencySumUs = 0;
+
+// ═══════════════════════════════════════════════════════════════════════════
+// BLE CALLBACKS
+// ═══════════════════════════════════════════════════════════════════════════
+
+class SolaceClientCallback : public BLEClientCallbacks {
+  void onConnect(BLEClient* pclient) {
+    Serial.println("[SOLACE] ✅ BLE Connected");
+  }
+  void onDisconnect(BLEClient* pclient) {
+    solaceLinkUp = false;
+    Serial.println("[SOLACE] ❌ BLE Disconnected");
+  }
+};
+
+// Antwoorden (DeviceType / Battery) alleen loggen
+static void solaceNotify(BLERemoteCharacteristic* chr, uint8_t* data, size_t len, bool isNotify) {
+  char buf[32];
+  size_t n = len < sizeof(buf) - 1 ? len : sizeof(buf) - 1;
+  memcpy(buf, data, n);
+  buf[n] = 0;
+  Serial.printf("[SOLACE] ← %s\n", buf);
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// CONNECTION
+// ═══════════════════════════════════════════════════════════════════════════
+
+static bool solaceIsLovenseService(const std::string& uuid) {
+  const std::string suffix = SOLACE_SERVICE_SUFFIX;
+  return uuid == SOLACE_SERVICE_LEGACY ||
+         (uuid.size() > suffix.size() && uuid.compare(uuid.size() - suffix.size(), suffix.size(), suffix) == 0);
+}
+
+static void solaceWrite(const char* cmd) {
+  solaceTx->writeValue((uint8_t*)cmd, strlen(cmd), false);
+}
+
+bool solaceConnect() {
+  keonInit();   // BLEDevice::init (één keer, gedeeld met de Keon)
+
+  Serial.println("[SOLACE] Attempting connection...");
+
+  if (solaceClient == nullptr) {
+    solaceClient = BLEDevice::createClient();
+    solaceClient->setClientCallbacks(new SolaceClientCallback());
+  }
+
+  if (!solaceClient->connect(BLEAddress(SOLACE_MAC_ADDRESS))) {
+    Serial.println("[SOLACE] Connection failed!");
+    return false;
+  }
+
+  delay(500);
+
+  // Lovense service zoeken: UUID verschilt per model / generatie
+  BLERemoteService* svc = nullptr;
+  std::map<std::string, BLERemoteService*>* services = solaceClient->getServices();
+  if (services != nullptr) {
+    for (auto &entry : *services) {
+      if (solaceIsLovenseService(entry.first)) {
+        svc = entry.second;
+        Serial.printf("[SOLACE] Service %s\n", entry.first.c_str());
+        break;
+      }
+    }
+  }
+  if (svc == nullptr) {
+    Serial.println("[SOLACE] Lovense service not found!");
+    solaceClient->disconnect();
+    return false;
+  }
+
+  solaceTx = nullptr;
+  solaceRx = nullptr;
+  std::map<std::string, BLERemoteCharacteristic*>* characteristics = svc->getCharacteristics();
+  if (characteristics != nullptr) {
+    for (auto &entry : *characteristics) {
+      BLERemoteCharacteristic* pChar = entry.second;
+      if (solaceTx == nullptr && (pChar->canWrite() || pChar->canWriteNoResponse())) solaceTx = pChar;
+      else if (solaceRx == nullptr && pChar->canNotify()) solaceRx = pChar;
+    }
+  }
+  if (solaceTx == nullptr) {
+    Serial.println("[SOLACE] No writable characteristic found!");
+    solaceClient->disconnect();
+    return false;
+  }
+  if (solaceRx != nullptr) solaceRx->registerForNotify(solaceNotify);
+
+  portENTER_CRITICAL(&solaceMux);
+  solaceSlotFull = false;
+  solaceLastLevel = 0xFF;
+  portEXIT_CRITICAL(&solaceMux);
+  solaceLastWriteUs = 0;
+
+  solaceWrite(SOLACE_CMD_HELLO);
+  solaceLinkUp = true;
+  Serial.printf("[SOLACE] ✅ Connected to %s\n", SOLACE_MAC_ADDRESS);
+  return true;
+}
+
+void solaceDisconnect() {
+  if (solaceLinkUp && solaceClient != nullptr) {
+    Serial.println("[SOLACE] Disconnecting...");
+    solaceStop();
+    solaceFlush(500);
+    solaceClient->disconnect();
+  }
+  solaceLinkUp = false;
+  solaceTx = nullptr;
+  solaceRx = nullptr;
+}
+
+bool solaceIsConnected() {
+  return solaceLinkUp && solaceClient != nullptr && solaceTx != nullptr;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// COMMAND PIPELINE - laatste wint, alleen sturen bij ander niveau
+// ═══════════════════════════════════════════════════════════════════════════
+
+static uint8_t solaceLevelFor(uint8_t speed) {
+  if (speed == 0) return 0;
+  uint8_t level = (uint8_t)(((uint16_t)speed * SOLACE_SPEED_MAX + 49) / 99);
+  return level < 1 ? 1 : level;
+}
+
+bool solaceMoveAsync(uint8_t position, uint8_t speed, StrokerDoneFn done) {
+  if (!solaceIsConnected()) return false;
+  if (position > 99) position = 99;
+  if (speed > 99) speed = 99;
+
+  SolaceCmd cmd = {position, speed, (uint32_t)micros(), done};
+  SolaceCmd replaced;
+  bool hasReplaced = false;
+  bool unchanged = false;
+
+  portENTER_CRITICAL(&solaceMux);
+  if (!solaceSlotFull && solaceLevelFor(speed) == solaceLastLevel) {
+    unchanged = true;
+  } else {
+    if (solaceSlotFull) {
+      replaced = solaceSlot;
+      hasReplaced = true;
+    }
+    solaceSlot = cmd;
+    solaceSlotFull = true;
+  }
+  portEXIT_CRITICAL(&solaceMux);
+
+  if (hasReplaced && replaced.done) replaced.done(replaced.position, replaced.speed, STROKER_CMD_SKIPPED, 0);
+  if (unchanged && done) done(position, speed, STROKER_CMD_SKIPPED, 0);
+  return true;
+}
+
+bool solaceStop() {
+  return solaceMoveAsync(50, 0, nullptr);
+}
+
+bool solaceFlush(uint32_t timeoutMs) {
+  uint32_t start = millis();
+  while (millis() - start < timeoutMs) {
+    portENTER_CRITICAL(&solaceMux);
+    bool empty = !solaceSlotFull;
+    portEXIT_CRITICAL(&solaceMux);
+    if (empty) return true;
+    delay(5);
+  }
+  return false;
+}
+
+void solaceService() {
+  if (solaceLinkUp && solaceClient != nullptr && !solaceClient->isConnected()) {
+    Serial.println("[SOLACE] Connection lost!");
+    solaceLinkUp = false;
+  }
+
+  SolaceCmd cmd;
+  bool have = false;
+  bool connected = solaceIsConnected();
+  if (connected && solaceLastWriteUs != 0 && micros() - solaceLastWriteUs < SOLACE_CMD_SPACING_MS * 1000UL) return;
+
+  portENTER_CRITICAL(&solaceMux);
+  if (solaceSlotFull) {
+    cmd = solaceSlot;
+    solaceSlotFull = false;
+    have = true;
+  }
+  if (!connected) solaceLastLevel = 0xFF;
+  portEXIT_CRITICAL(&solaceMux);
+  if (!have) return;
+
+  if (!connected) {
+    if (cmd.done) cmd.done(cmd.position, cmd.speed, STROKER_CMD_FAILED, 0);
+    return;
+  }
+
+  uint8_t level = solaceLevelFor(cmd.speed);
+  char buf[24];
+  snprintf(buf, sizeof(buf), SOLACE_CMD_SPEED_FMT, level);
+  solaceWrite(buf);
+  solaceLastWriteUs = micros();
+  uint32_t latencyUs = solaceLastWriteUs - cmd.queuedUs;
+
+  portENTER_CRITICAL(&solaceMux);
+  solaceLastLevel = level;
+  solaceSent++;
+  solaceLatencySumUs += latencyUs;
+  portEXIT_CRITICAL(&solaceMux);
+
+  if (cmd.done) cmd.done(cmd.position, cmd.speed, STROKER_CMD_DONE, latencyUs);
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// STROKER DEVICE
+// ═══════════════════════════════════════════════════════════════════════════
+
+static const StrokerCaps SOLACE_CAPS = {
+  false,                      // Alleen tempo (zie boven)
+  SOLACE_SPEED_MAX + 1,
+  SOLACE_CMD_SPACING_MS,
+  SOLACE_AIR_MS,
+  400.0f,                     // Niet gebruikt zonder positie
+  4000.0f
+};
+
+class SolaceDevice : public StrokerDevice {
+public:
+  const char* name() const override { return "Solace"; }
+  const StrokerCaps& caps() const override { return SOLACE_CAPS; }
+  bool connect() override { return solaceConnect(); }
+  void disconnect() override { solaceDisconnect(); }
+  bool isConnected() override { return solaceIsConnected(); }
+  bool moveAsync(uint8_t position, uint8_t speed, StrokerDoneFn done) override {
+    return solaceMoveAsync(position, speed, done);
+  }
+  bool stop() override { return solaceStop(); }
+  bool flush(uint32_t timeoutMs) override { return solaceFlush(timeoutMs); }
+  void service() override { solaceService(); }
+  uint32_t avgLatencyUs() override { return solaceSent ? solaceLatencySumUs / solaceSent : 0; }
+};
+
+static SolaceDevice solaceDevice;
+
+StrokerDevice* solaceGetDevice() {
+  return &solaceDevice;
+}
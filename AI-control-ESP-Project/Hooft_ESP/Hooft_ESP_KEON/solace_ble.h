@@ -0,0 +1,46 @@
+#ifndef SOLACE_BLE_H
+#define SOLACE_BLE_H
+
+#include <Arduino.h>
+#include "stroker_device.h"
+
+// ===============================================================================
+// LOVENSE SOLACE BLE - StrokerDevice driver
+// ===============================================================================
+// Lovense toys praten ASCII commando's met ';' over een UART-achtige service
+// (TX = write, RX = notify). Service/characteristics worden bij het
+// verbinden gezocht op het bekende Lovense UUID patroon, niet vast gezet.
+//
+// ⚠️ Het Solace Pro 2 protocol is nog NIET gesnift (LOVENSE SOLACE PRO 2/
+// LOVENSE_CHECKLIST.md). De commando's hieronder zijn die van andere Lovense
+// toys (DeviceType;, Battery;, Thrusting:N;). Na de capture alleen de
+// defines aanpassen; als de Pro 2 een positie commando blijkt te hebben,
+// caps.position aanzetten en solaceService() de positie laten sturen.
+//
+// Tot dan: alleen tempo. De motion engine stuurt (positie, snelheid) zoals
+// bij de Keon; de driver maakt daar een stoot niveau 0-20 van en stuurt
+// alleen bij een ander niveau (samenvoegen zit in de driver).
+// ===============================================================================
+
+#define SOLACE_MAC_ADDRESS        "00:00:00:00:00:00"                   // Invullen na scan
+#define SOLACE_SERVICE_SUFFIX     "-4bd4-bbd5-a6920e4c5653"             // Lovense service patroon
+#define SOLACE_SERVICE_LEGACY     "0000fff0-0000-1000-8000-00805f9b34fb" // Oudere Lovense toys
+#define SOLACE_CMD_SPEED_FMT      "Thrusting:%u;"
+#define SOLACE_CMD_HELLO          "DeviceType;"
+#define SOLACE_SPEED_MAX          20     // Thrusting 0-20
+#define SOLACE_CMD_SPACING_MS     100    // Lovense toys slikken ~10 commando's/sec
+#define SOLACE_AIR_MS             50     // Schatting: nog niet gemeten
+
+// StrokerDevice driver voor de Solace
+StrokerDevice* solaceGetDevice();
+
+bool solaceConnect();
+void solaceDisconnect();
+bool solaceIsConnected();
+
+bool solaceMoveAsync(uint8_t position, uint8_t speed, StrokerDoneFn done);
+bool solaceStop();
+bool solaceFlush(uint32_t timeoutMs);
+void solaceService();   // Vanuit Keon task
+
+#endif
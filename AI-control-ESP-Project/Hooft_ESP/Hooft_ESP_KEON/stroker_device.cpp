@@ -0,0 +1,14 @@
+#include "stroker_device.h"
+
+// Gelezen door Keon task (Core 0) en UI (Core 1): pointer schrijven is atomair
+static StrokerDevice* volatile activeDevice = nullptr;
+
+StrokerDevice* strokerActive() {
+  return activeDevice;
+}
+
+void strokerSelect(StrokerDevice* dev) {
+  if (dev == activeDevice) return;
+  activeDevice = dev;
+  Serial.printf("[STROKER] Actief device: %s\n", dev ? dev->name() : "geen");
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <Arduino.h>
+
+// ===============================================================================
+// STROKER DEVICE - Eén interface voor Keon, Solace en de mock
+// ===============================================================================
+// De motion engine (keon_motion.cpp), de level tick en de UI praten met het
+// ACTIEVE device via deze interface; welk protocol erachter zit weet alleen
+// de driver:
+//
+//   keon_ble.cpp     Kiiroo Keon   [0x04][0x00][pos][0x00][speed], positie
+//   solace_ble.cpp   Lovense Solace ASCII "Thrusting:N;", alleen tempo
+//   stroker_mock.h   Geen hardware: kinematica model, voor testen
+//
+// moveAsync() blokkeert nooit: de driver zet klaar en schrijft in service()
+// (Keon task, Core 0). Rate limit, samenvoegen van commando's en het meten
+// van de latency zitten in de driver, want die verschillen per device. De
+// caps vertellen de engine wat het device kan, zodat die per device
+// optimaal plant (kinematica, vooruit sturen, minimale segment tijd).
+// ===============================================================================
+
+enum StrokerCmdResult : uint8_t {
+  STROKER_CMD_DONE = 0,      // Naar het device geschreven
+  STROKER_CMD_SKIPPED,       // Vervangen door nieuwer commando / al zo ingesteld
+  STROKER_CMD_FAILED         // Write mislukt of verbinding weg
+};
+// Draait in de Keon task (Core 0): kort houden, geen BLE calls
+typedef void (*StrokerDoneFn)(uint8_t position, uint8_t speed, StrokerCmdResult result, uint32_t latencyUs);
+
+struct StrokerCaps {
+  bool     position;        // Kan naar een positie 0-99 (anders alleen tempo)
+  uint8_t  speedSteps;      // Verschillende snelheden (Keon 100, Solace 21)
+  uint16_t minSpacingMs;    // Snelste commando tempo van de driver
+  uint16_t airMs;           // Write klaar → device beweegt (schatting)
+  float    maxUnitsPerSec;  // Kinematica: posities/sec bij snelheid 99
+  float    accelUps2;       // Kinematica: versnelling (posities/sec²)
+};
+
+class StrokerDevice {
+public:
+  virtual ~StrokerDevice() {}
+
+  virtual const char* name() const = 0;
+  virtual const StrokerCaps& caps() const = 0;
+
+  // Verbinding (connect mag blokkeren: UI / setup)
+  virtual bool connect() = 0;
+  virtual void disconnect() = 0;
+  virtual bool isConnected() = 0;
+
+  // Beweging - niet blokkerend. done (optioneel) komt uit service()
+  virtual bool moveAsync(uint8_t position, uint8_t speed, StrokerDoneFn done) = 0;
+  virtual bool stop() = 0;
+  virtual bool flush(uint32_t timeoutMs) = 0;   // Niet vanuit de Keon task
+
+  // Vanuit de Keon task: schrijven, rate limit, verbinding bewaken
+  virtual void service() = 0;
+
+  // Gemiddelde moveAsync → write klaar (µs), 0 = nog niet gemeten
+  virtual uint32_t avgLatencyUs() = 0;
+};
+
+// Actief device (nullptr = geen). Wisselen stopt het oude device niet
+StrokerDevice* strokerActive();
+void strokerSelect(StrokerDevice* dev);
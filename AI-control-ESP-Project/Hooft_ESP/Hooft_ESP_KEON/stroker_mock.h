@@ -0,0 +1,146 @@
+#pragma once
+#include <Arduino.h>
+#include "stroker_device.h"
+#include "keon_kinematics.h"
+
+// ===============================================================================
+// STROKER MOCK - StrokerDevice zonder hardware
+// ===============================================================================
+// Gedraagt zich als een Keon: zelfde caps, commando's laatste-wint met de
+// minimale tussenruimte, write duurt STROKER_MOCK_WRITE_MS en komt airMs
+// later aan bij een kinematica model (keon_kinematics.h). simPos() is waar
+// het "device" staat: naast keonMotion_predictPos() gelegd geeft dat de fout
+// van de tijdlijn, zonder Keon en zonder BLE.
+//
+// STROKER_MOCK_ENABLED 1 → keonStartTask() kiest de mock als actief device.
+// Header-only en zonder BLE, dus ook op de PC te gebruiken (host/
+// test_stroker_mock.cpp, host/keon_motion_sim.cpp). Geen locking:
+// alleen voor testen, niet tegelijk vanuit UI en Keon task bedienen.
+// ===============================================================================
+
+#ifndef STROKER_MOCK_ENABLED
+#define STROKER_MOCK_ENABLED   0
+#endif
+#define STROKER_MOCK_WRITE_MS  8
+#define STROKER_MOCK_AIR_MS    35      // "Echte" vertraging (caps zegt 30: model zit er net naast)
+#define STROKER_MOCK_INFLIGHT  4
+
+class StrokerMockDevice : public StrokerDevice {
+public:
+  StrokerMockDevice() {
+    KeonKinModel model = {caps_.maxUnitsPerSec, caps_.accelUps2};
+    keonKin_reset(sim_, model, 0.0f);
+  }
+
+  const char* name() const override { return "Mock"; }
+  const StrokerCaps& caps() const override { return caps_; }
+
+  bool connect() override { connected_ = true; return true; }
+  void disconnect() override { connected_ = false; }
+  bool isConnected() override { return connected_; }
+
+  bool moveAsync(uint8_t position, uint8_t speed, StrokerDoneFn done) override {
+    if (!connected_) return false;
+    if (position > 99) position = 99;
+    if (speed > 99) speed = 99;
+    Cmd replaced = slot_;
+    bool hadSlot = slotFull_;
+    bool unchanged = !slotFull_ && position == lastPos_ && speed == lastSpeed_;
+    if (!unchanged) {
+      slot_ = {position, speed, (uint32_t)micros(), done};
+      slotFull_ = true;
+    }
+    if (hadSlot && replaced.done) replaced.done(replaced.pos, replaced.speed, STROKER_CMD_SKIPPED, 0);
+    if (unchanged && done) done(position, speed, STROKER_CMD_SKIPPED, 0);
+    return true;
+  }
+
+  bool stop() override { return moveAsync(lastPos_ > 99 ? 50 : lastPos_, 0, nullptr); }
+
+  bool flush(uint32_t timeoutMs) override {
+    uint32_t start = millis();
+    while (slotFull_ && millis() - start < timeoutMs) delay(5);
+    return !slotFull_;
+  }
+
+  void service() override {
+    advance(millis());
+    if (!connected_ || !slotFull_) return;
+    uint32_t nowUs = micros();
+    if (lastWriteUs_ != 0 && nowUs - lastWriteUs_ < caps_.minSpacingMs * 1000UL) return;
+
+    Cmd cmd = slot_;
+    slotFull_ = false;
+    lastWriteUs_ = nowUs;
+    lastPos_ = cmd.pos;
+    lastSpeed_ = cmd.speed;
+    uint32_t latencyUs = nowUs + STROKER_MOCK_WRITE_MS * 1000UL - cmd.queuedUs;
+    latencySumUs_ += latencyUs;
+    sent_++;
+
+    // In de lucht tot write + air
+    if (inflightCount_ >= STROKER_MOCK_INFLIGHT) applyOldest();
+    Inflight& f = inflight_[(inflightHead_ + inflightCount_) % STROKER_MOCK_INFLIGHT];
+    f.applyMs = millis() + STROKER_MOCK_WRITE_MS + STROKER_MOCK_AIR_MS;
+    f.pos = cmd.pos;
+    f.speed = cmd.speed;
+    inflightCount_++;
+
+    if (cmd.done) cmd.done(cmd.pos, cmd.speed, STROKER_CMD_DONE, latencyUs);
+  }
+
+  uint32_t avgLatencyUs() override { return sent_ ? latencySumUs_ / sent_ : 0; }
+
+  // Waar het gesimuleerde device nu staat
+  float simPos(uint32_t nowMs) {
+    advance(nowMs);
+    return sim_.pos;
+  }
+
+private:
+  struct Cmd { uint8_t pos; uint8_t speed; uint32_t queuedUs; StrokerDoneFn done; };
+  struct Inflight { uint32_t applyMs; uint8_t pos; uint8_t speed; };
+
+  void applyOldest() {
+    Inflight& f = inflight_[inflightHead_];
+    keonKin_command(sim_, f.pos, f.speed);
+    inflightHead_ = (inflightHead_ + 1) % STROKER_MOCK_INFLIGHT;
+    inflightCount_--;
+  }
+
+  void advance(uint32_t nowMs) {
+    if (simMs_ == 0) simMs_ = nowMs;
+    while (inflightCount_ > 0 && (int32_t)(nowMs - inflight_[inflightHead_].applyMs) >= 0) {
+      uint32_t at = inflight_[inflightHead_].applyMs;
+      if ((int32_t)(at - simMs_) > 0) {
+        keonKin_step(sim_, (float)(at - simMs_));
+        simMs_ = at;
+      }
+      applyOldest();
+    }
+    if ((int32_t)(nowMs - simMs_) > 0) {
+      keonKin_step(sim_, (float)(nowMs - simMs_));
+      simMs_ = nowMs;
+    }
+  }
+
+  const StrokerCaps caps_ = {true, 100, 40, 30, 400.0f, 4000.0f};
+  bool connected_ = true;
+  Cmd slot_ = {0, 0, 0, nullptr};
+  bool slotFull_ = false;
+  uint8_t lastPos_ = 0xFF;
+  uint8_t lastSpeed_ = 0xFF;
+  uint32_t lastWriteUs_ = 0;
+  uint32_t sent_ = 0;
+  uint32_t latencySumUs_ = 0;
+  KeonKinState sim_;
+  uint32_t simMs_ = 0;
+  Inflight inflight_[STROKER_MOCK_INFLIGHT];
+  uint8_t inflightHead_ = 0;
+  uint8_t inflightCount_ = 0;
+};
+
+static inline StrokerDevice* strokerMockDevice() {
+  static StrokerMockDevice mock;
+  return &mock;
+}
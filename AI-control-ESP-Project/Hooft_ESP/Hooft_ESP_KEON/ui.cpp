@@ -9,9 +9,15 @@
 #include "ui.h"
 #include "espnow_comm.h"
 #include "vacuum.h"
+#include "latency_trace.h"
+#include "espnow_link.h"
+#include "espnow_rx_queue.h"
 #include "display.h"
 #include "settings.h"
 #include "keon_ble.h"  // NEW: Keon BLE support
+#include "keon_motion.h"
+#include "solace_ble.h"
+#include "frame_pacer.h"
 
 // Forward declarations
 static void drawRightMenu();  // ← VOEG DEZE TOE!
@@ -155,7 +161,7 @@ void printfClipped(const char* format, ...) {
 
 // ================== Menu / UI ==================
 enum UIMode { MODE_ANIM=0, MODE_MENU=1 };
-enum MenuPage { PAGE_MAIN=0, PAGE_SETTINGS=1, PAGE_COLORS=2, PAGE_VACUUM=3, PAGE_MOTION=4, PAGE_ESPNOW=5, PAGE_AUTO_VACUUM=6, PAGE_SMERING=7 };
+enum MenuPage { PAGE_MAIN=0, PAGE_SETTINGS=1, PAGE_COLORS=2, PAGE_VACUUM=3, PAGE_MOTION=4, PAGE_ESPNOW=5, PAGE_AUTO_VACUUM=6, PAGE_SMERING=7, PAGE_LATENCY=8, PAGE_LINK=9 };
 static UIMode   uiMode = MODE_MENU;
 static MenuPage currentPage = PAGE_MAIN;
 
@@ -165,6 +171,7 @@ bool  paused   = true;
 
 static bool  parkToBottom = false;
 static float capY_draw    = 0.0f;
+static bool  keonSyncEnabled = false;   // Uit = stroker geparkeerd (pauze via C-knop, start)
 
 bool solaceConnected = false;
 bool motionConnected = false;
@@ -193,6 +200,28 @@ static uint32_t cooldownStartStrokes = 0;
 static uint32_t cooldownSeconds = 0;  // Wordt gevuld vanuit CFG of Body ESP
 static uint32_t cooldownStrokes = 0;
 
+// Sleeve stand 0..1 (1 = uit) voor dit frame. Stuurt de motion engine de
+// Keon, dan komt de stand uit de Keon tijdlijn (geschreven commando's +
+// gemeten latency) in plaats van uit 'phase': scherm en sleeve % naar de
+// Body ESP lopen dan gelijk met de echte Keon i.p.v. met een eigen klok.
+// Level mode loopt ook via de engine (KEON_MOTION_LEVEL_WAYPOINTS).
+// Fout t.o.v. het device: host/keon_motion_sim.cpp (zelfde aanroep, mock).
+static bool keonTimelineStroke01(float& s) {
+  float pos;
+  StrokerDevice* dev = strokerActive();
+  if (paused || parkToBottom || !dev || !dev->isConnected() || keonMotion_source() == KEON_MOTION_IDLE) return false;
+  if (!keonMotion_predictPos(millis() + KEON_MOTION_DISPLAY_MS, pos)) return false;
+  s = pos / 99.0f;
+  return true;
+}
+
+static float animStroke01() {
+  float s;
+  if (keonTimelineStroke01(s)) return s;
+  s = 0.5f * (sinf(phase) + 1.0f);
+  return schlick_gain(CFG.easeGain, s);
+}
+
 float getSleevePercentage() {
   const int BL = L_CANVAS_H - 4;
   const int MIN_ROD_VIS_IN = max(2, (int)round(12*1.25f) - 4);
@@ -204,8 +233,7 @@ float getSleevePercentage() {
   int CAP_Y_IN  = (int)round(CAP_Y_MID + (CAP_Y_IN_BASE  - CAP_Y_MID) * RANGE_SCALE);
   int CAP_Y_OUT = (int)round(CAP_Y_MID + (CAP_Y_OUT_BASE - CAP_Y_MID) * RANGE_SCALE);
   
-  float s = 0.5f * (sinf(phase) + 1.0f);
-  float ease = schlick_gain(CFG.easeGain, s);
+  float ease = animStroke01();
   int capY_phase = (int)round((float)CAP_Y_IN + ease*(float)(CAP_Y_OUT - CAP_Y_IN));
   int capY = parkToBottom ? (int)round(capY_draw) : (!paused ? capY_phase : (int)round(capY_draw));
   
@@ -234,6 +262,7 @@ static void startKeonConnection() {
   if (keonConnect()) {
     keonConnected = true;
     connectionInProgress = false;
+    strokerSelect(keonGetDevice());
     
     // Auto-close popup on success
     connectionPopupOpen = false;
@@ -257,6 +286,7 @@ static bool checkKeonConnectionProgress() {
     
     if (keonIsConnected()) {
       keonConnected = true;
+      strokerSelect(keonGetDevice());
       
       // Auto-close popup
       connectionPopupOpen = false;
@@ -307,11 +337,17 @@ static void disconnectKeon() {
   }
 }
 
-// ========== SOLACE CONNECTION (KEPT) ==========
+// ========== SOLACE CONNECTION (solace_ble.cpp) ==========
 static void startSolaceConnection() {
   Serial.println("[CONNECTION] Starting Solace connection attempt...");
   connectionInProgress = true;
   connectionStartTime = millis();
+  
+  if (solaceConnect()) {
+    solaceConnected = true;
+    strokerSelect(solaceGetDevice());
+    Serial.println("[SOLACE] Connected successfully!");
+  }
 }
 
 static bool checkSolaceConnectionProgress() {
@@ -324,9 +360,10 @@ static bool checkSolaceConnectionProgress() {
   } else if (elapsed < 1400) {
     connectionInProgress = false;
     
-    bool success = (random(100) < 75);
+    bool success = solaceIsConnected();
     
     if (success) {
+      strokerSelect(solaceGetDevice());
       Serial.println("[CONNECTION] Solace handshake successful");
       Serial.println("[CONNECTION] Solace connected successfully");
       return true;
@@ -344,8 +381,9 @@ static void disconnectSolace() {
   if (solaceConnected) {
     Serial.println("[CONNECTION] Disconnecting from Solace...");
     Serial.println("[CONNECTION] Sending disconnect signal to Solace");
-    delay(200);
+    solaceDisconnect();
     solaceConnected = false;
+    strokerSelect(keonGetDevice());
     Serial.println("[CONNECTION] Solace disconnected");
   }
 }
@@ -585,6 +623,8 @@ static void setMenuTitleAndItems(){
   else if (currentPage == PAGE_ESPNOW)    gfx->print("ESP STATUS");
   else if (currentPage == PAGE_AUTO_VACUUM) gfx->print("AUTO VACUUM");
   else if (currentPage == PAGE_SMERING)   gfx->print("SMERING");
+  else if (currentPage == PAGE_LATENCY)   gfx->print("LATENCY");
+  else if (currentPage == PAGE_LINK)      gfx->print("LINK");
   else                                    gfx->print("MENU");
 
   setMenuFontItem();
@@ -966,12 +1006,13 @@ static void drawESPNowPage(){
   int y = R_WIN_Y + 60;
   const int LH = 20;
   
-  for (int i=0; i<1; i++){
+  const char* items[] = { "< Terug", "Latency >", "Link >" };
+  for (int i=0; i<3; i++){
     bool sel = (uiMode==MODE_MENU && i==menuIdx);
     uint16_t col = sel ? 0x07E0 : CFG.COL_MENU_PINK;
     gfx->setTextColor(col, CFG.COL_BG);
     gfx->setCursor(R_WIN_X+20, y);
-    gfx->print("< Terug");
+    gfx->print(items[i]);
     y += LH;
   }
   
@@ -1043,6 +1084,149 @@ static void drawESPNowPage(){
   printClippedText("Y:sel Z:back C:menu");
 }
 
+static void drawLatencyPage(){
+  gfx->fillRect(R_WIN_X, R_WIN_Y, R_WIN_W, R_WIN_H, CFG.COL_BG);
+  gfx->drawRoundRect(R_WIN_X+0, R_WIN_Y+0, R_WIN_W, R_WIN_H, 12, CFG.COL_FRAME2);
+  gfx->drawRoundRect(R_WIN_X+2, R_WIN_Y+2, R_WIN_W-4, R_WIN_H-4, 10, CFG.COL_FRAME);
+
+  setMenuTitleAndItems();
+  setMenuFontItem();
+  
+  int y = R_WIN_Y + 60;
+  const int LH = 20;
+  
+  bool sel = (uiMode==MODE_MENU && menuIdx==0);
+  gfx->setTextColor(sel ? 0x07E0 : CFG.COL_MENU_PINK, CFG.COL_BG);
+  gfx->setCursor(R_WIN_X+20, y);
+  gfx->print("< Terug");
+  y += LH;
+  
+  // Tabel in kleine font: stap, p50, p95, max (ms)
+  gfx->setFont(nullptr); gfx->setTextSize(1);
+  const int SLH = 13;
+  y -= 4;
+  gfx->setTextColor(0x8410, CFG.COL_BG);
+  gfx->setCursor(R_WIN_X+12, y);
+  gfx->print("Stap        p50    p95    max");
+  y += SLH;
+  
+  for (uint8_t s=0; s<LAT_STAGE_COUNT; s++){
+    LatencyStats st = latencyTrace_getStats((LatencyStage)s);
+    uint16_t col = (s == LAT_TOTAL) ? 0xFFE0 : 0xFFFF;
+    if (st.count == 0) col = 0x8410;
+    gfx->setTextColor(col, CFG.COL_BG);
+    gfx->setCursor(R_WIN_X+12, y);
+    if (st.count == 0) {
+      gfx->printf("%-9s     -      -      -", latencyTrace_stageName((LatencyStage)s));
+    } else {
+      gfx->printf("%-9s %6.1f %6.1f %6.1f", latencyTrace_stageName((LatencyStage)s),
+                  st.p50Us / 1000.0f, st.p95Us / 1000.0f, st.maxUs / 1000.0f);
+    }
+    y += SLH;
+  }
+  
+  LatencyStats total = latencyTrace_getStats(LAT_TOTAL);
+  gfx->setTextColor(0x8410, CFG.COL_BG);
+  gfx->setCursor(R_WIN_X+12, y + 4);
+  gfx->printf("ms - %lu volledige traces", (unsigned long)total.count);
+  
+  gfx->setCursor(R_WIN_X+20, R_WIN_Y + R_WIN_H - 10);
+  printClippedText("Y:sel Z:back C:menu");
+}
+
+// Kleur bij link kwaliteit (espnowLink_quality)
+static uint16_t linkQualityColor(uint8_t q){
+  if (q >= 70) return 0x07E0;
+  if (q >= 40) return 0xFFE0;
+  return 0xF800;
+}
+
+// Alleen RSSI + laatste contact (Pomp / M5 praten geen binair protocol)
+static void drawLinkRssiLine(int y, const char* name, const EspNowLinkStats& link){
+  gfx->setCursor(R_WIN_X+12, y);
+  if (link.lastRxMs == 0) {
+    gfx->setTextColor(0x8410, CFG.COL_BG);
+    gfx->printf("%-5s geen ontvangst", name);
+    return;
+  }
+  float age = (millis() - link.lastRxMs) / 1000.0f;
+  gfx->setTextColor(age > ESPNOW_LINK_STALE_MS / 1000.0f ? 0xF800 : 0xFFFF, CFG.COL_BG);
+  gfx->printf("%-5s RSSI %4.0f min %4d %4.1fs", name, link.rssiAvg, link.rssiMin, age);
+}
+
+static void drawLinkPage(){
+  gfx->fillRect(R_WIN_X, R_WIN_Y, R_WIN_W, R_WIN_H, CFG.COL_BG);
+  gfx->drawRoundRect(R_WIN_X+0, R_WIN_Y+0, R_WIN_W, R_WIN_H, 12, CFG.COL_FRAME2);
+  gfx->drawRoundRect(R_WIN_X+2, R_WIN_Y+2, R_WIN_W-4, R_WIN_H-4, 10, CFG.COL_FRAME);
+
+  setMenuTitleAndItems();
+  setMenuFontItem();
+  
+  int y = R_WIN_Y + 60;
+  const int LH = 20;
+  
+  bool sel = (uiMode==MODE_MENU && menuIdx==0);
+  gfx->setTextColor(sel ? 0x07E0 : CFG.COL_MENU_PINK, CFG.COL_BG);
+  gfx->setCursor(R_WIN_X+20, y);
+  gfx->print("< Terug");
+  y += LH;
+  
+  gfx->setFont(nullptr); gfx->setTextSize(1);
+  const int SLH = 13;
+  y -= 4;
+  
+  // Body ESP: volledige meting (PING/PONG + seq gaten)
+  const EspNowLinkStats& body = getBodyLinkStats();
+  uint8_t q = espnowLink_quality(body, millis());
+  gfx->setTextColor(linkQualityColor(q), CFG.COL_BG);
+  gfx->setCursor(R_WIN_X+12, y);
+  gfx->printf("Body  Q:%3d %-6s kan %d", q, espnowLink_qualityName(q), WiFi.channel());
+  y += SLH;
+  
+  gfx->setTextColor(0xFFFF, CFG.COL_BG);
+  gfx->setCursor(R_WIN_X+12, y);
+  if (body.pongs > 0) {
+    gfx->printf(" RTT %.1f jit %.1f max %.0f ms", body.rttAvgMs, body.rttJitterMs, body.rttMaxMs);
+  } else {
+    gfx->print(" RTT -");
+  }
+  y += SLH;
+  
+  gfx->setCursor(R_WIN_X+12, y);
+  gfx->printf(" wij: verl %2d%% RSSI %4.0f", espnowLink_lossPct(body), body.rssiAvg);
+  y += SLH;
+  
+  gfx->setCursor(R_WIN_X+12, y);
+  gfx->printf(" Body: verl %2d%% RSSI %4d", body.peerLossPct, body.peerRssi);
+  y += SLH;
+  
+  gfx->setTextColor(0x8410, CFG.COL_BG);
+  gfx->setCursor(R_WIN_X+12, y);
+  gfx->printf(" ping %lu/%lu weg %lu", (unsigned long)body.pongs, (unsigned long)body.pingsSent,
+              (unsigned long)body.pingsLost);
+  // Body → wij in één richting (Body ESP stempelt met onze klok zodra gesynchroniseerd)
+  if (body.oneWayCount > 0) gfx->printf(" 1w %.1fms", body.oneWayAvgMs);
+  y += SLH + 4;
+  
+  drawLinkRssiLine(y, "Pomp", getPumpLinkStats());
+  y += SLH;
+  drawLinkRssiLine(y, "M5", getM5LinkStats());
+  y += SLH + 4;
+  
+  // Wachtrijen: ontvangst (callback → loop) en herhalingen naar Body ESP
+  const EspNowRxQueue& rxq = getESPNowRxQueue();
+  gfx->setTextColor(0x8410, CFG.COL_BG);
+  gfx->setCursor(R_WIN_X+12, y);
+  gfx->printf("RX queue max %d/%d weg %lu", rxq.highWater, ESPNOW_RXQ_DEPTH,
+              (unsigned long)espnowRx_dropped(rxq));
+  y += SLH;
+  gfx->setCursor(R_WIN_X+12, y);
+  gfx->printf("TX open %d opgegeven %lu", getBodyPendingFrames(), (unsigned long)getBodyDroppedFrames());
+  
+  gfx->setCursor(R_WIN_X+20, R_WIN_Y + R_WIN_H - 10);
+  printClippedText("Y:sel Z:back C:menu");
+}
+
 static void drawVacuumPage(){
   gfx->fillRect(R_WIN_X, R_WIN_Y, R_WIN_W, R_WIN_H, CFG.COL_BG);
   gfx->drawRoundRect(R_WIN_X+0, R_WIN_Y+0, R_WIN_W, R_WIN_H, 12, CFG.COL_FRAME2);
@@ -1270,6 +1454,8 @@ static void drawRightMenu(){
   if (currentPage == PAGE_VACUUM){ drawVacuumPage(); return; }
   if (currentPage == PAGE_MOTION){ drawMotionPage(); return; }
   if (currentPage == PAGE_ESPNOW){ drawESPNowPage(); return; }
+  if (currentPage == PAGE_LATENCY){ drawLatencyPage(); return; }
+  if (currentPage == PAGE_LINK){ drawLinkPage(); return; }
   if (currentPage == PAGE_AUTO_VACUUM){ drawAutoVacuumPage(); return; }
   if (currentPage == PAGE_SMERING){ drawSmeringPage(); return; }
 
@@ -1376,7 +1562,7 @@ static void handleMenuY(int jy){
   if (now - lastNav < NAV_MS) return;
 
   const int JY_LO_M=70, JY_HI_M=180;
-  int maxIdx = (currentPage==PAGE_MAIN ? 7 : (currentPage==PAGE_SETTINGS ? 4 : (currentPage==PAGE_VACUUM ? 1 : (currentPage==PAGE_MOTION ? 4 : (currentPage==PAGE_ESPNOW ? 0 : (currentPage==PAGE_AUTO_VACUUM ? 2 : (currentPage==PAGE_SMERING ? 3 : 2)))))));
+  int maxIdx = (currentPage==PAGE_MAIN ? 7 : (currentPage==PAGE_SETTINGS ? 4 : (currentPage==PAGE_VACUUM ? 1 : (currentPage==PAGE_MOTION ? 4 : (currentPage==PAGE_ESPNOW ? 2 : (currentPage==PAGE_LATENCY || currentPage==PAGE_LINK ? 0 : (currentPage==PAGE_AUTO_VACUUM ? 2 : (currentPage==PAGE_SMERING ? 3 : 2))))))));
 
   if (!menuEdit) {
     if (jy > JY_HI_M && menuIdx > 0) { menuIdx--; drawRightMenu(); lastNav=now; return; }
@@ -1511,7 +1697,19 @@ static void updateSpeedStepWithJoystick(int jy){
 }
 
 static const float TAU = 6.2831853f;
-static uint32_t lastUs = 0;
+
+// Motion blend en richting correctie zijn per frame (FRAME_TARGET_FPS)
+// afgesteld en lopen nu per animatie stap (FRAME_ANIM_STEP_US): per stap
+// omrekenen zodat de tijdconstante gelijk blijft
+static const float ANIM_FRAMES_PER_STEP = FRAME_ANIM_STEP_US * FRAME_TARGET_FPS / 1e6f;
+static float perAnimStep(float perFrame) {
+  return 1.0f - powf(1.0f - perFrame, ANIM_FRAMES_PER_STEP);
+}
+static const float MOTION_SPEED_ALPHA = perAnimStep(0.1f);
+static const float DIR_CORRECTION_SLOW = perAnimStep(0.02f);   // L0-L2: 2% per frame
+static const float DIR_CORRECTION_FAST = perAnimStep(0.01f);   // L3-L5: 1% per frame
+static const uint8_t DIR_STABLE_STEPS = (uint8_t)(3 / ANIM_FRAMES_PER_STEP + 0.5f);   // 3 frames
+
 float    phase=0.0f;
 float    velEMA=0.0f;
 static int      prevCapY = INT_MIN;
@@ -1572,21 +1770,20 @@ void uiInit() {
 
   uint16_t rodCol = lerp_rgb565_u8(CFG.rodSlowR,CFG.rodSlowG,CFG.rodSlowB,
                                    CFG.rodFastR,CFG.rodFastG,CFG.rodFastB, 0.0f);
-  cv->fillScreen(CFG.COL_BG);
+  canvasClear(CFG.COL_BG);
   drawSleeveFixedTop((int)capY_draw, CFG.COL_TAN);
   drawRodFromCap_Vinside_NoSeam((int)capY_draw, DRAW_BASELINE_Y, rodCol, 0xE946);
-  cv->flush();
+  canvasFlush();
 
   drawSpeedBarTop(g_speedStep, CFG.SPEED_STEPS);
   drawVacArrowHeader(false);
-  lastUs = micros();
+  framePacer_animSteps(micros());   // Animatie klok starten
   g_speedStep = 0; upArmed = downArmed = true;
 }
 
 void uiTick() {
   // Guard: Skip one frame after popup closes to prevent residual C-events
   static bool skipCEventThisFrame = false;
-  static bool keonSyncEnabled = false;
 
   bool cNow=false, zNow=false;
   int jy=128, jx=128;
@@ -1804,6 +2001,7 @@ if (nunchukHelpPopupOpen) {
   } else if (cev==CE_LONG){
     uiMode = (uiMode==MODE_MENU)? MODE_ANIM : MODE_MENU;
     menuEdit = false; colorEdit=false; paletteOpen=false;
+    if (uiMode == MODE_ANIM) canvasMarkAll();   // Scherm kan intussen overschreven zijn
     drawRightMenu();
     
   } else if (cev==CE_SHORT && !paletteOpen){
@@ -1836,7 +2034,7 @@ if (nunchukHelpPopupOpen) {
       // Stuur naar Body ESP
       machineStatus_message_t cooldownMsg;
       memset(&cooldownMsg, 0, sizeof(cooldownMsg));
-      strcpy(cooldownMsg.command, "ORGASM_COMPLETE");
+      cooldownMsg.opcode = ESPNOW_OP_ORGASM_COMPLETE;
       extern void sendBodyESPStatusUpdate(const machineStatus_message_t &msg);
       sendBodyESPStatusUpdate(cooldownMsg);
       
@@ -1952,6 +2150,12 @@ if (nunchukHelpPopupOpen) {
   }
 
   if (uiMode==MODE_MENU) {
+    // Latency / link pagina live verversen
+    if (currentPage == PAGE_LATENCY || currentPage == PAGE_LINK) {
+      static uint32_t lastLatencyDraw = 0;
+      if (millis() - lastLatencyDraw > 1000) { lastLatencyDraw = millis(); drawRightMenu(); }
+    }
+    
     if (zEdge) {
       if (currentPage == PAGE_COLORS){
         if (!paletteOpen) {
@@ -2005,6 +2209,12 @@ if (nunchukHelpPopupOpen) {
           else if (menuIdx == 1 || menuIdx == 2 || menuIdx == 3 || menuIdx == 4) { menuEdit = true; drawRightMenu(); }
         } else if (currentPage == PAGE_ESPNOW) {
           if (menuIdx == 0) { currentPage = PAGE_MAIN; menuIdx = 3; drawRightMenu(); }
+          else if (menuIdx == 1) { currentPage = PAGE_LATENCY; menuIdx = 0; drawRightMenu(); }
+          else if (menuIdx == 2) { currentPage = PAGE_LINK; menuIdx = 0; drawRightMenu(); }
+        } else if (currentPage == PAGE_LATENCY) {
+          if (menuIdx == 0) { currentPage = PAGE_ESPNOW; menuIdx = 1; drawRightMenu(); }
+        } else if (currentPage == PAGE_LINK) {
+          if (menuIdx == 0) { currentPage = PAGE_ESPNOW; menuIdx = 2; drawRightMenu(); }
         } else if (currentPage == PAGE_AUTO_VACUUM) {
           if (menuIdx == 0) { currentPage = PAGE_MAIN; menuIdx = 6; drawRightMenu(); }
           else if (menuIdx == 1 || menuIdx == 2) { menuEdit = true; drawRightMenu(); }
@@ -2055,14 +2265,17 @@ if (nunchukHelpPopupOpen) {
 
   // ================= ANIMATIE EERST =================
   // We need to calculate animation first to get updated phase for auto vacuum
+  // Vorig frame te duur → dit frame alleen input + animatie (frame_pacer.h)
+  const bool render = !framePacer_skipRender();
   updateSpeedStepWithJoystick(jy);
-  drawSpeedBarTop(g_speedStep, CFG.SPEED_STEPS);
+  if (render) drawSpeedBarTop(g_speedStep, CFG.SPEED_STEPS);
   //updateSpeedStepWithJoystick(jy);
   //drawSpeedBarTop(g_speedStep, CFG.SPEED_STEPS);
 
-  uint32_t nowUs = micros();
-  float dt = (nowUs - lastUs) / 1e6f;
-  lastUs = nowUs;
+  // Vaste stappen: animatie tempo (en de blend / correctie per stap, zie
+  // perAnimStep) hangt niet af van hoe lang een frame duurt
+  const uint8_t animSteps = framePacer_animSteps(micros());
+  const float dt = FRAME_ANIM_DT;
 
 //------------------------------------------------------
 
@@ -2073,7 +2286,7 @@ float step01 = (CFG.SPEED_STEPS<=1)?0.0f : (float)g_speedStep/(float)(CFG.SPEED_
 extern float keonGetStrokeFrequency(uint8_t level);
 float baseInstF = keonGetStrokeFrequency(g_speedStep);
 
-if (!paused && !parkToBottom) {
+for (uint8_t animStep = 0; animStep < animSteps && !paused && !parkToBottom; animStep++) {
   // ═══════════════════════════════════════════════════════════
   // ADAPTIVE MOTION BLEND
   // ═══════════════════════════════════════════════════════════
@@ -2092,7 +2305,7 @@ if (!paused && !parkToBottom) {
     float motionWeight = CFG.motionSpeedWeight / 100.0f;
     
     static float smoothedMotionSpeed = 0.0f;
-    smoothedMotionSpeed = 0.9f * smoothedMotionSpeed + 0.1f * currentMotionSpeed;
+    smoothedMotionSpeed += MOTION_SPEED_ALPHA * (currentMotionSpeed - smoothedMotionSpeed);
     
     float motionSpeedMultiplier = (smoothedMotionSpeed / 100.0f) * 1.5f;
     float blendedFreq = baseInstF * (nunchukWeight + (motionWeight * motionSpeedMultiplier));
@@ -2111,9 +2324,9 @@ if (!paused && !parkToBottom) {
       
       if (currentMotionDir == lastDir) {
         dirCounter++;
-        if (dirCounter >= 3) {  // 3 frames (sneller dan 5)
+        if (dirCounter >= DIR_STABLE_STEPS) {  // 3 frames (sneller dan 5)
           stableDir = currentMotionDir;
-          dirCounter = 3;
+          dirCounter = DIR_STABLE_STEPS;
         }
       } else {
         dirCounter = 0;
@@ -2128,8 +2341,8 @@ if (!paused && !parkToBottom) {
         while (phaseDiff < -3.14159f) phaseDiff += 6.28318f;
         
         // Adaptive correctie snelheid op basis van level
-        float correctionRate = 0.02f;  // L0-L2: 2%
-        if (g_speedStep >= 3) correctionRate = 0.01f;  // L3-L5: 1%
+        float correctionRate = DIR_CORRECTION_SLOW;  // L0-L2: 2%
+        if (g_speedStep >= 3) correctionRate = DIR_CORRECTION_FAST;  // L3-L5: 1%
         
         if (abs(phaseDiff) > 0.785f) {  // >45° uit sync
           phase += phaseDiff * correctionRate;
@@ -2243,8 +2456,19 @@ if (!paused && !parkToBottom) {
   }*/
   //----------------------------------------------------------------------------
   
-  float s = 0.5f * (sinf(phase) + 1.0f);
-  float ease = schlick_gain(CFG.easeGain, s);
+  // Keon tijdlijn actief: phase meenemen zodat de animatie zonder sprong
+  // verder loopt als de engine stopt
+  float timelineS, ease;
+  if (keonTimelineStroke01(timelineS)) {
+    static float lastTimelineS = 0.0f;
+    float a = asinf(constrain(2.0f * timelineS - 1.0f, -1.0f, 1.0f));
+    phase = (timelineS >= lastTimelineS) ? a : 3.14159f - a;
+    if (phase < 0.0f) phase += TAU;
+    lastTimelineS = timelineS;
+    ease = timelineS;
+  } else {
+    ease = schlick_gain(CFG.easeGain, 0.5f * (sinf(phase) + 1.0f));
+  }
   
   const int BL = L_CANVAS_H - 4;
   const int MIN_ROD_VIS_IN = max(2, (int)round(12*1.25f) - 4);
@@ -2325,16 +2549,19 @@ if (!paused && !parkToBottom) {
   // ========== KEON UPDATE (AUTONOMOUS) ==========
   // Check connection status
   keonCheckConnection();
+  if (solaceConnected && !solaceIsConnected()) {
+    solaceConnected = false;                 // Solace weg → Keon weer actief device
+    strokerSelect(keonGetDevice());
+  }
   
-  // ✅ AUTONOMOUS KEON CONTROL - handles pause/resume internally
-  extern void keonIndependentTick();
-  keonIndependentTick();
-  // NOTE: keonIndependentTick() checkt zelf 'paused' flag en handled parking
+  // Levels, pauze en hervatten: keonIndependentTick() in de Keon task
+  // (keon_ble.cpp, Core 0). Niet ook hier aanroepen: de state daarin is
+  // alleen van de Keon task
 
   //if (parkToBottom && capY_draw < (float)CAP_Y_IN && paused) {
   if (parkToBottom && capY_draw < (float)CAP_Y_IN) {  
     //capY_draw += 0.5f;
-    capY_draw += 1.0f;
+    capY_draw += 0.5f * animSteps;   // 60 px/s (was 1 px per frame)
     if (capY_draw > (float)CAP_Y_IN) {
       capY_draw = (float)CAP_Y_IN;
       parkToBottom=false;
@@ -2354,9 +2581,9 @@ if (!paused && !parkToBottom) {
   uint16_t rodCol = lerp_rgb565_u8(CFG.rodSlowR,CFG.rodSlowG,CFG.rodSlowB,
                                    CFG.rodFastR,CFG.rodFastG,CFG.rodFastB, step01);
   
-  if (uiMode == MODE_ANIM) {
+  if (uiMode == MODE_ANIM && render) {
     uint16_t bgColor = getOrgasmBackgroundColor();  // ✅ NIEUW
-    cv->fillScreen(bgColor);                        // ✅ NIEUW
+    canvasClear(bgColor);                           // Andere kleur → hele canvas
     drawSleeveFixedTop(capYnow, CFG.COL_TAN);
     drawRodFromCap_Vinside_NoSeam(capYnow, DRAW_BASELINE_Y, rodCol, 0xE946);
     
@@ -2365,20 +2592,31 @@ if (!paused && !parkToBottom) {
     drawVibeLightning(false);  // Right side - bottom half
     drawSuctionSymbol(true);   // Left side - top half
     drawSuctionSymbol(false);  // Right side - top half
+    drawFrameOverlay();        // Alleen met FRAME_OVERLAY_ENABLED
+    framePacer_controlPoint(); // Control taken niet de hele flush laten wachten
     
-    cv->flush();
+    uint32_t flushStartUs = micros();
+    canvasFlush();             // Alleen gewijzigde tegels (display.cpp)
+    framePacer_onFlush(micros() - flushStartUs);
     drawVacArrowHeader(goingUp);
   }
-  // ========== KEON SYNC (FIXED!) ==========
+  // ========== STROKER PARKEREN ==========
+  // Eén keer bij de overgang naar sync uit / pauze / parkeren, niet elk frame:
+  // het actieve device (Keon, Solace, mock) houdt de laatste stand zelf vast.
+  // Device (opnieuw) verbonden → opnieuw beslissen
   keonCheckConnection();
   
-  if (keonConnected) {
-    if (!keonSyncEnabled || paused || parkToBottom) {
-      keonMove(0, 0);
-    } else {
-      float sleevePercent = getSleevePercentage();
-      //keonSyncToAnimation(g_speedStep, CFG.SPEED_STEPS, sleevePercent);
+  static bool strokerParked = false;
+  StrokerDevice* parkDev = strokerActive();
+  bool wantPark = !keonSyncEnabled || paused || parkToBottom;
+  if (!parkDev || !parkDev->isConnected()) {
+    strokerParked = false;
+  } else if (wantPark != strokerParked) {
+    if (wantPark) {
+      Serial.printf("[STROKER] %s parkeren\n", parkDev->name());
+      parkDev->moveAsync(0, 0, nullptr);
     }
+    strokerParked = wantPark;
   }
 
   // ═══════════════════════════════════════════════════════════
@@ -2443,7 +2681,7 @@ if (!paused && !parkToBottom) {
       // Stuur naar Body ESP
       machineStatus_message_t resumeMsg;
       memset(&resumeMsg, 0, sizeof(resumeMsg));
-      strcpy(resumeMsg.command, "COOLDOWN_COMPLETE");
+      resumeMsg.opcode = ESPNOW_OP_COOLDOWN_COMPLETE;
       extern void sendBodyESPStatusUpdate(const machineStatus_message_t &msg);
       sendBodyESPStatusUpdate(resumeMsg);
       
@@ -2473,14 +2711,13 @@ if (!paused && !parkToBottom) {
 void resetPauseState() {
   extern bool paused;
   extern bool sessionActive;
-  //extern bool keonSyncEnabled;  // ← Ook extern!
   
   paused = false;
   sessionActive = true;
   parkToBottom = false;
   phase = -1.5707963f;
   velEMA = 0.0f;
-  //keonSyncEnabled = true;
+  keonSyncEnabled = true;
   
   Serial.println("[UI] Pause state reset via Body ESP resume");
 }
@@ -17,6 +17,7 @@
 #include <esp_now.h>
 #include <esp_wifi.h>
 #include <math.h>
+#include "espnow_protocol.h"
 
 // =============================================================================
 // ⚡ GEVOELIGHEID INSTELLING - Verander dit getal van 1 tot 100
@@ -44,10 +45,8 @@ static const uint8_t WIFI_CHANNEL = 4;                   // vast kanaal 4 (belan
 
 // ---- Protocol ----
 #define MSG_VER 1
-enum MsgKind : uint8_t { MK_ATOM_MOTION = 1, MK_PUMP_COLORS = 2 };
-
-struct AtomMotion { uint8_t ver,kind; int8_t dir; uint8_t speed; uint8_t flags; };
-struct PumpColors { uint8_t ver,kind; uint8_t a_r,a_g,a_b, b_r,b_g,b_b, flags; };
+// AtomMotion / PumpColors: espnow_protocol.h
+enum MsgKind : uint8_t { MK_ATOM_MOTION = ESPNOW_MK_ATOM_MOTION, MK_PUMP_COLORS = ESPNOW_MK_PUMP_COLORS };
 
 // ---- LED pins ----
 #define VACUUM_LED_PIN 10   // Interne rode LED op M5StickC Plus - DEBUG gebruik
@@ -0,0 +1,588 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <stddef.h>
+
+// ===============================================================================
+// ESP-NOW PROTOCOL - Gedeeld door alle firmwares
+// ===============================================================================
+// IDENTIEKE KOPIE in:
+//   Body_ESP_FINAL/Body_ESP/espnow_protocol.h
+//   Hooft_ESP/Hooft_ESP_KEON/espnow_protocol.h
+//   Pomp_unit_V1.0/espnow_protocol.h
+//   M5StickC_Plus/espnow_protocol.h
+// Arduino IDE kan niet buiten de sketch map includen: altijd alle vier
+// tegelijk aanpassen (bij wijziging wire formaat ook ESPNOW_PROTO_VERSION).
+//
+// Body ESP <-> HoofdESP: binair frame i.p.v. char command[32] + strcmp keten
+//
+//   [EspNowHeader 10B][payload per opcode][EspNowTracePayload 20B, optioneel]
+//
+//   - magic + version: oude (string) berichten en andere versies worden
+//     herkend en genegeerd i.p.v. verkeerd geïnterpreteerd
+//   - opcode: 1 byte → switch/jump table bij ontvangst
+//   - seq: per zender oplopend (verlies / dubbel detectie)
+//   - timeMs: millis() van de zender
+//   - Snelheden als fixed point (x1000 / x100 / x10): AI bericht 16 bytes
+//     (was 64), status 26 bytes (was 69)
+//   - Kritieke opcodes (espnow_needsAck) krijgen ESPNOW_FLAG_ACK_REQ: de
+//     ontvanger stuurt ESPNOW_OP_ACK terug, de zender herhaalt tot dan
+//     (espnow_reliable.h). Periodiek verkeer blijft fire-and-forget.
+//   - STATUS_DELTA: veldmasker + alleen gewijzigde velden (4-18 bytes
+//     payload i.p.v. 16), zender beslist wanneer (espnow_publisher.h)
+//   - PING/PONG: RTT meting + elkaars ontvangst kwaliteit (espnow_link.h)
+//     en 4 tijdstempels voor de sessie klok (espnow_timesync.h)
+//   - ESPNOW_FLAG_SYNCED: timeMs is sessie klok (HoofdESP millis) i.p.v.
+//     de eigen millis() → ontvanger kan one-way latency / leeftijd meten
+//   - Veiligheid opcodes (espnow_isPriority: stop, nood pauze, vacuum los,
+//     ORGASM_TRIGGER) krijgen ESPNOW_FLAG_PRIORITY: eigen ontvangst queue
+//     en herhaal lane, gaan voor al het andere verkeer
+//
+// Pomp Unit en M5StickC gebruikten al binaire structs met versie byte: die
+// staan hier ongewijzigd (zelfde wire formaat) zodat iedereen dezelfde
+// definitie + size check gebruikt.
+// ===============================================================================
+
+#define ESPNOW_PROTO_MAGIC      0xB7
+#define ESPNOW_PROTO_VERSION    6       // 2: ACK, 3: STATUS_DELTA, 4: PING/PONG, 5: tijd sync, 6: eigen seq reeks niet kritiek
+
+// Header flags
+#define ESPNOW_FLAG_TRACE       0x01    // EspNowTracePayload volgt na payload
+#define ESPNOW_FLAG_ACK_REQ     0x02    // Ontvanger moet ESPNOW_OP_ACK terugsturen
+#define ESPNOW_FLAG_SYNCED      0x04    // hdr.timeMs = sessie klok (espnow_timesync.h)
+#define ESPNOW_FLAG_PRIORITY    0x08    // Veiligheid: voorrang bij zenden en ontvangen
+
+enum EspNowOpcode : uint8_t {
+  ESPNOW_OP_NONE                = 0x00,
+
+  // ===== Body ESP → HoofdESP (payload: EspNowAiPayload) =====
+  ESPNOW_OP_AI_OVERRIDE         = 0x10,   // Trust/sleeve factoren
+  ESPNOW_OP_AI_WARMUP           = 0x11,   // Forceert speed step (stressLevel)
+  ESPNOW_OP_AI_TEST_START       = 0x12,
+  ESPNOW_OP_AI_RESUME_SLOW      = 0x13,
+  ESPNOW_OP_AI_STRESS_START     = 0x14,
+  ESPNOW_OP_AI_STRESS_ADJUST    = 0x15,
+  ESPNOW_OP_AI_STRESS_RESUME    = 0x16,
+  ESPNOW_OP_AI_VIBE_ON          = 0x17,
+  ESPNOW_OP_AI_VIBE_OFF         = 0x18,
+  ESPNOW_OP_AI_VACUUM_ON        = 0x19,
+  ESPNOW_OP_AI_VACUUM_OFF       = 0x1A,
+  ESPNOW_OP_AI_EMERGENCY_OVERRIDE = 0x1B,
+  ESPNOW_OP_PLAYBACK_STRESS     = 0x20,
+  ESPNOW_OP_PLAYBACK_STOP       = 0x21,
+  ESPNOW_OP_FUNSCRIPT_ACTION    = 0x22,
+  ESPNOW_OP_HEARTBEAT           = 0x30,
+  ESPNOW_OP_EMERGENCY_STOP      = 0x31,
+  ESPNOW_OP_RESUME_SESSION      = 0x32,
+
+  // ===== HoofdESP → Body ESP (payload: EspNowStatusPayload) =====
+  ESPNOW_OP_STATUS_UPDATE       = 0x40,
+  ESPNOW_OP_ORGASM_TRIGGER      = 0x41,
+  ESPNOW_OP_ORGASM_COMPLETE     = 0x42,
+  ESPNOW_OP_COOLDOWN_COMPLETE   = 0x43,
+  ESPNOW_OP_FUNSCRIPT_ON        = 0x44,
+  ESPNOW_OP_FUNSCRIPT_OFF       = 0x45,
+  ESPNOW_OP_STATUS_DELTA        = 0x46,   // Payload: veldmasker + gewijzigde velden
+
+  // ===== Beide richtingen =====
+  ESPNOW_OP_ACK                 = 0x50,   // Bevestiging van een ESPNOW_FLAG_ACK_REQ frame (EspNowAckPayload)
+  ESPNOW_OP_PING                = 0x51,   // Link meting (EspNowLinkPayload)
+  ESPNOW_OP_PONG                = 0x52    // Antwoord op PING: t1Us/pingId terug + t2Us/t3Us
+};
+
+// ===============================================================================
+// FRAME
+// ===============================================================================
+
+struct __attribute__((packed)) EspNowHeader {
+  uint8_t  magic;       // ESPNOW_PROTO_MAGIC
+  uint8_t  version;     // ESPNOW_PROTO_VERSION
+  uint8_t  opcode;      // EspNowOpcode
+  uint8_t  flags;       // ESPNOW_FLAG_*
+  uint16_t seq;         // Per zender oplopend
+  uint32_t timeMs;      // millis() van zender
+};
+
+// AI_OVERRIDE bits
+#define ESPNOW_AI_OVERRULE      0x01
+#define ESPNOW_AI_VIBE          0x02
+#define ESPNOW_AI_ZUIGEN        0x04
+
+struct __attribute__((packed)) EspNowAiPayload {
+  int16_t  trust_x1000;   // 0-2000 (0.0-2.0)
+  int16_t  sleeve_x1000;
+  uint8_t  stressLevel;   // 0-7
+  uint8_t  bits;          // ESPNOW_AI_*
+};
+
+// STATUS_UPDATE bits
+#define ESPNOW_ST_VIBE          0x01
+#define ESPNOW_ST_ZUIG          0x02
+#define ESPNOW_ST_PAUSE         0x04
+#define ESPNOW_ST_LUBE          0x08
+
+struct __attribute__((packed)) EspNowStatusPayload {
+  int16_t  trust_x1000;       // 0.0-2.0
+  int16_t  sleeve_x1000;
+  uint16_t suction_x10;       // 0.0-100.0
+  uint16_t pause_x100;        // 0.0-10.0 sec
+  int16_t  vacuumMbar_x10;
+  uint16_t cyclusTijd_x100;   // Sec, max 655
+  uint16_t sleevePct_x10;     // 0.0-100.0 %
+  uint8_t  speedStep;         // 0-7
+  uint8_t  bits;              // ESPNOW_ST_*
+};
+
+// PING / PONG: beide kanten sturen hun eigen ontvangst kwaliteit mee.
+// Tijden zijn esp_timer_get_time() (µs sinds boot, 64 bit: geen wrap).
+struct __attribute__((packed)) EspNowLinkPayload {
+  int64_t  t1Us;          // PING verstuurd, klok PING zender (PONG: ongewijzigd terug)
+  int64_t  t2Us;          // PONG: PING ontvangen, klok PONG zender (PING: 0)
+  int64_t  t3Us;          // PONG: PONG verstuurd, klok PONG zender (PING: 0)
+  uint16_t pingId;
+  int8_t   rssi;          // Gemiddelde RSSI van wat de zender van deze frame ontvangt (dBm, 0 = onbekend)
+  uint8_t  lossPct;       // Verlies volgens de zender van deze frame (0-100)
+};
+
+struct __attribute__((packed)) EspNowAckPayload {
+  uint16_t ackSeq;        // hdr.seq van het bevestigde frame
+  uint8_t  ackOpcode;     // Opcode van het bevestigde frame (log/controle)
+};
+
+// STATUS_DELTA veldmasker (bit per veld van EspNowStatusPayload, in volgorde)
+enum EspNowStatusField : uint8_t {
+  ESPNOW_SF_TRUST = 0,
+  ESPNOW_SF_SLEEVE,
+  ESPNOW_SF_SUCTION,
+  ESPNOW_SF_PAUSE,
+  ESPNOW_SF_VACUUM,
+  ESPNOW_SF_CYCLUS,
+  ESPNOW_SF_SLEEVE_PCT,
+  ESPNOW_SF_SPEED_STEP,
+  ESPNOW_SF_BITS,
+  ESPNOW_SF_COUNT
+};
+
+#define ESPNOW_SF_ALL           ((uint16_t)((1u << ESPNOW_SF_COUNT) - 1))
+
+// Latency trace (HoofdESP latency_trace.h), alleen met ESPNOW_FLAG_TRACE
+struct __attribute__((packed)) EspNowTracePayload {
+  uint32_t traceId;
+  uint32_t sensorUs;
+  uint32_t decisionUs;
+  uint32_t sendUs;
+  uint32_t airUs;
+};
+
+struct __attribute__((packed)) EspNowFrame {
+  EspNowHeader hdr;
+  union __attribute__((packed)) {
+    EspNowAiPayload ai;
+    EspNowStatusPayload status;
+    EspNowAckPayload ack;
+    EspNowLinkPayload link;
+    uint8_t delta[2 + sizeof(EspNowStatusPayload)];   // STATUS_DELTA: masker + velden
+  };
+  EspNowTracePayload trace;   // Alleen geldig met ESPNOW_FLAG_TRACE
+};
+
+static_assert(sizeof(EspNowHeader) == 10, "EspNowHeader wire formaat gewijzigd");
+static_assert(sizeof(EspNowAiPayload) == 6, "EspNowAiPayload wire formaat gewijzigd");
+static_assert(sizeof(EspNowStatusPayload) == 16, "EspNowStatusPayload wire formaat gewijzigd");
+static_assert(sizeof(EspNowLinkPayload) == 28, "EspNowLinkPayload wire formaat gewijzigd");
+static_assert(sizeof(EspNowAckPayload) == 3, "EspNowAckPayload wire formaat gewijzigd");
+static_assert(offsetof(EspNowStatusPayload, sleevePct_x10) == 12 && offsetof(EspNowStatusPayload, bits) == 15,
+              "ESPNOW_SF_OFFSET tabel past niet bij EspNowStatusPayload");
+static_assert(sizeof(EspNowTracePayload) == 20, "EspNowTracePayload wire formaat gewijzigd");
+#define ESPNOW_MAX_FRAME        sizeof(EspNowFrame)
+
+static_assert(ESPNOW_MAX_FRAME <= 250, "ESP-NOW max 250 bytes per frame");
+
+// ===============================================================================
+// ENCODE / DECODE
+// ===============================================================================
+
+enum EspNowDecodeResult : uint8_t {
+  ESPNOW_DECODE_OK = 0,
+  ESPNOW_DECODE_TOO_SHORT,
+  ESPNOW_DECODE_BAD_MAGIC,
+  ESPNOW_DECODE_BAD_VERSION,
+  ESPNOW_DECODE_UNKNOWN_OPCODE,
+  ESPNOW_DECODE_BAD_LENGTH
+};
+
+static inline bool espnow_isBodyOpcode(uint8_t op) {
+  return op >= ESPNOW_OP_AI_OVERRIDE && op <= ESPNOW_OP_RESUME_SESSION;
+}
+
+static inline bool espnow_isHooftOpcode(uint8_t op) {
+  return op >= ESPNOW_OP_STATUS_UPDATE && op <= ESPNOW_OP_STATUS_DELTA;
+}
+
+// Offset / grootte per veld binnen EspNowStatusPayload
+static const uint8_t ESPNOW_SF_OFFSET[ESPNOW_SF_COUNT] = { 0, 2, 4, 6, 8, 10, 12, 14, 15 };
+static const uint8_t ESPNOW_SF_SIZE[ESPNOW_SF_COUNT]   = { 2, 2, 2, 2, 2, 2,  2,  1,  1 };
+
+static inline uint8_t espnow_deltaSize(uint16_t mask) {
+  uint8_t size = 2;
+  for (uint8_t f = 0; f < ESPNOW_SF_COUNT; f++) {
+    if (mask & (1u << f)) size += ESPNOW_SF_SIZE[f];
+  }
+  return size;
+}
+
+static inline int32_t espnow_statusField(const EspNowStatusPayload& st, uint8_t f) {
+  const uint8_t* p = (const uint8_t*)&st + ESPNOW_SF_OFFSET[f];
+  if (ESPNOW_SF_SIZE[f] == 1) return *p;
+  int16_t v;
+  memcpy(&v, p, 2);
+  // Unsigned velden (suction, pause, cyclus, sleevePct) niet negatief maken
+  if (f == ESPNOW_SF_SUCTION || f == ESPNOW_SF_PAUSE || f == ESPNOW_SF_CYCLUS || f == ESPNOW_SF_SLEEVE_PCT) {
+    return (uint16_t)v;
+  }
+  return v;
+}
+
+// Masker van velden die meer dan deadband[f] (fixed point eenheden) verschillen.
+// deadband nullptr = elke wijziging telt. bits vergelijkt altijd exact.
+static inline uint16_t espnow_statusDiff(const EspNowStatusPayload& a, const EspNowStatusPayload& b,
+                                         const uint16_t* deadband) {
+  uint16_t mask = 0;
+  for (uint8_t f = 0; f < ESPNOW_SF_COUNT; f++) {
+    int32_t d = espnow_statusField(a, f) - espnow_statusField(b, f);
+    if (d < 0) d = -d;
+    uint16_t band = (deadband && f != ESPNOW_SF_BITS) ? deadband[f] : 0;
+    if (d > band) mask |= (1u << f);
+  }
+  return mask;
+}
+
+// Velden uit mask van src naar dst kopiëren
+static inline void espnow_copyStatusFields(const EspNowStatusPayload& src, EspNowStatusPayload& dst, uint16_t mask) {
+  for (uint8_t f = 0; f < ESPNOW_SF_COUNT; f++) {
+    if (mask & (1u << f)) {
+      memcpy((uint8_t*)&dst + ESPNOW_SF_OFFSET[f], (const uint8_t*)&src + ESPNOW_SF_OFFSET[f], ESPNOW_SF_SIZE[f]);
+    }
+  }
+}
+
+// STATUS_DELTA payload vullen (daarna espnow_encode met ESPNOW_OP_STATUS_DELTA)
+static inline void espnow_buildStatusDelta(EspNowFrame& frame, const EspNowStatusPayload& st, uint16_t mask) {
+  mask &= ESPNOW_SF_ALL;
+  memcpy(frame.delta, &mask, 2);
+  uint8_t pos = 2;
+  for (uint8_t f = 0; f < ESPNOW_SF_COUNT; f++) {
+    if (mask & (1u << f)) {
+      memcpy(frame.delta + pos, (const uint8_t*)&st + ESPNOW_SF_OFFSET[f], ESPNOW_SF_SIZE[f]);
+      pos += ESPNOW_SF_SIZE[f];
+    }
+  }
+}
+
+// Ontvangen STATUS_DELTA op de laatst bekende status toepassen, geeft masker terug
+static inline uint16_t espnow_applyStatusDelta(const EspNowFrame& frame, EspNowStatusPayload& st) {
+  uint16_t mask;
+  memcpy(&mask, frame.delta, 2);
+  uint8_t pos = 2;
+  for (uint8_t f = 0; f < ESPNOW_SF_COUNT; f++) {
+    if (mask & (1u << f)) {
+      memcpy((uint8_t*)&st + ESPNOW_SF_OFFSET[f], frame.delta + pos, ESPNOW_SF_SIZE[f]);
+      pos += ESPNOW_SF_SIZE[f];
+    }
+  }
+  return mask;
+}
+
+// Commando's die niet verloren mogen gaan. Status, heartbeat en playback/
+// funscript streams niet: die worden toch periodiek opnieuw gestuurd.
+static inline bool espnow_needsAck(uint8_t op) {
+  switch (op) {
+    case ESPNOW_OP_AI_OVERRIDE:   case ESPNOW_OP_AI_WARMUP:
+    case ESPNOW_OP_AI_TEST_START: case ESPNOW_OP_AI_RESUME_SLOW:
+    case ESPNOW_OP_AI_STRESS_START: case ESPNOW_OP_AI_STRESS_ADJUST:
+    case ESPNOW_OP_AI_STRESS_RESUME:
+    case ESPNOW_OP_AI_VIBE_ON:    case ESPNOW_OP_AI_VIBE_OFF:
+    case ESPNOW_OP_AI_VACUUM_ON:  case ESPNOW_OP_AI_VACUUM_OFF:
+    case ESPNOW_OP_AI_EMERGENCY_OVERRIDE:
+    case ESPNOW_OP_PLAYBACK_STOP:
+    case ESPNOW_OP_EMERGENCY_STOP: case ESPNOW_OP_RESUME_SESSION:
+    case ESPNOW_OP_ORGASM_TRIGGER: case ESPNOW_OP_ORGASM_COMPLETE:
+    case ESPNOW_OP_COOLDOWN_COMPLETE:
+    case ESPNOW_OP_FUNSCRIPT_ON:  case ESPNOW_OP_FUNSCRIPT_OFF:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Veiligheid kritiek: mag niet achter status / heartbeat verkeer wachten.
+// Altijd ook espnow_needsAck.
+static inline bool espnow_isPriority(uint8_t op) {
+  switch (op) {
+    case ESPNOW_OP_EMERGENCY_STOP:
+    case ESPNOW_OP_AI_EMERGENCY_OVERRIDE:   // Nood pauze (safe mode)
+    case ESPNOW_OP_PLAYBACK_STOP:
+    case ESPNOW_OP_AI_VACUUM_OFF:           // Vacuum los
+    case ESPNOW_OP_ORGASM_TRIGGER:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Vanuit de receive callback: voorrang frame? Alleen header bytes bekijken,
+// decoderen gebeurt pas in loop()
+static inline bool espnow_peekPriority(const uint8_t* data, int len) {
+  return len >= (int)sizeof(EspNowHeader) && data[0] == ESPNOW_PROTO_MAGIC &&
+         data[1] == ESPNOW_PROTO_VERSION && (data[3] & ESPNOW_FLAG_PRIORITY);
+}
+
+// Payload bytes voor opcode, 0 = onbekende opcode
+static inline uint8_t espnow_payloadSize(uint8_t op) {
+  switch (op) {
+    case ESPNOW_OP_AI_OVERRIDE:   case ESPNOW_OP_AI_WARMUP:
+    case ESPNOW_OP_AI_TEST_START: case ESPNOW_OP_AI_RESUME_SLOW:
+    case ESPNOW_OP_AI_STRESS_START: case ESPNOW_OP_AI_STRESS_ADJUST:
+    case ESPNOW_OP_AI_STRESS_RESUME:
+    case ESPNOW_OP_AI_VIBE_ON:    case ESPNOW_OP_AI_VIBE_OFF:
+    case ESPNOW_OP_AI_VACUUM_ON:  case ESPNOW_OP_AI_VACUUM_OFF:
+    case ESPNOW_OP_AI_EMERGENCY_OVERRIDE:
+    case ESPNOW_OP_PLAYBACK_STRESS: case ESPNOW_OP_PLAYBACK_STOP:
+    case ESPNOW_OP_FUNSCRIPT_ACTION:
+    case ESPNOW_OP_HEARTBEAT:     case ESPNOW_OP_EMERGENCY_STOP:
+    case ESPNOW_OP_RESUME_SESSION:
+      return sizeof(EspNowAiPayload);
+    case ESPNOW_OP_STATUS_UPDATE: case ESPNOW_OP_ORGASM_TRIGGER:
+    case ESPNOW_OP_ORGASM_COMPLETE: case ESPNOW_OP_COOLDOWN_COMPLETE:
+    case ESPNOW_OP_FUNSCRIPT_ON:  case ESPNOW_OP_FUNSCRIPT_OFF:
+      return sizeof(EspNowStatusPayload);
+    case ESPNOW_OP_ACK:
+      return sizeof(EspNowAckPayload);
+    case ESPNOW_OP_PING:
+    case ESPNOW_OP_PONG:
+      return sizeof(EspNowLinkPayload);
+    case ESPNOW_OP_STATUS_DELTA:
+      return 2;   // Minimaal: alleen masker (zie espnow_framePayloadSize)
+    default:
+      return 0;
+  }
+}
+
+static inline const char* espnow_opcodeName(uint8_t op) {
+  switch (op) {
+    case ESPNOW_OP_AI_OVERRIDE:         return "AI_OVERRIDE";
+    case ESPNOW_OP_AI_WARMUP:           return "AI_WARMUP";
+    case ESPNOW_OP_AI_TEST_START:       return "AI_TEST_START";
+    case ESPNOW_OP_AI_RESUME_SLOW:      return "AI_RESUME_SLOW";
+    case ESPNOW_OP_AI_STRESS_START:     return "AI_STRESS_START";
+    case ESPNOW_OP_AI_STRESS_ADJUST:    return "AI_STRESS_ADJUST";
+    case ESPNOW_OP_AI_STRESS_RESUME:    return "AI_STRESS_RESUME";
+    case ESPNOW_OP_AI_VIBE_ON:          return "AI_VIBE_ON";
+    case ESPNOW_OP_AI_VIBE_OFF:         return "AI_VIBE_OFF";
+    case ESPNOW_OP_AI_VACUUM_ON:        return "AI_VACUUM_ON";
+    case ESPNOW_OP_AI_VACUUM_OFF:       return "AI_VACUUM_OFF";
+    case ESPNOW_OP_AI_EMERGENCY_OVERRIDE: return "AI_EMERGENCY_OVERRIDE";
+    case ESPNOW_OP_PLAYBACK_STRESS:     return "PLAYBACK_STRESS";
+    case ESPNOW_OP_PLAYBACK_STOP:       return "PLAYBACK_STOP";
+    case ESPNOW_OP_FUNSCRIPT_ACTION:    return "FUNSCRIPT_ACTION";
+    case ESPNOW_OP_HEARTBEAT:           return "HEARTBEAT";
+    case ESPNOW_OP_EMERGENCY_STOP:      return "EMERGENCY_STOP";
+    case ESPNOW_OP_RESUME_SESSION:      return "RESUME_SESSION";
+    case ESPNOW_OP_STATUS_UPDATE:       return "STATUS_UPDATE";
+    case ESPNOW_OP_ORGASM_TRIGGER:      return "ORGASM_TRIGGER";
+    case ESPNOW_OP_ORGASM_COMPLETE:     return "ORGASM_COMPLETE";
+    case ESPNOW_OP_COOLDOWN_COMPLETE:   return "COOLDOWN_COMPLETE";
+    case ESPNOW_OP_FUNSCRIPT_ON:        return "FUNSCRIPT_ON";
+    case ESPNOW_OP_FUNSCRIPT_OFF:       return "FUNSCRIPT_OFF";
+    case ESPNOW_OP_STATUS_DELTA:        return "STATUS_DELTA";
+    case ESPNOW_OP_ACK:                 return "ACK";
+    case ESPNOW_OP_PING:                return "PING";
+    case ESPNOW_OP_PONG:                return "PONG";
+    default:                            return "?";
+  }
+}
+
+// Payload bytes van een concreet frame (STATUS_DELTA hangt af van het masker)
+static inline uint8_t espnow_framePayloadSize(uint8_t op, const uint8_t* payload) {
+  if (op == ESPNOW_OP_STATUS_DELTA) {
+    uint16_t mask;
+    memcpy(&mask, payload, 2);
+    return espnow_deltaSize(mask & ESPNOW_SF_ALL);
+  }
+  return espnow_payloadSize(op);
+}
+
+// Fixed point met afronding en begrenzing
+static inline int16_t espnow_toFixed(float value, float scale) {
+  float v = value * scale;
+  v += (v >= 0.0f) ? 0.5f : -0.5f;
+  if (v > 32767.0f) v = 32767.0f;
+  if (v < -32768.0f) v = -32768.0f;
+  return (int16_t)v;
+}
+
+static inline uint16_t espnow_toUFixed(float value, float scale) {
+  float v = value * scale + 0.5f;
+  if (v > 65535.0f) v = 65535.0f;
+  if (v < 0.0f) v = 0.0f;
+  return (uint16_t)v;
+}
+
+// Header invullen en frame compact in out[] zetten (trace direct na de
+// payload), geeft het aantal te versturen bytes terug. extraFlags: bv.
+// ESPNOW_FLAG_SYNCED als timeMs de sessie klok is.
+static inline uint8_t espnow_encode(EspNowFrame& frame, uint8_t op, uint16_t seq, uint32_t timeMs,
+                                    bool withTrace, uint8_t out[ESPNOW_MAX_FRAME], uint8_t extraFlags = 0) {
+  frame.hdr.magic = ESPNOW_PROTO_MAGIC;
+  frame.hdr.version = ESPNOW_PROTO_VERSION;
+  frame.hdr.opcode = op;
+  frame.hdr.flags = (withTrace ? ESPNOW_FLAG_TRACE : 0) |
+                    (espnow_needsAck(op) ? ESPNOW_FLAG_ACK_REQ : 0) |
+                    (espnow_isPriority(op) ? ESPNOW_FLAG_PRIORITY : 0) |
+                    (extraFlags & ESPNOW_FLAG_SYNCED);
+  frame.hdr.seq = seq;
+  frame.hdr.timeMs = timeMs;
+
+  uint8_t payload = espnow_framePayloadSize(op, (const uint8_t*)&frame.ai);
+  uint8_t len = 0;
+  memcpy(out, &frame.hdr, sizeof(EspNowHeader));
+  len += sizeof(EspNowHeader);
+  memcpy(out + len, &frame.ai, payload);   // Union: zelfde startadres voor alle payloads
+  len += payload;
+  if (withTrace) {
+    memcpy(out + len, &frame.trace, sizeof(EspNowTracePayload));
+    len += sizeof(EspNowTracePayload);
+  }
+  return len;
+}
+
+// Valideert en kopieert; velden die niet in het frame zaten worden 0
+static inline EspNowDecodeResult espnow_decode(const uint8_t* data, int len, EspNowFrame& out) {
+  memset(&out, 0, sizeof(out));
+  if (len < (int)sizeof(EspNowHeader)) return ESPNOW_DECODE_TOO_SHORT;
+
+  memcpy(&out.hdr, data, sizeof(EspNowHeader));
+  if (out.hdr.magic != ESPNOW_PROTO_MAGIC) return ESPNOW_DECODE_BAD_MAGIC;
+  if (out.hdr.version != ESPNOW_PROTO_VERSION) return ESPNOW_DECODE_BAD_VERSION;
+
+  uint8_t payload = espnow_payloadSize(out.hdr.opcode);
+  if (payload == 0) return ESPNOW_DECODE_UNKNOWN_OPCODE;
+  if (out.hdr.opcode == ESPNOW_OP_STATUS_DELTA) {
+    if (len < (int)sizeof(EspNowHeader) + 2) return ESPNOW_DECODE_BAD_LENGTH;
+    uint16_t mask;
+    memcpy(&mask, data + sizeof(EspNowHeader), 2);
+    if (mask & ~ESPNOW_SF_ALL) return ESPNOW_DECODE_BAD_LENGTH;
+    payload = espnow_deltaSize(mask);
+  }
+
+  int expected = sizeof(EspNowHeader) + payload;
+  bool withTrace = out.hdr.flags & ESPNOW_FLAG_TRACE;
+  if (withTrace) expected += sizeof(EspNowTracePayload);
+  if (len != expected) return ESPNOW_DECODE_BAD_LENGTH;
+
+  const uint8_t* p = data + sizeof(EspNowHeader);
+  memcpy(&out.ai, p, payload);   // Union: zelfde startadres voor alle payloads
+  if (withTrace) {
+    memcpy(&out.trace, p + payload, sizeof(EspNowTracePayload));
+  }
+  return ESPNOW_DECODE_OK;
+}
+
+static inline const char* espnow_decodeError(EspNowDecodeResult result) {
+  switch (result) {
+    case ESPNOW_DECODE_OK:             return "OK";
+    case ESPNOW_DECODE_TOO_SHORT:      return "te kort";
+    case ESPNOW_DECODE_BAD_MAGIC:      return "geen protocol frame (oud formaat?)";
+    case ESPNOW_DECODE_BAD_VERSION:    return "andere protocol versie";
+    case ESPNOW_DECODE_UNKNOWN_OPCODE: return "onbekende opcode";
+    case ESPNOW_DECODE_BAD_LENGTH:     return "lengte past niet bij opcode";
+    default:                           return "?";
+  }
+}
+
+// ===============================================================================
+// POMP UNIT <-> HOOFDESP (bestaand binair formaat, ongewijzigd)
+// ===============================================================================
+
+struct __attribute__((packed)) MainMsgV1 {
+  uint8_t  version;           // 1
+  uint8_t  arrow_full;
+  uint8_t  session_started;
+  uint32_t punch_count;
+  uint32_t punch_goal;
+  int16_t  vacuum_set_x10;
+};
+
+struct __attribute__((packed)) MainMsgV2 {
+  uint8_t  version;           // 2
+  uint8_t  arrow_full;
+  uint8_t  session_started;
+  uint32_t punch_count;
+  uint32_t punch_goal;
+  int16_t  vacuum_set_x10;
+  uint8_t  force_pump_state;
+};
+
+// HoofdESP → Pomp Unit
+struct __attribute__((packed)) MainMsgV3 {
+  uint8_t  version;           // Bericht versie (3)
+  uint8_t  arrow_full;        // Pijl vol status (0/1)
+  uint8_t  session_started;   // Sessie start trigger
+  uint32_t punch_count;       // Huidige punch teller
+  uint32_t punch_goal;        // Punch doel voor lube trigger
+  int16_t  vacuum_set_x10;    // Vacuum setpoint (tienden cmHg)
+  uint8_t  force_pump_state;  // 0=AUTO, 1=FORCE_OFF, 2=FORCE_ON
+  uint8_t  cmd_lube_prime_now;// Pulse commando: lube prime
+  uint8_t  cmd_lube_shot_now; // Pulse commando: lube shot
+  uint16_t lube_duration_ms;  // Lube timing in milliseconden (0-20000ms)
+  uint8_t  cmd_toggle_zuigen; // Pulse commando: toggle zuigen mode (0/1)
+  int16_t  zuig_target_x10;   // Zuig target vacuum (tienden cmHg)
+};
+
+// Pomp Unit → HoofdESP (telemetrie)
+struct __attribute__((packed)) PumpStatusMsg {
+  uint8_t  version;              // Message versie (1)
+  float    current_vacuum_cmHg;  // HX711 vacuum waarde
+  uint8_t  vacuum_pump_on;       // Vacuum pomp status (0/1)
+  uint8_t  lube_pump_on;         // Lube pomp status (0/1)
+  uint8_t  servo_open;           // Servo valve positie (0/1)
+  uint8_t  air_relay_open;       // Air relay status (0/1)
+  float    lube_remaining_sec;   // Resterende lube tijd
+  char     system_status[8];     // "OK"/"TARE"/"ERROR"
+  uint8_t  force_pump_state;     // Huidige force state
+  uint8_t  zuig_active;          // Zuigen mode actief op Pomp Unit (0/1)
+  uint32_t uptime_sec;           // System uptime
+};
+
+static_assert(sizeof(MainMsgV1) == 13, "MainMsgV1 wire formaat gewijzigd");
+static_assert(sizeof(MainMsgV2) == 14, "MainMsgV2 wire formaat gewijzigd");
+static_assert(sizeof(MainMsgV3) == 21, "MainMsgV3 wire formaat gewijzigd");
+static_assert(sizeof(PumpStatusMsg) == 27, "PumpStatusMsg wire formaat gewijzigd");
+
+// ===============================================================================
+// M5STICKC PLUS <-> HOOFDESP (bestaand binair formaat, ongewijzigd)
+// ===============================================================================
+
+#define ESPNOW_MK_ATOM_MOTION   1
+#define ESPNOW_MK_PUMP_COLORS   2
+
+// M5StickC → HoofdESP
+struct __attribute__((packed)) AtomMotion {
+  uint8_t ver;     // Message version (1)
+  uint8_t kind;    // ESPNOW_MK_ATOM_MOTION
+  int8_t  dir;     // +1=UP, -1=DOWN, 0=STILL
+  uint8_t speed;   // 0-100
+  uint8_t flags;
+};
+
+// HoofdESP → M5StickC
+struct __attribute__((packed)) PumpColors {
+  uint8_t ver;     // Message version (1)
+  uint8_t kind;    // ESPNOW_MK_PUMP_COLORS
+  uint8_t a_r, a_g, a_b;  // Pump A kleur
+  uint8_t b_r, b_g, b_b;  // Pump B kleur
+  uint8_t flags;   // Status flags (bit 3 = debug LED)
+};
+
+static_assert(sizeof(AtomMotion) == 5, "AtomMotion wire formaat gewijzigd");
+static_assert(sizeof(PumpColors) == 9, "PumpColors wire formaat gewijzigd");
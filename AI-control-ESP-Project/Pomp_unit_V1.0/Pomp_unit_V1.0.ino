@@ -39,6 +39,8 @@
 #include <U8g2lib.h>
 #include <HX711.h>
 #include <Servo.h>
+#include "espnow_protocol.h"
+#include "espnow_rx_queue.h"
 
 U8G2_SH1106_128X64_NONAME_F_HW_I2C u8g2(U8G2_R2, U8X8_PIN_NONE);
 
@@ -105,53 +107,7 @@ bool      tare_pending = false;
 uint32_t  tare_at_ms   = 0;
 
 // ---- ESPNOW payloads ----
-// Incoming messages (from HoofdESP)
-struct __attribute__((packed)) MainMsgV1 {
-  uint8_t  version;           
-  uint8_t  arrow_full;
-  uint8_t  session_started;
-  uint32_t punch_count;
-  uint32_t punch_goal;
-  int16_t  vacuum_set_x10;
-};
-struct __attribute__((packed)) MainMsgV2 {
-  uint8_t  version;           
-  uint8_t  arrow_full;
-  uint8_t  session_started;
-  uint32_t punch_count;
-  uint32_t punch_goal;
-  int16_t  vacuum_set_x10;
-  uint8_t  force_pump_state;  
-};
-struct __attribute__((packed)) MainMsgV3 {
-  uint8_t  version;           
-  uint8_t  arrow_full;
-  uint8_t  session_started;
-  uint32_t punch_count;
-  uint32_t punch_goal;
-  int16_t  vacuum_set_x10;
-  uint8_t  force_pump_state;  
-  uint8_t  cmd_lube_prime_now;// 0/1 pulse
-  uint8_t  cmd_lube_shot_now; // 0/1 pulse
-  uint16_t lube_duration_ms;  // Lube timing in milliseconden (0-20000ms)
-  uint8_t  cmd_toggle_zuigen; // Pulse commando: toggle zuigen mode (0/1)
-  int16_t  zuig_target_x10;   // Zuig target vacuum (tienden cmHg)
-};
-
-// Outgoing telemetry message (to HoofdESP)
-struct __attribute__((packed)) PumpStatusMsg {
-  uint8_t  version;              // Message version (1)
-  float    current_vacuum_cmHg;  // HX711 vacuum reading
-  uint8_t  vacuum_pump_on;       // Vacuum pump status (0/1)
-  uint8_t  lube_pump_on;         // Lube pump status (0/1)
-  uint8_t  servo_open;           // Servo valve position (0/1)
-  uint8_t  air_relay_open;       // Air relay status (0/1)
-  float    lube_remaining_sec;   // Remaining lube time in seconds
-  char     system_status[8];     // "OK"/"TARE"/"ERROR"
-  uint8_t  force_pump_state;     // Current force state (0=AUTO,1=OFF,2=ON)
-  uint8_t  zuig_active;          // Zuigen mode active on Pump Unit (0/1)
-  uint32_t uptime_sec;           // System uptime in seconds
-};
+// MainMsgV1/V2/V3 (van HoofdESP) en PumpStatusMsg (naar HoofdESP): espnow_protocol.h
 
 float rollingAverage(float x){
   vac_buf[vac_idx]=x; vac_idx=(vac_idx+1)%6; if(vac_fill<6)vac_fill++;
@@ -159,7 +115,14 @@ float rollingAverage(float x){
   return s/(vac_fill?vac_fill:1);
 }
 
+static EspNowRxQueue rxQueue;
+
+// WiFi callback: alleen kopiëren, verwerken gebeurt in processRx() vanuit loop()
 void onDataRecv(uint8_t *mac,uint8_t *incomingData,uint8_t len){
+  espnowRx_push(rxQueue, mac, incomingData, len, 0, micros());
+}
+
+void handleMainMsg(const uint8_t *mac,const uint8_t *incomingData,uint8_t len){
   // Debug ESP-NOW ontvangst
   Serial.printf("[ESP-NOW RX] From: %02X:%02X:%02X:%02X:%02X:%02X, Len: %d\n",
                 mac[0],mac[1],mac[2],mac[3],mac[4],mac[5], len);
@@ -467,7 +430,20 @@ void setup(){
   Serial.printf("[PumpUnit] PumpStatusMsg size: %d bytes\n", sizeof(PumpStatusMsg));
 }
 
+void processRx(){
+  static uint32_t lastDropped=0;
+  EspNowRxItem item;
+  while(espnowRx_pop(rxQueue,item)) handleMainMsg(item.mac,item.data,item.len);
+  uint32_t dropped=espnowRx_dropped(rxQueue);
+  if(dropped!=lastDropped){
+    Serial.printf("[ESP-NOW RX] %u frames weggegooid (vol:%u te lang:%u)\n",
+                  dropped-lastDropped, rxQueue.overflows, rxQueue.tooLong);
+    lastDropped=dropped;
+  }
+}
+
 void loop(){
+  processRx();   // Ontvangen ESP-NOW frames toepassen (elke loop, ook tussen ticks)
   t_now=millis();
   if(t_now - t_last < 20){ delay(1); return; }
   t_last=t_now;
@@ -0,0 +1,900 @@
+/*
+  espnow_link_sim - Body ESP <-> HoofdESP over een gesimuleerde radio link
+
+  ═══════════════════════════════════════════════════════════════════════════
+  Drijft de portable ESP-NOW headers zoals de firmware ze gebruikt:
+
+    espnow_protocol.h   encode / decode, STATUS_UPDATE + STATUS_DELTA
+    espnow_reliable.h   ACK, herhaling, voorrang lane, duplicaat filter
+    espnow_rx_queue.h   receive callback → queue → loop() (2 queues per node)
+    espnow_publisher.h  adaptief status ritme van de HoofdESP
+    espnow_timesync.h   sessie klok van de Body (PING/PONG, espnow_link.h)
+
+  Discrete event simulatie in µs. Elke node heeft een eigen klok (boot
+  moment + kristal drift), een loop() ritme en optioneel stalls (SD flush,
+  BLE connect) waarin de queue vol loopt. Per richting een link model:
+  latency, jitter, verlies (Bernoulli of Gilbert-Elliott bursts) en
+  omgedraaide volgorde.
+
+  Per scenario gemeten en gecontroleerd:
+    - kritieke commando's: levering, latency p50/p99/max, voorrang max
+    - geen enkel commando dubbel uitgevoerd
+    - kritieke volgnummers zonder gaten (ACK/status/PING eigen reeks)
+    - niets stil kwijt: niet uitgevoerd → zender heeft het opgegeven
+    - niets opgegeven (behalve als de ontvanger langer blokkeert)
+    - status op de Body: hoe lang wijkt die af van de HoofdESP
+    - tijd sync fout tegen de espnowSync_errorUs() grens
+    - verlies schatting (espnow_link.h) tegen echt verlies
+
+  Daarna een micro benchmark (ns per frame) van de hete paden.
+  ═══════════════════════════════════════════════════════════════════════════
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <math.h>
+#include <queue>
+#include <random>
+#include <stdio.h>
+#include <vector>
+
+#include "espnow_protocol.h"
+#include "espnow_reliable.h"
+#include "espnow_rx_queue.h"
+#include "espnow_publisher.h"
+#include "espnow_timesync.h"
+#include "espnow_link.h"
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                          \
+  do {                                            \
+    if (!(cond)) {                                \
+      failures++;                                 \
+      printf("  FOUT %s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__);                        \
+      printf("\n");                               \
+    }                                             \
+  } while (0)
+
+// ===== Firmware constanten (zelfde waarden als in de .ino / .cpp) =====
+
+// Hooft espnow_comm.cpp
+static const uint32_t BODY_ESP_UPDATE_INTERVAL = 500;
+static const uint32_t BODY_ESP_MIN_GAP = 40;
+static const uint32_t BODY_ESP_KEEPALIVE = 2000;
+static const uint16_t BODY_STATUS_DEADBAND[ESPNOW_SF_COUNT] = { 20, 20, 5, 0, 5, 5, 20, 0, 0 };
+static const uint16_t BODY_STATUS_URGENT = (1u << ESPNOW_SF_TRUST) | (1u << ESPNOW_SF_SLEEVE) |
+                                           (1u << ESPNOW_SF_PAUSE) | (1u << ESPNOW_SF_SPEED_STEP) |
+                                           (1u << ESPNOW_SF_BITS);
+
+// Body_ESP.ino
+static const uint32_t AI_CMD_MIN_GAP_MS = 500;
+static const uint32_t AI_CMD_KEEPALIVE_MS = 3000;
+static const float AI_CMD_TRUST_DEADBAND = 0.02f;
+
+// ===== Link model =====
+
+struct LinkModel {
+  uint32_t latencyUs;     // Vaste radio + MAC tijd
+  uint32_t jitterUs;      // Uniform 0..jitter erbij
+  float    lossGood;      // Verlies in de goede toestand
+  float    lossBad;       // Verlies in de burst toestand (storing)
+  uint32_t goodMs;        // Gem. duur goede toestand (0 = geen bursts)
+  uint32_t badMs;         // Gem. duur van een storing
+  float    reorderPct;    // Frame extra vertraagd → komt na latere frames
+  bool     sendFail;      // Verlies → send callback FAIL (unicast MAC ACK)
+};
+
+struct Scenario {
+  const char* name;
+  LinkModel link;
+  uint32_t bodyStallEveryMs, bodyStallMs;     // 0 = geen stalls
+  uint32_t hooftStallEveryMs, hooftStallMs;
+
+  // Grenzen
+  float    minDelivered;    // Fractie kritieke commando's uitgevoerd
+  float    maxP99Ms;        // Kritieke latency p99 (eerste send → uitgevoerd)
+  float    maxPrioMs;       // Voorrang: slechtste latency
+  float    maxStatusMs;     // Langste afwijking van de status op de Body
+  bool     expectOverflow;  // Stall scenario: queue moet vollopen
+  bool     giveUpOk;        // Ontvanger blokkeert langer dan het budget
+};
+
+static const uint32_t RUN_MS = 120000;       // Verkeer
+static const uint32_t DRAIN_MS = 3000;       // Daarna alleen nog herhalingen / ACKs
+
+// ===== Simulatie =====
+
+enum EventType : uint8_t { EV_LOOP, EV_RX, EV_SEND_FAIL };
+
+struct Event {
+  int64_t  atUs;
+  uint64_t order;         // Zelfde tijd: volgorde van inplannen
+  EventType type;
+  uint8_t  node;
+  uint8_t  len;
+  uint8_t  data[ESPNOW_MAX_FRAME];
+  bool operator>(const Event& o) const { return atUs != o.atUs ? atUs > o.atUs : order > o.order; }
+};
+
+struct Direction {
+  LinkModel model;
+  bool     bad;           // Gilbert-Elliott toestand
+  int64_t  stateUntilUs;
+  int64_t  lastArrivalUs; // Radio queue is FIFO: jitter draait niets om
+  uint32_t frames;
+  uint32_t lost;          // Op de lucht
+  uint32_t reordered;
+  uint64_t bytes;
+};
+
+// Kritiek commando (ACK_REQ) zoals de zender het verstuurde
+struct Command {
+  uint8_t  op;
+  bool     priority;
+  int64_t  sentUs;        // Sim tijd eerste send
+  int64_t  execUs;        // Sim tijd eerste uitvoering, -1 = nooit
+  int      execs;
+};
+
+struct Node {
+  const char* name;
+  uint8_t  id;
+  int64_t  bootUs;        // Lokale klok = sim tijd + bootUs + drift
+  double   driftPpm;
+  uint32_t loopUs;
+  uint32_t stallEveryMs, stallMs;
+  int64_t  nextStallUs, stallUntilUs;
+
+  EspNowReliable  rel;
+  EspNowLinkStats link;
+  EspNowRxQueue   rxq;
+  EspNowRxQueue   rxPrio;
+  Direction       tx;     // Naar de peer
+
+  std::map<uint16_t, Command> sentCmds;    // Op seq, alleen kritieke frames
+  uint32_t executed;                        // Kritieke frames uitgevoerd (uniek)
+  uint32_t dupExecs;                        // Zelfde seq twee keer uitgevoerd
+};
+
+static Node nodes[2];
+static Node& body = nodes[0];
+static Node& hooft = nodes[1];
+
+static int64_t simUs;
+static uint64_t eventOrder;
+static std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+static std::mt19937 rng;
+
+static float uniform() { return std::uniform_real_distribution<float>(0.0f, 1.0f)(rng); }
+
+static int64_t localUs(const Node& n) {
+  return simUs + n.bootUs + (int64_t)(simUs * n.driftPpm / 1e6);
+}
+static uint32_t localMs(const Node& n) { return (uint32_t)(localUs(n) / 1000); }
+
+static void schedule(int64_t atUs, EventType type, uint8_t node, const uint8_t* data = nullptr, uint8_t len = 0) {
+  Event ev;
+  ev.atUs = atUs;
+  ev.order = eventOrder++;
+  ev.type = type;
+  ev.node = node;
+  ev.len = len;
+  if (len) memcpy(ev.data, data, len);
+  events.push(ev);
+}
+
+// ===== Zenden (EspNowRelSendFn is een kale functie pointer) =====
+
+static Node* sender;
+
+static int64_t poissonUs(float meanMs) {
+  return (int64_t)(std::exponential_distribution<float>(1.0f / meanMs)(rng) * 1000.0f);
+}
+
+static bool airSend(const uint8_t* frame, uint8_t len) {
+  Node& n = *sender;
+  Direction& d = n.tx;
+  const LinkModel& m = d.model;
+  d.frames++;
+  d.bytes += len;
+
+  // Storingen in de tijd (WiFi, magnetron, lichaam ertussen), niet per frame
+  while (m.goodMs && simUs >= d.stateUntilUs) {
+    d.bad = !d.bad;
+    d.stateUntilUs += poissonUs(d.bad ? m.badMs : m.goodMs);
+  }
+  if (uniform() < (d.bad ? m.lossBad : m.lossGood)) {
+    d.lost++;
+    if (m.sendFail) schedule(simUs + m.latencyUs, EV_SEND_FAIL, n.id);
+    return true;    // esp_now_send() accepteerde het frame
+  }
+
+  int64_t atUs = simUs + m.latencyUs + (m.jitterUs ? (int64_t)(uniform() * m.jitterUs) : 0);
+  if (m.reorderPct > 0.0f && uniform() * 100.0f < m.reorderPct) {
+    atUs += m.jitterUs + 5000 + (int64_t)(uniform() * 10000);   // Komt na latere frames
+    d.reordered++;
+  } else {
+    atUs = std::max(atUs, d.lastArrivalUs);
+    d.lastArrivalUs = atUs;
+  }
+  schedule(atUs, EV_RX, 1 - n.id, frame, len);
+  return true;
+}
+
+static bool sendFrom(Node& n, const uint8_t* frame, uint8_t len) {
+  sender = &n;
+  return airSend(frame, len);
+}
+
+// Kritiek frame bijhouden voor de controle aan de ontvangende kant
+static void trackCommand(Node& n, const uint8_t* frame) {
+  const EspNowHeader* hdr = (const EspNowHeader*)frame;
+  if (!(hdr->flags & ESPNOW_FLAG_ACK_REQ)) return;
+  Command& c = n.sentCmds[hdr->seq];
+  c.op = hdr->opcode;
+  c.priority = hdr->flags & ESPNOW_FLAG_PRIORITY;
+  c.sentUs = simUs;
+  c.execUs = -1;
+  c.execs = 0;
+}
+
+static void relSend(Node& n, const uint8_t* frame, uint8_t len) {
+  trackCommand(n, frame);
+  sender = &n;
+  espnowRel_send(n.rel, frame, len, localMs(n), airSend);
+}
+
+// Uitvoering aan de ontvangende kant (na het duplicaat filter)
+static void executed(Node& receiver, const EspNowHeader& hdr) {
+  if (!(hdr.flags & ESPNOW_FLAG_ACK_REQ)) return;
+  Node& from = nodes[1 - receiver.id];
+  auto it = from.sentCmds.find(hdr.seq);
+  if (it == from.sentCmds.end()) return;
+  Command& c = it->second;
+  if (c.execs++ == 0) {
+    c.execUs = simUs;
+    receiver.executed++;
+  } else {
+    receiver.dupExecs++;
+  }
+}
+
+// ===== Body ESP =====
+
+struct BodyApp {
+  EspNowClockSync clock;
+  EspNowPublisher aiPub;
+  EspNowStatusPayload hooftStatus;     // Zoals de Body de machine kent
+  bool     statusSeen;
+  bool     statusFull;                  // Volledige status gehad (basis voor delta's)
+  uint16_t statusSeq;
+
+  float    aiTrust;                    // Wat de AI nu wil
+  int64_t  nextAiChangeUs;
+  int64_t  nextStopUs;
+  int64_t  resumeAtUs;
+  uint32_t lastHeartbeatMs;
+
+  uint8_t  lastOpcode;
+  float    lastTrust;
+
+  // Tijd sync controle
+  uint32_t syncSamples;
+  uint32_t syncOutside;                // |fout| > espnowSync_errorUs()
+  double   syncErrMaxUs;
+  double   syncErrSumUs;
+  double   syncBoundSumUs;
+
+  // Status afwijking (urgente velden buiten deadband)
+  int64_t  mismatchSinceUs;            // -1 = gelijk
+  std::vector<float> mismatchMs;
+};
+
+struct HooftApp {
+  EspNowPublisher pub;
+  EspNowStatusPayload lastSent;
+  EspNowStatusPayload current;
+
+  int64_t  nextStepUs;
+  int64_t  nextTrustUs;
+  int64_t  nextPauseUs;
+  int64_t  nextOrgasmUs;
+  int64_t  cooldownAtUs;
+  int16_t  vacuum;
+
+  float    aiTrust;                    // Laatst uitgevoerde AI_OVERRIDE
+  uint16_t aiLastSeq;
+  bool     aiSeen;
+  uint32_t aiStale;                    // Ouder AI_OVERRIDE na een nieuwer uitgevoerd
+};
+
+static BodyApp bodyApp;
+static HooftApp hooftApp;
+static bool trafficOn;
+
+// Body_ESP.ino espnowSessionMs()
+static uint32_t bodySessionMs(uint8_t* flags) {
+  int64_t nowUs = localUs(body);
+  bool synced = espnowSync_isSynced(bodyApp.clock, nowUs);
+  if (flags) *flags = synced ? ESPNOW_FLAG_SYNCED : 0;
+  return (uint32_t)((synced ? espnowSync_toMasterUs(bodyApp.clock, nowUs) : nowUs) / 1000);
+}
+
+static void bodyHandleFrame(const EspNowRxItem& item) {
+  int64_t rxUs = espnowSync_extendUs(item.rxUs, localUs(body));
+  uint32_t now = localMs(body);
+  EspNowFrame frame;
+  if (espnow_decode(item.data, item.len, frame) != ESPNOW_DECODE_OK) return;
+  espnowLink_onFrame(body.link, frame.hdr, item.rssi, now);
+
+  uint8_t buf[ESPNOW_MAX_FRAME];
+  uint8_t flags;
+  switch (frame.hdr.opcode) {
+    case ESPNOW_OP_ACK:
+      espnowRel_onAck(body.rel, frame.ack.ackSeq, now);
+      return;
+    case ESPNOW_OP_PING: {
+      EspNowFrame pong;
+      memset(&pong, 0, sizeof(pong));
+      espnowLink_buildPong(body.link, frame, now, rxUs, localUs(body), pong);
+      uint32_t sessionMs = bodySessionMs(&flags);
+      uint8_t len = espnow_encode(pong, ESPNOW_OP_PONG, espnowRel_nextSeq(body.rel, ESPNOW_OP_PONG), sessionMs, false, buf, flags);
+      sendFrom(body, buf, len);
+      return;
+    }
+    case ESPNOW_OP_PONG:
+      if (espnowLink_onPong(body.link, frame, now, rxUs)) {
+        espnowSync_onSample(bodyApp.clock, frame.link.t1Us, frame.link.t2Us, frame.link.t3Us, rxUs);
+      }
+      return;
+    default:
+      break;
+  }
+  if (!espnow_isHooftOpcode(frame.hdr.opcode)) return;
+
+  uint32_t ackMs = bodySessionMs(&flags);
+  uint8_t ackLen = espnowRel_buildAck(body.rel, frame.hdr, ackMs, buf, flags);
+  if (ackLen) sendFrom(body, buf, ackLen);
+  if (espnowRel_onReceive(body.rel, frame.hdr)) return;
+
+  executed(body, frame.hdr);
+
+  // Body_ESP.ino: te late status niet over een nieuwere heen
+  bool isStatus = frame.hdr.opcode == ESPNOW_OP_STATUS_UPDATE || frame.hdr.opcode == ESPNOW_OP_STATUS_DELTA;
+  if (frame.hdr.opcode == ESPNOW_OP_STATUS_DELTA && !bodyApp.statusFull) isStatus = false;
+  int16_t statusAge = (int16_t)(bodyApp.statusSeq - frame.hdr.seq);
+  if (isStatus && !(bodyApp.statusSeen && statusAge > 0 && statusAge < ESPNOW_REL_DUP_BITS)) {
+    if (frame.hdr.opcode == ESPNOW_OP_STATUS_UPDATE) {
+      bodyApp.hooftStatus = frame.status;
+      bodyApp.statusFull = true;
+    } else {
+      espnow_applyStatusDelta(frame, bodyApp.hooftStatus);
+    }
+    bodyApp.statusSeq = frame.hdr.seq;
+    bodyApp.statusSeen = true;
+  }
+}
+
+static void bodySendCommand(uint8_t op, float trust) {
+  EspNowFrame frame;
+  memset(&frame, 0, sizeof(frame));
+  frame.ai.trust_x1000 = espnow_toFixed(trust, 1000.0f);
+  frame.ai.sleeve_x1000 = 1000;
+  frame.ai.bits = ESPNOW_AI_OVERRULE;
+  uint8_t flags;
+  uint32_t sessionMs = bodySessionMs(&flags);
+  uint8_t buf[ESPNOW_MAX_FRAME];
+  uint8_t len = espnow_encode(frame, op, espnowRel_nextSeq(body.rel, op), sessionMs, false, buf, flags);
+  relSend(body, buf, len);
+}
+
+static void bodyLoop() {
+  EspNowRxItem item;
+  while (espnowRx_pop(body.rxPrio, item)) bodyHandleFrame(item);
+  while (espnowRx_pop(body.rxq, item)) bodyHandleFrame(item);
+
+  sender = &body;
+  espnowRel_poll(body.rel, localMs(body), airSend);
+  uint32_t now = localMs(body);
+
+  if (trafficOn) {
+    // AI wil iets anders (Body_ESP.ino aiCommandDue)
+    if (simUs >= bodyApp.nextAiChangeUs) {
+      bodyApp.aiTrust = 0.5f + 0.05f * (rng() % 21);
+      bodyApp.nextAiChangeUs = simUs + poissonUs(800);
+    }
+    bool changed = bodyApp.lastOpcode != ESPNOW_OP_AI_OVERRIDE ||
+                   fabsf(bodyApp.aiTrust - bodyApp.lastTrust) > AI_CMD_TRUST_DEADBAND;
+    if (!espnowRel_priorityOpen(body.rel)) {
+      EspNowPubSend kind = espnowPub_decide(bodyApp.aiPub, now, changed, false);
+      if (kind != ESPNOW_PUB_NONE) {
+        bodyApp.lastOpcode = ESPNOW_OP_AI_OVERRIDE;
+        bodyApp.lastTrust = bodyApp.aiTrust;
+        bodySendCommand(ESPNOW_OP_AI_OVERRIDE, bodyApp.aiTrust);
+        espnowPub_sent(bodyApp.aiPub, now, kind);
+      }
+    }
+
+    // Noodstop (voorrang) en 2 s later hervatten
+    if (simUs >= bodyApp.nextStopUs) {
+      bodySendCommand(ESPNOW_OP_EMERGENCY_STOP, 0.0f);
+      bodyApp.nextStopUs = simUs + poissonUs(15000);
+      bodyApp.resumeAtUs = simUs + 2000000;
+    }
+    if (bodyApp.resumeAtUs && simUs >= bodyApp.resumeAtUs) {
+      bodySendCommand(ESPNOW_OP_RESUME_SESSION, 0.0f);
+      bodyApp.resumeAtUs = 0;
+    }
+
+    if (now - bodyApp.lastHeartbeatMs >= 1000 && !espnowRel_priorityOpen(body.rel)) {
+      bodyApp.lastHeartbeatMs = now;
+      bodySendCommand(ESPNOW_OP_HEARTBEAT, 0.0f);
+    }
+  }
+
+  if (!espnowRel_priorityOpen(body.rel) && espnowLink_pingDue(body.link, now)) {
+    EspNowFrame ping;
+    memset(&ping, 0, sizeof(ping));
+    uint8_t flags;
+    uint32_t sessionMs = bodySessionMs(&flags);
+    espnowLink_buildPing(body.link, now, localUs(body), ping);
+    uint8_t buf[ESPNOW_MAX_FRAME];
+    uint8_t len = espnow_encode(ping, ESPNOW_OP_PING, espnowRel_nextSeq(body.rel, ESPNOW_OP_PING), sessionMs, false, buf, flags);
+    sendFrom(body, buf, len);
+  }
+
+  // Tijd sync tegen de echte HoofdESP klok
+  int64_t nowUs = localUs(body);
+  if (espnowSync_isSynced(bodyApp.clock, nowUs)) {
+    double err = fabs((double)(espnowSync_toMasterUs(bodyApp.clock, nowUs) - localUs(hooft)));
+    uint32_t bound = espnowSync_errorUs(bodyApp.clock, nowUs);
+    bodyApp.syncSamples++;
+    if (err > bound) bodyApp.syncOutside++;
+    bodyApp.syncErrMaxUs = std::max(bodyApp.syncErrMaxUs, err);
+    bodyApp.syncErrSumUs += err;
+    bodyApp.syncBoundSumUs += bound;
+  }
+
+  // Status op de Body tegen de machine
+  uint16_t diff = bodyApp.statusSeen
+                ? espnow_statusDiff(bodyApp.hooftStatus, hooftApp.current, BODY_STATUS_DEADBAND) & BODY_STATUS_URGENT
+                : 0;
+  if (diff && bodyApp.mismatchSinceUs < 0) {
+    bodyApp.mismatchSinceUs = simUs;
+  } else if (!diff && bodyApp.mismatchSinceUs >= 0) {
+    bodyApp.mismatchMs.push_back((simUs - bodyApp.mismatchSinceUs) / 1000.0f);
+    bodyApp.mismatchSinceUs = -1;
+  }
+}
+
+// ===== HoofdESP =====
+
+static void hooftHandleFrame(const EspNowRxItem& item) {
+  int64_t rxUs = espnowSync_extendUs(item.rxUs, localUs(hooft));
+  uint32_t now = localMs(hooft);
+  EspNowFrame frame;
+  if (espnow_decode(item.data, item.len, frame) != ESPNOW_DECODE_OK) return;
+  espnowLink_onFrame(hooft.link, frame.hdr, item.rssi, now);
+
+  uint8_t buf[ESPNOW_MAX_FRAME];
+  switch (frame.hdr.opcode) {
+    case ESPNOW_OP_ACK:
+      espnowRel_onAck(hooft.rel, frame.ack.ackSeq, now);
+      return;
+    case ESPNOW_OP_PING: {
+      EspNowFrame pong;
+      memset(&pong, 0, sizeof(pong));
+      espnowLink_buildPong(hooft.link, frame, now, rxUs, localUs(hooft), pong);
+      uint8_t len = espnow_encode(pong, ESPNOW_OP_PONG, espnowRel_nextSeq(hooft.rel, ESPNOW_OP_PONG), now, false, buf, ESPNOW_FLAG_SYNCED);
+      sendFrom(hooft, buf, len);
+      return;
+    }
+    case ESPNOW_OP_PONG:
+      espnowLink_onPong(hooft.link, frame, now, rxUs);
+      return;
+    default:
+      break;
+  }
+  if (!espnow_isBodyOpcode(frame.hdr.opcode)) return;
+
+  uint8_t ackLen = espnowRel_buildAck(hooft.rel, frame.hdr, now, buf, ESPNOW_FLAG_SYNCED);
+  if (ackLen) sendFrom(hooft, buf, ackLen);
+  if (espnowRel_onReceive(hooft.rel, frame.hdr)) return;
+
+  executed(hooft, frame.hdr);
+  if (frame.hdr.opcode == ESPNOW_OP_AI_OVERRIDE) {
+    if (hooftApp.aiSeen && (int16_t)(frame.hdr.seq - hooftApp.aiLastSeq) < 0) {
+      hooftApp.aiStale++;
+    } else {
+      hooftApp.aiSeen = true;
+      hooftApp.aiLastSeq = frame.hdr.seq;
+      hooftApp.aiTrust = frame.ai.trust_x1000 / 1000.0f;
+    }
+  }
+}
+
+static void hooftSendEvent(uint8_t op) {
+  EspNowFrame frame;
+  memset(&frame, 0, sizeof(frame));
+  frame.status = hooftApp.current;
+  uint8_t buf[ESPNOW_MAX_FRAME];
+  uint8_t len = espnow_encode(frame, op, espnowRel_nextSeq(hooft.rel, op), localMs(hooft), false, buf, ESPNOW_FLAG_SYNCED);
+  relSend(hooft, buf, len);
+}
+
+// Machine die beweegt: sleeve positie continu, de rest met sprongen
+static void hooftUpdateMachine() {
+  EspNowStatusPayload& st = hooftApp.current;
+  double t = simUs / 1e6;
+  st.sleevePct_x10 = (uint16_t)(500 + 450 * sin(t * 2.0 * M_PI * 0.5));
+  st.sleeve_x1000 = 1000;
+  st.cyclusTijd_x100 = 200;
+
+  if (!trafficOn) return;
+  if (simUs >= hooftApp.nextStepUs) {
+    st.speedStep = rng() % 8;
+    hooftApp.nextStepUs = simUs + poissonUs(3000);
+  }
+  if (simUs >= hooftApp.nextTrustUs) {
+    st.trust_x1000 = 500 + 50 * (rng() % 21);
+    hooftApp.nextTrustUs = simUs + poissonUs(2000);
+  }
+  if (simUs >= hooftApp.nextPauseUs) {
+    st.bits ^= ESPNOW_ST_PAUSE;
+    hooftApp.nextPauseUs = simUs + poissonUs(10000);
+  }
+  hooftApp.vacuum += (int16_t)(rng() % 7) - 3;
+  st.vacuumMbar_x10 = hooftApp.vacuum;
+}
+
+static void hooftLoop() {
+  EspNowRxItem item;
+  while (espnowRx_pop(hooft.rxPrio, item)) hooftHandleFrame(item);
+  while (espnowRx_pop(hooft.rxq, item)) hooftHandleFrame(item);
+
+  sender = &hooft;
+  espnowRel_poll(hooft.rel, localMs(hooft), airSend);
+  uint32_t now = localMs(hooft);
+
+  hooftUpdateMachine();
+
+  // espnow_comm.cpp: status via de publisher, niet als er voorrang open staat
+  if (!espnowRel_priorityOpen(hooft.rel)) {
+    const EspNowStatusPayload& current = hooftApp.current;
+    uint16_t changed = espnow_statusDiff(current, hooftApp.lastSent, BODY_STATUS_DEADBAND);
+    EspNowPubSend kind = espnowPub_decide(hooftApp.pub, now, changed & BODY_STATUS_URGENT,
+                                          changed & ~BODY_STATUS_URGENT);
+    if (kind != ESPNOW_PUB_NONE) {
+      EspNowFrame frame;
+      memset(&frame, 0, sizeof(frame));
+      uint8_t op = ESPNOW_OP_STATUS_UPDATE;
+      if (kind == ESPNOW_PUB_FULL) {
+        frame.status = current;
+      } else {
+        espnow_buildStatusDelta(frame, current, espnow_statusDiff(current, hooftApp.lastSent, nullptr));
+        op = ESPNOW_OP_STATUS_DELTA;
+      }
+      uint8_t buf[ESPNOW_MAX_FRAME];
+      uint8_t len = espnow_encode(frame, op, espnowRel_nextSeq(hooft.rel, op), now, false, buf, ESPNOW_FLAG_SYNCED);
+      sendFrom(hooft, buf, len);
+      hooftApp.lastSent = current;
+      espnowPub_sent(hooftApp.pub, now, kind);
+    }
+  }
+
+  if (trafficOn) {
+    if (simUs >= hooftApp.nextOrgasmUs) {
+      hooftSendEvent(ESPNOW_OP_ORGASM_TRIGGER);
+      hooftApp.nextOrgasmUs = simUs + poissonUs(20000);
+      hooftApp.cooldownAtUs = simUs + 3000000;
+    }
+    if (hooftApp.cooldownAtUs && simUs >= hooftApp.cooldownAtUs) {
+      hooftSendEvent(ESPNOW_OP_COOLDOWN_COMPLETE);
+      hooftApp.cooldownAtUs = 0;
+    }
+  }
+
+  if (!espnowRel_priorityOpen(hooft.rel) && espnowLink_pingDue(hooft.link, now)) {
+    EspNowFrame ping;
+    memset(&ping, 0, sizeof(ping));
+    espnowLink_buildPing(hooft.link, now, localUs(hooft), ping);
+    uint8_t buf[ESPNOW_MAX_FRAME];
+    uint8_t len = espnow_encode(ping, ESPNOW_OP_PING, espnowRel_nextSeq(hooft.rel, ESPNOW_OP_PING), now, false, buf, ESPNOW_FLAG_SYNCED);
+    sendFrom(hooft, buf, len);
+  }
+}
+
+// ===== Scenario draaien =====
+
+static void initNode(Node& n, uint8_t id, const char* name, int64_t bootUs, double driftPpm,
+                     uint32_t loopUs, uint32_t stallEveryMs, uint32_t stallMs, const LinkModel& link) {
+  n.name = name;
+  n.id = id;
+  n.bootUs = bootUs;
+  n.driftPpm = driftPpm;
+  n.loopUs = loopUs;
+  n.stallEveryMs = stallEveryMs;
+  n.stallMs = stallMs;
+  n.nextStallUs = stallEveryMs ? (int64_t)stallEveryMs * 1000 : INT64_MAX;
+  n.stallUntilUs = 0;
+  espnowRel_reset(n.rel);
+  espnowLink_reset(n.link);
+  memset(&n.rxq, 0, sizeof(n.rxq));
+  memset(&n.rxPrio, 0, sizeof(n.rxPrio));
+  memset(&n.tx, 0, sizeof(n.tx));
+  n.tx.model = link;
+  n.sentCmds.clear();
+  n.executed = 0;
+  n.dupExecs = 0;
+}
+
+static void onEvent(const Event& ev) {
+  Node& n = nodes[ev.node];
+  switch (ev.type) {
+    case EV_RX: {
+      // Receive callback (WiFi task): alleen in de queue, ook tijdens een stall
+      static const uint8_t mac[6] = { 0 };
+      int8_t rssi = -55 - (int8_t)(rng() % 10);
+      EspNowRxQueue& q = espnow_peekPriority(ev.data, ev.len) ? n.rxPrio : n.rxq;
+      espnowRx_push(q, mac, ev.data, ev.len, rssi, (uint32_t)localUs(n));
+      break;
+    }
+    case EV_SEND_FAIL:
+      espnowRel_onSendStatus(n.rel, false);
+      break;
+    case EV_LOOP:
+      if (simUs >= n.nextStallUs) {
+        n.stallUntilUs = simUs + (int64_t)n.stallMs * 1000;
+        n.nextStallUs += (int64_t)n.stallEveryMs * 1000;
+      }
+      if (simUs < n.stallUntilUs) {
+        schedule(n.stallUntilUs, EV_LOOP, n.id);
+        break;
+      }
+      if (&n == &body) bodyLoop();
+      else hooftLoop();
+      schedule(simUs + n.loopUs + (int64_t)(uniform() * n.loopUs / 4), EV_LOOP, n.id);
+      break;
+  }
+}
+
+static float percentile(std::vector<float> v, float p) {
+  if (v.empty()) return 0.0f;
+  std::sort(v.begin(), v.end());
+  size_t i = (size_t)(p / 100.0f * (v.size() - 1) + 0.5f);
+  return v[i];
+}
+
+struct CmdResult {
+  uint32_t sent = 0;
+  uint32_t done = 0;
+  uint32_t silent = 0;      // Niet uitgevoerd en niet opgegeven door de zender
+  std::vector<float> latMs;
+  float prioMaxMs = 0;
+  uint32_t prioSent = 0;
+  uint32_t prioDone = 0;
+};
+
+static void collect(const Node& from, CmdResult& r) {
+  uint32_t notDone = 0;
+  for (const auto& kv : from.sentCmds) {
+    const Command& c = kv.second;
+    r.sent++;
+    if (c.priority) r.prioSent++;
+    if (c.execUs < 0) {
+      notDone++;
+      continue;
+    }
+    float ms = (c.execUs - c.sentUs) / 1000.0f;
+    r.done++;
+    r.latMs.push_back(ms);
+    if (c.priority) {
+      r.prioDone++;
+      r.prioMaxMs = std::max(r.prioMaxMs, ms);
+    }
+  }
+  if (notDone > from.rel.stats.dropped) r.silent += notDone - from.rel.stats.dropped;
+}
+
+static void runScenario(const Scenario& sc, uint32_t seed) {
+  printf("Scenario %s\n", sc.name);
+  rng.seed(seed);
+  simUs = 0;
+  eventOrder = 0;
+  while (!events.empty()) events.pop();
+
+  // HoofdESP draait al langer dan de Body, kristallen wijken ±tientallen ppm af
+  initNode(body, 0, "Body", 4000000, +25.0, 10000, sc.bodyStallEveryMs, sc.bodyStallMs, sc.link);
+  initNode(hooft, 1, "HoofdESP", 12000000, -15.0, 5000, sc.hooftStallEveryMs, sc.hooftStallMs, sc.link);
+
+  bodyApp = BodyApp();
+  espnowSync_reset(bodyApp.clock);
+  espnowPub_init(bodyApp.aiPub, AI_CMD_MIN_GAP_MS, AI_CMD_MIN_GAP_MS, AI_CMD_KEEPALIVE_MS);
+  bodyApp.mismatchSinceUs = -1;
+  bodyApp.lastTrust = -1.0f;
+  bodyApp.nextStopUs = poissonUs(15000);
+
+  hooftApp = HooftApp();
+  espnowPub_init(hooftApp.pub, BODY_ESP_MIN_GAP, BODY_ESP_UPDATE_INTERVAL, BODY_ESP_KEEPALIVE);
+  hooftApp.nextOrgasmUs = poissonUs(20000);
+
+  trafficOn = true;
+  schedule(0, EV_LOOP, 0);
+  schedule(1234, EV_LOOP, 1);
+  const int64_t endUs = (int64_t)(RUN_MS + DRAIN_MS) * 1000;
+  while (!events.empty() && events.top().atUs <= endUs) {
+    Event ev = events.top();
+    events.pop();
+    simUs = ev.atUs;
+    if (trafficOn && simUs >= (int64_t)RUN_MS * 1000) trafficOn = false;
+    onEvent(ev);
+  }
+  if (bodyApp.mismatchSinceUs >= 0) bodyApp.mismatchMs.push_back((simUs - bodyApp.mismatchSinceUs) / 1000.0f);
+
+  CmdResult up, down;      // Body → HoofdESP, HoofdESP → Body
+  collect(body, up);
+  collect(hooft, down);
+
+  for (int dir = 0; dir < 2; dir++) {
+    const CmdResult& r = dir ? down : up;
+    const Node& from = dir ? hooft : body;
+    const Node& to = dir ? body : hooft;
+    const Direction& d = from.tx;
+    float delivered = r.sent ? (float)r.done / r.sent : 1.0f;
+    float actualLoss = d.frames ? (float)(d.lost + espnowRx_dropped(to.rxq) + espnowRx_dropped(to.rxPrio)) / d.frames : 0;
+    float estLoss = to.link.rxFrames ? (float)to.link.rxLost / (to.link.rxLost + to.link.rxFrames) : 0;
+
+    printf("  %s → %s: %u frames (%llu bytes, %.0f B/s), lucht verlies %u, volgorde %u, queue vol %u/%u\n",
+           from.name, to.name, d.frames, (unsigned long long)d.bytes, d.bytes * 1000.0 / (RUN_MS + DRAIN_MS),
+           d.lost, d.reordered, to.rxq.overflows, to.rxPrio.overflows);
+    printf("    kritiek %u/%u uitgevoerd (%.2f%%), p50 %.1f p99 %.1f max %.1f ms, herhaald %u, opgegeven %u\n",
+           r.done, r.sent, delivered * 100.0f, percentile(r.latMs, 50), percentile(r.latMs, 99),
+           percentile(r.latMs, 100), from.rel.stats.retried, from.rel.stats.dropped);
+    printf("    voorrang %u/%u, slechtst %.1f ms | dubbel uitgevoerd %u | verlies echt %.1f%% geschat %.1f%%\n",
+           r.prioDone, r.prioSent, r.prioMaxMs, to.dupExecs, actualLoss * 100.0f, estLoss * 100.0f);
+
+    CHECK(to.dupExecs == 0, "%s: %u commando's dubbel uitgevoerd", sc.name, to.dupExecs);
+    CHECK(r.silent == 0, "%s: %u commando's stil kwijt (niet uitgevoerd, niet opgegeven)", sc.name, r.silent);
+    CHECK(from.rel.txSeq == r.sent, "%s: %s → %s kritieke reeks %u volgnummers voor %u frames", sc.name,
+          from.name, to.name, from.rel.txSeq, r.sent);
+    CHECK(sc.giveUpOk || from.rel.stats.dropped == 0, "%s: %s → %s %u kritieke frames opgegeven", sc.name, from.name,
+          to.name, from.rel.stats.dropped);
+    CHECK(espnowRel_outstanding(from.rel) == 0, "%s: %d frames nog open na de drain", sc.name,
+          espnowRel_outstanding(from.rel));
+    CHECK(delivered >= sc.minDelivered, "%s: %s → %s levering %.2f%% < %.2f%%", sc.name, from.name, to.name,
+          delivered * 100.0f, sc.minDelivered * 100.0f);
+    CHECK(percentile(r.latMs, 99) <= sc.maxP99Ms, "%s: %s → %s p99 %.1f ms > %.1f ms", sc.name, from.name,
+          to.name, percentile(r.latMs, 99), sc.maxP99Ms);
+    CHECK(r.prioDone == r.prioSent, "%s: %s → %s voorrang %u/%u", sc.name, from.name, to.name,
+          r.prioDone, r.prioSent);
+    CHECK(r.prioMaxMs <= sc.maxPrioMs, "%s: %s → %s voorrang %.1f ms > %.1f ms", sc.name, from.name,
+          to.name, r.prioMaxMs, sc.maxPrioMs);
+    CHECK(fabsf(estLoss - actualLoss) <= 0.02f + 0.5f * actualLoss,
+          "%s: %s verlies schatting %.1f%% past niet bij %.1f%%", sc.name, to.name,
+          estLoss * 100.0f, actualLoss * 100.0f);
+    if (sc.expectOverflow && dir == 1) {
+      CHECK(to.rxq.overflows > 0, "%s: stall liet de Body queue niet vollopen", sc.name);
+    }
+  }
+
+  const HooftApp& h = hooftApp;
+  printf("  status: %u full, %u delta, afwijking p50 %.0f p99 %.0f max %.0f ms (%zu keer)\n",
+         h.pub.fullSent, h.pub.deltaSent, percentile(bodyApp.mismatchMs, 50),
+         percentile(bodyApp.mismatchMs, 99), percentile(bodyApp.mismatchMs, 100), bodyApp.mismatchMs.size());
+  CHECK(percentile(bodyApp.mismatchMs, 100) <= sc.maxStatusMs, "%s: status week %.0f ms af > %.0f ms",
+        sc.name, percentile(bodyApp.mismatchMs, 100), sc.maxStatusMs);
+
+  // Laatste AI commando moet op de HoofdESP staan (tenzij opgegeven)
+  printf("  AI: HoofdESP trust %.2f, Body %.2f, %u oudere AI_OVERRIDE na een nieuwere\n",
+         h.aiTrust, bodyApp.lastTrust, h.aiStale);
+  CHECK(fabsf(h.aiTrust - bodyApp.lastTrust) < 0.001f || body.rel.stats.dropped > 0,
+        "%s: HoofdESP trust %.2f, Body stuurde %.2f", sc.name, h.aiTrust, bodyApp.lastTrust);
+
+  const EspNowClockSync& sync = bodyApp.clock;
+  double meanErr = bodyApp.syncSamples ? bodyApp.syncErrSumUs / bodyApp.syncSamples : 0;
+  double meanBound = bodyApp.syncSamples ? bodyApp.syncBoundSumUs / bodyApp.syncSamples : 0;
+  float outside = bodyApp.syncSamples ? (float)bodyApp.syncOutside / bodyApp.syncSamples : 1.0f;
+  printf("  sync: fout gem %.0f max %.0f µs, grens gem %.0f µs, %.2f%% buiten grens, drift %.1f ppm (echt %.1f)\n",
+         meanErr, bodyApp.syncErrMaxUs, meanBound, outside * 100.0f, sync.driftPpm,
+         (hooft.driftPpm - body.driftPpm));
+  CHECK(bodyApp.syncSamples > 0, "%s: Body nooit gesynchroniseerd", sc.name);
+  CHECK(outside <= 0.01f, "%s: %.2f%% van de tijd buiten de sync fout grens", sc.name, outside * 100.0f);
+  CHECK(bodyApp.syncErrMaxUs <= 10000, "%s: sync fout %.0f µs > 10 ms", sc.name, bodyApp.syncErrMaxUs);
+}
+
+// ===== Benchmark =====
+
+template <typename Fn>
+static double nsPer(int n, Fn fn) {
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; i++) fn(i);
+  auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+}
+
+static volatile uint32_t sink;
+
+static void benchmark() {
+  const int N = 1000000;
+  printf("Benchmark (host, ns per frame)\n");
+
+  EspNowFrame frame, decoded;
+  memset(&frame, 0, sizeof(frame));
+  frame.ai.trust_x1000 = 1000;
+  uint8_t buf[ESPNOW_MAX_FRAME];
+  double codec = nsPer(N, [&](int i) {
+    frame.ai.trust_x1000 = (int16_t)i;
+    uint8_t len = espnow_encode(frame, ESPNOW_OP_AI_OVERRIDE, (uint16_t)i, i, false, buf);
+    sink += espnow_decode(buf, len, decoded) + decoded.ai.trust_x1000;
+  });
+
+  EspNowStatusPayload a, b, rx;
+  memset(&a, 0, sizeof(a));
+  memset(&b, 0, sizeof(b));
+  memset(&rx, 0, sizeof(rx));
+  double delta = nsPer(N, [&](int i) {
+    a.sleevePct_x10 = (uint16_t)(i & 1023);
+    a.speedStep = (uint8_t)(i >> 10) & 7;
+    uint16_t mask = espnow_statusDiff(a, b, BODY_STATUS_DEADBAND);
+    espnow_buildStatusDelta(frame, a, espnow_statusDiff(a, b, nullptr));
+    sink += espnow_applyStatusDelta(frame, rx) + mask;
+    b = a;
+  });
+
+  EspNowReliable rel;
+  espnowRel_reset(rel);
+  EspNowHeader hdr;
+  memset(&hdr, 0, sizeof(hdr));
+  hdr.flags = ESPNOW_FLAG_ACK_REQ;
+  double dedup = nsPer(N, [&](int i) {
+    hdr.seq = (uint16_t)(i - (i & 3));   // Elk volgnummer 4x: 3 duplicaten
+    hdr.timeMs = i / 100;
+    sink += espnowRel_onReceive(rel, hdr);
+  });
+
+  static EspNowRxQueue q;
+  memset(&q, 0, sizeof(q));
+  static const uint8_t mac[6] = { 0 };
+  EspNowRxItem item = {};
+  double queue = nsPer(N, [&](int i) {
+    espnowRx_push(q, mac, buf, 16, -60, i);
+    sink += espnowRx_pop(q, item) + item.len;
+  });
+
+  printf("  encode+decode AI_OVERRIDE  %6.1f ns\n", codec);
+  printf("  status diff+delta+apply    %6.1f ns\n", delta);
+  printf("  duplicaat filter           %6.1f ns\n", dedup);
+  printf("  rx queue push+pop          %6.1f ns\n", queue);
+}
+
+int main() {
+  //             latency jitter verlies  storing  goed   storing volgorde sendFail
+  //                    µs     µs  goed     verlies  ms     ms      %
+  static const Scenario scenarios[] = {
+    { "ideaal",  { 1500,     0, 0.00f, 0.00f,    0,   0, 0.0f, false }, 0, 0, 0, 0,
+                 1.0f,   30.0f,  30.0f,  100.0f, false, false },
+    // Zelfde als de firmware netem test (NETEM_CONFIG = { 10, 5, 10, 5 })
+    { "netem",   { 5000, 10000, 0.10f, 0.10f,    0,   0, 5.0f, false }, 0, 0, 0, 0,
+                 0.999f, 150.0f, 200.0f, 2500.0f, false, false },
+    // Storingen van gem. 150 ms (80% verlies): het herhaalbudget (~1.4 s,
+    // MAC fouten apart) overbrugt een storing, niets wordt opgegeven
+    { "burst",   { 2000,  2000, 0.01f, 0.80f, 3000, 150, 1.0f, true  }, 0, 0, 0, 0,
+                 1.0f,   500.0f, 450.0f, 2500.0f, false, false },
+    // Body blokkeert 1.5 s elke 20 s (ML training / SD), HoofdESP 150 ms elke
+    // 7 s (BLE): Body queue loopt vol, voorrang wacht in zijn eigen queue.
+    // Voorrang geeft na ~400 ms op terwijl de Body nog stilstaat; het frame
+    // wordt daarna wel uitgevoerd (stil kwijt blijft 0)
+    { "stall",   { 2000,  2000, 0.02f, 0.02f,    0,   0, 1.0f, true  }, 20000, 1500, 7000, 150,
+                 0.99f, 1600.0f, 1600.0f, 2500.0f, true,  true  },
+  };
+
+  uint32_t seed = 1;
+  for (const Scenario& sc : scenarios) runScenario(sc, seed++);
+  benchmark();
+
+  printf(failures ? "espnow_link_sim: %d FOUT(EN)\n" : "espnow_link_sim: OK\n", failures);
+  return failures ? 1 : 0;
+}
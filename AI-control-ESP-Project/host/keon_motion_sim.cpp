@@ -0,0 +1,391 @@
+/*
+  keon_motion_sim - Keon motion engine tegen de mock (HoofdESP keon_motion.cpp)
+
+  ═══════════════════════════════════════════════════════════════════════════
+  De echte keon_motion.cpp + stroker_device.cpp, met StrokerMockDevice
+  (stroker_mock.h) als actief device. Gesimuleerde klok, zelfde lus als de
+  Keon task: elke 5 ms keonMotion_tick() en daarna service() van het device.
+
+  Twee fouten naast elkaar, in posities (0-99):
+    engine   |script - schaduw model|  keonMotion_getStats(), wat de
+             HoofdESP logt. Het schaduw model krijgt de eigen commando's:
+             dit meet of de planning haalbaar is, niet waar het device is
+    device   |script - mock simPos()|  de mock heeft een andere air tijd
+             dan de caps (35 vs 30 ms), dus dit laat zien wat de engine
+             zelf niet kan zien
+
+  Scenario's:
+    gemengd   funscript met segmenten van 150-700 ms (pushScript in stukken)
+    L5        volle slagen 0↔99 op het L5 tempo, als script
+    live      dezelfde gemengde acties één voor één binnen, zoals
+              ESPNOW_OP_FUNSCRIPT_ACTION (espnow_comm.cpp): sessie tijd +
+              KEON_MOTION_SCRIPT_DELAY_MS, radio vertraging 2-15 ms. Daarna
+              stil → engine valt terug (KEON_MOTION_SCRIPT_HOLD_MS)
+    level     LEVEL bron per level: gemeten slag tempo van de mock tegen
+              keonGetStrokeFrequency(), geen geclipte slagen, slag lengte
+              tegen keonKin_reach()
+
+  Grenzen (engine fout gem): gemengd < 7, level < 12. Het L5 script (volle
+  slagen) is fysiek niet haalbaar: daar alleen een ruime grens en clipped.
+
+  Overal ook de tijdlijn (animatie + sleeve % naar de Body ESP): elke 20 ms
+  een frame met keonMotion_predictPos(nu + KEON_MOTION_DISPLAY_MS), zoals
+  keonTimelineStroke01() in ui.cpp, en op het moment dat dat frame op het
+  scherm staat vergeleken met de mock.
+  ═══════════════════════════════════════════════════════════════════════════
+*/
+
+#include <Arduino.h>
+#include <random>
+#include <vector>
+
+#include "keon_kinematics.h"
+#include "keon_motion.h"
+#include "keon_ble.h"
+#include "stroker_device.h"
+#include "stroker_mock.h"
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                          \
+  do {                                            \
+    if (!(cond)) {                                \
+      failures++;                                 \
+      printf("  FOUT %s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__);                        \
+      printf("\n");                               \
+    }                                             \
+  } while (0)
+
+// keon_ble.cpp heeft BLE nodig en bouwt niet op de PC: kopie van de
+// actieve frequentie tabel daar (/1.09)
+float keonGetStrokeFrequency(uint8_t level) {
+  if (level > 7) level = 7;
+  const float frequencies[8] = {
+    0.489f, 0.917f, 1.147f, 1.330f, 1.450f, 1.578f, 1.679f, 1.835f
+  };
+  return frequencies[level];
+}
+
+static const uint32_t TASK_MS = 5;      // vTaskDelay in keonTask()
+// Animatie vs device, gem posities. De mock beweegt 13 ms later dan de
+// tijdlijn aanneemt (write 8 ms na de done callback, air 35 i.p.v. 30 ms):
+// bij volle slagen is dat ~3 posities
+static const float TIMELINE_MAX_AVG = 5.0f;
+
+static StrokerMockDevice* mock = nullptr;
+
+// ===== Fout =====
+
+struct ErrStats {
+  uint32_t n = 0;
+  double sumAbs = 0.0;
+  double sumSq = 0.0;
+  float max = 0.0f;
+
+  void add(float err) {
+    err = fabsf(err);
+    n++;
+    sumAbs += err;
+    sumSq += (double)err * err;
+    if (err > max) max = err;
+  }
+  float avg() const { return n ? (float)(sumAbs / n) : 0.0f; }
+  float rms() const { return n ? sqrtf((float)(sumSq / n)) : 0.0f; }
+};
+
+// Animatie frames: voorspelling van de tijdlijn tegen de mock op het
+// moment dat het frame zichtbaar is. Zelfde aanroep als keonTimelineStroke01()
+// (ui.cpp), daar gedeeld door 99 voor de sleeve stand 0..1
+struct TimelineProbe {
+  static const uint32_t FRAME_MS = 20;
+  struct Frame { uint32_t shownMs; float pos; };
+
+  std::vector<Frame> pending;
+  ErrStats err;
+  uint32_t frames = 0;
+  uint32_t missing = 0;       // Engine actief maar geen tijdlijn → animatie valt terug op phase
+  uint32_t nextFrameMs = 0;
+
+  void reset() { *this = TimelineProbe(); }
+
+  void step(uint32_t nowMs) {
+    size_t keep = 0;
+    for (const Frame& f : pending) {
+      if ((int32_t)(nowMs - f.shownMs) >= 0) err.add(f.pos - mock->simPos(nowMs));
+      else pending[keep++] = f;
+    }
+    pending.resize(keep);
+
+    if ((int32_t)(nowMs - nextFrameMs) < 0 || keonMotion_source() == KEON_MOTION_IDLE) return;
+    nextFrameMs = nowMs + FRAME_MS;
+    frames++;
+    float pos;
+    if (keonMotion_predictPos(nowMs + KEON_MOTION_DISPLAY_MS, pos)) pending.push_back({nowMs + KEON_MOTION_DISPLAY_MS, pos});
+    else missing++;
+  }
+};
+
+static TimelineProbe timelineProbe;
+
+// ===== Script =====
+
+// Script positie op t (lineair tussen acties, absolute tijden). false = buiten het script
+static bool scriptPosAt(const std::vector<KeonWaypoint>& script, uint32_t t, float& pos) {
+  for (size_t i = 0; i + 1 < script.size(); i++) {
+    const KeonWaypoint& a = script[i];
+    const KeonWaypoint& b = script[i + 1];
+    if ((int32_t)(t - a.atMs) < 0 || (int32_t)(t - b.atMs) >= 0) continue;
+    float f = (float)(t - a.atMs) / (float)(b.atMs - a.atMs);
+    pos = a.pos + f * ((float)b.pos - a.pos);
+    return true;
+  }
+  return false;
+}
+
+// Funscript met afwisselend omhoog / omlaag, segmenten minSeg..maxSeg ms
+static std::vector<KeonWaypoint> mixedScript(std::mt19937& rng, uint32_t durationMs, uint32_t minSeg, uint32_t maxSeg) {
+  std::uniform_int_distribution<uint32_t> seg(minSeg, maxSeg);
+  std::uniform_int_distribution<int> amp(20, 99);
+  std::vector<KeonWaypoint> script;
+  uint32_t t = 0;
+  int pos = 0;
+  bool up = true;
+  script.push_back({0, 0});
+  while (t < durationMs) {
+    t += seg(rng);
+    pos = up ? std::min(99, pos + amp(rng)) : std::max(0, pos - amp(rng));
+    script.push_back({t, (uint8_t)pos});
+    up = !up;
+  }
+  return script;
+}
+
+static std::vector<KeonWaypoint> levelScript(uint8_t level, uint32_t durationMs) {
+  uint32_t halfMs = (uint32_t)(500.0f / keonGetStrokeFrequency(level));
+  std::vector<KeonWaypoint> script;
+  bool high = false;
+  for (uint32_t t = 0; t <= durationMs; t += halfMs) {
+    script.push_back({t, (uint8_t)(high ? KEON_MOTION_STROKE_HIGH : KEON_MOTION_STROKE_LOW)});
+    high = !high;
+  }
+  return script;
+}
+
+// Eén Keon task ronde
+static void taskStep() {
+  shim_advanceMs(TASK_MS);
+  keonMotion_tick(millis());
+  mock->service();
+  timelineProbe.step(millis());
+}
+
+static void runIdle(uint32_t ms) {
+  for (uint32_t t = 0; t < ms; t += TASK_MS) taskStep();
+}
+
+struct RunResult {
+  ErrStats device;
+  TimelineProbe timeline;
+  KeonMotionStats engine;
+  uint32_t issued;
+  uint32_t skipped;
+  uint32_t clipped;
+  uint32_t overflow;
+};
+
+static void printResult(const char* name, const RunResult& r) {
+  printf("  %-8s engine gem %5.1f rms %5.1f max %5.1f | device gem %5.1f rms %5.1f max %5.1f | "
+         "cmd %lu overgeslagen %lu clipped %lu\n"
+         "           tijdlijn gem %5.2f rms %5.2f max %5.1f (%lu frames, %lu zonder tijdlijn)\n",
+         name, r.engine.trackAvg, r.engine.trackRms, r.engine.trackMax,
+         r.device.avg(), r.device.rms(), r.device.max,
+         (unsigned long)r.issued, (unsigned long)r.skipped, (unsigned long)r.clipped,
+         r.timeline.err.avg(), r.timeline.err.rms(), r.timeline.err.max,
+         (unsigned long)r.timeline.frames, (unsigned long)r.timeline.missing);
+}
+
+// Script (relatieve tijden) afspelen. live = acties één voor één binnen
+// zoals ESP-NOW frames, anders in stukken via keonMotion_pushScript()
+static RunResult runScript(const std::vector<KeonWaypoint>& rel, bool live, std::mt19937& rng) {
+  KeonMotionStats before = keonMotion_getStats();
+  keonMotion_start(KEON_MOTION_SCRIPT);
+  keonMotion_resetTracking();
+  timelineProbe.reset();
+
+  uint32_t startMs = millis() + KEON_MOTION_SCRIPT_DELAY_MS;
+  std::vector<KeonWaypoint> script;
+  for (const KeonWaypoint& w : rel) script.push_back({startMs + w.atMs, w.pos});
+
+  std::uniform_int_distribution<uint32_t> radioMs(2, 15);
+  std::vector<uint32_t> arriveMs;
+  for (const KeonWaypoint& w : script) arriveMs.push_back(w.atMs - KEON_MOTION_SCRIPT_DELAY_MS + radioMs(rng));
+
+  RunResult r;
+  size_t next = 0;
+  uint32_t endMs = script.back().atMs + 200;
+  while ((int32_t)(millis() - endMs) < 0) {
+    if (live) {
+      while (next < script.size() && (int32_t)(millis() - arriveMs[next]) >= 0) {
+        // Zelfde mapping als espnow_comm.cpp: Body stuurt sleeve = positie / 50
+        float sleeve = (script[next].pos * 100 / 99) / 50.0f;
+        float posF = constrain(sleeve * 50.0f, 0.0f, 100.0f);
+        uint8_t pos = (uint8_t)(posF * 99.0f / 100.0f + 0.5f);
+        CHECK(keonMotion_push(script[next].atMs, pos), "live actie %u geweigerd", (unsigned)next);
+        next++;
+      }
+    } else if (next < script.size()) {
+      uint16_t n = (uint16_t)std::min<size_t>(keonMotion_free(), script.size() - next);
+      next += keonMotion_pushScript(&rel[next], n, startMs);
+    }
+    taskStep();
+    float ref;
+    if (scriptPosAt(script, millis(), ref)) r.device.add(ref - mock->simPos(millis()));
+  }
+
+  r.engine = keonMotion_getStats();
+  r.timeline = timelineProbe;
+  r.issued = r.engine.issued - before.issued;
+  r.skipped = r.engine.skipped - before.skipped;
+  r.clipped = r.engine.clipped - before.clipped;
+  r.overflow = r.engine.overflow - before.overflow;
+  return r;
+}
+
+// ===== Scenario's =====
+
+static void scenarioScripts() {
+  printf("\n== Funscript (SCRIPT bron) ==\n");
+  std::mt19937 rng(45);
+  std::vector<KeonWaypoint> mixed = mixedScript(rng, 60000, 150, 700);
+
+  RunResult batch = runScript(mixed, false, rng);
+  printResult("gemengd", batch);
+  CHECK(batch.overflow == 0, "gemengd: %lu waypoints geweigerd", (unsigned long)batch.overflow);
+  CHECK(batch.device.avg() < 7.0f, "gemengd: device fout gem %.1f", batch.device.avg());
+  CHECK(batch.engine.trackAvg < 7.0f, "gemengd: engine fout gem %.1f", batch.engine.trackAvg);
+  CHECK(batch.timeline.err.avg() < TIMELINE_MAX_AVG, "gemengd: tijdlijn fout gem %.2f", batch.timeline.err.avg());
+  keonMotion_stop();
+  runIdle(1000);
+
+  RunResult l5 = runScript(levelScript(5, 30000), false, rng);
+  printResult("L5", l5);
+  // 0↔99 in 317 ms is sneller dan het model kan (348 ms): het script zelf
+  // is niet haalbaar, slag wordt korter. Level bron doet dat wel goed
+  CHECK(l5.clipped > 0, "L5: geen clipped slagen, model sneller dan verwacht");
+  CHECK(l5.device.avg() < 25.0f, "L5: device fout gem %.1f", l5.device.avg());
+  // Tijdlijn volgt het device, ook als dat het script niet haalt
+  CHECK(l5.timeline.err.avg() < TIMELINE_MAX_AVG, "L5: tijdlijn fout gem %.2f", l5.timeline.err.avg());
+  keonMotion_stop();
+  runIdle(1000);
+
+  RunResult live = runScript(mixed, true, rng);
+  printResult("live", live);
+  // Live mag niet merkbaar slechter zijn dan alles vooraf in de rij
+  CHECK(live.device.avg() < batch.device.avg() + 1.0f, "live: device fout gem %.1f (vooraf %.1f)",
+        live.device.avg(), batch.device.avg());
+  CHECK(live.skipped <= batch.skipped + 2, "live: %lu overgeslagen (vooraf %lu)",
+        (unsigned long)live.skipped, (unsigned long)batch.skipped);
+
+  // Body stopt met sturen → na de hold tijd terug naar de level slagen / idle
+  KeonMotionSource fallback = KEON_MOTION_LEVEL_WAYPOINTS ? KEON_MOTION_LEVEL : KEON_MOTION_IDLE;
+  runIdle(KEON_MOTION_SCRIPT_HOLD_MS / 2);
+  CHECK(keonMotion_source() == KEON_MOTION_SCRIPT, "script al beëindigd binnen de hold tijd");
+  runIdle(KEON_MOTION_SCRIPT_HOLD_MS);
+  CHECK(keonMotion_source() == fallback, "na de hold tijd bron %u, verwacht %u",
+        keonMotion_source(), fallback);
+
+  // Level mode zoals geconfigureerd: IDLE = geen tijdlijn, animatie loopt
+  // dan op een eigen klok naast de Keon (ui.cpp keonTimelineStroke01())
+  CHECK(fallback == KEON_MOTION_LEVEL, "level mode zonder tijdlijn (KEON_MOTION_LEVEL_WAYPOINTS 0)");
+  keonMotion_setLevel(3);
+  timelineProbe.reset();
+  runIdle(10000);
+  printf("  level na script: tijdlijn gem %.2f max %.1f (%lu frames, %lu zonder tijdlijn)\n",
+         timelineProbe.err.avg(), timelineProbe.err.max, (unsigned long)timelineProbe.frames,
+         (unsigned long)timelineProbe.missing);
+  CHECK(timelineProbe.frames > 400 && timelineProbe.missing == 0, "level na script: %lu frames, %lu zonder tijdlijn",
+        (unsigned long)timelineProbe.frames, (unsigned long)timelineProbe.missing);
+  CHECK(timelineProbe.err.avg() < TIMELINE_MAX_AVG, "level na script: tijdlijn fout gem %.2f",
+        timelineProbe.err.avg());
+
+  printf("  device - engine: gemengd %+.1f, L5 %+.1f posities (air tijd mock 35 ms, caps 30 ms)\n",
+         batch.device.avg() - batch.engine.trackAvg, l5.device.avg() - l5.engine.trackAvg);
+  keonMotion_stop();
+  runIdle(1000);
+}
+
+// LEVEL bron: slagen van de mock tellen (door 50 met hysterese)
+static void scenarioLevels() {
+  printf("\n== Level slagen (LEVEL bron) ==\n");
+  const uint32_t RUN_MS = 20000;
+  keonMotion_start(KEON_MOTION_LEVEL);
+  for (uint8_t level = 0; level < 8; level++) {
+    keonMotion_setLevel(level);
+    runIdle(2000);   // Inlopen op het nieuwe tempo
+    KeonMotionStats before = keonMotion_getStats();
+    keonMotion_resetTracking();
+    timelineProbe.reset();
+
+    uint32_t cycles = 0;
+    uint32_t firstMs = 0;
+    uint32_t lastMs = 0;
+    bool low = mock->simPos(millis()) < 40.0f;
+    float minPos = 99.0f;
+    float maxPos = 0.0f;
+    for (uint32_t t = 0; t < RUN_MS; t += TASK_MS) {
+      taskStep();
+      float p = mock->simPos(millis());
+      minPos = std::min(minPos, p);
+      maxPos = std::max(maxPos, p);
+      if (low && p > 60.0f) {
+        low = false;
+        if (!firstMs) firstMs = millis();
+        else cycles++;
+        lastMs = millis();
+      } else if (!low && p < 40.0f) {
+        low = true;
+      }
+    }
+    KeonMotionStats st = keonMotion_getStats();
+    float want = keonGetStrokeFrequency(level);
+    float hz = (cycles && lastMs != firstMs) ? cycles * 1000.0f / (lastMs - firstMs) : 0.0f;
+    const TimelineProbe& tl = timelineProbe;
+    printf("  L%u  %.3f Hz (doel %.3f)  slag %4.1f-%4.1f  engine gem %5.1f max %5.1f  clipped %lu/%lu  "
+           "tijdlijn gem %4.2f max %4.1f\n",
+           level, hz, want, minPos, maxPos, st.trackAvg, st.trackMax,
+           (unsigned long)(st.clipped - before.clipped), (unsigned long)(st.issued - before.issued),
+           tl.err.avg(), tl.err.max);
+    CHECK(fabsf(hz - want) < 0.05f * want, "L%u: tempo %.3f Hz, doel %.3f", level, hz, want);
+    // Slag: wat het model in een halve periode haalt (keon_motion.cpp); de
+    // snelheid stappen ronden af, dus 90% daarvan
+    const StrokerCaps& caps = mock->caps();
+    KeonKinModel model = {caps.maxUnitsPerSec, caps.accelUps2};
+    float reach = keonKin_reach(model, (uint32_t)(500.0f / want * KEON_MOTION_LEVEL_MARGIN));
+    float wantStroke = std::min(reach, (float)(KEON_MOTION_STROKE_HIGH - KEON_MOTION_STROKE_LOW));
+    CHECK(maxPos - minPos > 0.9f * wantStroke, "L%u: slag %.1f posities, haalbaar %.1f", level, maxPos - minPos,
+          wantStroke);
+    CHECK(st.clipped == before.clipped, "L%u: %lu slagen geclipt", level, (unsigned long)(st.clipped - before.clipped));
+    CHECK(st.trackAvg < 12.0f, "L%u: engine fout gem %.1f", level, st.trackAvg);
+    CHECK(tl.err.avg() < TIMELINE_MAX_AVG, "L%u: tijdlijn fout gem %.2f", level, tl.err.avg());
+    CHECK(tl.missing == 0, "L%u: %lu frames zonder tijdlijn", level, (unsigned long)tl.missing);
+  }
+  keonMotion_stop();
+  runIdle(1000);
+}
+
+int main() {
+  shim_setManualClock(true);
+  shim_setMicros(1000000);
+  shim_setSerialQuiet(true);
+
+  mock = static_cast<StrokerMockDevice*>(strokerMockDevice());
+  strokerSelect(mock);
+  runIdle(100);
+
+  scenarioScripts();
+  scenarioLevels();
+
+  printf(failures ? "keon_motion_sim: %d FOUT(EN)\n" : "keon_motion_sim: OK\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,145 @@
+/*
+  ml_codegen - Host generator voor ml_compiled_model.h
+
+  ═══════════════════════════════════════════════════════════════════════════
+  Zelfde mlCodegen_writeHeader() als op de Body, maar op de PC:
+
+    ml_codegen <model.bin> <ml_compiled_model.h>
+      model.bin (/ml_training op de SD kaart) → C++ header
+
+    ml_codegen --demo <map>
+      Traint een boom op een synthetische dataset en schrijft
+      <map>/model.bin + <map>/parity.csv (zelfde formaat als de Body
+      schrijft), zodat `make ml-parity` zonder SD kaart draait
+  ═══════════════════════════════════════════════════════════════════════════
+*/
+
+#include <Arduino.h>
+#include <SD_MMC.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "ml_decision_tree.h"
+#include "ml_model_codegen.h"
+
+namespace stdfs = std::filesystem;
+
+static bool readHostFile(const std::string& path, String& out) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) return false;
+  std::stringstream buf;
+  buf << in.rdbuf();
+  out = String(buf.str());
+  return true;
+}
+
+static bool writeHostFile(const std::string& path, const String& data) {
+  std::ofstream out(path, std::ios::binary);
+  if (!out) return false;
+  out << data.c_str();
+  return (bool)out;
+}
+
+// ===== Synthetische dataset =====
+
+// Stress level volgt vooral HR en GSR, met wat ruis op de grenzen
+static int demoLabel(const float raw[9]) {
+  float score = (raw[0] - 60.0f) / 20.0f + raw[2] / 1200.0f + raw[4] / 200.0f;
+  if (raw[7] > 0.5f) score += 0.5f;
+  return constrain((int)score + 1, 1, 7);
+}
+
+static int runDemo(const std::string& dir) {
+  stdfs::create_directories(dir);
+  randomSeed(1234);
+
+  std::vector<TrainingSample> samples;
+  String csv = "Time,HR,Temp,GSR,Adem,Trust,SleevePos,Suction,Vibe\n";
+
+  for (int i = 0; i < 600; i++) {
+    float raw[9];
+    raw[0] = 55 + random(0, 1200) / 10.0f;        // HR 55-175
+    raw[1] = 33 + random(0, 400) / 100.0f;        // Temp 33-37
+    raw[2] = random(0, 40950) / 10.0f;            // GSR
+    raw[3] = random(0, 1000) / 10.0f;             // Adem
+    raw[4] = random(0, 2550) / 10.0f;             // Trust
+    raw[5] = random(0, 1000) / 10.0f;             // SleevePos
+    raw[6] = random(0, 2550) / 10.0f;             // Suction
+    raw[7] = random(0, 2);                        // Vibe
+    raw[8] = i;                                   // Time (sec)
+
+    // Zelfde afronding als writeParityDataset() op de Body
+    char line[160];
+    snprintf(line, sizeof(line), "%.1f,%.1f,%.2f,%.1f,%.1f,%.2f,%.1f,%.1f,%.1f\n",
+             raw[8], raw[0], raw[1], raw[2], raw[3], raw[4], raw[5], raw[6], raw[7]);
+    csv += line;
+
+    TrainingSample sample;
+    memcpy(sample.features, raw, sizeof(raw));
+    sample.label = demoLabel(raw);
+    normalizeFeatures(sample.features);
+    samples.push_back(sample);
+  }
+
+  DecisionTree tree(8, 4);
+  if (!tree.train(samples)) {
+    fprintf(stderr, "Training mislukt\n");
+    return 1;
+  }
+
+  if (!writeHostFile(dir + "/model.bin", tree.serialize()) ||
+      !writeHostFile(dir + "/parity.csv", csv)) {
+    fprintf(stderr, "Kan niet schrijven naar %s\n", dir.c_str());
+    return 1;
+  }
+
+  printf("[DEMO] %s/model.bin + parity.csv (%zu samples)\n", dir.c_str(), samples.size());
+  return 0;
+}
+
+// ===== Model → header =====
+
+static int runCodegen(const std::string& modelPath, const std::string& outPath) {
+  String json;
+  if (!readHostFile(modelPath, json)) {
+    fprintf(stderr, "Kan %s niet lezen\n", modelPath.c_str());
+    return 1;
+  }
+
+  DecisionTree tree;
+  if (!tree.deserialize(json) || !tree.hasModel()) {
+    fprintf(stderr, "%s is geen geldig model\n", modelPath.c_str());
+    return 1;
+  }
+
+  // mlCodegen_writeHeader schrijft naar de "SD kaart": een staging map
+  stdfs::path out = stdfs::absolute(outPath);
+  stdfs::path staging = out.parent_path() / ".sd";
+  shim_setSdRoot(staging.string().c_str());
+
+  if (!mlCodegen_writeHeader(&tree)) return 1;
+
+  std::error_code ec;
+  stdfs::copy_file(staging.string() + ML_CODEGEN_PATH, out,
+                   stdfs::copy_options::overwrite_existing, ec);
+  stdfs::remove_all(staging, ec);
+  if (!stdfs::exists(out)) {
+    fprintf(stderr, "Kan %s niet schrijven\n", out.string().c_str());
+    return 1;
+  }
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  if (argc == 3 && strcmp(argv[1], "--demo") == 0) {
+    return runDemo(argv[2]);
+  }
+  if (argc == 3) {
+    return runCodegen(argv[1], argv[2]);
+  }
+
+  fprintf(stderr, "Gebruik: %s <model.bin> <ml_compiled_model.h>\n"
+                  "         %s --demo <map>\n", argv[0], argv[0]);
+  return 2;
+}
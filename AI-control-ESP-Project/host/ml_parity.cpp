@@ -0,0 +1,63 @@
+/*
+  ml_parity - Gegenereerde header tegen de interpreter (host)
+
+  ═══════════════════════════════════════════════════════════════════════════
+  Gebouwd met AI_USE_COMPILED_MODEL=1 en de net gegenereerde
+  ml_compiled_model.h op het include pad, dus precies de code die op de
+  Body in flash komt:
+
+    ml_parity <model.bin> <dataset.csv>
+
+  Draait mlCodegen_parityCheck() over de dataset (parity.csv van de Body
+  of een .aly/.csv opname). Exit 0 = geen enkel verschil.
+  ═══════════════════════════════════════════════════════════════════════════
+*/
+
+#include <Arduino.h>
+#include <SD_MMC.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "ml_decision_tree.h"
+#include "ml_model_codegen.h"
+
+#if !AI_USE_COMPILED_MODEL
+#error "ml_parity moet met -DAI_USE_COMPILED_MODEL=1 gebouwd worden"
+#endif
+#include "ml_compiled_model.h"
+
+namespace stdfs = std::filesystem;
+
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    fprintf(stderr, "Gebruik: %s <model.bin> <dataset.csv>\n", argv[0]);
+    return 2;
+  }
+
+  std::ifstream in(argv[1], std::ios::binary);
+  std::stringstream json;
+  json << in.rdbuf();
+
+  DecisionTree tree;
+  if (!in || !tree.deserialize(String(json.str())) || !tree.hasModel()) {
+    fprintf(stderr, "%s is geen geldig model\n", argv[1]);
+    return 1;
+  }
+
+  // Dataset pad rechtstreeks: SD root = bestandssysteem root
+  shim_setSdRoot("");
+  std::string dataset = stdfs::absolute(argv[2]).string();
+
+  ParityResult result;
+  bool ok = mlCodegen_parityCheck(&tree, dataset.c_str(), &result);
+
+  if (mlCodegen_modelHash(&tree) != ML_COMPILED_MODEL_HASH) {
+    fprintf(stderr, "Header is niet voor dit model gegenereerd\n");
+    return 1;
+  }
+
+  printf("[PARITY] %s: %u samples, %u verschillen\n",
+         ok ? "OK" : "FOUT", result.samples, result.mismatches);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,261 @@
+/*
+  Arduino.cpp - Host shim implementatie
+*/
+
+#include "Arduino.h"
+#include <chrono>
+#include <thread>
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         KLOK
+// ═══════════════════════════════════════════════════════════════════════════
+
+static bool manualClock = false;
+static uint64_t manualUs = 0;
+
+static uint64_t nowUs() {
+  if (manualClock) return manualUs;
+  static const auto start = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+           std::chrono::steady_clock::now() - start).count();
+}
+
+unsigned long millis() { return (unsigned long)(uint32_t)(nowUs() / 1000); }
+unsigned long micros() { return (unsigned long)(uint32_t)nowUs(); }
+
+void delay(unsigned long ms) { delayMicroseconds(ms * 1000); }
+
+void delayMicroseconds(unsigned int us) {
+  if (manualClock) {
+    manualUs += us;
+  } else {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+  }
+}
+
+void yield() {}
+
+void shim_setManualClock(bool manual) {
+  if (manual && !manualClock) manualUs = 0;
+  manualClock = manual;
+}
+
+void shim_setMicros(uint64_t us) { manualUs = us; }
+void shim_advanceUs(uint64_t us) { manualUs += us; }
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         OVERIG
+// ═══════════════════════════════════════════════════════════════════════════
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+static uint32_t rngState = 1;
+
+void randomSeed(unsigned long seed) { rngState = seed ? (uint32_t)seed : 1; }
+
+long random(long maxValue) {
+  if (maxValue <= 0) return 0;
+  // xorshift32: zelfde reeks op elk platform
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return (long)(rngState % (uint32_t)maxValue);
+}
+
+long random(long minValue, long maxValue) {
+  if (minValue >= maxValue) return minValue;
+  return minValue + random(maxValue - minValue);
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         STRING
+// ═══════════════════════════════════════════════════════════════════════════
+
+static std::string formatInteger(long long value, unsigned char base) {
+  if (base == 10) return std::to_string(value);
+  char buf[72];
+  const char* digits = "0123456789abcdef";
+  unsigned long long v = (unsigned long long)value;
+  int pos = sizeof(buf) - 1;
+  buf[pos] = '\0';
+  do {
+    buf[--pos] = digits[v % base];
+    v /= base;
+  } while (v && pos > 0);
+  return std::string(&buf[pos]);
+}
+
+String::String(int value, unsigned char base) : s(formatInteger(value, base)) {}
+String::String(unsigned int value, unsigned char base) : s(formatInteger(value, base)) {}
+String::String(long value, unsigned char base) : s(formatInteger(value, base)) {}
+String::String(unsigned long value, unsigned char base) : s(formatInteger((long long)value, base)) {}
+
+String::String(float value, unsigned int decimals) {
+  char buf[48];
+  snprintf(buf, sizeof(buf), "%.*f", (int)decimals, (double)value);
+  s = buf;
+}
+
+String::String(double value, unsigned int decimals) {
+  char buf[48];
+  snprintf(buf, sizeof(buf), "%.*f", (int)decimals, value);
+  s = buf;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+  size_t pos = s.find(c, from);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const String& str, unsigned int from) const {
+  size_t pos = s.find(str.s, from);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(char c) const {
+  size_t pos = s.rfind(c);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(const String& str) const {
+  size_t pos = s.rfind(str.s);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int from) const {
+  return substring(from, length());
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+  if (from > to) std::swap(from, to);
+  if (from >= s.size()) return String();
+  if (to > s.size()) to = s.size();
+  return String(s.substr(from, to - from));
+}
+
+bool String::startsWith(const String& prefix) const {
+  return s.compare(0, prefix.s.size(), prefix.s) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+  return s.size() >= suffix.s.size() &&
+         s.compare(s.size() - suffix.s.size(), suffix.s.size(), suffix.s) == 0;
+}
+
+bool String::equalsIgnoreCase(const String& other) const {
+  if (s.size() != other.s.size()) return false;
+  for (size_t i = 0; i < s.size(); i++) {
+    if (tolower((unsigned char)s[i]) != tolower((unsigned char)other.s[i])) return false;
+  }
+  return true;
+}
+
+void String::replace(const String& find, const String& with) {
+  if (find.s.empty()) return;
+  size_t pos = 0;
+  while ((pos = s.find(find.s, pos)) != std::string::npos) {
+    s.replace(pos, find.s.size(), with.s);
+    pos += with.s.size();
+  }
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+  if (index >= s.size()) return;
+  s.erase(index, count);
+}
+
+void String::trim() {
+  size_t start = 0;
+  while (start < s.size() && isspace((unsigned char)s[start])) start++;
+  size_t end = s.size();
+  while (end > start && isspace((unsigned char)s[end - 1])) end--;
+  s = s.substr(start, end - start);
+}
+
+void String::toLowerCase() {
+  for (char& c : s) c = (char)tolower((unsigned char)c);
+}
+
+void String::toUpperCase() {
+  for (char& c : s) c = (char)toupper((unsigned char)c);
+}
+
+void String::toCharArray(char* buf, unsigned int size) const {
+  if (!buf || size == 0) return;
+  strncpy(buf, s.c_str(), size - 1);
+  buf[size - 1] = '\0';
+}
+
+String operator+(const String& a, const String& b) { return String(a.s + b.s); }
+String operator+(const String& a, const char* b) { return String(a.s + (b ? b : "")); }
+String operator+(const char* a, const String& b) { return String(std::string(a ? a : "") + b.s); }
+String operator+(const String& a, char b) { return String(a.s + b); }
+String operator+(const String& a, int b) { return a + String(b); }
+String operator+(const String& a, unsigned int b) { return a + String(b); }
+String operator+(const String& a, long b) { return a + String(b); }
+String operator+(const String& a, unsigned long b) { return a + String(b); }
+String operator+(const String& a, float b) { return a + String(b); }
+String operator+(const String& a, double b) { return a + String(b); }
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                         PRINT / STREAM
+// ═══════════════════════════════════════════════════════════════════════════
+
+size_t Print::printf(const char* format, ...) {
+  char stackBuf[256];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(stackBuf, sizeof(stackBuf), format, args);
+  va_end(args);
+  if (len < 0) return 0;
+
+  if ((size_t)len < sizeof(stackBuf)) {
+    return write((const uint8_t*)stackBuf, len);
+  }
+
+  std::string big(len + 1, '\0');
+  va_start(args, format);
+  vsnprintf(&big[0], big.size(), format, args);
+  va_end(args);
+  return write((const uint8_t*)big.data(), len);
+}
+
+String Stream::readStringUntil(char terminator) {
+  String out;
+  int c;
+  while ((c = read()) >= 0 && c != terminator) {
+    out += (char)c;
+  }
+  return out;
+}
+
+String Stream::readString() {
+  String out;
+  int c;
+  while ((c = read()) >= 0) {
+    out += (char)c;
+  }
+  return out;
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+  size_t n = 0;
+  int c;
+  while (n < length && (c = read()) >= 0) {
+    buffer[n++] = (char)c;
+  }
+  return n;
+}
+
+static bool serialQuiet = false;
+
+void shim_setSerialQuiet(bool quiet) { serialQuiet = quiet; }
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  if (serialQuiet) return size;
+  return fwrite(buffer, 1, size, stdout);
+}
+
+HardwareSerial Serial;
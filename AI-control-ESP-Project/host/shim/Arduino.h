@@ -0,0 +1,216 @@
+/*
+  Arduino.h - Host shim
+
+  ═══════════════════════════════════════════════════════════════════════════
+  Net genoeg Arduino API om portable firmware modules op een PC te bouwen
+  (tests, simulators, codegen). Geen hardware: pinnen doen niets.
+
+  Klok: standaard de echte monotone klok. shim_setManualClock(true) zet een
+  gesimuleerde klok aan; millis()/micros() lopen dan alleen via
+  shim_advanceUs() of delay(). Zo zijn simulaties deterministisch.
+
+  Serial schrijft naar stdout, shim_setSerialQuiet(true) zet het stil
+  (benchmarks, lange simulaties).
+  ═══════════════════════════════════════════════════════════════════════════
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string>
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#ifndef PI
+#define PI          3.14159265358979323846
+#endif
+#define DEG_TO_RAD  0.017453292519943295769236907684886
+#define RAD_TO_DEG  57.295779513082320876798154814105
+
+#define HIGH          1
+#define LOW           0
+#define INPUT         0
+#define OUTPUT        1
+#define INPUT_PULLUP  2
+#define IRAM_ATTR
+
+// ===== Klok =====
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void shim_setManualClock(bool manual);   // true = gesimuleerde klok
+void shim_setMicros(uint64_t us);        // Alleen bij manual clock
+void shim_advanceUs(uint64_t us);
+static inline void shim_advanceMs(uint32_t ms) { shim_advanceUs((uint64_t)ms * 1000); }
+
+// ===== FreeRTOS =====
+// Host builds zijn single threaded: een kritieke sectie is niets
+
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED  0
+#define portENTER_CRITICAL(mux)       ((void)(mux))
+#define portEXIT_CRITICAL(mux)        ((void)(mux))
+
+// ===== Overig =====
+
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+long random(long maxValue);
+long random(long minValue, long maxValue);
+void randomSeed(unsigned long seed);
+
+static inline void pinMode(int, int) {}
+static inline void digitalWrite(int, int) {}
+static inline int digitalRead(int) { return LOW; }
+static inline int analogRead(int) { return 0; }
+
+static inline void* ps_malloc(size_t size) { return malloc(size); }
+static inline bool psramFound() { return false; }
+
+// ===== String =====
+
+class String {
+public:
+  String() {}
+  String(const char* cstr) : s(cstr ? cstr : "") {}
+  String(const std::string& str) : s(str) {}
+  explicit String(char c) : s(1, c) {}
+  String(int value, unsigned char base = 10);
+  String(unsigned int value, unsigned char base = 10);
+  String(long value, unsigned char base = 10);
+  String(unsigned long value, unsigned char base = 10);
+  String(float value, unsigned int decimals = 2);
+  String(double value, unsigned int decimals = 2);
+
+  const char* c_str() const { return s.c_str(); }
+  unsigned int length() const { return (unsigned int)s.size(); }
+  bool isEmpty() const { return s.empty(); }
+  void reserve(unsigned int size) { s.reserve(size); }
+
+  char charAt(unsigned int index) const { return index < s.size() ? s[index] : 0; }
+  char operator[](unsigned int index) const { return charAt(index); }
+  char& operator[](unsigned int index) { return s[index]; }
+
+  int indexOf(char c, unsigned int from = 0) const;
+  int indexOf(const String& str, unsigned int from = 0) const;
+  int lastIndexOf(char c) const;
+  int lastIndexOf(const String& str) const;
+  String substring(unsigned int from) const;
+  String substring(unsigned int from, unsigned int to) const;
+
+  bool startsWith(const String& prefix) const;
+  bool endsWith(const String& suffix) const;
+  bool equals(const String& other) const { return s == other.s; }
+  bool equalsIgnoreCase(const String& other) const;
+
+  void replace(const String& find, const String& with);
+  void remove(unsigned int index, unsigned int count = (unsigned int)-1);
+  void trim();
+  void toLowerCase();
+  void toUpperCase();
+  void toCharArray(char* buf, unsigned int size) const;
+
+  long toInt() const { return strtol(s.c_str(), nullptr, 10); }
+  float toFloat() const { return strtof(s.c_str(), nullptr); }
+  double toDouble() const { return strtod(s.c_str(), nullptr); }
+
+  bool concat(const String& other) { s += other.s; return true; }
+  String& operator+=(const String& other) { s += other.s; return *this; }
+  String& operator+=(const char* other) { s += other; return *this; }
+  String& operator+=(char c) { s += c; return *this; }
+  String& operator+=(int value) { return *this += String(value); }
+  String& operator+=(unsigned int value) { return *this += String(value); }
+  String& operator+=(long value) { return *this += String(value); }
+  String& operator+=(unsigned long value) { return *this += String(value); }
+  String& operator+=(float value) { return *this += String(value); }
+  String& operator+=(double value) { return *this += String(value); }
+
+  bool operator==(const String& other) const { return s == other.s; }
+  bool operator==(const char* other) const { return s == (other ? other : ""); }
+  bool operator!=(const String& other) const { return s != other.s; }
+  bool operator!=(const char* other) const { return !(*this == other); }
+  bool operator<(const String& other) const { return s < other.s; }
+
+  std::string s;
+};
+
+String operator+(const String& a, const String& b);
+String operator+(const String& a, const char* b);
+String operator+(const char* a, const String& b);
+String operator+(const String& a, char b);
+String operator+(const String& a, int b);
+String operator+(const String& a, unsigned int b);
+String operator+(const String& a, long b);
+String operator+(const String& a, unsigned long b);
+String operator+(const String& a, float b);
+String operator+(const String& a, double b);
+
+// ===== Print / Stream =====
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(const uint8_t* buffer, size_t size) = 0;
+  size_t write(uint8_t c) { return write(&c, 1); }
+
+  size_t print(const char* str) { return write((const uint8_t*)str, strlen(str)); }
+  size_t print(const String& str) { return print(str.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int value) { return print(String(value)); }
+  size_t print(unsigned int value) { return print(String(value)); }
+  size_t print(long value) { return print(String(value)); }
+  size_t print(unsigned long value) { return print(String(value)); }
+  size_t print(double value, int decimals = 2) { return print(String(value, decimals)); }
+
+  size_t println() { return print("\n"); }
+  template <typename T>
+  size_t println(const T& value) { return print(value) + println(); }
+  size_t println(double value, int decimals) { return print(value, decimals) + println(); }
+
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  String readStringUntil(char terminator);
+  String readString();
+  size_t readBytes(char* buffer, size_t length);
+  size_t readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+  void setTimeout(unsigned long) {}
+};
+
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long) {}
+  void flush() { fflush(stdout); }
+  operator bool() const { return true; }
+
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+};
+
+extern HardwareSerial Serial;
+
+void shim_setSerialQuiet(bool quiet);
@@ -0,0 +1,7 @@
+/*
+  BLEClient.h - Host shim, zie BLEDevice.h
+*/
+
+#pragma once
+
+#include "BLEDevice.h"
@@ -0,0 +1,11 @@
+/*
+  BLEDevice.h - Host shim
+
+  Leeg: keon_ble.h haalt de BLE headers binnen, maar de declaraties die de
+  host builds gebruiken (keon_motion.cpp) hebben geen BLE types nodig.
+  Code die echt BLE doet (keon_ble.cpp, solace_ble.cpp) bouwt niet op de PC.
+*/
+
+#pragma once
+
+#include "Arduino.h"
@@ -0,0 +1,173 @@
+/*
+  FS.cpp - Host shim implementatie (SD / SD_MMC op een map)
+*/
+
+#include "FS.h"
+#include "SD.h"
+#include "SD_MMC.h"
+
+#include <filesystem>
+#include <system_error>
+#include <vector>
+
+namespace stdfs = std::filesystem;
+
+static std::string sdRoot = "sd";
+
+void shim_setSdRoot(const char* hostDir) {
+  sdRoot = hostDir ? hostDir : "sd";
+}
+
+std::string shim_sdPath(const char* path) {
+  std::string p = path ? path : "/";
+  if (p.empty() || p[0] != '/') p = "/" + p;
+  return sdRoot + p;
+}
+
+namespace fs {
+
+// ===== File =====
+
+File::File(const std::string& host, const std::string& name, const char* mode)
+    : hostPath(host), virtualPath(name) {
+  size_t slash = name.find_last_of('/');
+  fileName = slash == std::string::npos ? name : name.substr(slash + 1);
+
+  std::error_code ec;
+  if (stdfs::is_directory(host, ec)) {
+    isDir = true;
+    return;
+  }
+  // "w"/"a" zoals op de ESP32: binair, geen CRLF vertaling
+  std::string m = std::string(mode) + "b";
+  fp = fopen(host.c_str(), m.c_str());
+}
+
+File::File(File&& other) noexcept { *this = std::move(other); }
+
+File& File::operator=(File&& other) noexcept {
+  if (this != &other) {
+    close();
+    fp = other.fp;
+    isDir = other.isDir;
+    hostPath = std::move(other.hostPath);
+    fileName = std::move(other.fileName);
+    virtualPath = std::move(other.virtualPath);
+    dirIndex = other.dirIndex;
+    other.fp = nullptr;
+    other.isDir = false;
+  }
+  return *this;
+}
+
+File::~File() { close(); }
+
+void File::close() {
+  if (fp) fclose(fp);
+  fp = nullptr;
+  isDir = false;
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+  return fp ? fwrite(buffer, 1, size, fp) : 0;
+}
+
+int File::available() {
+  if (!fp) return 0;
+  long pos = ftell(fp);
+  fseek(fp, 0, SEEK_END);
+  long end = ftell(fp);
+  fseek(fp, pos, SEEK_SET);
+  return (int)(end - pos);
+}
+
+int File::read() {
+  if (!fp) return -1;
+  int c = fgetc(fp);
+  return c == EOF ? -1 : c;
+}
+
+int File::peek() {
+  if (!fp) return -1;
+  int c = fgetc(fp);
+  if (c == EOF) return -1;
+  ungetc(c, fp);
+  return c;
+}
+
+void File::flush() {
+  if (fp) fflush(fp);
+}
+
+bool File::seek(uint32_t pos) {
+  return fp && fseek(fp, pos, SEEK_SET) == 0;
+}
+
+size_t File::position() const {
+  return fp ? (size_t)ftell(fp) : 0;
+}
+
+size_t File::size() const {
+  std::error_code ec;
+  if (fp) fflush(fp);
+  auto n = stdfs::file_size(hostPath, ec);
+  return ec ? 0 : (size_t)n;
+}
+
+File File::openNextFile() {
+  if (!isDir) return File();
+
+  // Gesorteerd, zodat de volgorde op elke PC gelijk is
+  std::vector<std::string> names;
+  std::error_code ec;
+  for (const auto& entry : stdfs::directory_iterator(hostPath, ec)) {
+    names.push_back(entry.path().filename().string());
+  }
+  std::sort(names.begin(), names.end());
+
+  if (dirIndex >= names.size()) return File();
+  const std::string& n = names[dirIndex++];
+  std::string child = virtualPath == "/" ? "/" + n : virtualPath + "/" + n;
+  return File(hostPath + "/" + n, child, FILE_READ);
+}
+
+// ===== FS =====
+
+File FS::open(const char* path, const char* mode) {
+  std::string host = shim_sdPath(path);
+  std::error_code ec;
+  if (strcmp(mode, FILE_READ) == 0 && !stdfs::exists(host, ec)) return File();
+  return File(host, path, mode);
+}
+
+bool FS::exists(const char* path) {
+  std::error_code ec;
+  return stdfs::exists(shim_sdPath(path), ec);
+}
+
+bool FS::mkdir(const char* path) {
+  std::error_code ec;
+  stdfs::create_directories(shim_sdPath(path), ec);
+  return !ec;
+}
+
+bool FS::remove(const char* path) {
+  std::error_code ec;
+  return stdfs::remove(shim_sdPath(path), ec);
+}
+
+bool FS::rename(const char* from, const char* to) {
+  std::error_code ec;
+  stdfs::rename(shim_sdPath(from), shim_sdPath(to), ec);
+  return !ec;
+}
+
+bool FS::rmdir(const char* path) {
+  std::error_code ec;
+  return stdfs::remove(shim_sdPath(path), ec);
+}
+
+}  // namespace fs
+
+SDFS SD;
+SDMMCFS SD_MMC;
@@ -0,0 +1,87 @@
+/*
+  FS.h - Host shim
+
+  SD / SD_MMC paden ("/ml_training/model.bin") komen onder een map op de PC
+  terecht, standaard ./sd. shim_setSdRoot() kiest een andere map.
+*/
+
+#pragma once
+
+#include "Arduino.h"
+
+#define FILE_READ    "r"
+#define FILE_WRITE   "w"
+#define FILE_APPEND  "a"
+
+enum sdcard_type_t { CARD_NONE = 0, CARD_MMC, CARD_SD, CARD_SDHC, CARD_UNKNOWN };
+
+namespace fs {
+
+class File : public Stream {
+public:
+  File() {}
+  File(const std::string& hostPath, const std::string& name, const char* mode);
+  File(const File& other) = delete;
+  File& operator=(const File& other) = delete;
+  File(File&& other) noexcept;
+  File& operator=(File&& other) noexcept;
+  ~File();
+
+  operator bool() const { return fp != nullptr || isDir; }
+  void close();
+
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int peek() override;
+  void flush();
+
+  bool seek(uint32_t pos);
+  size_t position() const;
+  size_t size() const;
+  const char* name() const { return fileName.c_str(); }
+  const char* path() const { return virtualPath.c_str(); }
+
+  bool isDirectory() const { return isDir; }
+  File openNextFile();
+  void rewindDirectory() { dirIndex = 0; }
+
+private:
+  FILE* fp = nullptr;
+  bool isDir = false;
+  std::string hostPath;
+  std::string fileName;
+  std::string virtualPath;
+  size_t dirIndex = 0;
+};
+
+class FS {
+public:
+  bool begin(bool = true, const char* = nullptr, uint8_t = 5, bool = false) { return true; }
+  void end() {}
+
+  File open(const char* path, const char* mode = FILE_READ);
+  File open(const String& path, const char* mode = FILE_READ) { return open(path.c_str(), mode); }
+  bool exists(const char* path);
+  bool exists(const String& path) { return exists(path.c_str()); }
+  bool mkdir(const char* path);
+  bool mkdir(const String& path) { return mkdir(path.c_str()); }
+  bool remove(const char* path);
+  bool remove(const String& path) { return remove(path.c_str()); }
+  bool rename(const char* from, const char* to);
+  bool rmdir(const char* path);
+
+  sdcard_type_t cardType() { return CARD_SDHC; }
+  uint64_t cardSize() { return 0; }
+  uint64_t totalBytes() { return 0; }
+  uint64_t usedBytes() { return 0; }
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
+
+void shim_setSdRoot(const char* hostDir);
+std::string shim_sdPath(const char* path);   // Host pad voor een SD pad
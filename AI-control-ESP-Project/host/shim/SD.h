@@ -0,0 +1,11 @@
+/*
+  SD.h - Host shim, zie FS.h
+*/
+
+#pragma once
+
+#include "FS.h"
+
+class SDFS : public fs::FS {};
+
+extern SDFS SD;
@@ -0,0 +1,11 @@
+/*
+  SD_MMC.h - Host shim, zie FS.h
+*/
+
+#pragma once
+
+#include "FS.h"
+
+class SDMMCFS : public fs::FS {};
+
+extern SDMMCFS SD_MMC;
@@ -0,0 +1,315 @@
+/*
+  test_change_point - Page-Hinkley / CUSUM detector (Body change_point.cpp)
+
+  ═══════════════════════════════════════════════════════════════════════════
+  Gesimuleerde HR op 10 Hz (70 BPM, gaussische ruis σ = 2 BPM), gesimuleerde
+  klok. Meet wat change_point.h belooft:
+    - sprong van 2σ       → detectie vertraging (samples)
+    - helling 0.025σ/tick → detectie vertraging
+    - stilstaand signaal  → vals alarm per 1000 samples
+  zowel voor ruwe alarmen als voor bevestigde (persistentie, HR + GSR
+  samen), plus richting, onset schatting, ontbrekende sensor en de ring.
+  ═══════════════════════════════════════════════════════════════════════════
+*/
+
+#include <Arduino.h>
+#include <random>
+#include <vector>
+
+#include "change_point.h"
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                          \
+  do {                                            \
+    if (!(cond)) {                                \
+      failures++;                                 \
+      printf("  FOUT %s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__);                        \
+      printf("\n");                               \
+    }                                             \
+  } while (0)
+
+static const float HR_BASE = 70.0f;
+static const float HR_NOISE = 2.0f;     // σ
+static const uint32_t TICK_MS = 100;    // 10 Hz
+static const int TRIALS = 200;
+static const int CHANGE_AT = 300;       // Na warm-up + inregelen
+
+// Eén sample HR (Temp/GSR 0 = sensor ontbreekt, alleen HR kanaal actief)
+static void feedHr(float hr) {
+  shim_advanceMs(TICK_MS);
+  changePoint_update(hr, 0.0f, 0.0f);
+}
+
+// Eerste HR event na lastSeq, -1 = geen
+static int nextHrEvent(uint32_t& lastSeq, ChangePointEvent& out) {
+  ChangePointEvent ev;
+  while (changePoint_next(lastSeq, ev)) {
+    if (ev.channel == CP_HR) {
+      out = ev;
+      return 1;
+    }
+  }
+  return -1;
+}
+
+// Ruwe alarmen en bevestigingen apart geteld
+struct DelayStats {
+  int detected = 0;
+  int wrongDirection = 0;   // Vals alarm tegen de verandering in
+  int early = 0;            // Vals alarm vóór de verandering
+  double delaySum = 0;
+  int delayMax = 0;
+  double onsetErrSum = 0;   // |onset - echte start| in samples
+};
+
+struct TrialStats {
+  DelayStats raw;
+  DelayStats confirmed;
+};
+
+// Event verwerken, true = eerste detectie in de goede richting
+static bool countEvent(DelayStats& stats, const ChangePointEvent& ev, int i, int direction, uint32_t changeMs) {
+  if (i < CHANGE_AT) {
+    stats.early++;
+    return false;
+  }
+  if (ev.direction != direction) {
+    // Kan bij een trage helling: ruis alarm vóór de helling groot is
+    stats.wrongDirection++;
+    return false;
+  }
+  int delay = i - CHANGE_AT;
+  stats.detected++;
+  stats.delaySum += delay;
+  stats.delayMax = max(stats.delayMax, delay);
+  stats.onsetErrSum += fabs((double)ev.onsetMs - (double)changeMs) / TICK_MS;
+  return true;
+}
+
+static double meanDelay(const DelayStats& s) {
+  return s.detected ? s.delaySum / s.detected : 0;
+}
+
+// Verandering vanaf CHANGE_AT: level(i) geeft de verschuiving in σ
+template <typename LevelFn>
+static TrialStats runTrials(LevelFn level, int maxSamples, int direction) {
+  TrialStats stats;
+  std::mt19937 rng(42);
+  std::normal_distribution<float> noise(0.0f, HR_NOISE);
+
+  for (int t = 0; t < TRIALS; t++) {
+    changePoint_reset();
+    uint32_t lastSeq = 0;
+    ChangePointEvent drain;
+    while (changePoint_next(lastSeq, drain)) {}
+
+    uint32_t changeMs = 0;
+    bool rawDone = false;
+    bool confirmedDone = false;
+    for (int i = 0; i < maxSamples && !confirmedDone; i++) {
+      float shift = i >= CHANGE_AT ? level(i - CHANGE_AT) : 0.0f;
+      feedHr(HR_BASE + shift * HR_NOISE + noise(rng));
+      if (i == CHANGE_AT) changeMs = millis();
+
+      ChangePointEvent ev;
+      while (nextHrEvent(lastSeq, ev) > 0) {
+        if (ev.confirmed) {
+          confirmedDone = countEvent(stats.confirmed, ev, i, direction, changeMs) || confirmedDone;
+        } else if (!rawDone) {
+          rawDone = countEvent(stats.raw, ev, i, direction, changeMs);
+        }
+      }
+    }
+  }
+  return stats;
+}
+
+static void printStats(const char* label, const DelayStats& s) {
+  printf("  %s: gedetecteerd %d/%d, vertraging gem %.1f max %d samples\n",
+         label, s.detected, TRIALS, meanDelay(s), s.delayMax);
+  printf("  %s: vals alarm %d vooraf, %d tegengesteld\n", label, s.early, s.wrongDirection);
+}
+
+// Vóór de verandering: ~250 samples na de warm-up per run. Ruw ≈ 1 per
+// 800 samples → verwacht ~0.3 per run; bevestigd vrijwel nooit.
+static void checkEarly(const TrialStats& s) {
+  CHECK(s.raw.early <= TRIALS * 3 / 5, "%d ruwe alarmen vóór de verandering (max %d)", s.raw.early, TRIALS * 3 / 5);
+  CHECK(s.confirmed.early <= TRIALS / 100, "%d bevestigde alarmen vóór de verandering (max %d)",
+        s.confirmed.early, TRIALS / 100);
+}
+
+// ===== Tests =====
+
+static void testStep() {
+  printf("Sprong 2σ omhoog (%d runs)\n", TRIALS);
+  TrialStats s = runTrials([](int) { return 2.0f; }, CHANGE_AT + 100, +1);
+  printStats("ruw", s.raw);
+  printStats("bevestigd", s.confirmed);
+  printf("  onset fout %.1f samples\n", s.raw.detected ? s.raw.onsetErrSum / s.raw.detected : 0);
+
+  CHECK(s.raw.detected >= TRIALS * 95 / 100, "te weinig detecties: %d", s.raw.detected);
+  CHECK(meanDelay(s.raw) <= 6.0, "gemiddelde vertraging %.1f > 6 samples", meanDelay(s.raw));
+  CHECK(s.raw.wrongDirection <= TRIALS / 20, "%d alarmen in verkeerde richting", s.raw.wrongDirection);
+  CHECK(s.raw.detected && s.raw.onsetErrSum / s.raw.detected <= 4.0, "onset schatting te ver van de sprong");
+  CHECK(s.confirmed.detected >= TRIALS * 95 / 100, "te weinig bevestigd: %d", s.confirmed.detected);
+  CHECK(meanDelay(s.confirmed) <= 6.0 + CP_CONFIRM_SAMPLES, "bevestiging na gem %.1f samples",
+        meanDelay(s.confirmed));
+  CHECK(s.confirmed.wrongDirection == 0, "%d bevestigd in verkeerde richting", s.confirmed.wrongDirection);
+  checkEarly(s);
+}
+
+static void testStepDown() {
+  printf("Sprong 2σ omlaag (%d runs)\n", TRIALS);
+  TrialStats s = runTrials([](int) { return -2.0f; }, CHANGE_AT + 100, -1);
+  printStats("ruw", s.raw);
+  printStats("bevestigd", s.confirmed);
+
+  CHECK(s.raw.detected >= TRIALS * 95 / 100, "te weinig detecties: %d", s.raw.detected);
+  CHECK(meanDelay(s.raw) <= 6.0, "gemiddelde vertraging %.1f > 6 samples", meanDelay(s.raw));
+  CHECK(s.raw.wrongDirection <= TRIALS / 20, "%d alarmen in verkeerde richting", s.raw.wrongDirection);
+  CHECK(s.confirmed.detected >= TRIALS * 95 / 100, "te weinig bevestigd: %d", s.confirmed.detected);
+  CHECK(meanDelay(s.confirmed) <= 6.0 + CP_CONFIRM_SAMPLES, "bevestiging na gem %.1f samples",
+        meanDelay(s.confirmed));
+  CHECK(s.confirmed.wrongDirection == 0, "%d bevestigd in verkeerde richting", s.confirmed.wrongDirection);
+  checkEarly(s);
+}
+
+static void testRamp() {
+  printf("Helling 0.025σ per sample (%d runs)\n", TRIALS);
+  TrialStats s = runTrials([](int i) { return 0.025f * i; }, CHANGE_AT + 300, +1);
+  printStats("ruw", s.raw);
+  printStats("bevestigd", s.confirmed);
+
+  CHECK(s.raw.detected >= TRIALS * 95 / 100, "te weinig detecties: %d", s.raw.detected);
+  CHECK(meanDelay(s.raw) <= 50.0, "gemiddelde vertraging %.1f > 50 samples", meanDelay(s.raw));
+  CHECK(s.raw.wrongDirection <= TRIALS / 20, "%d alarmen in verkeerde richting", s.raw.wrongDirection);
+  CHECK(s.confirmed.detected >= TRIALS * 95 / 100, "te weinig bevestigd: %d", s.confirmed.detected);
+  CHECK(meanDelay(s.confirmed) <= 50.0 + CP_CONFIRM_SAMPLES, "bevestiging na gem %.1f samples",
+        meanDelay(s.confirmed));
+  CHECK(s.confirmed.wrongDirection == 0, "%d bevestigd in verkeerde richting", s.confirmed.wrongDirection);
+  checkEarly(s);
+}
+
+// HR en GSR tegelijk omhoog: bevestigd zonder het persistentie venster af te wachten
+static void testCrossChannel() {
+  printf("HR + GSR samen (%d runs)\n", TRIALS);
+  std::mt19937 rng(11);
+  std::normal_distribution<float> noise(0.0f, 1.0f);
+  int confirmed = 0;
+  int delaySum = 0;
+  for (int t = 0; t < TRIALS; t++) {
+    changePoint_reset();
+    uint32_t lastSeq = 0;
+    ChangePointEvent ev;
+    while (changePoint_next(lastSeq, ev)) {}
+
+    for (int i = 0; i < CHANGE_AT + 100; i++) {
+      float shift = i >= CHANGE_AT ? 3.0f : 0.0f;
+      shim_advanceMs(TICK_MS);
+      changePoint_update(HR_BASE + (shift + noise(rng)) * HR_NOISE, 0.0f, 400.0f + (shift + noise(rng)) * 10.0f);
+      bool done = false;
+      while (changePoint_next(lastSeq, ev)) {
+        if (ev.confirmed && i >= CHANGE_AT && ev.direction > 0) done = true;
+      }
+      if (done) {
+        confirmed++;
+        delaySum += i - CHANGE_AT;
+        break;
+      }
+    }
+  }
+  double mean = confirmed ? (double)delaySum / confirmed : 0;
+  printf("  bevestigd %d/%d, gem %.1f samples\n", confirmed, TRIALS, mean);
+  CHECK(confirmed >= TRIALS * 95 / 100, "te weinig bevestigd: %d", confirmed);
+  CHECK(mean < CP_CONFIRM_SAMPLES / 2, "HR + GSR bevestiging na gem %.1f samples", mean);
+}
+
+static void testFalseAlarms() {
+  const int samples = 200000;
+  printf("Stilstaand signaal (%d samples)\n", samples);
+
+  std::mt19937 rng(7);
+  std::normal_distribution<float> noise(0.0f, HR_NOISE);
+  changePoint_reset();
+  uint32_t lastSeq = 0;
+  ChangePointEvent ev;
+  while (changePoint_next(lastSeq, ev)) {}
+
+  int alarms = 0;
+  int confirmed = 0;
+  for (int i = 0; i < samples; i++) {
+    feedHr(HR_BASE + noise(rng));
+    while (nextHrEvent(lastSeq, ev) > 0) {
+      if (ev.confirmed) confirmed++;
+      else alarms++;
+    }
+  }
+
+  double per1000 = alarms * 1000.0 / samples;
+  double confirmedPer1000 = confirmed * 1000.0 / samples;
+  printf("  ruw: %d valse alarmen = %.2f per 1000 samples (1 per %.0f)\n",
+         alarms, per1000, alarms ? (double)samples / alarms : 0.0);
+  printf("  bevestigd: %d = %.3f per 1000 samples\n", confirmed, confirmedPer1000);
+  CHECK(per1000 <= 2.0, "vals alarm %.2f per 1000 samples > 2", per1000);
+  CHECK(confirmedPer1000 <= 0.05, "bevestigd vals alarm %.3f per 1000 samples > 0.05", confirmedPer1000);
+}
+
+static void testMissingSensor() {
+  printf("Ontbrekende sensor\n");
+  changePoint_reset();
+  uint32_t lastSeq = 0;
+  ChangePointEvent ev;
+  while (changePoint_next(lastSeq, ev)) {}
+
+  // Inregelen op 70, dan uitval (0) en terug: geen alarm
+  for (int i = 0; i < 200; i++) feedHr(HR_BASE);
+  for (int i = 0; i < 50; i++) feedHr(0.0f);
+  for (int i = 0; i < 50; i++) feedHr(HR_BASE);
+  CHECK(nextHrEvent(lastSeq, ev) < 0, "alarm door sensor uitval");
+}
+
+static void testEventRing() {
+  printf("Event ring\n");
+  changePoint_reset();
+  uint32_t reader = 0;
+  ChangePointEvent ev;
+  while (changePoint_next(reader, ev)) {}
+  uint32_t lagging = reader;
+
+  // Blokgolf: elke sprong geeft een event, meer dan de ring bevat
+  for (int i = 0; i < 100; i++) feedHr(HR_BASE);
+  int generated = 0;
+  for (int block = 0; block < CP_EVENT_RING + 4; block++) {
+    float level = (block % 2 == 0) ? HR_BASE + 20 : HR_BASE;
+    for (int i = 0; i < 40; i++) feedHr(level);
+  }
+  uint32_t seq = reader;
+  while (changePoint_next(seq, ev)) generated++;
+  CHECK(generated == CP_EVENT_RING, "lezer ziet %d events, verwacht %d (laatste in de ring)",
+        generated, CP_EVENT_RING);
+
+  // Achterlopende lezer slaat over naar het oudste event dat nog in de ring staat
+  CHECK(changePoint_next(lagging, ev), "achterlopende lezer krijgt niets");
+  CHECK(ev.seq == seq - CP_EVENT_RING + 1, "oudste event seq %u, verwacht %u",
+        ev.seq, seq - CP_EVENT_RING + 1);
+  CHECK(strcmp(changePoint_eventName(ev), ev.direction > 0 ? "CP_HR_UP" : "CP_HR_DOWN") == 0,
+        "event naam %s", changePoint_eventName(ev));
+}
+
+int main() {
+  shim_setManualClock(true);
+  shim_setSerialQuiet(true);
+
+  testStep();
+  testStepDown();
+  testRamp();
+  testCrossChannel();
+  testFalseAlarms();
+  testMissingSensor();
+  testEventRing();
+
+  printf(failures ? "test_change_point: %d FOUT(EN)\n" : "test_change_point: OK\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,252 @@
+/*
+  test_espnow_protocol - Wire formaat van espnow_protocol.h
+
+  ═══════════════════════════════════════════════════════════════════════════
+  Header-only, geen shim nodig (bouwt met -Wall -Wextra -Werror):
+    - round-trip encode → decode voor elke opcode, met en zonder trace
+    - STATUS_DELTA voor alle veldmaskers
+    - afgekapte frames, te lange frames, andere versie / magic / opcode
+    - fixed point afronding en begrenzing, statusDiff deadband
+  De Makefile controleert daarnaast dat alle vier de kopieën gelijk zijn.
+  ═══════════════════════════════════════════════════════════════════════════
+*/
+
+#include <stdio.h>
+#include <random>
+#include <vector>
+
+#include "espnow_protocol.h"
+
+static int failures = 0;
+static int checks = 0;
+
+#define CHECK(cond, ...)                            \
+  do {                                              \
+    checks++;                                       \
+    if (!(cond)) {                                  \
+      failures++;                                   \
+      printf("  FOUT %s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__);                          \
+      printf("\n");                                 \
+    }                                               \
+  } while (0)
+
+static std::mt19937 rng(2024);
+
+static void randomBytes(void* dst, size_t len) {
+  uint8_t* p = (uint8_t*)dst;
+  for (size_t i = 0; i < len; i++) p[i] = (uint8_t)rng();
+}
+
+// Alle opcodes met een vaste payload (STATUS_DELTA apart)
+static std::vector<uint8_t> knownOpcodes() {
+  std::vector<uint8_t> ops;
+  for (int op = 0; op < 256; op++) {
+    if (op != ESPNOW_OP_STATUS_DELTA && espnow_payloadSize(op) > 0) ops.push_back((uint8_t)op);
+  }
+  return ops;
+}
+
+// Geldig frame voor op in out[], geeft lengte terug
+static uint8_t encodeRandom(uint8_t op, bool withTrace, EspNowFrame& frame, uint8_t out[ESPNOW_MAX_FRAME]) {
+  memset(&frame, 0, sizeof(frame));
+  randomBytes(&frame.ai, espnow_payloadSize(op));
+  randomBytes(&frame.trace, sizeof(frame.trace));
+  return espnow_encode(frame, op, (uint16_t)rng(), rng(), withTrace, out);
+}
+
+// ===== Tests =====
+
+static void testRoundTrip() {
+  printf("Round-trip alle opcodes\n");
+  std::vector<uint8_t> ops = knownOpcodes();
+  CHECK(ops.size() == 27, "%zu opcodes met payload, verwacht 27", ops.size());
+
+  for (uint8_t op : ops) {
+    for (int trace = 0; trace < 2; trace++) {
+      EspNowFrame frame, decoded;
+      uint8_t buf[ESPNOW_MAX_FRAME];
+      uint8_t len = encodeRandom(op, trace, frame, buf);
+
+      int expected = sizeof(EspNowHeader) + espnow_payloadSize(op) + (trace ? sizeof(EspNowTracePayload) : 0);
+      CHECK(len == expected, "%s: lengte %u, verwacht %d", espnow_opcodeName(op), len, expected);
+
+      EspNowDecodeResult r = espnow_decode(buf, len, decoded);
+      CHECK(r == ESPNOW_DECODE_OK, "%s: %s", espnow_opcodeName(op), espnow_decodeError(r));
+      CHECK(memcmp(&decoded.hdr, &frame.hdr, sizeof(EspNowHeader)) == 0, "%s: header", espnow_opcodeName(op));
+      CHECK(memcmp(&decoded.ai, &frame.ai, espnow_payloadSize(op)) == 0, "%s: payload", espnow_opcodeName(op));
+      if (trace) {
+        CHECK(memcmp(&decoded.trace, &frame.trace, sizeof(EspNowTracePayload)) == 0,
+              "%s: trace", espnow_opcodeName(op));
+      }
+
+      // Flags volgen uit de opcode, niet uit de aanroeper
+      CHECK(((decoded.hdr.flags & ESPNOW_FLAG_ACK_REQ) != 0) == espnow_needsAck(op),
+            "%s: ACK_REQ flag", espnow_opcodeName(op));
+      CHECK(((decoded.hdr.flags & ESPNOW_FLAG_PRIORITY) != 0) == espnow_isPriority(op),
+            "%s: PRIORITY flag", espnow_opcodeName(op));
+      CHECK(espnow_peekPriority(buf, len) == espnow_isPriority(op), "%s: peekPriority", espnow_opcodeName(op));
+      CHECK(strcmp(espnow_opcodeName(op), "?") != 0, "opcode 0x%02X zonder naam", op);
+    }
+  }
+
+  // Voorrang altijd met ACK
+  for (uint8_t op : ops) {
+    if (espnow_isPriority(op)) CHECK(espnow_needsAck(op), "%s: voorrang zonder ACK", espnow_opcodeName(op));
+  }
+
+  // Alleen SYNCED gaat via extraFlags door
+  EspNowFrame frame, decoded;
+  uint8_t buf[ESPNOW_MAX_FRAME];
+  memset(&frame, 0, sizeof(frame));
+  uint8_t len = espnow_encode(frame, ESPNOW_OP_HEARTBEAT, 1, 2, false, buf, 0xFF);
+  CHECK(espnow_decode(buf, len, decoded) == ESPNOW_DECODE_OK, "HEARTBEAT met extraFlags");
+  CHECK(decoded.hdr.flags == ESPNOW_FLAG_SYNCED, "extraFlags 0xFF → flags 0x%02X", decoded.hdr.flags);
+}
+
+static void testStatusDelta() {
+  printf("STATUS_DELTA alle maskers\n");
+  for (uint16_t mask = 0; mask <= ESPNOW_SF_ALL; mask++) {
+    EspNowStatusPayload st, base, applied;
+    randomBytes(&st, sizeof(st));
+    randomBytes(&base, sizeof(base));
+    applied = base;
+
+    EspNowFrame frame, decoded;
+    uint8_t buf[ESPNOW_MAX_FRAME];
+    memset(&frame, 0, sizeof(frame));
+    espnow_buildStatusDelta(frame, st, mask);
+    uint8_t len = espnow_encode(frame, ESPNOW_OP_STATUS_DELTA, mask, 0, false, buf);
+    CHECK(len == sizeof(EspNowHeader) + espnow_deltaSize(mask), "masker 0x%03X: lengte %u", mask, len);
+
+    EspNowDecodeResult r = espnow_decode(buf, len, decoded);
+    CHECK(r == ESPNOW_DECODE_OK, "masker 0x%03X: %s", mask, espnow_decodeError(r));
+    CHECK(espnow_applyStatusDelta(decoded, applied) == mask, "masker 0x%03X terug", mask);
+
+    // Velden in het masker van st, de rest onveranderd van base
+    EspNowStatusPayload expected = base;
+    espnow_copyStatusFields(st, expected, mask);
+    CHECK(memcmp(&applied, &expected, sizeof(expected)) == 0, "masker 0x%03X: velden", mask);
+
+    // Afgekapt: masker belooft meer velden dan er zijn
+    if (mask != 0) {
+      CHECK(espnow_decode(buf, len - 1, decoded) == ESPNOW_DECODE_BAD_LENGTH, "masker 0x%03X afgekapt", mask);
+    }
+  }
+
+  // Niet bestaande veld bits → geen geldige lengte te bepalen
+  uint8_t buf[ESPNOW_MAX_FRAME];
+  EspNowFrame frame, decoded;
+  memset(&frame, 0, sizeof(frame));
+  uint8_t len = espnow_encode(frame, ESPNOW_OP_STATUS_DELTA, 0, 0, false, buf);
+  uint16_t badMask = 1u << ESPNOW_SF_COUNT;
+  memcpy(buf + sizeof(EspNowHeader), &badMask, 2);
+  CHECK(espnow_decode(buf, len, decoded) == ESPNOW_DECODE_BAD_LENGTH, "onbekend veld bit");
+
+  // Alleen header, masker ontbreekt
+  CHECK(espnow_decode(buf, sizeof(EspNowHeader) + 1, decoded) == ESPNOW_DECODE_BAD_LENGTH, "delta zonder masker");
+}
+
+static void testTruncated() {
+  printf("Afgekapte en te lange frames\n");
+  for (uint8_t op : knownOpcodes()) {
+    for (int trace = 0; trace < 2; trace++) {
+      EspNowFrame frame, decoded;
+      uint8_t buf[ESPNOW_MAX_FRAME + 1];
+      uint8_t len = encodeRandom(op, trace, frame, buf);
+
+      for (int cut = 0; cut < len; cut++) {
+        EspNowDecodeResult r = espnow_decode(buf, cut, decoded);
+        EspNowDecodeResult want = cut < (int)sizeof(EspNowHeader) ? ESPNOW_DECODE_TOO_SHORT
+                                                                  : ESPNOW_DECODE_BAD_LENGTH;
+        CHECK(r == want, "%s trace=%d: %d van %u bytes → %s", espnow_opcodeName(op), trace, cut, len,
+              espnow_decodeError(r));
+      }
+
+      buf[len] = 0;
+      CHECK(espnow_decode(buf, len + 1, decoded) == ESPNOW_DECODE_BAD_LENGTH,
+            "%s: byte te veel geaccepteerd", espnow_opcodeName(op));
+
+      // Trace flag zonder trace bytes (of andersom)
+      buf[3] ^= ESPNOW_FLAG_TRACE;
+      CHECK(espnow_decode(buf, len, decoded) == ESPNOW_DECODE_BAD_LENGTH,
+            "%s: trace flag past niet bij lengte", espnow_opcodeName(op));
+    }
+  }
+}
+
+static void testVersionMismatch() {
+  printf("Andere versie, magic en opcode\n");
+  EspNowFrame frame, decoded;
+  uint8_t buf[ESPNOW_MAX_FRAME];
+  uint8_t len = encodeRandom(ESPNOW_OP_EMERGENCY_STOP, false, frame, buf);
+
+  for (int v = 0; v < 256; v++) {
+    if (v == ESPNOW_PROTO_VERSION) continue;
+    buf[1] = (uint8_t)v;
+    CHECK(espnow_decode(buf, len, decoded) == ESPNOW_DECODE_BAD_VERSION, "versie %d geaccepteerd", v);
+    CHECK(!espnow_peekPriority(buf, len), "versie %d als voorrang gezien", v);
+  }
+  buf[1] = ESPNOW_PROTO_VERSION;
+
+  buf[0] = ESPNOW_PROTO_MAGIC ^ 0xFF;
+  CHECK(espnow_decode(buf, len, decoded) == ESPNOW_DECODE_BAD_MAGIC, "verkeerde magic");
+  buf[0] = ESPNOW_PROTO_MAGIC;
+
+  // Oud formaat: char command[32] + floats
+  char legacy[64] = "AI_OVERRIDE";
+  CHECK(espnow_decode((const uint8_t*)legacy, sizeof(legacy), decoded) == ESPNOW_DECODE_BAD_MAGIC,
+        "oud string bericht niet herkend");
+
+  int unknown = 0;
+  for (int op = 0; op < 256; op++) {
+    if (espnow_payloadSize(op) != 0) continue;
+    buf[2] = (uint8_t)op;
+    CHECK(espnow_decode(buf, len, decoded) == ESPNOW_DECODE_UNKNOWN_OPCODE, "opcode 0x%02X", op);
+    unknown++;
+  }
+  CHECK(unknown == 256 - 28, "%d onbekende opcodes", unknown);
+
+  // Mislukte decode laat niets van het vorige frame achter
+  CHECK(decoded.hdr.magic == ESPNOW_PROTO_MAGIC && decoded.ai.trust_x1000 == 0, "decoded niet gewist");
+}
+
+static void testFixedPoint() {
+  printf("Fixed point\n");
+  CHECK(espnow_toFixed(1.2345f, 1000) == 1235, "1.2345 x1000 → %d", espnow_toFixed(1.2345f, 1000));
+  CHECK(espnow_toFixed(-1.2345f, 1000) == -1235, "-1.2345 x1000 → %d", espnow_toFixed(-1.2345f, 1000));
+  CHECK(espnow_toFixed(100.0f, 1000) == 32767, "begrenzing boven");
+  CHECK(espnow_toFixed(-100.0f, 1000) == -32768, "begrenzing onder");
+  CHECK(espnow_toUFixed(99.96f, 10) == 1000, "99.96 x10 → %u", espnow_toUFixed(99.96f, 10));
+  CHECK(espnow_toUFixed(-1.0f, 10) == 0, "negatief unsigned");
+  CHECK(espnow_toUFixed(1e6f, 100) == 65535, "begrenzing unsigned");
+
+  // statusDiff: deadband per veld, bits altijd exact, unsigned velden niet negatief
+  EspNowStatusPayload a, b;
+  memset(&a, 0, sizeof(a));
+  b = a;
+  b.suction_x10 = 60000;   // Zou als int16 negatief zijn
+  b.trust_x1000 = 5;
+  b.bits = 1;
+  uint16_t deadband[ESPNOW_SF_COUNT] = { 10, 10, 10, 10, 10, 10, 10, 10, 10 };
+  uint16_t mask = espnow_statusDiff(a, b, deadband);
+  CHECK(mask == ((1u << ESPNOW_SF_SUCTION) | (1u << ESPNOW_SF_BITS)), "statusDiff masker 0x%03X", mask);
+  CHECK(espnow_statusField(b, ESPNOW_SF_SUCTION) == 60000, "unsigned veld %d", (int)espnow_statusField(b, ESPNOW_SF_SUCTION));
+  CHECK(espnow_statusDiff(a, b, nullptr) == ((1u << ESPNOW_SF_TRUST) | (1u << ESPNOW_SF_SUCTION) | (1u << ESPNOW_SF_BITS)),
+        "statusDiff zonder deadband");
+}
+
+int main() {
+  testRoundTrip();
+  testStatusDelta();
+  testTruncated();
+  testVersionMismatch();
+  testFixedPoint();
+
+  if (failures) {
+    printf("test_espnow_protocol: %d van %d checks FOUT\n", failures, checks);
+    return 1;
+  }
+  printf("test_espnow_protocol: OK (%d checks)\n", checks);
+  return 0;
+}
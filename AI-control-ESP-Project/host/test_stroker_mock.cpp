@@ -0,0 +1,165 @@
+/*
+  test_stroker_mock - StrokerMockDevice (HoofdESP stroker_mock.h)
+
+  ═══════════════════════════════════════════════════════════════════════════
+  De mock is het "device" in keon_motion_sim; hier zijn eigen gedrag, met
+  de gesimuleerde klok:
+    - caps zoals de Keon
+    - laatste-wint: vervangen commando → SKIPPED, geschreven → DONE
+    - minimale tussenruimte (caps.minSpacingMs) tussen writes
+    - zelfde commando als laatst geschreven → meteen SKIPPED
+    - beweging begint write + air na service(), volle slag haalt de tijd
+      die keon_kinematics.h voorspelt
+    - niet verbonden → moveAsync() weigert
+  ═══════════════════════════════════════════════════════════════════════════
+*/
+
+#include <Arduino.h>
+#include <vector>
+
+#include "stroker_mock.h"
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                          \
+  do {                                            \
+    if (!(cond)) {                                \
+      failures++;                                 \
+      printf("  FOUT %s:%d: ", __FILE__, __LINE__); \
+      printf(__VA_ARGS__);                        \
+      printf("\n");                               \
+    }                                             \
+  } while (0)
+
+struct DoneEvent {
+  uint8_t pos;
+  uint8_t speed;
+  StrokerCmdResult result;
+  uint32_t latencyUs;
+};
+
+static std::vector<DoneEvent> events;
+
+static void onDone(uint8_t position, uint8_t speed, StrokerCmdResult result, uint32_t latencyUs) {
+  events.push_back({position, speed, result, latencyUs});
+}
+
+static uint32_t count(StrokerCmdResult result) {
+  uint32_t n = 0;
+  for (const DoneEvent& e : events) n += (e.result == result);
+  return n;
+}
+
+static void testCaps() {
+  StrokerMockDevice mock;
+  const StrokerCaps& caps = mock.caps();
+  CHECK(strcmp(mock.name(), "Mock") == 0, "naam %s", mock.name());
+  CHECK(caps.position && caps.speedSteps == 100, "caps: positie %d, %u stappen", caps.position, caps.speedSteps);
+  CHECK(caps.minSpacingMs == 40 && caps.airMs == 30, "caps: spacing %u ms, air %u ms", caps.minSpacingMs, caps.airMs);
+  CHECK(mock.isConnected(), "niet verbonden na aanmaken");
+  CHECK(mock.avgLatencyUs() == 0, "latency %lu zonder writes", (unsigned long)mock.avgLatencyUs());
+}
+
+static void testCoalesce() {
+  StrokerMockDevice mock;
+  events.clear();
+  mock.moveAsync(20, 50, onDone);
+  mock.moveAsync(60, 50, onDone);
+  mock.moveAsync(90, 70, onDone);
+  CHECK(count(STROKER_CMD_SKIPPED) == 2, "%lu vervangen, verwacht 2", (unsigned long)count(STROKER_CMD_SKIPPED));
+  mock.service();
+  CHECK(count(STROKER_CMD_DONE) == 1, "%lu geschreven, verwacht 1", (unsigned long)count(STROKER_CMD_DONE));
+  CHECK(!events.empty() && events.back().pos == 90 && events.back().speed == 70,
+        "laatste write %u/%u, verwacht 90/70", events.back().pos, events.back().speed);
+  CHECK(events.back().latencyUs >= STROKER_MOCK_WRITE_MS * 1000UL, "latency %lu us < write tijd",
+        (unsigned long)events.back().latencyUs);
+
+  // Zelfde als laatst geschreven → meteen SKIPPED, geen write
+  events.clear();
+  shim_advanceMs(100);
+  mock.moveAsync(90, 70, onDone);
+  mock.service();
+  CHECK(events.size() == 1 && events[0].result == STROKER_CMD_SKIPPED, "ongewijzigd commando niet overgeslagen");
+}
+
+static void testSpacing() {
+  StrokerMockDevice mock;
+  events.clear();
+  mock.moveAsync(10, 50, onDone);
+  mock.service();
+  uint32_t firstMs = millis();
+  mock.moveAsync(80, 50, onDone);
+  uint32_t writtenMs = 0;
+  for (int i = 0; i < 100 && !writtenMs; i++) {
+    shim_advanceMs(1);
+    mock.service();
+    if (count(STROKER_CMD_DONE) == 2) writtenMs = millis();
+  }
+  CHECK(writtenMs - firstMs == mock.caps().minSpacingMs, "tweede write na %lu ms, verwacht %u",
+        (unsigned long)(writtenMs - firstMs), mock.caps().minSpacingMs);
+}
+
+// Volle slag 0 → 99 op snelheid 99: start na write + air, duur volgens het model
+static void testMotion() {
+  StrokerMockDevice mock;
+  CHECK(mock.simPos(millis()) == 0.0f, "start positie %.1f", mock.simPos(millis()));
+  uint32_t sendMs = millis();
+  mock.moveAsync(99, 99, nullptr);
+  mock.service();
+
+  uint32_t startMs = 0;
+  uint32_t arriveMs = 0;
+  for (int i = 0; i < 1000 && !arriveMs; i++) {
+    shim_advanceMs(1);
+    float p = mock.simPos(millis());
+    if (!startMs && p > 0.0f) startMs = millis();
+    if (p >= 99.0f) arriveMs = millis();
+  }
+  uint32_t applyMs = STROKER_MOCK_WRITE_MS + STROKER_MOCK_AIR_MS;
+  CHECK(startMs - sendMs == applyMs + 1, "beweegt na %lu ms, verwacht %lu",
+        (unsigned long)(startMs - sendMs), (unsigned long)(applyMs + 1));
+
+  // Trapezium: t = d/v + v/a
+  const StrokerCaps& caps = mock.caps();
+  float expectMs = (99.0f / caps.maxUnitsPerSec + caps.maxUnitsPerSec / caps.accelUps2) * 1000.0f;
+  float tookMs = (float)(arriveMs - sendMs - applyMs);
+  printf("  volle slag: %.0f ms (model %.0f ms)\n", tookMs, expectMs);
+  CHECK(arriveMs && fabsf(tookMs - expectMs) < 15.0f, "volle slag %.0f ms, model %.0f ms", tookMs, expectMs);
+
+  // Snelheid 0 = stilstaan (stop())
+  mock.moveAsync(0, 0, nullptr);
+  shim_advanceMs(40);
+  mock.service();
+  shim_advanceMs(500);
+  CHECK(mock.simPos(millis()) == 99.0f, "snelheid 0 bewoog naar %.1f", mock.simPos(millis()));
+}
+
+static void testConnection() {
+  StrokerMockDevice mock;
+  mock.disconnect();
+  CHECK(!mock.isConnected(), "nog verbonden na disconnect");
+  CHECK(!mock.moveAsync(50, 50, nullptr), "moveAsync geaccepteerd zonder verbinding");
+  CHECK(mock.connect() && mock.isConnected(), "connect mislukt");
+  CHECK(mock.moveAsync(50, 50, nullptr), "moveAsync geweigerd na connect");
+
+  // Flush wacht op service() (Keon task); hier loopt die niet
+  CHECK(!mock.flush(20), "flush klaar met een commando in de rij");
+  mock.service();
+  CHECK(mock.flush(0), "flush niet klaar na service");
+  CHECK(mock.avgLatencyUs() >= STROKER_MOCK_WRITE_MS * 1000UL, "gem latency %lu us",
+        (unsigned long)mock.avgLatencyUs());
+}
+
+int main() {
+  shim_setManualClock(true);
+  shim_setMicros(1000000);
+
+  testCaps();
+  testCoalesce();
+  testSpacing();
+  testMotion();
+  testConnection();
+
+  printf(failures ? "test_stroker_mock: %d FOUT(EN)\n" : "test_stroker_mock: OK\n", failures);
+  return failures ? 1 : 0;
+}